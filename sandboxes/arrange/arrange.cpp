@@ -0,0 +1,51 @@
+#include <iostream>
+#include <cstdlib>
+
+#include <libnest2d/libnest2d.hpp>
+#include <libnest2d/tools/benchmark.h>
+
+#include "printer_parts.hpp"
+
+// Benchmark of the nfp placer on the printer parts of the libnest2d tests.
+// Nests the given number of copies of the parts into 250 x 210 mm bins, first
+// without rotations, then trying the four right angle rotations. Prints the
+// run times and the number of the bins used.
+int main(const int argc, const char * argv[])
+{
+    using namespace libnest2d;
+
+    int copies = argc > 1 ? std::atoi(argv[1]) : 1;
+    if (copies < 1) {
+        std::cerr << "Usage: " << argv[0] << " [number of copies]" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    std::vector<Item> input;
+    input.reserve(size_t(copies) * PRINTER_PART_POLYGONS.size());
+    for (int i = 0; i < copies; ++i)
+        for (auto &part : PRINTER_PART_POLYGONS) input.emplace_back(part);
+
+    auto bin = Box(250000000, 210000000);
+
+    auto run = [&input, &bin](const std::vector<Radians> &rotations) {
+        std::vector<Item> items = input;
+
+        NestConfig<> cfg;
+        cfg.placer_config.rotations = rotations;
+
+        Benchmark bench;
+        bench.start();
+        size_t bins = nest(items, bin, 0, cfg);
+        bench.stop();
+
+        std::cout << "Items: " << items.size()
+                  << " rotations: " << rotations.size()
+                  << " bins: " << bins
+                  << " duration [s]: " << bench.getElapsedSec() << std::endl;
+    };
+
+    run({0.});
+    run({0., Pi / 2., Pi, 3. * Pi / 2.});
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,58 @@
+#include <iostream>
+#include <cstdlib>
+#include <cmath>
+#include <random>
+
+#include "libslic3r/GCode/PreviewData.hpp"
+#include "slic3r/GUI/3DScene.hpp"
+
+// Benchmark of the triangulation of the G-code preview toolpaths, headless.
+// Generates a synthetic G-code preview of the given number of layers made of finely
+// tessellated arcs, triangulates it within the given memory budget, then refines
+// the top ten layers. Prints the statistics of the toolpaths cache after each step.
+int main(const int argc, const char * argv[])
+{
+    using namespace Slic3r;
+
+    int    layers = argc > 1 ? std::atoi(argv[1]) : 300;
+    double budget = argc > 2 ? std::atof(argv[2]) : 0.;
+    if (layers < 1 || budget < 0.) {
+        std::cerr << "Usage: " << argv[0] << " [number of layers] [memory budget in MB]" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    GCodePreviewData preview_data;
+    std::mt19937 rng(1);
+    for (int l = 0; l < layers; ++ l) {
+        GCodePreviewData::Extrusion::Layer layer(0.2f * (l + 1));
+        for (int p = 0; p < 40; ++ p) {
+            GCodePreviewData::Extrusion::Path path;
+            double cx = rng() % 200;
+            double cy = rng() % 200;
+            double r  = 2. + rng() % 20;
+            for (int i = 0, n = rng() % 300; i < n; ++ i)
+                path.polyline.points.emplace_back(scale_(cx + r * cos(0.02 * i)), scale_(cy + r * sin(0.02 * i)));
+            path.width          = 0.45f;
+            path.height         = 0.2f;
+            path.extrusion_role = erPerimeter;
+            layer.append(path);
+        }
+        layer.shrink_to_fit();
+        preview_data.extrusion.layers.emplace_back(std::move(layer));
+    }
+    std::cout << "Preview data: " << Slic3r::format_memsize_MB(preview_data.memory_used()) << std::endl;
+
+    GCodePreviewToolpathsCache cache;
+    GCodePreviewToolpathsCache::Limits limits;
+    limits.memory_budget = size_t(budget * 1024. * 1024.);
+    cache.set_limits(limits);
+
+    cache.update(preview_data);
+    std::cout << "Update: " << cache.stats().to_string() << std::endl;
+
+    size_t top = preview_data.extrusion.layers.size();
+    cache.refine(preview_data, (top > 10) ? top - 10 : 0, top);
+    std::cout << "Refine: " << cache.stats().to_string() << std::endl;
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,53 @@
+#include <iostream>
+#include <cstdlib>
+
+#include <libslic3r/TriangleMesh.hpp>
+
+#include <libnest2d/tools/benchmark.h>
+
+// Benchmark of the admesh facet connectivity and of the whole mesh repair.
+// Loads the given STL file or generates a finely tessellated sphere. Prints
+// the run times and the connectivity statistics, which are expected to stay
+// the same between implementations of the edge matching.
+int main(const int argc, const char * argv[])
+{
+    using namespace Slic3r;
+
+    TriangleMesh mesh;
+    if (argc > 1) {
+        if (! mesh.ReadSTLFile(argv[1])) {
+            std::cerr << "Could not load " << argv[1] << std::endl;
+            return EXIT_FAILURE;
+        }
+    } else {
+        // Approximately 2M facets.
+        mesh = make_sphere(50., 2. * PI / 1000.);
+    }
+
+    stl_file stl = mesh.stl;
+
+    Benchmark bench;
+    bench.start();
+    stl_check_facets_exact(&stl);
+    bench.stop();
+
+    std::cout << "Facets: " << stl.stats.number_of_facets
+              << " connected edges: " << stl.stats.connected_edges
+              << " facets with 1/2/3 connected edges: "
+              << stl.stats.connected_facets_1_edge << "/"
+              << stl.stats.connected_facets_2_edge << "/"
+              << stl.stats.connected_facets_3_edge << std::endl;
+    std::cout << "stl_check_facets_exact duration [s]: " << bench.getElapsedSec() << std::endl;
+
+    mesh.repaired = false;
+    bench.start();
+    mesh.repair();
+    bench.stop();
+
+    std::cout << "Facets after repair: " << mesh.stl.stats.number_of_facets
+              << " edges fixed: " << mesh.stl.stats.edges_fixed
+              << " facets removed: " << mesh.stl.stats.facets_removed << std::endl;
+    std::cout << "TriangleMesh::repair duration [s]: " << bench.getElapsedSec() << std::endl;
+
+    return EXIT_SUCCESS;
+}
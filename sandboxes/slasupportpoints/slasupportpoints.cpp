@@ -0,0 +1,56 @@
+#include <iostream>
+#include <vector>
+
+#include <libslic3r/TriangleMesh.hpp>
+#include <libslic3r/SLA/SupportPointGenerator.hpp>
+
+#include <libnest2d/tools/benchmark.h>
+
+// Benchmark of the SLA support point generator on a large flat overhang.
+// Prints the run time and the density statistics of the generated points,
+// which are expected to stay the same between implementations of the sampler.
+int main(const int argc, const char * argv[])
+{
+    using namespace Slic3r;
+
+    double size = 200.;
+    if (argc > 1)
+        size = std::atof(argv[1]);
+
+    if (size <= 0.) {
+        std::cout << "Usage: slasupportpoints [overhang_size_mm]" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    // A thin slab hovering above the print bed, its whole bottom is an island to be supported.
+    TriangleMesh mesh = make_cube(size, size, 2.);
+    mesh.translate(0.f, 0.f, 5.f);
+    mesh.require_shared_vertices();
+
+    sla::EigenMesh3D emesh{mesh};
+
+    std::vector<float> heights;
+    for (float h = 5.05f; h < 7.f; h += 0.05f)
+        heights.emplace_back(h);
+
+    std::vector<ExPolygons> slices;
+    TriangleMeshSlicer slicer{&mesh};
+    slicer.slice(heights, SlicingMode::Regular, 0.f, &slices, []{});
+
+    sla::SupportPointGenerator::Config cfg;
+    sla::SupportPointGenerator point_gen{emesh, cfg, [] {}, [](int) {}};
+    point_gen.seed(0);
+
+    Benchmark bench;
+    bench.start();
+    point_gen.execute(slices, heights);
+    bench.stop();
+
+    const std::vector<sla::SupportPoint> &pts = point_gen.output();
+    double area = size * size;
+    std::cout << "Support points: " << pts.size()
+              << " density [1/mm2]: " << double(pts.size()) / area
+              << " duration [s]: " << bench.getElapsedSec() << std::endl;
+
+    return EXIT_SUCCESS;
+}
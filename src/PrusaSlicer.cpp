@@ -22,6 +22,7 @@
 #include <cstring>
 #include <iostream>
 #include <math.h>
+#include <boost/algorithm/string/predicate.hpp>
 #include <boost/filesystem.hpp>
 #include <boost/nowide/args.hpp>
 #include <boost/nowide/cenv.hpp>
@@ -207,6 +208,26 @@ int CLI::run(int argc, char **argv)
             }
             m_models.clear();
             m_models.emplace_back(std::move(m));
+            m_model_beds.clear();
+        } else if (opt_key == "split_beds") {
+            const BoundingBoxf bb(fff_print_config.bed_shape.values);
+            std::vector<Model> new_models;
+            m_model_beds.clear();
+            for (auto &model : m_models) {
+                model.add_default_instances();
+                std::vector<const ModelInstance*> unfittable;
+                std::vector<Model> beds = model.split_to_beds(fff_print_config.min_object_distance(), bb, &unfittable);
+                if (! unfittable.empty()) {
+                    for (const ModelInstance *inst : unfittable)
+                        boost::nowide::cerr << "error: object " << inst->get_object()->name << " does not fit onto the print bed" << std::endl;
+                    return 1;
+                }
+                for (size_t i = 0; i < beds.size(); ++ i) {
+                    new_models.emplace_back(std::move(beds[i]));
+                    m_model_beds.emplace_back(int(i));
+                }
+            }
+            m_models = std::move(new_models);
         } else if (opt_key == "duplicate") {
             const BoundingBoxf &bb = fff_print_config.bed_shape.values;
             for (auto &model : m_models) {
@@ -422,7 +443,8 @@ int CLI::run(int argc, char **argv)
                 });
 
                 PrintBase  *print = (printer_technology == ptFFF) ? static_cast<PrintBase*>(&fff_print) : static_cast<PrintBase*>(&sla_print);
-                if (! m_config.opt_bool("dont_arrange")) {
+                // The models split to beds are already arranged onto the print bed.
+                if (! m_config.opt_bool("dont_arrange") && m_model_beds.empty()) {
                     //FIXME make the min_object_distance configurable.
                     model.arrange_objects(fff_print.config().min_object_distance());
                     model.center_instances_around_point((! user_center_specified && m_print_config.has("bed_shape")) ? 
@@ -445,6 +467,9 @@ int CLI::run(int argc, char **argv)
                     try {
                         std::string outfile_final;
                         print->process();
+                        if (! m_model_beds.empty())
+                            // The output file name would be the same for all the beds.
+                            outfile = this->bed_filepath(model_in, print->output_filepath(outfile));
                         if (printer_technology == ptFFF) {
                             // The outfile is processed by a PlaceholderParser.
                             outfile = fff_print.export_gcode(outfile, nullptr);
@@ -559,6 +584,12 @@ bool CLI::setup(int argc, char **argv)
                 boost::nowide::cerr << "Invalid SLIC3R_LOGLEVEL environment variable: " << loglevel << std::endl;
         }
     }
+    {
+        // Opt-in binary cache of the imported OBJ files, stored next to them.
+        const char *obj_cache = boost::nowide::getenv("SLIC3R_OBJ_CACHE");
+        if (obj_cache != nullptr && obj_cache[0] == '1')
+            Slic3r::set_obj_binary_cache(true);
+    }
 
     boost::filesystem::path path_to_binary = boost::filesystem::system_complete(argv[0]);
 
@@ -708,7 +739,25 @@ std::string CLI::output_filepath(const Model &model, IO::ExportFormat format) co
         else
             proposed_path = cmdline_path;
     }
-    return proposed_path.string();
+    return this->bed_filepath(model, proposed_path.string());
+}
+
+std::string CLI::bed_filepath(const Model &model, const std::string &path) const
+{
+    if (path.empty() || m_model_beds.size() != m_models.size())
+        return path;
+    size_t idx = 0;
+    while (idx < m_models.size() && &m_models[idx] != &model)
+        ++ idx;
+    if (idx == m_models.size())
+        return path;
+    boost::filesystem::path p(path);
+    std::string ext = p.extension().string();
+    // Keep the double extension of the zipped AMF.
+    if (boost::iends_with(path, ".zip.amf"))
+        ext = ".zip.amf";
+    std::string base = path.substr(0, path.size() - ext.size());
+    return base + "_bed" + std::to_string(m_model_beds[idx] + 1) + ext;
 }
 
 #if defined(_MSC_VER) || defined(__MINGW32__)
@@ -29,6 +29,8 @@ private:
     std::vector<std::string>    m_actions;
     std::vector<std::string>    m_transforms;
     std::vector<Model>          m_models;
+    // Bed index of each of m_models after --split-beds, empty otherwise.
+    std::vector<int>            m_model_beds;
 
     bool setup(int argc, char **argv);
     
@@ -41,6 +43,9 @@ private:
     bool has_print_action() const { return m_config.opt_bool("export_gcode") || m_config.opt_bool("export_sla"); }
     
     std::string output_filepath(const Model &model, IO::ExportFormat format) const;
+    
+    /// Appends the bed number to the file name when the models were split to beds.
+    std::string bed_filepath(const Model &model, const std::string &path) const;
 };
 
 }
@@ -34,6 +34,11 @@
 #define BOOST_POOL_NO_MT
 #include <boost/pool/object_pool.hpp>
 
+#include <tbb/parallel_for.h>
+#include <tbb/parallel_reduce.h>
+#include <tbb/parallel_sort.h>
+#include <tbb/blocked_range.h>
+
 #include "stl.h"
 
 struct HashEdge {
@@ -42,7 +47,15 @@ struct HashEdge {
 	// Compare two keys.
 	bool operator==(const HashEdge &rhs) const { return memcmp(key, rhs.key, sizeof(key)) == 0; }
 	bool operator!=(const HashEdge &rhs) const { return ! (*this == rhs); }
-	int  hash(int M) const { return ((key[0] / 11 + key[1] / 7 + key[2] / 3) ^ (key[3] / 11  + key[4] / 7 + key[5] / 3)) % M; }
+	// Multiplicative mixing of all the six key words. The former sum of the quotients
+	// produced many collisions for vertices on a regular grid.
+	uint64_t hash64() const {
+		uint64_t h = 0;
+		for (size_t i = 0; i < 6; ++ i)
+			h = (h ^ key[i]) * 0x9E3779B97F4A7C15ull;
+		return h ^ (h >> 29);
+	}
+	int  hash(int M) const { return int(hash64() % uint64_t(M)); }
 
 	// Index of a facet owning this edge.
 	int        facet_number;
@@ -51,12 +64,12 @@ struct HashEdge {
 	int        which_edge;
 	HashEdge  *next;
 
-	void load_exact(stl_file *stl, const stl_vertex *a, const stl_vertex *b)
+	void load_exact(float &shortest_edge, const stl_vertex *a, const stl_vertex *b)
 	{
 		{
 	    	stl_vertex diff = (*a - *b).cwiseAbs();
 	    	float max_diff = std::max(diff(0), std::max(diff(1), diff(2)));
-	    	stl->stats.shortest_edge = std::min(max_diff, stl->stats.shortest_edge);
+	    	shortest_edge = std::min(max_diff, shortest_edge);
 	  	}
 
 	  	// Ensure identical vertex ordering of equal edges.
@@ -120,6 +133,24 @@ private:
 	}
 };
 
+// Connect facets of two matching edges, update their neighbor lists.
+static void connect_neighbors(stl_file *stl, const HashEdge &edge_a, const HashEdge &edge_b)
+{
+	// Facet a's neighbor is facet b
+	stl->neighbors_start[edge_a.facet_number].neighbor[edge_a.which_edge % 3] = edge_b.facet_number;	/* sets the .neighbor part */
+	stl->neighbors_start[edge_a.facet_number].which_vertex_not[edge_a.which_edge % 3] = (edge_b.which_edge + 2) % 3; /* sets the .which_vertex_not part */
+
+	// Facet b's neighbor is facet a
+	stl->neighbors_start[edge_b.facet_number].neighbor[edge_b.which_edge % 3] = edge_a.facet_number;	/* sets the .neighbor part */
+	stl->neighbors_start[edge_b.facet_number].which_vertex_not[edge_b.which_edge % 3] = (edge_a.which_edge + 2) % 3; /* sets the .which_vertex_not part */
+
+	if (((edge_a.which_edge < 3) && (edge_b.which_edge < 3)) || ((edge_a.which_edge > 2) && (edge_b.which_edge > 2))) {
+		// These facets are oriented in opposite directions, their normals are probably messed up.
+		stl->neighbors_start[edge_a.facet_number].which_vertex_not[edge_a.which_edge % 3] += 3;
+		stl->neighbors_start[edge_b.facet_number].which_vertex_not[edge_b.which_edge % 3] += 3;
+	}
+}
+
 struct HashTableEdges {
 	HashTableEdges(size_t number_of_faces) {
 		this->M = (int)hash_size_from_nr_faces(number_of_faces);
@@ -241,19 +272,7 @@ private:
 
 	static void record_neighbors(stl_file *stl, const HashEdge &edge_a, const HashEdge &edge_b)
 	{
-		// Facet a's neighbor is facet b
-		stl->neighbors_start[edge_a.facet_number].neighbor[edge_a.which_edge % 3] = edge_b.facet_number;	/* sets the .neighbor part */
-		stl->neighbors_start[edge_a.facet_number].which_vertex_not[edge_a.which_edge % 3] = (edge_b.which_edge + 2) % 3; /* sets the .which_vertex_not part */
-
-		// Facet b's neighbor is facet a
-		stl->neighbors_start[edge_b.facet_number].neighbor[edge_b.which_edge % 3] = edge_a.facet_number;	/* sets the .neighbor part */
-		stl->neighbors_start[edge_b.facet_number].which_vertex_not[edge_b.which_edge % 3] = (edge_a.which_edge + 2) % 3; /* sets the .which_vertex_not part */
-
-		if (((edge_a.which_edge < 3) && (edge_b.which_edge < 3)) || ((edge_a.which_edge > 2) && (edge_b.which_edge > 2))) {
-			// These facets are oriented in opposite directions, their normals are probably messed up.
-			stl->neighbors_start[edge_a.facet_number].which_vertex_not[edge_a.which_edge % 3] += 3;
-			stl->neighbors_start[edge_b.facet_number].which_vertex_not[edge_b.which_edge % 3] += 3;
-		}
+		connect_neighbors(stl, edge_a, edge_b);
 
 		// Count successful connects:
 		// Total connects:
@@ -453,22 +472,95 @@ void stl_check_facets_exact(stl_file *stl)
 		  	++ i;
   	}
 
-  	// Initialize hash table.
-  	HashTableEdges hash_table(stl->stats.number_of_facets);
 	for (auto &neighbor : stl->neighbors_start)
 		neighbor.reset();
 
-  	// Connect neighbor edges.
-	for (uint32_t i = 0; i < stl->stats.number_of_facets; ++ i) {
-		const stl_facet &facet = stl->facet_start[i];
-		for (int j = 0; j < 3; ++ j) {
-			HashEdge edge;
-			edge.facet_number = i;
-			edge.which_edge = j;
-			edge.load_exact(stl, &facet.vertex[j], &facet.vertex[(j + 1) % 3]);
-			hash_table.insert_edge_exact(stl, edge);
+	// Instead of inserting the edges into a hash table one by one, the edges are sorted by the hashes of their keys
+	// in parallel and the runs of equal hashes are matched independently. Edges with equal hashes are sorted by their
+	// indices, so that they are paired in the same order as if they were matched sequentially: each edge is matched
+	// with the first unmatched equal edge of a different facet preceding it.
+	const size_t num_facets = stl->stats.number_of_facets;
+	std::vector<HashEdge> edges(num_facets * 3);
+	// Pairs of a key hash and an edge index.
+	std::vector<std::pair<uint64_t, uint32_t>> sorted(edges.size());
+	stl->stats.shortest_edge = tbb::parallel_reduce(tbb::blocked_range<size_t>(0, num_facets), stl->stats.shortest_edge,
+		[stl, &edges, &sorted](const tbb::blocked_range<size_t> &range, float shortest_edge) {
+			for (size_t i = range.begin(); i < range.end(); ++ i) {
+				const stl_facet &facet = stl->facet_start[i];
+				for (int j = 0; j < 3; ++ j) {
+					HashEdge &edge = edges[i * 3 + j];
+					edge.facet_number = int(i);
+					edge.which_edge = j;
+					edge.load_exact(shortest_edge, &facet.vertex[j], &facet.vertex[(j + 1) % 3]);
+					sorted[i * 3 + j] = std::make_pair(edge.hash64(), uint32_t(i * 3 + j));
+				}
+			}
+			return shortest_edge;
+		},
+		[](float a, float b) { return std::min(a, b); });
+
+	tbb::parallel_sort(sorted.begin(), sorted.end());
+
+	// Connect neighbor edges. Each task processes the runs of equal hashes starting inside its range.
+	// Every edge updates its own slot of the neighbor list only, thus the tasks do not interfere.
+	tbb::parallel_for(tbb::blocked_range<size_t>(0, sorted.size()), [stl, &edges, &sorted](const tbb::blocked_range<size_t> &range) {
+		std::vector<const HashEdge*> unmatched;
+		size_t begin = range.begin();
+		while (begin < range.end() && begin > 0 && sorted[begin].first == sorted[begin - 1].first)
+			++ begin;
+		while (begin < range.end()) {
+			size_t end = begin + 1;
+			while (end < sorted.size() && sorted[end].first == sorted[begin].first)
+				++ end;
+			if (end == begin + 2) {
+				// The most common case of an edge shared by two facets.
+				const HashEdge &edge_a = edges[sorted[begin].second];
+				const HashEdge &edge_b = edges[sorted[begin + 1].second];
+				if (edge_a.facet_number != edge_b.facet_number && edge_a == edge_b)
+					connect_neighbors(stl, edge_b, edge_a);
+			} else if (end > begin + 2) {
+				unmatched.clear();
+				for (size_t i = begin; i < end; ++ i) {
+					const HashEdge &edge = edges[sorted[i].second];
+					auto it = std::find_if(unmatched.begin(), unmatched.end(),
+						[&edge](const HashEdge *other) { return other->facet_number != edge.facet_number && *other == edge; });
+					if (it == unmatched.end())
+						unmatched.emplace_back(&edge);
+					else {
+						connect_neighbors(stl, edge, **it);
+						unmatched.erase(it);
+					}
+				}
+			}
+			begin = end;
 		}
-	}
+	});
+
+	// Count successful connects. Each facet contributes to the counters up to its number of neighbors,
+	// which is the same result as counting the connects one by one.
+	struct ConnectStats { int edges = 0, facets_1_edge = 0, facets_2_edge = 0, facets_3_edge = 0; };
+	ConnectStats connect_stats = tbb::parallel_reduce(tbb::blocked_range<size_t>(0, num_facets), ConnectStats(),
+		[stl](const tbb::blocked_range<size_t> &range, ConnectStats cs) {
+			for (size_t i = range.begin(); i < range.end(); ++ i) {
+				int n = stl->neighbors_start[i].num_neighbors();
+				cs.edges += n;
+				cs.facets_1_edge += n >= 1;
+				cs.facets_2_edge += n >= 2;
+				cs.facets_3_edge += n >= 3;
+			}
+			return cs;
+		},
+		[](ConnectStats a, const ConnectStats &b) {
+			a.edges += b.edges;
+			a.facets_1_edge += b.facets_1_edge;
+			a.facets_2_edge += b.facets_2_edge;
+			a.facets_3_edge += b.facets_3_edge;
+			return a;
+		});
+	stl->stats.connected_edges         = connect_stats.edges;
+	stl->stats.connected_facets_1_edge = connect_stats.facets_1_edge;
+	stl->stats.connected_facets_2_edge = connect_stats.facets_2_edge;
+	stl->stats.connected_facets_3_edge = connect_stats.facets_3_edge;
 
 #if 0
 	printf("Number of faces: %d, number of manifold edges: %d, number of connected edges: %d, number of unconnected edges: %d\r\n", 
@@ -677,7 +769,7 @@ void stl_fill_holes(stl_file *stl)
 			HashEdge edge;
 	  		edge.facet_number = i;
 	  		edge.which_edge = j;
-	  		edge.load_exact(stl, &facet.vertex[j], &facet.vertex[(j + 1) % 3]);
+	  		edge.load_exact(stl->stats.shortest_edge, &facet.vertex[j], &facet.vertex[(j + 1) % 3]);
 	  		hash_table.insert_edge_exact(stl, edge);
 		}
 	}
@@ -727,7 +819,7 @@ void stl_fill_holes(stl_file *stl)
 	      				HashEdge edge;
 	        			edge.facet_number = stl->stats.number_of_facets - 1;
 	        			edge.which_edge = k;
-	        			edge.load_exact(stl, &new_facet.vertex[k], &new_facet.vertex[(k + 1) % 3]);
+	        			edge.load_exact(stl->stats.shortest_edge, &new_facet.vertex[k], &new_facet.vertex[(k + 1) % 3]);
 	        			hash_table.insert_edge_exact(stl, edge);
 	      			}
 	      			break;
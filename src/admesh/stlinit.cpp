@@ -26,9 +26,18 @@
 #include <math.h>
 #include <assert.h>
 
+#include <algorithm>
+#include <vector>
+
 #include <boost/log/trivial.hpp>
 #include <boost/nowide/cstdio.hpp>
 #include <boost/detail/endian.hpp>
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
+#include <tbb/parallel_for.h>
+#include <tbb/parallel_reduce.h>
+#include <tbb/blocked_range.h>
 
 #include "stl.h"
 
@@ -40,206 +49,366 @@
 extern void stl_internal_reverse_quads(char *buf, size_t cnt);
 #endif /* BOOST_LITTLE_ENDIAN */
 
-static FILE* stl_open_count_facets(stl_file *stl, const char *file) 
+// Read only view of the whole content of an STL file. The file is memory mapped
+// if possible, otherwise (for example if the operating system cannot map a file
+// with the given UTF-8 name) it is read into memory in one go.
+class StlFileView
 {
-  	// Open the file in binary mode first.
-  	FILE *fp = boost::nowide::fopen(file, "rb");
-  	if (fp == nullptr) {
-		BOOST_LOG_TRIVIAL(error) << "stl_open_count_facets: Couldn't open " << file << " for reading";
-    	return nullptr;
-  	}
-  	// Find size of file.
-  	fseek(fp, 0, SEEK_END);
-  	long file_size = ftell(fp);
-
-  	// Check for binary or ASCII file.
-  	fseek(fp, HEADER_SIZE, SEEK_SET);
-	unsigned char chtest[128];
-  	if (! fread(chtest, sizeof(chtest), 1, fp)) {
-		BOOST_LOG_TRIVIAL(error) << "stl_open_count_facets: The input is an empty file: " << file;
-    	fclose(fp);
-    	return nullptr;
-  	}
-  	stl->stats.type = ascii;
-  	for (size_t s = 0; s < sizeof(chtest); s++) {
-    	if (chtest[s] > 127) {
-      		stl->stats.type = binary;
-      		break;
-    	}
-  	}
-  	rewind(fp);
-
-  	uint32_t num_facets = 0;
-
-  	// Get the header and the number of facets in the .STL file.
-  	// If the .STL file is binary, then do the following:
-  	if (stl->stats.type == binary) {
-    	// Test if the STL file has the right size.
-    	if (((file_size - HEADER_SIZE) % SIZEOF_STL_FACET != 0) || (file_size < STL_MIN_FILE_SIZE)) {
-			BOOST_LOG_TRIVIAL(error) << "stl_open_count_facets: The file " << file << " has the wrong size.";
-      		fclose(fp);
-      		return nullptr;
-    	}
-    	num_facets = (file_size - HEADER_SIZE) / SIZEOF_STL_FACET;
-
-    	// Read the header.
-    	if (fread(stl->stats.header, LABEL_SIZE, 1, fp) > 79)
-      		stl->stats.header[80] = '\0';
-
-    	// Read the int following the header.  This should contain # of facets.
-	  	uint32_t header_num_facets;
-    	bool header_num_faces_read = fread(&header_num_facets, sizeof(uint32_t), 1, fp) != 0;
-#ifndef BOOST_LITTLE_ENDIAN
-    	// Convert from little endian to big endian.
-    	stl_internal_reverse_quads((char*)&header_num_facets, 4);
-#endif /* BOOST_LITTLE_ENDIAN */
-    	if (! header_num_faces_read || num_facets != header_num_facets)
-			BOOST_LOG_TRIVIAL(info) << "stl_open_count_facets: Warning: File size doesn't match number of facets in the header: " << file;
-  	}
-  	// Otherwise, if the .STL file is ASCII, then do the following:
-  	else
-  	{
-    	// Reopen the file in text mode (for getting correct newlines on Windows)
-    	// fix to silence a warning about unused return value.
-    	// obviously if it fails we have problems....
-    	fp = boost::nowide::freopen(file, "r", fp);
-
-		// do another null check to be safe
-    	if (fp == nullptr) {
-			BOOST_LOG_TRIVIAL(error) << "stl_open_count_facets: Couldn't open " << file << " for reading";
-      		fclose(fp);
-      		return nullptr;
-    	}
-    
-    	// Find the number of facets.
-		char linebuf[100];
-		int num_lines = 1;
-		while (fgets(linebuf, 100, fp) != nullptr) {
-		    // Don't count short lines.
-		    if (strlen(linebuf) <= 4)
-		    	continue;
-		    // Skip solid/endsolid lines as broken STL file generators may put several of them.
-		    if (strncmp(linebuf, "solid", 5) == 0 || strncmp(linebuf, "endsolid", 8) == 0)
-		    	continue;
-		    ++ num_lines;
+public:
+	bool open(const char *file)
+	{
+		try {
+			m_mapping = boost::interprocess::file_mapping(file, boost::interprocess::read_only);
+			m_region  = boost::interprocess::mapped_region(m_mapping, boost::interprocess::read_only);
+			m_data    = static_cast<const char*>(m_region.get_address());
+			m_size    = m_region.get_size();
+			return true;
+		} catch (const boost::interprocess::interprocess_exception &) {
+			// Empty files cannot be mapped, non ASCII file names may not be supported
+			// by the file mapping on Windows. Fall back to reading the file.
 		}
 
-    	rewind(fp);
-    
-    	// Get the header.
-		int i = 0;
-    	for (; i < 80 && (stl->stats.header[i] = getc(fp)) != '\n'; ++ i) ;
-    	stl->stats.header[i] = '\0'; // Lose the '\n'
-    	stl->stats.header[80] = '\0';
+		FILE *fp = boost::nowide::fopen(file, "rb");
+		if (fp == nullptr)
+			return false;
+		fseek(fp, 0, SEEK_END);
+		long file_size = ftell(fp);
+		rewind(fp);
+		bool ok = file_size >= 0;
+		if (ok) {
+			m_buffer.resize(size_t(file_size));
+			ok = m_buffer.empty() || fread(m_buffer.data(), 1, m_buffer.size(), fp) == m_buffer.size();
+		}
+		fclose(fp);
+		m_data = m_buffer.data();
+		m_size = m_buffer.size();
+		return ok;
+	}
 
-    	num_facets = num_lines / ASCII_LINES_PER_FACET;
-  	}
+	const char* data() const { return m_data; }
+	size_t      size() const { return m_size; }
 
-  	stl->stats.number_of_facets += num_facets;
-  	stl->stats.original_num_facets = stl->stats.number_of_facets;
-  	return fp;
-}
+private:
+	boost::interprocess::file_mapping  m_mapping;
+	boost::interprocess::mapped_region m_region;
+	std::vector<char>                  m_buffer;
+	const char                        *m_data = nullptr;
+	size_t                             m_size = 0;
+};
 
-/* Reads the contents of the file pointed to by fp into the stl structure,
-   starting at facet first_facet.  The second argument says if it's our first
-   time running this for the stl and therefore we should reset our max and min stats. */
-static bool stl_read(stl_file *stl, FILE *fp, int first_facet, bool first)
+// Number of facets and bytes processed by a single task when loading an STL.
+static constexpr size_t STL_BINARY_GRAIN = 16384;
+static constexpr size_t STL_ASCII_CHUNK  = 4 * 1024 * 1024;
+
+static bool stl_read_binary(stl_file *stl, const StlFileView &view, const char *file)
 {
-	if (stl->stats.type == binary)
-    	fseek(fp, HEADER_SIZE, SEEK_SET);
-  	else
-    	rewind(fp);
-
-  	char normal_buf[3][32];
-  	for (uint32_t i = first_facet; i < stl->stats.number_of_facets; ++ i) {
-  	  	stl_facet facet;
-
-    	if (stl->stats.type == binary) {
-      		// Read a single facet from a binary .STL file. We assume little-endian architecture!
-      		if (fread(&facet, 1, SIZEOF_STL_FACET, fp) != SIZEOF_STL_FACET)
-      			return false;
+	// Test if the STL file has the right size.
+	if (((view.size() - HEADER_SIZE) % SIZEOF_STL_FACET != 0) || (view.size() < STL_MIN_FILE_SIZE)) {
+		BOOST_LOG_TRIVIAL(error) << "stl_open: The file " << file << " has the wrong size.";
+		return false;
+	}
+	uint32_t num_facets = uint32_t((view.size() - HEADER_SIZE) / SIZEOF_STL_FACET);
+
+	// Read the header.
+	memcpy(stl->stats.header, view.data(), LABEL_SIZE);
+	stl->stats.header[80] = '\0';
+
+	// Read the int following the header.  This should contain # of facets.
+	uint32_t header_num_facets;
+	memcpy(&header_num_facets, view.data() + LABEL_SIZE, sizeof(uint32_t));
 #ifndef BOOST_LITTLE_ENDIAN
-      		// Convert the loaded little endian data to big endian.
-      		stl_internal_reverse_quads((char*)&facet, 48);
+	// Convert from little endian to big endian.
+	stl_internal_reverse_quads((char*)&header_num_facets, 4);
 #endif /* BOOST_LITTLE_ENDIAN */
-    	} else {
-			// Read a single facet from an ASCII .STL file
-			// skip solid/endsolid
-			// (in this order, otherwise it won't work when they are paired in the middle of a file)
-			fscanf(fp, " endsolid%*[^\n]\n");
-			fscanf(fp, " solid%*[^\n]\n");  // name might contain spaces so %*s doesn't work and it also can be empty (just "solid")
-			// Leading space in the fscanf format skips all leading white spaces including numerous new lines and tabs.
-			int res_normal     = fscanf(fp, " facet normal %31s %31s %31s", normal_buf[0], normal_buf[1], normal_buf[2]);
-			assert(res_normal == 3);
-			int res_outer_loop = fscanf(fp, " outer loop");
-			assert(res_outer_loop == 0);
-			int res_vertex1    = fscanf(fp, " vertex %f %f %f", &facet.vertex[0](0), &facet.vertex[0](1), &facet.vertex[0](2));
-			assert(res_vertex1 == 3);
-			int res_vertex2    = fscanf(fp, " vertex %f %f %f", &facet.vertex[1](0), &facet.vertex[1](1), &facet.vertex[1](2));
-			assert(res_vertex2 == 3);
-			// Trailing whitespace is there to eat all whitespaces and empty lines up to the next non-whitespace.
-			int res_vertex3    = fscanf(fp, " vertex %f %f %f ", &facet.vertex[2](0), &facet.vertex[2](1), &facet.vertex[2](2));
-			assert(res_vertex3 == 3);
+	if (num_facets != header_num_facets)
+		BOOST_LOG_TRIVIAL(info) << "stl_open: Warning: File size doesn't match number of facets in the header: " << file;
+
+	stl->stats.number_of_facets    = num_facets;
+	stl->stats.original_num_facets = num_facets;
+	stl_allocate(stl);
+
+	// Copy the facets straight from the file. sizeof(stl_facet) is larger than
+	// SIZEOF_STL_FACET due to padding, thus the facets are copied one by one.
+	const char *src = view.data() + HEADER_SIZE;
+	tbb::parallel_for(tbb::blocked_range<size_t>(0, num_facets, STL_BINARY_GRAIN),
+		[stl, src](const tbb::blocked_range<size_t> &range) {
+		for (size_t i = range.begin(); i < range.end(); ++ i) {
+			stl_facet  &facet = stl->facet_start[i];
+			const char *data  = src + i * SIZEOF_STL_FACET;
+			// The normal, the three vertices and the two attribute bytes.
+			memcpy(facet.normal.data(), data, 12);
+			for (int j = 0; j < 3; ++ j)
+				memcpy(facet.vertex[j].data(), data + 12 * (j + 1), 12);
+			memcpy(facet.extra, data + 48, 2);
+#ifndef BOOST_LITTLE_ENDIAN
+			// Convert the loaded little endian data to big endian.
+			stl_internal_reverse_quads((char*)facet.normal.data(), 12);
+			for (int j = 0; j < 3; ++ j)
+				stl_internal_reverse_quads((char*)facet.vertex[j].data(), 12);
+#endif /* BOOST_LITTLE_ENDIAN */
+		}
+	});
+	return true;
+}
+
+namespace {
+
+// Minimal tokenizer of an in memory ASCII STL.
+class StlAsciiParser
+{
+public:
+	StlAsciiParser(const char *begin, const char *end) : m_ptr(begin), m_end(end) {}
+
+	// Parses the facets until the end of the range. Returns false if the input is malformed.
+	bool parse(std::vector<stl_facet> &out)
+	{
+		for (;;) {
+			// Skip solid/endsolid, broken STL file generators may put several of them.
+			skip_ws();
+			while (keyword("endsolid", false) || keyword("solid", false)) {
+				skip_line();
+				skip_ws();
+			}
+			if (m_ptr == m_end)
+				return true;
+
+			stl_facet facet;
+			if (! keyword("facet") || ! keyword("normal"))
+				return false;
+			// Invalid normals (denormals, not a numbers) are silently reset.
+			bool normal_ok[3];
+			for (size_t j = 0; j < 3; ++ j)
+				normal_ok[j] = number(facet.normal(j));
+			if (! (normal_ok[0] && normal_ok[1] && normal_ok[2]))
+				memset(&facet.normal, 0, sizeof(facet.normal));
+			if (! keyword("outer") || ! keyword("loop"))
+				return false;
+			for (size_t j = 0; j < 3; ++ j)
+				if (! keyword("vertex") || ! number(facet.vertex[j](0)) || ! number(facet.vertex[j](1)) || ! number(facet.vertex[j](2)))
+					return false;
 			// Some G-code generators tend to produce text after "endloop" and "endfacet". Just ignore it.
-			char buf[2048];
-			fgets(buf, 2047, fp);
-			bool endloop_ok = strncmp(buf, "endloop", 7) == 0 && (buf[7] == '\r' || buf[7] == '\n' || buf[7] == ' ' || buf[7] == '\t');
-			assert(endloop_ok);
-			// Skip the trailing whitespaces and empty lines.
-			fscanf(fp, " ");
-			fgets(buf, 2047, fp);
-			bool endfacet_ok = strncmp(buf, "endfacet", 8) == 0 && (buf[8] == '\r' || buf[8] == '\n' || buf[8] == ' ' || buf[8] == '\t');
-			assert(endfacet_ok);
-			if (res_normal != 3 || res_outer_loop != 0 || res_vertex1 != 3 || res_vertex2 != 3 || res_vertex3 != 3 || ! endloop_ok || ! endfacet_ok) {
-				BOOST_LOG_TRIVIAL(error) << "Something is syntactically very wrong with this ASCII STL! ";
+			if (! keyword("endloop"))
 				return false;
-			}
+			skip_line();
+			if (! keyword("endfacet"))
+				return false;
+			skip_line();
+			memset(facet.extra, 0, sizeof(facet.extra));
+			out.emplace_back(facet);
+		}
+	}
+
+private:
+	static bool is_ws(char c) { return c == ' ' || c == '\t' || c == '\r' || c == '\n' || c == '\v' || c == '\f'; }
+
+	void skip_ws() { while (m_ptr != m_end && is_ws(*m_ptr)) ++ m_ptr; }
+	void skip_line()
+	{
+		while (m_ptr != m_end && *m_ptr != '\n') ++ m_ptr;
+		if (m_ptr != m_end) ++ m_ptr;
+	}
+
+	// Consumes the keyword if it is the next token or, if whole_word is false, a prefix of the next token.
+	bool keyword(const char *kw, bool whole_word = true)
+	{
+		skip_ws();
+		size_t len = strlen(kw);
+		if (size_t(m_end - m_ptr) < len || strncmp(m_ptr, kw, len) != 0 ||
+			(whole_word && m_ptr + len != m_end && ! is_ws(m_ptr[len])))
+			return false;
+		m_ptr += len;
+		return true;
+	}
 
-			// The facet normal has been parsed as a single string as to workaround for not a numbers in the normal definition.
-			if (sscanf(normal_buf[0], "%f", &facet.normal(0)) != 1 ||
-			    sscanf(normal_buf[1], "%f", &facet.normal(1)) != 1 ||
-			    sscanf(normal_buf[2], "%f", &facet.normal(2)) != 1) {
-			    // Normal was mangled. Maybe denormals or "not a number" were stored?
-			  	// Just reset the normal and silently ignore it.
-			  	memset(&facet.normal, 0, sizeof(facet.normal));
+	// Parses the next token as a float. Plain decimal numbers with a short
+	// mantissa are converted exactly without calling into the C library,
+	// anything else is handed over to strtof().
+	bool number(float &out)
+	{
+		skip_ws();
+		const char *begin = m_ptr;
+		const char *token_end = m_ptr;
+		while (token_end != m_end && ! is_ws(*token_end)) ++ token_end;
+		if (begin == token_end)
+			return false;
+		m_ptr = token_end;
+
+		const char *p = begin;
+		bool negative = *p == '-';
+		if (*p == '-' || *p == '+') ++ p;
+		uint32_t mantissa = 0;
+		int      digits   = 0;
+		int      exponent = 0;
+		bool     any      = false;
+		for (; p != token_end && *p >= '0' && *p <= '9'; ++ p, any = true) {
+			if (mantissa != 0 || *p != '0') {
+				if (++ digits > 7) break;
+				mantissa = mantissa * 10 + uint32_t(*p - '0');
 			}
 		}
-
-#if 0
-		// Report close to zero vertex coordinates. Due to the nature of the floating point numbers,
-		// close to zero values may be represented with singificantly higher precision than the rest of the vertices.
-		// It may be worth to round these numbers to zero during loading to reduce the number of errors reported
-		// during the STL import.
-		for (size_t j = 0; j < 3; ++ j) {
-		if (facet.vertex[j](0) > -1e-12f && facet.vertex[j](0) < 1e-12f)
-		    printf("stl_read: facet %d(0) = %e\r\n", j, facet.vertex[j](0));
-		if (facet.vertex[j](1) > -1e-12f && facet.vertex[j](1) < 1e-12f)
-		    printf("stl_read: facet %d(1) = %e\r\n", j, facet.vertex[j](1));
-		if (facet.vertex[j](2) > -1e-12f && facet.vertex[j](2) < 1e-12f)
-		    printf("stl_read: facet %d(2) = %e\r\n", j, facet.vertex[j](2));
+		if (digits <= 7 && p != token_end && *p == '.') {
+			for (++ p; p != token_end && *p >= '0' && *p <= '9'; ++ p, any = true) {
+				if (mantissa != 0 || *p != '0') {
+					if (++ digits > 7) break;
+					mantissa = mantissa * 10 + uint32_t(*p - '0');
+				}
+				-- exponent;
+			}
 		}
-#endif
+		if (digits <= 7 && any && p != token_end && (*p == 'e' || *p == 'E')) {
+			++ p;
+			bool exp_negative = p != token_end && *p == '-';
+			if (p != token_end && (*p == '-' || *p == '+')) ++ p;
+			int e = 0;
+			bool exp_any = false;
+			for (; p != token_end && *p >= '0' && *p <= '9' && e < 1000; ++ p, exp_any = true)
+				e = e * 10 + (*p - '0');
+			if (! exp_any)
+				any = false;
+			exponent += exp_negative ? -e : e;
+		}
+		// Both the mantissa (< 2^24) and the power of ten (<= 10^10) are exactly
+		// representable as floats, thus a single multiplication or division
+		// yields a correctly rounded result.
+		static const float pow10[] = { 1e0f, 1e1f, 1e2f, 1e3f, 1e4f, 1e5f, 1e6f, 1e7f, 1e8f, 1e9f, 1e10f };
+		if (any && digits <= 7 && p == token_end && exponent >= -10 && exponent <= 10) {
+			float v = float(mantissa);
+			v = exponent < 0 ? v / pow10[-exponent] : v * pow10[exponent];
+			out = negative ? -v : v;
+			return true;
+		}
+
+		char buf[64];
+		size_t len = std::min(size_t(token_end - begin), sizeof(buf) - 1);
+		memcpy(buf, begin, len);
+		buf[len] = '\0';
+		char *parsed_end = nullptr;
+		out = strtof(buf, &parsed_end);
+		return parsed_end != buf;
+	}
+
+	const char *m_ptr;
+	const char *m_end;
+};
+
+} // namespace
+
+static bool stl_read_ascii(stl_file *stl, const StlFileView &view)
+{
+	const char *begin = view.data();
+	const char *end   = begin + view.size();
+
+	// Get the header.
+	size_t i = 0;
+	for (; i < 80 && i < view.size() && begin[i] != '\n'; ++ i)
+		stl->stats.header[i] = begin[i];
+	if (i > 0 && stl->stats.header[i - 1] == '\r')
+		-- i;
+	stl->stats.header[i] = '\0';
+	stl->stats.header[80] = '\0';
+
+	// Split the file into chunks ending with a complete facet, so that they could be parsed independently.
+	std::vector<const char*> bounds { begin };
+	static const char endfacet[] = "endfacet";
+	while (size_t(end - bounds.back()) > STL_ASCII_CHUNK) {
+		const char *it = std::search(bounds.back() + STL_ASCII_CHUNK, end, endfacet, endfacet + sizeof(endfacet) - 1);
+		it = std::find(it, end, '\n');
+		if (it == end)
+			break;
+		bounds.emplace_back(it + 1);
+	}
+	bounds.emplace_back(end);
+
+	size_t nchunks = bounds.size() - 1;
+	std::vector<std::vector<stl_facet>> chunks(nchunks);
+	std::vector<char> chunk_ok(nchunks, false);
+	tbb::parallel_for(size_t(0), nchunks, [&bounds, &chunks, &chunk_ok](size_t ichunk) {
+		chunks[ichunk].reserve(size_t(bounds[ichunk + 1] - bounds[ichunk]) / 256);
+		chunk_ok[ichunk] = StlAsciiParser(bounds[ichunk], bounds[ichunk + 1]).parse(chunks[ichunk]);
+	});
+	if (std::find(chunk_ok.begin(), chunk_ok.end(), false) != chunk_ok.end()) {
+		BOOST_LOG_TRIVIAL(error) << "Something is syntactically very wrong with this ASCII STL! ";
+		return false;
+	}
 
-		// Write the facet into memory.
-		stl->facet_start[i] = facet;
-		stl_facet_stats(stl, facet, first);
-  	}
-  
-  	stl->stats.size = stl->stats.max - stl->stats.min;
-  	stl->stats.bounding_diameter = stl->stats.size.norm();
-  	return true;
+	std::vector<size_t> offsets(nchunks + 1, 0);
+	for (size_t ichunk = 0; ichunk < nchunks; ++ ichunk)
+		offsets[ichunk + 1] = offsets[ichunk] + chunks[ichunk].size();
+
+	stl->stats.number_of_facets    = uint32_t(offsets.back());
+	stl->stats.original_num_facets = stl->stats.number_of_facets;
+	stl_allocate(stl);
+	tbb::parallel_for(size_t(0), nchunks, [stl, &chunks, &offsets](size_t ichunk) {
+		std::copy(chunks[ichunk].begin(), chunks[ichunk].end(), stl->facet_start.begin() + offsets[ichunk]);
+		chunks[ichunk] = std::vector<stl_facet>();
+	});
+	return true;
+}
+
+// Bounding box of the loaded facets and the initial estimate of the shortest edge,
+// the same values stl_facet_stats() would produce when called for all the facets.
+static void stl_loaded_facets_stats(stl_file *stl)
+{
+	if (stl->facet_start.empty()) {
+		stl->stats.size = stl->stats.max - stl->stats.min;
+		stl->stats.bounding_diameter = stl->stats.size.norm();
+		return;
+	}
+
+	bool first = true;
+	stl_facet_stats(stl, stl->facet_start.front(), first);
+
+	using MinMax = std::pair<stl_vertex, stl_vertex>;
+	MinMax bbox = tbb::parallel_reduce(
+		tbb::blocked_range<size_t>(0, stl->facet_start.size(), STL_BINARY_GRAIN),
+		MinMax(stl->stats.min, stl->stats.max),
+		[stl](const tbb::blocked_range<size_t> &range, MinMax bbox) {
+			for (size_t i = range.begin(); i < range.end(); ++ i)
+				for (const stl_vertex &v : stl->facet_start[i].vertex) {
+					bbox.first  = bbox.first.cwiseMin(v);
+					bbox.second = bbox.second.cwiseMax(v);
+				}
+			return bbox;
+		},
+		[](const MinMax &a, const MinMax &b) {
+			return MinMax(a.first.cwiseMin(b.first), a.second.cwiseMax(b.second));
+		});
+
+	stl->stats.min = bbox.first;
+	stl->stats.max = bbox.second;
+	stl->stats.size = stl->stats.max - stl->stats.min;
+	stl->stats.bounding_diameter = stl->stats.size.norm();
 }
 
 bool stl_open(stl_file *stl, const char *file)
 {
 	stl->clear();
-	FILE *fp = stl_open_count_facets(stl, file);
-	if (fp == nullptr)
+
+	StlFileView view;
+	if (! view.open(file)) {
+		BOOST_LOG_TRIVIAL(error) << "stl_open: Couldn't open " << file << " for reading";
 		return false;
-	stl_allocate(stl);
-	bool result = stl_read(stl, fp, 0, true);
-  	fclose(fp);
-  	return result;
+	}
+
+	// Check for binary or ASCII file.
+	const size_t chtest_size = 128;
+	if (view.size() < HEADER_SIZE + chtest_size) {
+		BOOST_LOG_TRIVIAL(error) << "stl_open: The input is an empty file: " << file;
+		return false;
+	}
+	const unsigned char *chtest = reinterpret_cast<const unsigned char*>(view.data()) + HEADER_SIZE;
+	stl->stats.type = ascii;
+	for (size_t s = 0; s < chtest_size; s++) {
+		if (chtest[s] > 127) {
+			stl->stats.type = binary;
+			break;
+		}
+	}
+
+	bool result = stl->stats.type == binary ? stl_read_binary(stl, view, file) : stl_read_ascii(stl, view);
+	if (result)
+		stl_loaded_facets_stats(stl);
+	return result;
 }
 
 void stl_allocate(stl_file *stl) 
@@ -8,6 +8,9 @@
 #include <iterator>
 #include <future>
 #include <atomic>
+#include <mutex>
+#include <memory>
+#include <unordered_map>
 
 #ifndef NDEBUG
 #include <iostream>
@@ -368,6 +371,144 @@ public:
 
 };
 
+/**
+ * A cache of no fit polygons keyed by the shapes of the stationary and the
+ * orbiting items.
+ *
+ * The nfp of two items only depends on their shapes (including their rotation
+ * and inflation), their translations only move the resulting polygon around.
+ * The cached nfps are stored relative to the translation of the stationary
+ * item, thus a bin full of copies of the same part needs a single nfp
+ * calculation for each orbiter shape. The cache can be shared by multiple
+ * threads.
+ */
+template<class RawShape> class NfpCache {
+    using Item = _Item<RawShape>;
+    using Vertex = TPoint<RawShape>;
+
+    struct Entry {
+        RawShape stationary;    // Untranslated contour of the stationary item
+        RawShape orbiter;       // Untranslated contour of the orbiting item
+        RawShape nfp;           // Relative to the stationary item's translation
+    };
+
+    // Maximum number of cached nfps, the cache is flushed when exceeded.
+    static const size_t MAX_ENTRIES = 10000;
+
+    std::unordered_multimap<size_t, Entry> entries_;
+    mutable std::mutex mutex_;
+
+    static RawShape untranslated(const Item& itm)
+    {
+        RawShape ret = itm.transformedShape();
+        Vertex tr = itm.translation();
+        sl::translate(ret, Vertex{-getX(tr), -getY(tr)});
+        return ret;
+    }
+
+    // Is the contour of the item equal to the untranslated contour sh?
+    static bool matches(const Item& itm, const RawShape& sh)
+    {
+        const RawShape& tsh = itm.transformedShape();
+        if(sl::contourVertexCount(tsh) != sl::contourVertexCount(sh))
+            return false;
+
+        Vertex tr = itm.translation();
+        return std::equal(sl::cbegin(tsh), sl::cend(tsh), sl::cbegin(sh),
+                          [&tr](const Vertex& v, const Vertex& vsh) {
+            return getX(v) - getX(tr) == getX(vsh) &&
+                   getY(v) - getY(tr) == getY(vsh);
+        });
+    }
+
+public:
+
+    /// Hash of the contour of an item regardless of its translation.
+    static size_t shapeHash(const Item& itm)
+    {
+        Vertex tr = itm.translation();
+        std::hash<TCoord<Vertex>> hasher;
+        size_t seed = 0;
+        auto combine = [&seed, &hasher](TCoord<Vertex> c) {
+            seed ^= hasher(c) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+        };
+        const RawShape& tsh = itm.transformedShape();
+        for(auto it = sl::cbegin(tsh); it != sl::cend(tsh); ++it) {
+            combine(getX(*it) - getX(tr));
+            combine(getY(*it) - getY(tr));
+        }
+        return seed;
+    }
+
+    /// Hash of a (stationary, orbiter) pair from the hashes of their shapes.
+    static size_t pairHash(size_t stationary, size_t orbiter)
+    {
+        return stationary ^ (orbiter + 0x9e3779b9 + (stationary << 6) +
+                             (stationary >> 2));
+    }
+
+    /// Do the two items have the same shape regardless of their translation?
+    static bool sameShape(const Item& itm1, const Item& itm2)
+    {
+        const RawShape& tsh = itm2.transformedShape();
+        Vertex tr = itm2.translation();
+        if(sl::contourVertexCount(itm1.transformedShape()) !=
+           sl::contourVertexCount(tsh)) return false;
+
+        Vertex tr1 = itm1.translation();
+        return std::equal(sl::cbegin(itm1.transformedShape()),
+                          sl::cend(itm1.transformedShape()), sl::cbegin(tsh),
+                          [&tr, &tr1](const Vertex& v1, const Vertex& v2) {
+            return getX(v1) - getX(tr1) == getX(v2) - getX(tr) &&
+                   getY(v1) - getY(tr1) == getY(v2) - getY(tr);
+        });
+    }
+
+    /// Look up the nfp of the stationary and orbiter items. On success the
+    /// nfp is placed around the stationary item into nfp and true is returned.
+    bool get(size_t hash, const Item& stationary, const Item& orbiter,
+             RawShape& nfp) const
+    {
+        std::lock_guard<std::mutex> lk(mutex_);
+        auto range = entries_.equal_range(hash);
+        for(auto it = range.first; it != range.second; ++it) {
+            const Entry& e = it->second;
+            if(matches(stationary, e.stationary) &&
+               matches(orbiter, e.orbiter)) {
+                nfp = e.nfp;
+                sl::translate(nfp, stationary.translation());
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /// Store the nfp calculated for the stationary and orbiter items.
+    void put(size_t hash, const Item& stationary, const Item& orbiter,
+             const RawShape& nfp)
+    {
+        Entry e{ untranslated(stationary), untranslated(orbiter), nfp };
+        Vertex tr = stationary.translation();
+        sl::translate(e.nfp, Vertex{-getX(tr), -getY(tr)});
+
+        std::lock_guard<std::mutex> lk(mutex_);
+        if(entries_.size() >= MAX_ENTRIES) entries_.clear();
+        entries_.emplace(hash, std::move(e));
+    }
+
+    size_t size() const
+    {
+        std::lock_guard<std::mutex> lk(mutex_);
+        return entries_.size();
+    }
+
+    void clear()
+    {
+        std::lock_guard<std::mutex> lk(mutex_);
+        entries_.clear();
+    }
+};
+
 template<nfp::NfpLevel lvl>
 struct Lvl { static const nfp::NfpLevel value = lvl; };
 
@@ -573,12 +714,70 @@ public:
     inline void clearItems() {
         finalAlign(bin_);
         Base::clearItems();
+        merged_pile_.clear();
+        merged_items_.clear();
     }
 
 private:
 
     using Shapes = TMultiShape<RawShape>;
 
+    // The nfps calculated so far, shared by the copies of this placer.
+    std::shared_ptr<NfpCache<RawShape>> nfpcache_ =
+            std::make_shared<NfpCache<RawShape>>();
+
+    // The union of the items placed so far. The items are appended to the
+    // bin one by one so only the newly placed items are merged into it.
+    struct MergedItem { const Item *item; Vertex tr; Radians rot; };
+    Shapes merged_pile_;
+    std::vector<MergedItem> merged_items_;
+
+    const Shapes& mergedPile()
+    {
+        // Check which of the merged items are still there unchanged. Items
+        // may be unpacked or moved around, then the pile is rebuilt.
+        size_t n = 0;
+        for(; n < merged_items_.size() && n < items_.size(); ++n) {
+            const MergedItem& m = merged_items_[n];
+            const Item& itm = items_[n];
+            if(m.item != &itm || m.tr != itm.translation() ||
+               m.rot != itm.rotation()) break;
+        }
+
+        if(n < merged_items_.size()) {
+            merged_pile_.clear();
+            merged_items_.clear();
+            n = 0;
+        }
+
+        if(n < items_.size()) {
+            Shapes pile = std::move(merged_pile_);
+            pile.reserve(pile.size() + items_.size() - n);
+            for(; n < items_.size(); ++n) {
+                const Item& itm = items_[n];
+                pile.emplace_back(itm.transformedShape());
+                merged_items_.push_back({&itm, itm.translation(),
+                                         itm.rotation()});
+            }
+            merged_pile_ = nfp::merge(pile);
+        }
+
+        return merged_pile_;
+    }
+
+    // Fill the lazily computed members of the item so that it can be read
+    // concurrently afterwards.
+    static void fillCaches(const Item& itm)
+    {
+        itm.transformedShape();
+        itm.referenceVertex();
+        itm.rightmostTopVertex();
+        itm.leftmostBottomVertex();
+        itm.boundingBox();
+        itm.area();
+        itm.isContourConvex();
+    }
+
     Shapes calcnfp(const Item &trsh, Lvl<nfp::NfpLevel::CONVEX_ONLY>)
     {
         using namespace nfp;
@@ -589,22 +788,45 @@ private:
         // TODO: this is a workaround and should be solved in Item with mutexes
         // guarding the mutable members when writing them.
         // /////////////////////////////////////////////////////////////////////
-        trsh.transformedShape();
-        trsh.referenceVertex();
-        trsh.rightmostTopVertex();
-        trsh.leftmostBottomVertex();
-
-        for(Item& itm : items_) {
-            itm.transformedShape();
-            itm.referenceVertex();
-            itm.rightmostTopVertex();
-            itm.leftmostBottomVertex();
-        }
+        fillCaches(trsh);
+        for(Item& itm : items_) fillCaches(itm);
         // /////////////////////////////////////////////////////////////////////
 
-        __parallel::enumerate(items_.begin(), items_.end(),
-                              [&nfps, &trsh](const Item& sh, size_t n)
+        // The nfp of two items depends only on their shapes, so the nfps
+        // already known are taken from the cache. Items of the same shape as
+        // an earlier item of this bin reuse its nfp, only the rest is
+        // calculated.
+        const size_t orbhash = NfpCache<RawShape>::shapeHash(trsh);
+        std::vector<size_t> hashes(items_.size());
+        std::vector<size_t> misses;
+        std::vector<std::pair<size_t, size_t>> copies; // (item, same shape)
+        std::unordered_multimap<size_t, size_t> pending;
+
+        for(size_t n = 0; n < items_.size(); ++n) {
+            const Item& sh = items_[n];
+            size_t h = NfpCache<RawShape>::pairHash(
+                        NfpCache<RawShape>::shapeHash(sh), orbhash);
+            hashes[n] = h;
+
+            if(nfpcache_->get(h, sh, trsh, nfps[n])) continue;
+
+            auto range = pending.equal_range(h);
+            auto it = std::find_if(range.first, range.second,
+                                   [this, &sh](const std::pair<size_t, size_t>& p) {
+                return NfpCache<RawShape>::sameShape(items_[p.second], sh);
+            });
+
+            if(it != range.second) copies.emplace_back(n, it->second);
+            else {
+                pending.emplace(h, n);
+                misses.emplace_back(n);
+            }
+        }
+
+        __parallel::enumerate(misses.begin(), misses.end(),
+                              [this, &nfps, &trsh](size_t n, size_t)
         {
+            const Item& sh = items_[n];
             auto& fixedp = sh.transformedShape();
             auto& orbp = trsh.transformedShape();
             auto subnfp_r = noFitPolygon<NfpLevel::CONVEX_ONLY>(fixedp, orbp);
@@ -612,6 +834,15 @@ private:
             nfps[n] = subnfp_r.first;
         });
 
+        for(size_t n : misses) nfpcache_->put(hashes[n], items_[n], trsh, nfps[n]);
+
+        for(auto& cp : copies) {
+            Vertex d = items_[cp.first].get().translation() -
+                       items_[cp.second].get().translation();
+            nfps[cp.first] = nfps[cp.second];
+            sl::translate(nfps[cp.first], d);
+        }
+
         return nfp::merge(nfps);
     }
 
@@ -772,6 +1003,220 @@ private:
 
     using Edges = EdgeCache<RawShape>;
 
+    struct RotationResult {
+        double score = std::numeric_limits<double>::max();
+        double overfit = std::numeric_limits<double>::max();
+        Vertex translation = {0, 0};
+    };
+
+    // A starting point of the local optimization on an nfp contour
+    struct Start {
+        double relpos;
+        unsigned nfpidx;
+        int hidx;
+    };
+
+    // Find the best position of the item with its current rotation.
+    RotationResult tryRotation(Item& item,
+                               const Shapes& merged_pile,
+                               const RawShape& pile_hull,
+                               std::launch policy)
+    {
+        RotationResult ret;
+
+        item.boundingBox(); // fill the bb cache
+
+        // place the new item outside of the print bed to make sure
+        // it is disjunct from the current merged pile
+        placeOutsideOfBin(item);
+
+        Shapes nfps = calcnfp(item, Lvl<MaxNfpLevel::value>());
+
+        auto iv = item.referenceVertex();
+
+        auto startpos = item.translation();
+
+        std::vector<Edges> ecache;
+        ecache.reserve(nfps.size());
+
+        for(auto& nfp : nfps ) {
+            ecache.emplace_back(nfp);
+            ecache.back().accuracy(config_.accuracy);
+        }
+
+        auto& bin = bin_;
+        double norm = norm_;
+        auto pbb = sl::boundingBox(merged_pile);
+        auto binbb = sl::boundingBox(bin);
+
+        // This is the kernel part of the object function that is
+        // customizable by the library client
+        std::function<double(const Item&)> _objfunc;
+        if(config_.object_function) _objfunc = config_.object_function;
+        else {
+
+            // Inside check has to be strict if no alignment was enabled
+            std::function<double(const Box&)> ins_check;
+            if(config_.alignment == Config::Alignment::DONT_ALIGN)
+                ins_check = [&binbb, norm](const Box& fullbb) {
+                    double ret = 0;
+                    if(!sl::isInside(fullbb, binbb))
+                        ret += norm;
+                    return ret;
+                };
+            else
+                ins_check = [&bin](const Box& fullbb) {
+                    double miss = overfit(fullbb, bin);
+                    miss = miss > 0? miss : 0;
+                    return std::pow(miss, 2);
+                };
+
+            _objfunc = [norm, binbb, pbb, ins_check](const Item& item)
+            {
+                auto ibb = item.boundingBox();
+                auto fullbb = sl::boundingBox(pbb, ibb);
+
+                double score = pl::distance(ibb.center(),
+                                            binbb.center());
+                score /= norm;
+
+                score += ins_check(fullbb);
+
+                return score;
+            };
+        }
+
+        // Our object function for placement
+        auto rawobjfunc = [_objfunc, iv, startpos]
+                (Vertex v, Item& itm)
+        {
+            auto d = v - iv;
+            d += startpos;
+            itm.translation(d);
+            return _objfunc(itm);
+        };
+
+        auto getNfpPoint = [&ecache](const Optimum& opt)
+        {
+            return opt.hidx < 0? ecache[opt.nfpidx].coords(opt.relpos) :
+                    ecache[opt.nfpidx].coords(opt.hidx, opt.relpos);
+        };
+
+        auto alignment = config_.alignment;
+
+        // The convex hull of the pile with the item is the convex hull of
+        // the pile's hull with the item.
+        auto boundaryCheck = [alignment, &pile_hull, &getNfpPoint,
+                &item, &bin, &iv, &startpos] (const Optimum& o)
+        {
+            auto v = getNfpPoint(o);
+            auto d = v - iv;
+            d += startpos;
+            item.translation(d);
+
+            Shapes hull_and_item;
+            hull_and_item.reserve(2);
+            hull_and_item.emplace_back(pile_hull);
+            hull_and_item.emplace_back(item.transformedShape());
+            auto chull = sl::convexHull(hull_and_item);
+
+            double miss = 0;
+            if(alignment == Config::Alignment::DONT_ALIGN)
+               miss = sl::isInside(chull, bin) ? -1.0 : 1.0;
+            else miss = overfit(chull, bin);
+
+            return miss;
+        };
+
+        Optimum optimum(0, 0);
+        double best_score = std::numeric_limits<double>::max();
+
+        using OptResult = opt::Result<double>;
+        using OptResults = std::vector<OptResult>;
+
+        // Local optimization with the polygon corners as starting points.
+        // The starting points of all the nfps and their holes are optimized
+        // concurrently, the results are examined in the same order as the
+        // nfps: the first of the equal scores wins.
+        std::vector<Start> starts;
+        std::vector<size_t> groups;   // first start of each contour
+        for(unsigned ch = 0; ch < ecache.size(); ch++) {
+            auto& cache = ecache[ch];
+
+            groups.emplace_back(starts.size());
+            for(double pos : cache.corners())
+                starts.push_back({pos, ch, -1});
+
+            for(unsigned hidx = 0; hidx < cache.holeCount(); ++hidx) {
+                groups.emplace_back(starts.size());
+                for(double pos : cache.corners(hidx))
+                    starts.push_back({pos, ch, int(hidx)});
+            }
+        }
+        groups.emplace_back(starts.size());
+
+        OptResults results(starts.size());
+        float accuracy = config_.accuracy;
+
+        __parallel::enumerate(starts.begin(), starts.end(),
+                              [&results, &item, &rawobjfunc, &getNfpPoint,
+                               accuracy] (const Start& st, size_t n)
+        {
+            Optimizer solver(accuracy);
+
+            Item itemcpy = item;
+            auto contour_ofn = [&rawobjfunc, &getNfpPoint, &st, &itemcpy]
+                    (double relpos)
+            {
+                Optimum op(relpos, st.nfpidx, st.hidx);
+                return rawobjfunc(getNfpPoint(op), itemcpy);
+            };
+
+            try {
+                results[n] = solver.optimize_min(contour_ofn,
+                                opt::initvals<double>(st.relpos),
+                                opt::bound<double>(0, 1.0)
+                                );
+            } catch(std::exception& e) {
+                derr() << "ERROR: " << e.what() << "\n";
+            }
+        }, policy);
+
+        auto resultcomp =
+                []( const OptResult& r1, const OptResult& r2 ) {
+            return r1.score < r2.score;
+        };
+
+        for(size_t g = 0; g + 1 < groups.size(); ++g) {
+            if(groups[g] == groups[g + 1]) continue;
+
+            auto from = results.begin() + long(groups[g]);
+            auto to = results.begin() + long(groups[g + 1]);
+            auto mr = *std::min_element(from, to, resultcomp);
+            const Start& st = starts[groups[g]];
+
+            if(mr.score < best_score) {
+                Optimum o(std::get<0>(mr.optimum), st.nfpidx, st.hidx);
+                double miss = boundaryCheck(o);
+                if(miss <= 0) {
+                    best_score = mr.score;
+                    optimum = o;
+                } else {
+                    ret.overfit = std::min(miss, ret.overfit);
+                }
+            }
+        }
+
+        if(best_score < ret.score) {
+            auto d = getNfpPoint(optimum) - iv;
+            d += startpos;
+            ret.translation = d;
+            ret.score = best_score;
+        }
+
+        return ret;
+    }
+
     template<class Range = ConstItemRange<typename Base::DefaultIter>>
     PackResult _trypack(
             Item& item,
@@ -793,252 +1238,52 @@ private:
             can_pack = best_overfit <= 0;
         } else {
 
-            double global_score = std::numeric_limits<double>::max();
-
             auto initial_tr = item.translation();
             auto initial_rot = item.rotation();
-            Vertex final_tr = {0, 0};
-            Radians final_rot = initial_rot;
-            Shapes nfps;
-
-            for(auto rot : config_.rotations) {
-
-                item.translation(initial_tr);
-                item.rotation(initial_rot + rot);
-                item.boundingBox(); // fill the bb cache
-
-                // place the new item outside of the print bed to make sure
-                // it is disjunct from the current merged pile
-                placeOutsideOfBin(item);
-
-                nfps = calcnfp(item, Lvl<MaxNfpLevel::value>());
-
-                auto iv = item.referenceVertex();
-
-                auto startpos = item.translation();
-
-                std::vector<Edges> ecache;
-                ecache.reserve(nfps.size());
-
-                for(auto& nfp : nfps ) {
-                    ecache.emplace_back(nfp);
-                    ecache.back().accuracy(config_.accuracy);
-                }
 
-                Shapes pile;
-                pile.reserve(items_.size()+1);
-                // double pile_area = 0;
-                for(Item& mitem : items_) {
-                    pile.emplace_back(mitem.transformedShape());
-                    // pile_area += mitem.area();
-                }
-
-                auto merged_pile = nfp::merge(pile);
-                auto& bin = bin_;
-                double norm = norm_;
-                auto pbb = sl::boundingBox(merged_pile);
-                auto binbb = sl::boundingBox(bin);
-
-                // This is the kernel part of the object function that is
-                // customizable by the library client
-                std::function<double(const Item&)> _objfunc;
-                if(config_.object_function) _objfunc = config_.object_function;
-                else {
-
-                    // Inside check has to be strict if no alignment was enabled
-                    std::function<double(const Box&)> ins_check;
-                    if(config_.alignment == Config::Alignment::DONT_ALIGN)
-                        ins_check = [&binbb, norm](const Box& fullbb) {
-                            double ret = 0;
-                            if(!sl::isInside(fullbb, binbb))
-                                ret += norm;
-                            return ret;
-                        };
-                    else
-                        ins_check = [&bin](const Box& fullbb) {
-                            double miss = overfit(fullbb, bin);
-                            miss = miss > 0? miss : 0;
-                            return std::pow(miss, 2);
-                        };
-
-                    _objfunc = [norm, binbb, pbb, ins_check](const Item& item)
-                    {
-                        auto ibb = item.boundingBox();
-                        auto fullbb = sl::boundingBox(pbb, ibb);
-
-                        double score = pl::distance(ibb.center(),
-                                                    binbb.center());
-                        score /= norm;
-
-                        score += ins_check(fullbb);
-
-                        return score;
-                    };
-                }
-
-                // Our object function for placement
-                auto rawobjfunc = [_objfunc, iv, startpos]
-                        (Vertex v, Item& itm)
-                {
-                    auto d = v - iv;
-                    d += startpos;
-                    itm.translation(d);
-                    return _objfunc(itm);
-                };
+            // Everything not depending on the rotation of the new item is
+            // prepared only once, then the rotations are tried concurrently
+            // on copies of the item.
+            for(Item& itm : items_) fillCaches(itm);
+            fillCaches(item);
 
-                auto getNfpPoint = [&ecache](const Optimum& opt)
-                {
-                    return opt.hidx < 0? ecache[opt.nfpidx].coords(opt.relpos) :
-                            ecache[opt.nfpidx].coords(opt.hidx, opt.relpos);
-                };
+            const Shapes& merged_pile = mergedPile();
+            RawShape pile_hull = sl::convexHull(merged_pile);
 
-                auto alignment = config_.alignment;
+            if(config_.before_packing)
+                config_.before_packing(merged_pile, items_, remlist);
 
-                auto boundaryCheck = [alignment, &merged_pile, &getNfpPoint,
-                        &item, &bin, &iv, &startpos] (const Optimum& o)
-                {
-                    auto v = getNfpPoint(o);
-                    auto d = v - iv;
-                    d += startpos;
-                    item.translation(d);
+            std::launch policy = std::launch::deferred;
+            if(config_.parallel) policy |= std::launch::async;
 
-                    merged_pile.emplace_back(item.transformedShape());
-                    auto chull = sl::convexHull(merged_pile);
-                    merged_pile.pop_back();
+            std::vector<RotationResult> rresults(config_.rotations.size());
 
-                    double miss = 0;
-                    if(alignment == Config::Alignment::DONT_ALIGN)
-                       miss = sl::isInside(chull, bin) ? -1.0 : 1.0;
-                    else miss = overfit(chull, bin);
-
-                    return miss;
-                };
+            __parallel::enumerate(config_.rotations.begin(),
+                                  config_.rotations.end(),
+                                  [this, &item, &rresults, &merged_pile,
+                                   &pile_hull, initial_tr, initial_rot, policy]
+                                  (Radians rot, size_t r)
+            {
+                Item itm = item;
+                itm.translation(initial_tr);
+                itm.rotation(initial_rot + rot);
+                rresults[r] = tryRotation(itm, merged_pile, pile_hull, policy);
+            }, policy);
 
-                Optimum optimum(0, 0);
-                double best_score = std::numeric_limits<double>::max();
-                std::launch policy = std::launch::deferred;
-                if(config_.parallel) policy |= std::launch::async;
-
-                if(config_.before_packing)
-                    config_.before_packing(merged_pile, items_, remlist);
-
-                using OptResult = opt::Result<double>;
-                using OptResults = std::vector<OptResult>;
-
-                // Local optimization with the four polygon corners as
-                // starting points
-                for(unsigned ch = 0; ch < ecache.size(); ch++) {
-                    auto& cache = ecache[ch];
-
-                    OptResults results(cache.corners().size());
-
-                    auto& rofn = rawobjfunc;
-                    auto& nfpoint = getNfpPoint;
-                    float accuracy = config_.accuracy;
-
-                    __parallel::enumerate(
-                                cache.corners().begin(),
-                                cache.corners().end(),
-                                [&results, &item, &rofn, &nfpoint, ch, accuracy]
-                                (double pos, size_t n)
-                    {
-                        Optimizer solver(accuracy);
-
-                        Item itemcpy = item;
-                        auto contour_ofn = [&rofn, &nfpoint, ch, &itemcpy]
-                                (double relpos)
-                        {
-                            Optimum op(relpos, ch);
-                            return rofn(nfpoint(op), itemcpy);
-                        };
-
-                        try {
-                            results[n] = solver.optimize_min(contour_ofn,
-                                            opt::initvals<double>(pos),
-                                            opt::bound<double>(0, 1.0)
-                                            );
-                        } catch(std::exception& e) {
-                            derr() << "ERROR: " << e.what() << "\n";
-                        }
-                    }, policy);
-
-                    auto resultcomp =
-                            []( const OptResult& r1, const OptResult& r2 ) {
-                        return r1.score < r2.score;
-                    };
-
-                    auto mr = *std::min_element(results.begin(), results.end(),
-                                                resultcomp);
-
-                    if(mr.score < best_score) {
-                        Optimum o(std::get<0>(mr.optimum), ch, -1);
-                        double miss = boundaryCheck(o);
-                        if(miss <= 0) {
-                            best_score = mr.score;
-                            optimum = o;
-                        } else {
-                            best_overfit = std::min(miss, best_overfit);
-                        }
-                    }
+            // The first of the equally good rotations wins
+            double global_score = std::numeric_limits<double>::max();
+            Vertex final_tr = {0, 0};
+            Radians final_rot = initial_rot;
 
-                    for(unsigned hidx = 0; hidx < cache.holeCount(); ++hidx) {
-                        results.clear();
-                        results.resize(cache.corners(hidx).size());
-
-                        // TODO : use parallel for
-                        __parallel::enumerate(cache.corners(hidx).begin(),
-                                      cache.corners(hidx).end(),
-                                      [&results, &item, &nfpoint,
-                                       &rofn, ch, hidx, accuracy]
-                                      (double pos, size_t n)
-                        {
-                            Optimizer solver(accuracy);
-
-                            Item itmcpy = item;
-                            auto hole_ofn =
-                                    [&rofn, &nfpoint, ch, hidx, &itmcpy]
-                                    (double pos)
-                            {
-                                Optimum opt(pos, ch, hidx);
-                                return rofn(nfpoint(opt), itmcpy);
-                            };
-
-                            try {
-                                results[n] = solver.optimize_min(hole_ofn,
-                                                opt::initvals<double>(pos),
-                                                opt::bound<double>(0, 1.0)
-                                                );
-
-                            } catch(std::exception& e) {
-                                derr() << "ERROR: " << e.what() << "\n";
-                            }
-                        }, policy);
-
-                        auto hmr = *std::min_element(results.begin(),
-                                                    results.end(),
-                                                    resultcomp);
-
-                        if(hmr.score < best_score) {
-                            Optimum o(std::get<0>(hmr.optimum),
-                                      ch, hidx);
-                            double miss = boundaryCheck(o);
-                            if(miss <= 0.0) {
-                                best_score = hmr.score;
-                                optimum = o;
-                            } else {
-                                best_overfit = std::min(miss, best_overfit);
-                            }
-                        }
-                    }
-                }
+            for(size_t r = 0; r < rresults.size(); ++r) {
+                const RotationResult& rr = rresults[r];
+                best_overfit = std::min(rr.overfit, best_overfit);
 
-                if( best_score < global_score ) {
-                    auto d = getNfpPoint(optimum) - iv;
-                    d += startpos;
-                    final_tr = d;
-                    final_rot = initial_rot + rot;
+                if(rr.score < global_score) {
+                    final_tr = rr.translation;
+                    final_rot = initial_rot + config_.rotations[r];
                     can_pack = true;
-                    global_score = best_score;
+                    global_score = rr.score;
                 }
             }
 
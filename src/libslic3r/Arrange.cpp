@@ -11,6 +11,8 @@
 #include <numeric>
 #include <ClipperUtils.hpp>
 
+#include <tbb/parallel_for.h>
+
 #include <boost/geometry/index/rtree.hpp>
 
 #if defined(_MSC_VER) && defined(__clang__)
@@ -147,6 +149,7 @@ protected:
 
     double    m_norm;           // A coefficient to scale distances
     MultiPolygon m_merged_pile; // The already merged pile (vector of items)
+    clppr::Polygon m_pile_hull; // The convex hull of the merged pile
     Box          m_pilebb;      // The bounding box of the merged pile.
     ItemGroup m_remaining;      // Remaining items
     ItemGroup m_items;          // allready packed items
@@ -250,7 +253,6 @@ protected:
 
             // Query the spatial index for the neighbors
             std::vector<SpatElement> result;
-            result.reserve(index.size());
 
             index.query(query, std::back_inserter(result));
 
@@ -326,6 +328,7 @@ public:
             m_remaining = remaining;
 
             m_pilebb = sl::boundingBox(merged_pile);
+            m_pile_hull = sl::convexHull(merged_pile);
 
             m_rtree.clear();
             m_smallsrtree.clear();
@@ -415,8 +418,12 @@ template<> std::function<double(const Item&)> AutoArranger<Circle>::get_objfn()
         };
         
         if(isBig(item)) {
-            auto mp = m_merged_pile;
-            mp.push_back(item.transformedShape());
+            // The hull of the pile with the item is the hull of the pile's
+            // hull with the item, no need to copy the whole pile.
+            MultiPolygon mp;
+            mp.reserve(2);
+            mp.emplace_back(m_pile_hull);
+            mp.emplace_back(item.transformedShape());
             auto chull = sl::convexHull(mp);
             double miss = Placer::overfit(chull, m_bin);
             if(miss < 0) miss = 0;
@@ -707,5 +714,266 @@ void arrange(ArrangePolygons &             inp,
     arrange(inp, {}, min_d, bedhint, prfn, stopfn);
 }
 
+// Arrange the new items around the already arranged ones
+void arrange_new_items(ArrangePolygons &             inp,
+                       coord_t                       min_d,
+                       const BedShapeHint &          bedhint,
+                       std::function<void(unsigned)> prfn,
+                       std::function<bool()>         stopfn)
+{
+    ArrangePolygons newitems, fixed;
+    std::vector<size_t> newidx;
+    
+    for (size_t i = 0; i < inp.size(); ++i)
+        if (inp[i].is_arranged()) fixed.emplace_back(inp[i]);
+        else {
+            newitems.emplace_back(inp[i]);
+            newidx.emplace_back(i);
+        }
+    
+    if (newitems.empty()) return;
+    
+    arrange(newitems, fixed, min_d, bedhint, prfn, stopfn);
+    
+    for (size_t i = 0; i < newitems.size(); ++i) {
+        ArrangePolygon &ap = inp[newidx[i]];
+        ap.translation     = newitems[i].translation;
+        ap.rotation        = newitems[i].rotation;
+        ap.bed_idx         = newitems[i].bed_idx;
+    }
+}
+
+// The area of a bed, zero for an unbounded bed
+static double bed_area(const BedShapeHint &bedhint)
+{
+    switch (bedhint.get_type()) {
+    case bsBox: {
+        const BoundingBox &bb = bedhint.get_box();
+        return double(bb.max(X) - bb.min(X)) * double(bb.max(Y) - bb.min(Y));
+    }
+    case bsCircle: {
+        double r = bedhint.get_circle().radius();
+        return PI * r * r;
+    }
+    case bsIrregular: 
+        return std::abs(Polygon(bedhint.get_irregular().points).area());
+    case bsInfinite:
+    case bsUnknown: break;
+    }
+    
+    return 0.;
+}
+
+void arrange_beds(ArrangePolygons &             items,
+                  coord_t                       min_d,
+                  const BedShapeHint &          bedhint,
+                  std::function<void(unsigned)> prfn,
+                  std::function<bool()>         stopfn)
+{
+    const double bedarea = bed_area(bedhint);
+    if (bedarea <= 0.) {
+        // Everything fits onto an unbounded bed
+        arrange(items, min_d, bedhint, prfn, stopfn);
+        return;
+    }
+    
+    auto stopped = [&stopfn] { return stopfn && stopfn(); };
+    
+    // The area an item occupies on the bed including the gap around it
+    std::vector<double> areas(items.size());
+    for (size_t i = 0; i < items.size(); ++i) {
+        const Polygon &ctr = items[i].poly.contour;
+        double r = min_d / 2.;
+        areas[i] = std::abs(ctr.area()) + ctr.length() * r + PI * r * r;
+        items[i].bed_idx = UNARRANGED;
+    }
+    
+    // The same order as the one of the first fit selection
+    std::vector<size_t> queue(items.size());
+    std::iota(queue.begin(), queue.end(), size_t(0));
+    std::stable_sort(queue.begin(), queue.end(), [&items, &areas](size_t i, size_t j) {
+        return items[i].priority == items[j].priority ?
+                   areas[i] > areas[j] : items[i].priority > items[j].priority;
+    });
+    
+    std::vector<size_t> rank(items.size());
+    for (size_t r = 0; r < queue.size(); ++r) rank[queue[r]] = r;
+    
+    struct Bed {
+        std::vector<size_t> items;      // arranged onto this bed
+        double used = 0.;               // area of the arranged items
+    };
+    
+    std::vector<Bed> beds;
+    
+    // Rounds of the concurrent arrangement of the beds. Each round arranges
+    // fewer items, evicted from the beds mostly by the larger ones.
+    static const constexpr int MAX_ROUNDS = 3;
+    
+    // The beds which did not fit the item. Every item is tried on a bed at
+    // most once, this guarantees the termination.
+    std::vector<std::vector<size_t>> rejected(items.size());
+    auto is_rejected = [&rejected](size_t i, size_t b) {
+        return std::find(rejected[i].begin(), rejected[i].end(), b) != rejected[i].end();
+    };
+    
+    for (int round = 0; round < MAX_ROUNDS && ! queue.empty() && ! stopped(); ++round) {
+        // Distribute the items among the beds by their area, first fit
+        // decreasing.
+        std::vector<std::vector<size_t>> assigned(beds.size());
+        for (size_t i : queue) {
+            size_t b = 0;
+            for (; b < beds.size(); ++b)
+                if (! is_rejected(i, b) &&
+                    (beds[b].used == 0. || beds[b].used + areas[i] <= bedarea))
+                    break;
+            
+            if (b == beds.size()) {
+                beds.emplace_back();
+                assigned.emplace_back();
+            }
+            
+            assigned[b].emplace_back(i);
+            beds[b].used += areas[i];
+        }
+        
+        // Arrange the beds which received new items from scratch, the beds
+        // do not depend on each other.
+        std::vector<ArrangePolygons> results(beds.size());
+        std::vector<std::vector<size_t>> order(beds.size());
+        tbb::parallel_for(size_t(0), beds.size(), [&](size_t b) {
+            if (assigned[b].empty()) return;
+            
+            std::vector<size_t> &ids = order[b];
+            ids = beds[b].items;
+            ids.insert(ids.end(), assigned[b].begin(), assigned[b].end());
+            std::sort(ids.begin(), ids.end(), [&rank](size_t i, size_t j) {
+                return rank[i] < rank[j];
+            });
+            
+            ArrangePolygons &inp = results[b];
+            inp.reserve(ids.size());
+            for (size_t i : ids) {
+                inp.emplace_back(items[i]);
+                inp.back().bed_idx = UNARRANGED;
+                inp.back().setter  = nullptr;
+            }
+            
+            arrange(inp, min_d, bedhint, nullptr, stopfn);
+        });
+        
+        // Keep what fits onto the beds, the rest is distributed again
+        std::vector<size_t> overflow;
+        for (size_t b = 0; b < beds.size(); ++b) {
+            if (assigned[b].empty()) continue;
+            
+            Bed &bed = beds[b];
+            bed.items.clear();
+            for (size_t k = 0; k < order[b].size(); ++k) {
+                size_t                i  = order[b][k];
+                const ArrangePolygon &ap = results[b][k];
+                
+                if (ap.bed_idx == 0) {
+                    items[i].translation = ap.translation;
+                    items[i].rotation    = ap.rotation;
+                    items[i].bed_idx     = int(b);
+                    bed.items.emplace_back(i);
+                } else {
+                    items[i].bed_idx = UNARRANGED;
+                    bed.used -= areas[i];
+                    // Items not fitting even onto an empty bed are dropped
+                    if (ap.bed_idx != UNARRANGED) {
+                        rejected[i].emplace_back(b);
+                        overflow.emplace_back(i);
+                    }
+                }
+            }
+        }
+        
+        std::sort(overflow.begin(), overflow.end(), [&rank](size_t i, size_t j) {
+            return rank[i] < rank[j];
+        });
+        
+        queue = std::move(overflow);
+        if (prfn) prfn(unsigned(queue.size()));
+    }
+    
+    // The few items evicted repeatedly are arranged onto new beds at once
+    if (! queue.empty() && ! stopped()) {
+        ArrangePolygons inp;
+        inp.reserve(queue.size());
+        for (size_t i : queue) {
+            inp.emplace_back(items[i]);
+            inp.back().setter = nullptr;
+        }
+        
+        arrange(inp, min_d, bedhint, nullptr, stopfn);
+        
+        const size_t first = beds.size();
+        for (size_t k = 0; k < queue.size(); ++k) {
+            const ArrangePolygon &ap = inp[k];
+            if (ap.bed_idx == UNARRANGED) continue;
+            
+            size_t i = queue[k], b = first + size_t(ap.bed_idx);
+            items[i].translation = ap.translation;
+            items[i].rotation    = ap.rotation;
+            items[i].bed_idx     = int(b);
+            
+            if (b >= beds.size()) beds.resize(b + 1);
+            beds[b].items.emplace_back(i);
+        }
+    }
+    
+    // The last bed is usually filled the least. Its items are placed around
+    // the items of the other beds, left in place, while it saves a bed.
+    while (beds.size() > 1 && ! stopped()) {
+        std::vector<size_t> &last = beds.back().items;
+        
+        for (size_t b = 0; b + 1 < beds.size() && ! last.empty() && ! stopped(); ++b) {
+            ArrangePolygons inp, fixed;
+            for (size_t i : last) {
+                inp.emplace_back(items[i]);
+                inp.back().bed_idx = UNARRANGED;
+                inp.back().setter  = nullptr;
+            }
+            
+            for (size_t i : beds[b].items) {
+                fixed.emplace_back(items[i]);
+                fixed.back().bed_idx = 0;
+                fixed.back().setter  = nullptr;
+            }
+            
+            arrange(inp, fixed, min_d, bedhint, nullptr, stopfn);
+            
+            std::vector<size_t> rest;
+            for (size_t k = 0; k < last.size(); ++k) {
+                size_t i = last[k];
+                if (inp[k].bed_idx == 0) {
+                    items[i].translation = inp[k].translation;
+                    items[i].rotation    = inp[k].rotation;
+                    items[i].bed_idx     = int(b);
+                    beds[b].items.emplace_back(i);
+                } else rest.emplace_back(i);
+            }
+            
+            last = std::move(rest);
+        }
+        
+        if (! last.empty()) break;
+        
+        beds.pop_back();
+    }
+    
+    // The beds emptied by evicting their items or by dropping the items not
+    // fitting at all are skipped, the rest of the beds is numbered contiguously.
+    std::vector<int> bedmap(beds.size(), UNARRANGED);
+    int nbeds = 0;
+    for (size_t b = 0; b < beds.size(); ++b)
+        if (! beds[b].items.empty()) bedmap[b] = nbeds++;
+    
+    for (ArrangePolygon &ap : items)
+        if (ap.bed_idx != UNARRANGED) ap.bed_idx = bedmap[size_t(ap.bed_idx)];
+}
+
 } // namespace arr
 } // namespace Slic3r
@@ -177,6 +177,37 @@ void arrange(ArrangePolygons &             items,
              std::function<void(unsigned)> progressind   = nullptr,
              std::function<bool(void)>     stopcondition = nullptr);
 
+/// Arrange only the items which were not arranged yet (is_arranged() is
+/// false). The already arranged items keep their position and bed and the new
+/// items are packed around them, as if they were passed as excludes.
+void arrange_new_items(ArrangePolygons &             items,
+                       coord_t                       min_obj_distance,
+                       const BedShapeHint &          bedhint,
+                       std::function<void(unsigned)> progressind   = nullptr,
+                       std::function<bool(void)>     stopcondition = nullptr);
+
+/**
+ * \brief Arranges the input polygons onto as many beds as needed.
+ *
+ * Unlike arrange(), which opens a new logical bed whenever an item does not
+ * fit into any of the beds opened so far, the items are first distributed
+ * among the beds by their area and then each bed is arranged separately, so
+ * the beds are arranged concurrently. The items which do not fit onto their
+ * bed are distributed again among the beds not yet full for a few rounds,
+ * the rest is arranged onto new beds. This scales to hundreds of items on
+ * dozens of beds.
+ *
+ * The parameters and the results are the same as for arrange(), bed_idx is
+ * the index of the bed of the item. The beds are numbered contiguously from
+ * zero, none of them is left empty. The items not fitting even onto an empty
+ * bed are left UNARRANGED. The bed has to be bounded.
+ */
+void arrange_beds(ArrangePolygons &             items,
+                  coord_t                       min_obj_distance,
+                  const BedShapeHint &          bedhint,
+                  std::function<void(unsigned)> progressind   = nullptr,
+                  std::function<bool(void)>     stopcondition = nullptr);
+
 }   // arr
 }   // Slic3r
 #endif // MODELARRANGE_HPP
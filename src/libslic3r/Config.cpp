@@ -722,6 +722,29 @@ bool DynamicConfig::operator==(const DynamicConfig &rhs) const
     return it1 == it1_end && it2 == it2_end;
 }
 
+// this will *ignore* options not present in both configs
+t_config_option_keys DynamicConfig::diff(const DynamicConfig &rhs) const
+{
+    t_config_option_keys diff;
+    auto it1     = this->options.begin();
+    auto it1_end = this->options.end();
+    auto it2     = rhs.options.begin();
+    auto it2_end = rhs.options.end();
+    while (it1 != it1_end && it2 != it2_end) {
+        if (it1->first < it2->first)
+            ++ it1;
+        else if (it2->first < it1->first)
+            ++ it2;
+        else {
+            if (*it1->second != *it2->second)
+                diff.emplace_back(it1->first);
+            ++ it1;
+            ++ it2;
+        }
+    }
+    return diff;
+}
+
 // Remove options with all nil values, those are optional and it does not help to hold them.
 size_t DynamicConfig::remove_nil_options()
 {
@@ -115,6 +115,23 @@ enum PrinterTechnology : unsigned char
     ptAny
 };
 
+// Hashing of the configuration values, consistent with the comparison operators of the ConfigOptions:
+// Equal values, including the nil values of the nullable options, produce equal hashes.
+namespace ConfigHash {
+    inline size_t combine(size_t seed, size_t hash) { return seed ^ (hash + 0x9e3779b9 + (seed << 6) + (seed >> 2)); }
+    // Zero and negative zero compare equal, all NaNs (nil values) are equal as well.
+    inline size_t value(double v)               { return (v == 0.) ? 0 : std::isnan(v) ? size_t(-1) : std::hash<double>()(v); }
+    inline size_t value(int v)                  { return std::hash<int>()(v); }
+    inline size_t value(bool v)                 { return size_t(v); }
+    inline size_t value(unsigned char v)        { return size_t(v); }
+    inline size_t value(const std::string &v)   { return std::hash<std::string>()(v); }
+    inline size_t value(const Vec2d &v)         { return combine(value(v.x()), value(v.y())); }
+    inline size_t value(const Vec3d &v)         { return combine(combine(value(v.x()), value(v.y())), value(v.z())); }
+    // ConfigOptionEnum<T> compares equal to ConfigOptionEnumGeneric of the same integer value.
+    template<typename T>
+    inline typename std::enable_if<std::is_enum<T>::value, size_t>::type value(T v) { return value(int(v)); }
+}
+
 // A generic value of a configuration option.
 class ConfigOption {
 public:
@@ -132,6 +149,8 @@ public:
     virtual void                setInt(int /* val */) { throw BadOptionTypeException("Calling ConfigOption::setInt on a non-int ConfigOption"); }
     virtual bool                operator==(const ConfigOption &rhs) const = 0;
     bool                        operator!=(const ConfigOption &rhs) const { return ! (*this == rhs); }
+    // Hash of the value(s). Options comparing equal have equal hashes.
+    virtual size_t              hash()          const = 0;
     bool                        is_scalar()     const { return (int(this->type()) & int(coVectorType)) == 0; }
     bool                        is_vector()     const { return ! this->is_scalar(); }
     // If this option is nullable, then it may have its value or values set to nil.
@@ -183,6 +202,8 @@ public:
     bool operator==(const T &rhs) const { return this->value == rhs; }
     bool operator!=(const T &rhs) const { return this->value != rhs; }
 
+    size_t hash() const override { return ConfigHash::value(this->value); }
+
 private:
 	friend class cereal::access;
 	template<class Archive> void serialize(Archive & ar) { ar(this->value); }
@@ -337,6 +358,14 @@ public:
     bool operator==(const std::vector<T> &rhs) const { return this->values == rhs; }
     bool operator!=(const std::vector<T> &rhs) const { return this->values != rhs; }
 
+    size_t hash() const override
+    {
+        size_t seed = this->values.size();
+        for (const T &v : this->values)
+            seed = ConfigHash::combine(seed, ConfigHash::value(v));
+        return seed;
+    }
+
     // Is this option overridden by another option?
     // An option overrides another option if it is not nil and not equal.
     bool overriden_by(const ConfigOption *rhs) const override {
@@ -853,6 +882,8 @@ public:
     }
     bool                        operator==(const ConfigOptionFloatOrPercent &rhs) const 
         { return this->value == rhs.value && this->percent == rhs.percent; }
+    size_t                      hash() const override 
+        { return ConfigHash::combine(ConfigHash::value(this->value), ConfigHash::value(this->percent)); }
     double                      get_abs_value(double ratio_over) const 
         { return this->percent ? (ratio_over * this->value / 100) : this->value; }
 
@@ -1734,6 +1765,11 @@ public:
 
     bool           operator==(const DynamicConfig &rhs) const;
     bool           operator!=(const DynamicConfig &rhs) const { return ! (*this == rhs); }
+    // Faster variants of ConfigBase::diff() / equals() walking the two sorted maps of options in parallel.
+    using ConfigBase::diff;
+    using ConfigBase::equals;
+    t_config_option_keys diff(const DynamicConfig &rhs) const;
+    bool           equals(const DynamicConfig &rhs) const { return this->diff(rhs).empty(); }
 
     void swap(DynamicConfig &other) 
     { 
@@ -53,6 +53,9 @@ private:
     // Private constructor to create a key for a search in std::set.
     Extruder(unsigned int id) : m_id(id) {}
 
+    // GCodeWriter rebinds m_config when copied and compares the extruder state.
+    friend class GCodeWriter;
+
     // Reference to GCodeWriter instance owned by GCodeWriter.
     GCodeConfig *m_config;
     // Print-wide global ID of this extruder.
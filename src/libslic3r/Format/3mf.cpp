@@ -27,6 +27,7 @@ namespace pt = boost::property_tree;
 
 #include <expat.h>
 #include <Eigen/Dense>
+#include <tbb/parallel_for.h>
 #include "miniz_extension.hpp"
 
 // VERSION NUMBERS
@@ -159,6 +160,70 @@ int get_attribute_value_int(const char** attributes, unsigned int attributes_siz
     return (text != nullptr) ? ::atoi(text) : 0;
 }
 
+// Converts the text of a numeric attribute with the same result as ::atof().
+// Plain decimal numbers with up to 15 significant digits and a small exponent,
+// which is what 3MF exporters write for vertex coordinates, are converted
+// exactly without calling into the C library.
+double parse_attribute_double(const char* text)
+{
+    static const double pow10[] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+                                    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+
+    const char* p = text;
+    bool negative = *p == '-';
+    if (*p == '-' || *p == '+')
+        ++p;
+
+    uint64_t mantissa = 0;
+    int digits = 0;
+    int exponent = 0;
+    bool any = false;
+    for (; *p >= '0' && *p <= '9'; ++p, any = true)
+    {
+        if (mantissa != 0 || *p != '0')
+        {
+            if (++digits > 15)
+                return ::atof(text);
+            mantissa = mantissa * 10 + uint64_t(*p - '0');
+        }
+    }
+    if (*p == '.')
+    {
+        for (++p; *p >= '0' && *p <= '9'; ++p, any = true)
+        {
+            if (mantissa != 0 || *p != '0')
+            {
+                if (++digits > 15)
+                    return ::atof(text);
+                mantissa = mantissa * 10 + uint64_t(*p - '0');
+            }
+            --exponent;
+        }
+    }
+    if (any && (*p == 'e' || *p == 'E'))
+    {
+        ++p;
+        bool exp_negative = *p == '-';
+        if (*p == '-' || *p == '+')
+            ++p;
+        int e = 0;
+        bool exp_any = false;
+        for (; *p >= '0' && *p <= '9' && e < 1000; ++p, exp_any = true)
+            e = e * 10 + (*p - '0');
+        if (!exp_any)
+            any = false;
+        exponent += exp_negative ? -e : e;
+    }
+
+    // Anything else (leading white spaces, hexadecimal numbers, inf, nan...) is left to ::atof().
+    if (!any || *p != '\0' || exponent < -22 || exponent > 22)
+        return ::atof(text);
+
+    // Both the mantissa and the power of ten are exact, a single operation is correctly rounded.
+    double value = (exponent < 0) ? double(mantissa) / pow10[-exponent] : double(mantissa) * pow10[exponent];
+    return negative ? -value : value;
+}
+
 bool get_attribute_value_bool(const char** attributes, unsigned int attributes_size, const char* attribute_key)
 {
     const char* text = get_attribute_value_charptr(attributes, attributes_size, attribute_key);
@@ -492,7 +557,18 @@ namespace Slic3r {
         bool _handle_start_config_metadata(const char** attributes, unsigned int num_attributes);
         bool _handle_end_config_metadata();
 
-        bool _generate_volumes(ModelObject& object, const Geometry& geometry, const ObjectMetadata::VolumeMetadataList& volumes);
+        // Repaired mesh of a volume with its convex hull.
+        struct VolumeMesh
+        {
+            TriangleMesh mesh;
+            TriangleMesh convex_hull;
+        };
+
+        // Builds the meshes of the given volumes out of the object geometry. Does not touch the importer
+        // nor the model, so that it may be called concurrently for multiple objects.
+        // Returns false if the volumes reference triangles out of the geometry.
+        static bool _generate_volume_meshes(const Geometry& geometry, const ObjectMetadata::VolumeMetadataList& volumes, std::vector<VolumeMesh>& meshes);
+        bool _generate_volumes(ModelObject& object, const ObjectMetadata::VolumeMetadataList& volumes, std::vector<VolumeMesh>&& meshes);
 
         // callbacks to parse the .model file
         static void XMLCALL _handle_start_model_xml_element(void* userData, const char* name, const char** attributes);
@@ -659,6 +735,19 @@ namespace Slic3r {
 
         close_zip_reader(&archive);
 
+        // The meshes of the volumes are built and repaired concurrently for all the objects,
+        // the model is then updated sequentially in the order of the objects.
+        struct ObjectVolumes
+        {
+            ModelObject* model_object;
+            const Geometry* geometry;
+            ObjectMetadata::VolumeMetadataList volumes;
+            std::vector<VolumeMesh> meshes;
+            bool valid;
+        };
+        std::vector<ObjectVolumes> objects_volumes;
+        objects_volumes.reserve(m_objects.size());
+
         for (const IdToModelObjectMap::value_type& object : m_objects)
         {
             ModelObject *model_object = m_model->objects[object.second];
@@ -722,7 +811,23 @@ namespace Slic3r {
                 volumes_ptr = &volumes;
             }
 
-            if (!_generate_volumes(*model_object, obj_geometry->second, *volumes_ptr))
+            objects_volumes.push_back({ model_object, &obj_geometry->second, std::move(*volumes_ptr), {}, false });
+        }
+
+        tbb::parallel_for(size_t(0), objects_volumes.size(), [&objects_volumes](size_t idx) {
+            ObjectVolumes& object_volumes = objects_volumes[idx];
+            object_volumes.valid = _generate_volume_meshes(*object_volumes.geometry, object_volumes.volumes, object_volumes.meshes);
+        });
+
+        for (ObjectVolumes& object_volumes : objects_volumes)
+        {
+            if (!object_volumes.valid)
+            {
+                add_error("Found invalid triangle id");
+                return false;
+            }
+
+            if (!_generate_volumes(*object_volumes.model_object, object_volumes.volumes, std::move(object_volumes.meshes)))
                 return false;
         }
 
@@ -1480,9 +1585,21 @@ namespace Slic3r {
     {
         // appends the vertex coordinates
         // missing values are set equal to ZERO
-        m_curr_object.geometry.vertices.push_back(m_unit_factor * get_attribute_value_float(attributes, num_attributes, X_ATTR));
-        m_curr_object.geometry.vertices.push_back(m_unit_factor * get_attribute_value_float(attributes, num_attributes, Y_ATTR));
-        m_curr_object.geometry.vertices.push_back(m_unit_factor * get_attribute_value_float(attributes, num_attributes, Z_ATTR));
+        // this is the hot path of loading large files, thus the attributes are scanned just once
+        float coords[3] = { 0.0f, 0.0f, 0.0f };
+        if (attributes != nullptr && num_attributes % 2 == 0)
+        {
+            for (unsigned int a = 0; a < num_attributes; a += 2)
+            {
+                const char* key = attributes[a];
+                int axis = (::strcmp(key, X_ATTR) == 0) ? 0 : (::strcmp(key, Y_ATTR) == 0) ? 1 : (::strcmp(key, Z_ATTR) == 0) ? 2 : -1;
+                if (axis != -1)
+                    coords[axis] = (float)parse_attribute_double(attributes[a + 1]);
+            }
+        }
+
+        for (float coord : coords)
+            m_curr_object.geometry.vertices.push_back(m_unit_factor * coord);
         return true;
     }
 
@@ -1516,9 +1633,20 @@ namespace Slic3r {
 
         // appends the triangle's vertices indices
         // missing values are set equal to ZERO
-        m_curr_object.geometry.triangles.push_back((unsigned int)get_attribute_value_int(attributes, num_attributes, V1_ATTR));
-        m_curr_object.geometry.triangles.push_back((unsigned int)get_attribute_value_int(attributes, num_attributes, V2_ATTR));
-        m_curr_object.geometry.triangles.push_back((unsigned int)get_attribute_value_int(attributes, num_attributes, V3_ATTR));
+        // this is the hot path of loading large files, thus the attributes are scanned just once
+        unsigned int indices[3] = { 0, 0, 0 };
+        if (attributes != nullptr && num_attributes % 2 == 0)
+        {
+            for (unsigned int a = 0; a < num_attributes; a += 2)
+            {
+                const char* key = attributes[a];
+                int corner = (::strcmp(key, V1_ATTR) == 0) ? 0 : (::strcmp(key, V2_ATTR) == 0) ? 1 : (::strcmp(key, V3_ATTR) == 0) ? 2 : -1;
+                if (corner != -1)
+                    indices[corner] = (unsigned int)::atoi(attributes[a + 1]);
+            }
+        }
+
+        m_curr_object.geometry.triangles.insert(m_curr_object.geometry.triangles.end(), indices, indices + 3);
         return true;
     }
 
@@ -1790,42 +1918,23 @@ namespace Slic3r {
         return true;
     }
 
-    bool _3MF_Importer::_generate_volumes(ModelObject& object, const Geometry& geometry, const ObjectMetadata::VolumeMetadataList& volumes)
+    bool _3MF_Importer::_generate_volume_meshes(const Geometry& geometry, const ObjectMetadata::VolumeMetadataList& volumes, std::vector<VolumeMesh>& meshes)
     {
-        if (!object.volumes.empty())
-        {
-            add_error("Found invalid volumes count");
-            return false;
-        }
-
         unsigned int geo_tri_count = (unsigned int)geometry.triangles.size() / 3;
 
+        meshes.clear();
+        meshes.reserve(volumes.size());
         for (const ObjectMetadata::VolumeMetadata& volume_data : volumes)
         {
             if ((geo_tri_count <= volume_data.first_triangle_id) || (geo_tri_count <= volume_data.last_triangle_id) || (volume_data.last_triangle_id < volume_data.first_triangle_id))
-            {
-                add_error("Found invalid triangle id");
                 return false;
-            }
-
-            Transform3d volume_matrix_to_object = Transform3d::Identity();
-            bool        has_transform 		    = false;
-            // extract the volume transformation from the volume's metadata, if present
-            for (const Metadata& metadata : volume_data.metadata)
-            {
-                if (metadata.key == MATRIX_KEY)
-                {
-                    volume_matrix_to_object = Slic3r::Geometry::transform3d_from_string(metadata.value);
-                    has_transform 			= ! volume_matrix_to_object.isApprox(Transform3d::Identity(), 1e-10);
-                    break;
-                }
-            }
 
             // splits volume out of imported geometry
-			TriangleMesh triangle_mesh;
-            stl_file    &stl             = triangle_mesh.stl;
-			unsigned int triangles_count = volume_data.last_triangle_id - volume_data.first_triangle_id + 1;
-			stl.stats.type = inmemory;
+            meshes.emplace_back();
+            TriangleMesh &triangle_mesh   = meshes.back().mesh;
+            stl_file     &stl             = triangle_mesh.stl;
+            unsigned int triangles_count = volume_data.last_triangle_id - volume_data.first_triangle_id + 1;
+            stl.stats.type = inmemory;
             stl.stats.number_of_facets = (uint32_t)triangles_count;
             stl.stats.original_num_facets = (int)stl.stats.number_of_facets;
             stl_allocate(&stl);
@@ -1843,14 +1952,44 @@ namespace Slic3r {
                 }
             }
 
-			stl_get_size(&stl);
-			triangle_mesh.repair();
+            stl_get_size(&stl);
+            triangle_mesh.repair();
+            meshes.back().convex_hull = triangle_mesh.convex_hull_3d();
+        }
+
+        return true;
+    }
 
-			ModelVolume* volume = object.add_volume(std::move(triangle_mesh));
+    bool _3MF_Importer::_generate_volumes(ModelObject& object, const ObjectMetadata::VolumeMetadataList& volumes, std::vector<VolumeMesh>&& meshes)
+    {
+        if (!object.volumes.empty())
+        {
+            add_error("Found invalid volumes count");
+            return false;
+        }
+
+        assert(meshes.size() == volumes.size());
+        for (size_t volume_idx = 0; volume_idx < volumes.size(); ++volume_idx)
+        {
+            const ObjectMetadata::VolumeMetadata& volume_data = volumes[volume_idx];
+
+            Transform3d volume_matrix_to_object = Transform3d::Identity();
+            bool        has_transform 		    = false;
+            // extract the volume transformation from the volume's metadata, if present
+            for (const Metadata& metadata : volume_data.metadata)
+            {
+                if (metadata.key == MATRIX_KEY)
+                {
+                    volume_matrix_to_object = Slic3r::Geometry::transform3d_from_string(metadata.value);
+                    has_transform 			= ! volume_matrix_to_object.isApprox(Transform3d::Identity(), 1e-10);
+                    break;
+                }
+            }
+
+            ModelVolume* volume = object.add_volume(std::move(meshes[volume_idx].mesh), std::move(meshes[volume_idx].convex_hull));
             // stores the volume matrix taken from the metadata, if present
             if (has_transform)
                 volume->source.transform = Slic3r::Geometry::Transformation(volume_matrix_to_object);
-            volume->calculate_convex_hull();
 
             // apply the remaining volume's metadata
             for (const Metadata& metadata : volume_data.metadata)
@@ -1973,8 +2112,10 @@ namespace Slic3r {
         bool _add_thumbnail_file_to_archive(mz_zip_archive& archive, const ThumbnailData& thumbnail_data);
         bool _add_relationships_file_to_archive(mz_zip_archive& archive);
         bool _add_model_file_to_archive(mz_zip_archive& archive, const Model& model, IdToObjectDataMap &objects_data);
-        bool _add_object_to_model_stream(std::stringstream& stream, unsigned int& object_id, ModelObject& object, BuildItemsList& build_items, VolumeToOffsetsMap& volumes_offsets);
-        bool _add_mesh_to_object_stream(std::stringstream& stream, ModelObject& object, VolumeToOffsetsMap& volumes_offsets);
+        // Serialize a single object into its own part of the model file. Neither touches the exporter,
+        // so that multiple objects may be serialized concurrently.
+        static bool _add_object_to_model_stream(std::string& stream, unsigned int object_id, ModelObject& object, BuildItemsList& build_items, VolumeToOffsetsMap& volumes_offsets);
+        static bool _add_mesh_to_object_stream(std::string& stream, ModelObject& object, VolumeToOffsetsMap& volumes_offsets);
         bool _add_build_to_model_stream(std::stringstream& stream, const BuildItemsList& build_items);
         bool _add_layer_height_profile_file_to_archive(mz_zip_archive& archive, Model& model);
         bool _add_layer_config_ranges_file_to_archive(mz_zip_archive& archive, Model& model);
@@ -2197,8 +2338,23 @@ namespace Slic3r {
         stream << " <" << METADATA_TAG << " name=\"" << SLIC3RPE_3MF_VERSION << "\">" << VERSION_3MF << "</" << METADATA_TAG << ">\n";
         stream << " <" << RESOURCES_TAG << ">\n";
 
-        // Instance transformations, indexed by the 3MF object ID (which is a linear serialization of all instances of all ModelObjects).
-        BuildItemsList build_items;
+        // The model file is assembled from parts: the header, the objects and the build.
+        std::vector<std::string> parts;
+        parts.reserve(model.objects.size() + 2);
+        parts.emplace_back(stream.str());
+        stream.str("");
+
+        struct ObjectPart
+        {
+            ModelObject* object;
+            unsigned int object_id;
+            VolumeToOffsetsMap* volumes_offsets;
+            BuildItemsList build_items;
+            std::string xml;
+            bool valid;
+        };
+        std::vector<ObjectPart> objects_parts;
+        objects_parts.reserve(model.objects.size());
 
         // The object_id here is a one based identifier of the first instance of a ModelObject in the 3MF file, where
         // all the object instances of all ModelObjects are stored and indexed in a 1 based linear fashion.
@@ -2214,12 +2370,31 @@ namespace Slic3r {
             IdToObjectDataMap::iterator object_it = objects_data.insert(IdToObjectDataMap::value_type(curr_id, ObjectData(obj))).first;
             // Store geometry of all ModelVolumes contained in a single ModelObject into a single 3MF indexed triangle set object.
             // object_it->second.volumes_offsets will contain the offsets of the ModelVolumes in that single indexed triangle set.
+            objects_parts.push_back({ obj, curr_id, &object_it->second.volumes_offsets, {}, {}, false });
             // object_id will be increased to point to the 1st instance of the next ModelObject.
-            if (!_add_object_to_model_stream(stream, object_id, *obj, build_items, object_it->second.volumes_offsets))
+            object_id += (unsigned int)std::count_if(obj->instances.begin(), obj->instances.end(), [](const ModelInstance* instance) { return instance != nullptr; });
+        }
+
+        // The objects are serialized concurrently, the exceptions thrown for invalid meshes are propagated to this thread.
+        tbb::parallel_for(size_t(0), objects_parts.size(), [&objects_parts](size_t idx) {
+            ObjectPart& part = objects_parts[idx];
+            part.valid = _add_object_to_model_stream(part.xml, part.object_id, *part.object, part.build_items, *part.volumes_offsets);
+        });
+
+        // Instance transformations, indexed by the 3MF object ID (which is a linear serialization of all instances of all ModelObjects).
+        BuildItemsList build_items;
+        for (ObjectPart& part : objects_parts)
+        {
+            if (!part.valid)
             {
+                add_error("Found invalid mesh");
                 add_error("Unable to add object to archive");
                 return false;
             }
+
+            parts.emplace_back(std::move(part.xml));
+            assert(part.build_items.empty() || part.build_items.front().id == build_items.size() + 1);
+            build_items.insert(build_items.end(), part.build_items.begin(), part.build_items.end());
         }
 
         stream << " </" << RESOURCES_TAG << ">\n";
@@ -2233,9 +2408,9 @@ namespace Slic3r {
 
         stream << "</" << MODEL_TAG << ">\n";
 
-        std::string out = stream.str();
+        parts.emplace_back(stream.str());
 
-        if (!mz_zip_writer_add_mem(&archive, MODEL_FILE.c_str(), (const void*)out.data(), out.length(), MZ_DEFAULT_COMPRESSION))
+        if (!add_file_to_zip_writer(&archive, MODEL_FILE, parts, MZ_DEFAULT_COMPRESSION))
         {
             add_error("Unable to add model file to archive");
             return false;
@@ -2244,7 +2419,31 @@ namespace Slic3r {
         return true;
     }
 
-    bool _3MF_Exporter::_add_object_to_model_stream(std::stringstream& stream, unsigned int& object_id, ModelObject& object, BuildItemsList& build_items, VolumeToOffsetsMap& volumes_offsets)
+    // Appends the decimal representation of an unsigned integer.
+    static inline void append_uint(std::string& stream, unsigned int value)
+    {
+        char buffer[16];
+        char* end = buffer + sizeof(buffer);
+        char* begin = end;
+        do
+        {
+            *--begin = char('0' + value % 10);
+            value /= 10;
+        }
+        while (value != 0);
+        stream.append(begin, end);
+    }
+
+    // Appends a float with max_digits10 significant digits, matching std::ostream with std::setprecision(max_digits10),
+    // so that the conversion back to float is exact.
+    static inline void append_float(std::string& stream, float value)
+    {
+        char buffer[32];
+        int length = ::snprintf(buffer, sizeof(buffer), "%.*g", std::numeric_limits<float>::max_digits10, (double)value);
+        stream.append(buffer, (size_t)length);
+    }
+
+    bool _3MF_Exporter::_add_object_to_model_stream(std::string& stream, unsigned int object_id, ModelObject& object, BuildItemsList& build_items, VolumeToOffsetsMap& volumes_offsets)
     {
         unsigned int id = 0;
         for (const ModelInstance* instance : object.instances)
@@ -2254,42 +2453,70 @@ namespace Slic3r {
                 continue;
 
             unsigned int instance_id = object_id + id;
-            stream << "  <" << OBJECT_TAG << " id=\"" << instance_id << "\" type=\"model\">\n";
+            stream += "  <";
+            stream += OBJECT_TAG;
+            stream += " id=\"";
+            append_uint(stream, instance_id);
+            stream += "\" type=\"model\">\n";
 
             if (id == 0)
             {
                 if (!_add_mesh_to_object_stream(stream, object, volumes_offsets))
-                {
-                    add_error("Unable to add mesh to archive");
                     return false;
-                }
             }
             else
             {
-                stream << "   <" << COMPONENTS_TAG << ">\n";
-                stream << "    <" << COMPONENT_TAG << " objectid=\"" << object_id << "\" />\n";
-                stream << "   </" << COMPONENTS_TAG << ">\n";
+                stream += "   <";
+                stream += COMPONENTS_TAG;
+                stream += ">\n";
+                stream += "    <";
+                stream += COMPONENT_TAG;
+                stream += " objectid=\"";
+                append_uint(stream, object_id);
+                stream += "\" />\n";
+                stream += "   </";
+                stream += COMPONENTS_TAG;
+                stream += ">\n";
             }
 
             Transform3d t = instance->get_matrix();
-            // instance_id is just a 1 indexed index in build_items.
-            assert(instance_id == build_items.size() + 1);
+            // instance_id is just a 1 indexed index in build_items, which are collected for all the objects in order.
+            assert(instance_id == object_id + build_items.size());
             build_items.emplace_back(instance_id, t, instance->printable);
 
-            stream << "  </" << OBJECT_TAG << ">\n";
+            stream += "  </";
+            stream += OBJECT_TAG;
+            stream += ">\n";
 
             ++id;
         }
 
-        object_id += id;
         return true;
     }
 
-    bool _3MF_Exporter::_add_mesh_to_object_stream(std::stringstream& stream, ModelObject& object, VolumeToOffsetsMap& volumes_offsets)
+    bool _3MF_Exporter::_add_mesh_to_object_stream(std::string& stream, ModelObject& object, VolumeToOffsetsMap& volumes_offsets)
     {
-        stream << "   <" << MESH_TAG << ">\n";
-        stream << "    <" << VERTICES_TAG << ">\n";
+        size_t vertices_count_total  = 0;
+        size_t triangles_count_total = 0;
+        for (const ModelVolume* volume : object.volumes)
+        {
+            if (volume != nullptr)
+            {
+                vertices_count_total  += volume->mesh().its.vertices.size();
+                triangles_count_total += volume->mesh().its.indices.size();
+            }
+        }
+        // Rough estimate of the lengths of the vertex and triangle elements.
+        stream.reserve(stream.size() + 80 * vertices_count_total + 60 * triangles_count_total);
+
+        stream += "   <";
+        stream += MESH_TAG;
+        stream += ">\n";
+        stream += "    <";
+        stream += VERTICES_TAG;
+        stream += ">\n";
 
+        const std::string vertex_prefix = std::string("     <") + VERTEX_TAG + " x=\"";
         unsigned int vertices_count = 0;
         for (ModelVolume* volume : object.volumes)
         {
@@ -2305,10 +2532,7 @@ namespace Slic3r {
 
             const indexed_triangle_set &its = volume->mesh().its;
             if (its.vertices.empty())
-            {
-                add_error("Found invalid mesh");
                 return false;
-            }
 
             vertices_count += (int)its.vertices.size();
 
@@ -2316,17 +2540,25 @@ namespace Slic3r {
 
             for (size_t i = 0; i < its.vertices.size(); ++i)
             {
-                stream << "     <" << VERTEX_TAG << " ";
                 Vec3f v = (matrix * its.vertices[i].cast<double>()).cast<float>();
-                stream << "x=\"" << v(0) << "\" ";
-                stream << "y=\"" << v(1) << "\" ";
-                stream << "z=\"" << v(2) << "\" />\n";
+                stream += vertex_prefix;
+                append_float(stream, v(0));
+                stream += "\" y=\"";
+                append_float(stream, v(1));
+                stream += "\" z=\"";
+                append_float(stream, v(2));
+                stream += "\" />\n";
             }
         }
 
-        stream << "    </" << VERTICES_TAG << ">\n";
-        stream << "    <" << TRIANGLES_TAG << ">\n";
+        stream += "    </";
+        stream += VERTICES_TAG;
+        stream += ">\n";
+        stream += "    <";
+        stream += TRIANGLES_TAG;
+        stream += ">\n";
 
+        const std::string triangle_prefix = std::string("     <") + TRIANGLE_TAG + " v1=\"";
         unsigned int triangles_count = 0;
         for (ModelVolume* volume : object.volumes)
         {
@@ -2343,19 +2575,25 @@ namespace Slic3r {
             triangles_count += (int)its.indices.size();
             volume_it->second.last_triangle_id = triangles_count - 1;
 
+            unsigned int first_vertex_id = volume_it->second.first_vertex_id;
             for (size_t i = 0; i < its.indices.size(); ++ i)
             {
-                stream << "     <" << TRIANGLE_TAG << " ";
-                for (int j = 0; j < 3; ++j)
-                {
-                    stream << "v" << j + 1 << "=\"" << its.indices[i][j] + volume_it->second.first_vertex_id << "\" ";
-                }
-                stream << "/>\n";
-            }
-        }
-
-        stream << "    </" << TRIANGLES_TAG << ">\n";
-        stream << "   </" << MESH_TAG << ">\n";
+                stream += triangle_prefix;
+                append_uint(stream, its.indices[i][0] + first_vertex_id);
+                stream += "\" v2=\"";
+                append_uint(stream, its.indices[i][1] + first_vertex_id);
+                stream += "\" v3=\"";
+                append_uint(stream, its.indices[i][2] + first_vertex_id);
+                stream += "\" />\n";
+            }
+        }
+
+        stream += "    </";
+        stream += TRIANGLES_TAG;
+        stream += ">\n";
+        stream += "   </";
+        stream += MESH_TAG;
+        stream += ">\n";
 
         return true;
     }
@@ -15,13 +15,20 @@
 
 namespace Slic3r {
 
+static bool s_obj_binary_cache = false;
+
+void set_obj_binary_cache(bool enable)
+{
+    s_obj_binary_cache = enable;
+}
+
 bool load_obj(const char *path, TriangleMesh *meshptr)
 {
     if(meshptr == nullptr) return false;
     
     // Parse the OBJ file.
     ObjParser::ObjData data;
-    if (! ObjParser::objparse(path, data)) {
+    if (! (s_obj_binary_cache ? ObjParser::objparse_cached(path, data) : ObjParser::objparse(path, data))) {
         //    die "Failed to parse $file\n" if !-e $path;
         return false;
     }
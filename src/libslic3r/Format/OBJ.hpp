@@ -7,6 +7,10 @@ class TriangleMesh;
 class Model;
 class ModelObject;
 
+// Cache the parsed OBJ files in binary files next to them, see ObjParser::objparse_cached().
+// Disabled by default.
+extern void set_obj_binary_cache(bool enable);
+
 // Load an OBJ file into a provided model.
 extern bool load_obj(const char *path, TriangleMesh *mesh);
 extern bool load_obj(const char *path, Model *model, const char *object_name = nullptr);
@@ -1,13 +1,103 @@
 #include <stdlib.h>
 #include <string.h>
+#include <stdint.h>
 
 #include <boost/nowide/cstdio.hpp>
+#include <boost/filesystem/operations.hpp>
+
+#include <tbb/parallel_for.h>
 
 #include "objparser.hpp"
 
 namespace ObjParser {
 
-static bool obj_parseline(const char *line, ObjData &data)
+// Parses a number the same way as strtod(). Plain decimal numbers with up to 15 significant digits
+// and a small exponent, which is what the OBJ exporters write, are converted exactly without
+// calling into the C library.
+static double parse_double(const char *str, char **endptr)
+{
+	static const double pow10[] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+	                                1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+
+	const char *p = str;
+	bool negative = *p == '-';
+	if (*p == '-' || *p == '+')
+		++ p;
+
+	uint64_t mantissa = 0;
+	int      digits   = 0;
+	int      exponent = 0;
+	bool     any      = false;
+	for (; *p >= '0' && *p <= '9'; ++ p, any = true)
+		if (mantissa != 0 || *p != '0') {
+			if (++ digits > 15)
+				return strtod(str, endptr);
+			mantissa = mantissa * 10 + uint64_t(*p - '0');
+		}
+	if (*p == '.')
+		for (++ p; *p >= '0' && *p <= '9'; ++ p, any = true) {
+			if (mantissa != 0 || *p != '0') {
+				if (++ digits > 15)
+					return strtod(str, endptr);
+				mantissa = mantissa * 10 + uint64_t(*p - '0');
+			}
+			-- exponent;
+		}
+	if (any && (*p == 'e' || *p == 'E')) {
+		++ p;
+		bool exp_negative = *p == '-';
+		if (*p == '-' || *p == '+')
+			++ p;
+		int  e       = 0;
+		bool exp_any = false;
+		for (; *p >= '0' && *p <= '9' && e < 1000; ++ p, exp_any = true)
+			e = e * 10 + (*p - '0');
+		if (! exp_any || (*p >= '0' && *p <= '9'))
+			any = false;
+		exponent += exp_negative ? -e : e;
+	}
+
+	// Anything else (leading white spaces, hexadecimal numbers, inf, nan...) is left to strtod().
+	if (! any || *p == 'x' || *p == 'X' || exponent < -22 || exponent > 22)
+		return strtod(str, endptr);
+
+	// Both the mantissa and the power of ten are exact, a single operation is correctly rounded.
+	*endptr = const_cast<char*>(p);
+	double value = (exponent < 0) ? double(mantissa) / pow10[-exponent] : double(mantissa) * pow10[exponent];
+	return negative ? -value : value;
+}
+
+// Parses an integer the same way as strtol(str, endptr, 10).
+static long parse_long(const char *str, char **endptr)
+{
+	const char *p = str;
+	bool negative = *p == '-';
+	if (*p == '-' || *p == '+')
+		++ p;
+	if (*p < '0' || *p > '9')
+		return strtol(str, endptr, 10);
+	long value = 0;
+	for (int digits = 0; *p >= '0' && *p <= '9'; ++ p)
+		if (++ digits > 9)
+			return strtol(str, endptr, 10);
+		else
+			value = value * 10 + (*p - '0');
+	*endptr = const_cast<char*>(p);
+	return negative ? -value : value;
+}
+
+// Number of the coordinates, normals and texture coordinates preceding a block of lines,
+// which is parsed into its own ObjData. Needed to resolve the relative (negative) indices of faces.
+struct ObjIndexOffsets
+{
+	int  coordinates		= 0;
+	int  normals			= 0;
+	int  textureCoordinates	= 0;
+	// Set if a face referenced a vertex relatively.
+	bool relative			= false;
+};
+
+static bool obj_parseline(const char *line, ObjData &data, ObjIndexOffsets &offsets)
 {
 #define EATWS() while (*line == ' ' || *line == '\t') ++ line
 
@@ -37,14 +127,14 @@ static bool obj_parseline(const char *line, ObjData &data)
 				return false;
 			EATWS();
 			char *endptr = 0;
-			double u = strtod(line, &endptr);
+			double u = parse_double(line, &endptr);
 			if (endptr == 0 || (*endptr != ' ' && *endptr != '\t'))
 				return false;
 			line = endptr;
 			EATWS();
 			double v = 0;
 			if (*line != 0) {
-				v = strtod(line, &endptr);
+				v = parse_double(line, &endptr);
 				if (endptr == 0 || (*endptr != ' ' && *endptr != '\t' && *endptr != 0))
 					return false;
 				line = endptr;
@@ -52,7 +142,7 @@ static bool obj_parseline(const char *line, ObjData &data)
 			}
 			double w = 0;
 			if (*line != 0) {
-				w = strtod(line, &endptr);
+				w = parse_double(line, &endptr);
 				if (endptr == 0 || (*endptr != ' ' && *endptr != '\t' && *endptr != 0))
 					return false;
 				line = endptr;
@@ -74,17 +164,17 @@ static bool obj_parseline(const char *line, ObjData &data)
 				return false;
 			EATWS();
 			char *endptr = 0;
-			double x = strtod(line, &endptr);
+			double x = parse_double(line, &endptr);
 			if (endptr == 0 || (*endptr != ' ' && *endptr != '\t'))
 				return false;
 			line = endptr;
 			EATWS();
-			double y = strtod(line, &endptr);
+			double y = parse_double(line, &endptr);
 			if (endptr == 0 || (*endptr != ' ' && *endptr != '\t'))
 				return false;
 			line = endptr;
 			EATWS();
-			double z = strtod(line, &endptr);
+			double z = parse_double(line, &endptr);
 			if (endptr == 0 || (*endptr != ' ' && *endptr != '\t' && *endptr != 0))
 				return false;
 			line = endptr;
@@ -104,19 +194,19 @@ static bool obj_parseline(const char *line, ObjData &data)
 				return false;
 			EATWS();
 			char *endptr = 0;
-			double u = strtod(line, &endptr);
+			double u = parse_double(line, &endptr);
 			if (endptr == 0 || (*endptr != ' ' && *endptr != '\t' && *endptr != 0))
 				return false;
 			line = endptr;
 			EATWS();
-			double v = strtod(line, &endptr);
+			double v = parse_double(line, &endptr);
 			if (endptr == 0 || (*endptr != ' ' && *endptr != '\t' && *endptr != 0))
 				return false;
 			line = endptr;
 			EATWS();
 			double w = 0;
 			if (*line != 0) {
-				w = strtod(line, &endptr);
+				w = parse_double(line, &endptr);
 				if (endptr == 0 || (*endptr != ' ' && *endptr != '\t' && *endptr != 0))
 					return false;
 				line = endptr;
@@ -136,24 +226,24 @@ static bool obj_parseline(const char *line, ObjData &data)
 				return false;
 			EATWS();
 			char *endptr = 0;
-			double x = strtod(line, &endptr);
+			double x = parse_double(line, &endptr);
 			if (endptr == 0 || (*endptr != ' ' && *endptr != '\t'))
 				return false;
 			line = endptr;
 			EATWS();
-			double y = strtod(line, &endptr);
+			double y = parse_double(line, &endptr);
 			if (endptr == 0 || (*endptr != ' ' && *endptr != '\t'))
 				return false;
 			line = endptr;
 			EATWS();
-			double z = strtod(line, &endptr);
+			double z = parse_double(line, &endptr);
 			if (endptr == 0 || (*endptr != ' ' && *endptr != '\t' && *endptr != 0))
 				return false;
 			line = endptr;
 			EATWS();
 			double w = 1.0;
 			if (*line != 0) {
-				w = strtod(line, &endptr);
+				w = parse_double(line, &endptr);
 				if (endptr == 0 || (*endptr != ' ' && *endptr != '\t' && *endptr != 0))
 					return false;
 				line = endptr;
@@ -188,7 +278,7 @@ static bool obj_parseline(const char *line, ObjData &data)
 			vertex.coordIdx			= 0;
 			vertex.normalIdx		= 0;
 			vertex.textureCoordIdx	= 0;
-			vertex.coordIdx = strtol(line, &endptr, 10);
+			vertex.coordIdx = parse_long(line, &endptr);
 			// Coordinate has to be defined
 			if (endptr == 0 || (*endptr != ' ' && *endptr != '\t' && *endptr != '/' && *endptr != 0))
 				return false;
@@ -198,7 +288,7 @@ static bool obj_parseline(const char *line, ObjData &data)
 				// Texture coordinate index may be missing after a 1st slash, but then the normal index has to be present.
 				if (*line != '/') {
 					// Parse the texture coordinate index.
-					vertex.textureCoordIdx = strtol(line, &endptr, 10);
+					vertex.textureCoordIdx = parse_long(line, &endptr);
 					if (endptr == 0 || (*endptr != ' ' && *endptr != '\t' && *endptr != '/' && *endptr != 0))
 						return false;
 					line = endptr;
@@ -206,22 +296,24 @@ static bool obj_parseline(const char *line, ObjData &data)
 				if (*line == '/') {
 					// Parse normal index.
 					++ line;
-					vertex.normalIdx = strtol(line, &endptr, 10);
+					vertex.normalIdx = parse_long(line, &endptr);
 					if (endptr == 0 || (*endptr != ' ' && *endptr != '\t' && *endptr != 0))
 						return false;
 					line = endptr;
 				}
 			}
+			if (vertex.coordIdx < 0 || vertex.normalIdx < 0 || vertex.textureCoordIdx < 0)
+				offsets.relative = true;
 			if (vertex.coordIdx < 0)
-                vertex.coordIdx += (int)data.coordinates.size() / 4;
+                vertex.coordIdx += offsets.coordinates + (int)data.coordinates.size() / 4;
             else
 				-- vertex.coordIdx;
 			if (vertex.normalIdx < 0)
-                vertex.normalIdx += (int)data.normals.size() / 3;
+                vertex.normalIdx += offsets.normals + (int)data.normals.size() / 3;
             else
 				-- vertex.normalIdx;
 			if (vertex.textureCoordIdx < 0)
-                vertex.textureCoordIdx += (int)data.textureCoordinates.size() / 3;
+                vertex.textureCoordIdx += offsets.textureCoordinates + (int)data.textureCoordinates.size() / 3;
             else
 				-- vertex.textureCoordIdx;
 			data.vertices.push_back(vertex);
@@ -298,7 +390,7 @@ static bool obj_parseline(const char *line, ObjData &data)
 			return false;
 		EATWS();
 		char *endptr = 0;
-		long g = strtol(line, &endptr, 10);
+		long g = parse_long(line, &endptr);
 		if (endptr == 0 || (*endptr != ' ' && *endptr != '\t' && *endptr != 0))
 			return false;
 		line = endptr;
@@ -319,69 +411,151 @@ static bool obj_parseline(const char *line, ObjData &data)
 	return true;
 }
 
+// Parses the lines of a block of an OBJ file. The line ends are replaced with zeros in place,
+// so that the block may be parsed again if the offsets were not known for the first time.
+static void obj_parselines(char *begin, char *end, ObjData &data, ObjIndexOffsets &offsets)
+{
+	for (char *line = begin; line < end;) {
+		char *eol = line;
+		while (eol < end && *eol != '\r' && *eol != '\n' && *eol != 0)
+			++ eol;
+		// A block ends with a line end or with the zero terminating the buffer.
+		*eol = 0;
+		obj_parseline(line, data, offsets);
+		line = eol + 1;
+	}
+}
+
+// Minimum size of a block of an OBJ file parsed by a single thread.
+static const size_t OBJ_BLOCK_SIZE = 1024 * 1024;
+
+// Parses the content of an OBJ file terminated with zero. Blocks of lines are parsed concurrently
+// into their own ObjData, which are then concatenated.
+static bool objparse_buffer(std::vector<char> &buffer, ObjData &data)
+{
+	assert(! buffer.empty() && buffer.back() == 0);
+	char *begin = buffer.data();
+	char *end   = buffer.data() + buffer.size() - 1;
+
+	// Split the buffer into blocks of whole lines.
+	std::vector<char*> blocks { begin };
+	while (end - blocks.back() > ptrdiff_t(OBJ_BLOCK_SIZE)) {
+		char *eol = blocks.back() + OBJ_BLOCK_SIZE;
+		while (eol < end && *eol != '\n')
+			++ eol;
+		if (eol == end)
+			break;
+		blocks.emplace_back(eol + 1);
+	}
+	blocks.emplace_back(end);
+
+	size_t num_blocks = blocks.size() - 1;
+	std::vector<ObjData>		 blocks_data(num_blocks);
+	std::vector<ObjIndexOffsets> blocks_offsets(num_blocks);
+	try {
+		tbb::parallel_for(size_t(0), num_blocks, [&blocks, &blocks_data, &blocks_offsets](size_t i) {
+			obj_parselines(blocks[i], blocks[i + 1], blocks_data[i], blocks_offsets[i]);
+		});
+
+		// Blocks referencing vertices relatively have to be parsed again, now with the offsets known.
+		std::vector<size_t> reparse;
+		for (size_t i = 1; i < num_blocks; ++ i) {
+			ObjIndexOffsets &offsets = blocks_offsets[i];
+			const ObjIndexOffsets &prev_offsets = blocks_offsets[i - 1];
+			const ObjData &prev = blocks_data[i - 1];
+			offsets.coordinates			= prev_offsets.coordinates + (int)prev.coordinates.size() / 4;
+			offsets.normals				= prev_offsets.normals + (int)prev.normals.size() / 3;
+			offsets.textureCoordinates	= prev_offsets.textureCoordinates + (int)prev.textureCoordinates.size() / 3;
+			if (offsets.relative)
+				reparse.emplace_back(i);
+		}
+		tbb::parallel_for(size_t(0), reparse.size(), [&blocks, &blocks_data, &blocks_offsets, &reparse](size_t j) {
+			size_t i = reparse[j];
+			blocks_data[i] = ObjData();
+			obj_parselines(blocks[i], blocks[i + 1], blocks_data[i], blocks_offsets[i]);
+		});
+
+		if (num_blocks == 1) {
+			data = std::move(blocks_data.front());
+			return true;
+		}
+
+		auto append = [](auto &dst, const auto &src) { dst.insert(dst.end(), src.begin(), src.end()); };
+		for (const ObjData &block : blocks_data) {
+			int vertex_offset = (int)data.vertices.size();
+			append(data.coordinates,		block.coordinates);
+			append(data.textureCoordinates,	block.textureCoordinates);
+			append(data.normals,			block.normals);
+			append(data.parameters,			block.parameters);
+			append(data.mtllibs,			block.mtllibs);
+			append(data.vertices,			block.vertices);
+			for (ObjUseMtl usemtl : block.usemtls) {
+				usemtl.vertexIdxFirst += vertex_offset;
+				data.usemtls.emplace_back(std::move(usemtl));
+			}
+			for (ObjObject object : block.objects) {
+				object.vertexIdxFirst += vertex_offset;
+				data.objects.emplace_back(std::move(object));
+			}
+			for (ObjGroup group : block.groups) {
+				group.vertexIdxFirst += vertex_offset;
+				data.groups.emplace_back(std::move(group));
+			}
+			for (ObjSmoothingGroup group : block.smoothingGroups) {
+				group.vertexIdxFirst += vertex_offset;
+				data.smoothingGroups.emplace_back(group);
+			}
+		}
+	}
+	catch (std::bad_alloc&) {
+		printf("Out of memory\r\n");
+	}
+
+	return true;
+}
+
 bool objparse(const char *path, ObjData &data)
 {
-	FILE *pFile = boost::nowide::fopen(path, "rt");
+	FILE *pFile = boost::nowide::fopen(path, "rb");
 	if (pFile == 0)
 		return false;
 
+	std::vector<char> buffer;
 	try {
-		char buf[65536 * 2];
-		size_t len = 0;
-		size_t lenPrev = 0;
-		while ((len = ::fread(buf + lenPrev, 1, 65536, pFile)) != 0) {
-			len += lenPrev;
-			size_t lastLine = 0;
-			for (size_t i = 0; i < len; ++ i)
-				if (buf[i] == '\r' || buf[i] == '\n') {
-					buf[i] = 0;
-					char *c = buf + lastLine;
-					while (*c == ' ' || *c == '\t')
-						++ c;
-					obj_parseline(c, data);
-					lastLine = i + 1;
-				}
-			lenPrev = len - lastLine;
-			memmove(buf, buf + lastLine, lenPrev);
-		}
-    }
-    catch (std::bad_alloc&) {
-        printf("Out of memory\r\n");
+		boost::system::error_code ec;
+		uintmax_t size = boost::filesystem::file_size(path, ec);
+		if (! ec)
+			buffer.reserve(size_t(size) + 1);
+		char buf[65536];
+		while (size_t len = ::fread(buf, 1, sizeof(buf), pFile))
+			buffer.insert(buffer.end(), buf, buf + len);
+		buffer.emplace_back(0);
+	}
+	catch (std::bad_alloc&) {
+		printf("Out of memory\r\n");
+		::fclose(pFile);
+		return false;
 	}
 	::fclose(pFile);
 
-	// printf("vertices: %d\r\n", data.vertices.size() / 4);
-	// printf("coords: %d\r\n", data.coordinates.size());
-	return true;
+	return objparse_buffer(buffer, data);
 }
 
 bool objparse(std::istream &stream, ObjData &data)
 {
-    try {
-        char buf[65536 * 2];
-        size_t len = 0;
-        size_t lenPrev = 0;
-        while ((len = size_t(stream.read(buf + lenPrev, 65536).gcount())) != 0) {
-            len += lenPrev;
-            size_t lastLine = 0;
-            for (size_t i = 0; i < len; ++ i)
-                if (buf[i] == '\r' || buf[i] == '\n') {
-                    buf[i] = 0;
-                    char *c = buf + lastLine;
-                    while (*c == ' ' || *c == '\t')
-                        ++ c;
-                    obj_parseline(c, data);
-                    lastLine = i + 1;
-                }
-            lenPrev = len - lastLine;
-            memmove(buf, buf + lastLine, lenPrev);
-        }
-    }
-    catch (std::bad_alloc&) {
-        printf("Out of memory\r\n");
-    }
-    
-    return true;
+	std::vector<char> buffer;
+	try {
+		char buf[65536];
+		while (size_t len = size_t(stream.read(buf, sizeof(buf)).gcount()))
+			buffer.insert(buffer.end(), buf, buf + len);
+		buffer.emplace_back(0);
+	}
+	catch (std::bad_alloc&) {
+		printf("Out of memory\r\n");
+		return false;
+	}
+
+	return objparse_buffer(buffer, data);
 }
 
 template<typename T> 
@@ -448,7 +622,7 @@ bool loadvector(FILE *pFile, std::vector<std::string> &v)
 		size_t len = 0;
 		if (::fread(&len, sizeof(len), 1, pFile) != 1)
 			return false;
-		std::string s(" ", len);
+		std::string s(len, ' ');
 		if (::fread(s.data(), 1, len, pFile) != len)
 			return false;
 		v.push_back(std::move(s));
@@ -470,21 +644,23 @@ bool loadvectornameidx(FILE *pFile, std::vector<T> &v)
 		size_t len = 0;
 		if (::fread(&len, sizeof(len), 1, pFile) != 1)
 			return false;
-		v[i].name.assign(" ", len);
+		v[i].name.assign(len, ' ');
 		if (::fread(v[i].name.data(), 1, len, pFile) != len)
 			return false;
 	}
 	return true;
 }
 
-bool objbinsave(const char *path, const ObjData &data)
+bool objbinsave(const char *path, const ObjData &data, const ObjFileStamp &stamp)
 {
 	FILE *pFile = boost::nowide::fopen(path, "wb");
 	if (pFile == 0)
 		return false;
 
-	size_t version = 1;
+	size_t version = 2;
 	::fwrite(&version, 1, sizeof(version), pFile);
+	::fwrite(&stamp.size, 1, sizeof(stamp.size), pFile);
+	::fwrite(&stamp.mtime, 1, sizeof(stamp.mtime), pFile);
 
 	bool result =
 		savevector(pFile, data.coordinates)			&&
@@ -498,38 +674,84 @@ bool objbinsave(const char *path, const ObjData &data)
 		savevector(pFile, data.smoothingGroups)		&&
 		savevector(pFile, data.vertices);
 
+	result = ! ::ferror(pFile) && result;
 	::fclose(pFile);
 	return result;
 }
 
-bool objbinload(const char *path, ObjData &data)
+bool objbinload(const char *path, ObjData &data, ObjFileStamp *stamp)
 {
 	FILE *pFile = boost::nowide::fopen(path, "rb");
 	if (pFile == 0)
 		return false;
 
-	data.version = 0;
-	if (::fread(&data.version, sizeof(data.version), 1, pFile) != 1)
-		return false;
-	if (data.version != 1)
+	size_t version = 0;
+	ObjFileStamp file_stamp;
+	if (::fread(&version, sizeof(version), 1, pFile) != 1 || version != 2 ||
+		::fread(&file_stamp.size, sizeof(file_stamp.size), 1, pFile) != 1 ||
+		::fread(&file_stamp.mtime, sizeof(file_stamp.mtime), 1, pFile) != 1) {
+		::fclose(pFile);
 		return false;
+	}
+	data.version = int(version);
+	if (stamp != nullptr)
+		*stamp = file_stamp;
 
-	bool result =
-		loadvector(pFile, data.coordinates)			&&
-		loadvector(pFile, data.textureCoordinates)	&&
-		loadvector(pFile, data.normals)				&&
-		loadvector(pFile, data.parameters)			&&
-		loadvector(pFile, data.mtllibs)				&&
-		loadvectornameidx(pFile, data.usemtls)		&&
-		loadvectornameidx(pFile, data.objects)		&&
-		loadvectornameidx(pFile, data.groups)		&&
-		loadvector(pFile, data.smoothingGroups)		&&
-		loadvector(pFile, data.vertices);
+	bool result = false;
+	try {
+		result =
+			loadvector(pFile, data.coordinates)			&&
+			loadvector(pFile, data.textureCoordinates)	&&
+			loadvector(pFile, data.normals)				&&
+			loadvector(pFile, data.parameters)			&&
+			loadvector(pFile, data.mtllibs)				&&
+			loadvectornameidx(pFile, data.usemtls)		&&
+			loadvectornameidx(pFile, data.objects)		&&
+			loadvectornameidx(pFile, data.groups)		&&
+			loadvector(pFile, data.smoothingGroups)		&&
+			loadvector(pFile, data.vertices);
+	} catch (const std::exception &) {
+		// Damaged file with invalid vector sizes.
+		result = false;
+	}
 
 	::fclose(pFile);
 	return result;
 }
 
+bool objparse_cached(const char *path, ObjData &data)
+{
+	ObjFileStamp stamp;
+	try {
+		stamp.size  = uint64_t(boost::filesystem::file_size(path));
+		stamp.mtime = int64_t(boost::filesystem::last_write_time(path));
+	} catch (const std::exception &) {
+		return objparse(path, data);
+	}
+
+	std::string  cache_path = std::string(path) + ".bin";
+	ObjFileStamp cache_stamp;
+	if (objbinload(cache_path.c_str(), data, &cache_stamp) && cache_stamp == stamp)
+		return true;
+
+	data = ObjData();
+	if (! objparse(path, data))
+		return false;
+
+	// Write to a temporary file first, so that a partially written cache is never loaded.
+	// Failing to write the cache (for example into a read only directory) is not an error.
+	std::string tmp_path = cache_path + ".tmp";
+	if (objbinsave(tmp_path.c_str(), data, stamp)) {
+		boost::system::error_code ec;
+		boost::filesystem::rename(tmp_path, cache_path, ec);
+		if (! ec)
+			return true;
+	}
+	boost::system::error_code ec;
+	boost::filesystem::remove(tmp_path, ec);
+	return true;
+}
+
 template<typename T>
 bool vectorequal(const std::vector<T> &v1, const std::vector<T> &v2)
 {
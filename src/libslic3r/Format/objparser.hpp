@@ -1,6 +1,7 @@
 #ifndef slic3r_Format_objparser_hpp_
 #define slic3r_Format_objparser_hpp_
 
+#include <cstdint>
 #include <string>
 #include <vector>
 #include <istream>
@@ -97,12 +98,27 @@ struct ObjData {
 	std::vector<ObjVertex>			vertices;
 };
 
+// Size and modification time of an OBJ file, identifying the OBJ file a binary file was saved from.
+struct ObjFileStamp {
+	uint64_t	size  = 0;
+	int64_t		mtime = 0;
+};
+
+inline bool operator==(const ObjFileStamp &s1, const ObjFileStamp &s2)
+{
+	return s1.size == s2.size && s1.mtime == s2.mtime;
+}
+
 extern bool objparse(const char *path, ObjData &data);
 extern bool objparse(std::istream &stream, ObjData &data);
 
-extern bool objbinsave(const char *path, const ObjData &data);
+// Parses an OBJ file, caching the parsed data in a binary file <path>.bin next to the OBJ file.
+// The binary file is reused as long as the size and modification time of the OBJ file match.
+extern bool objparse_cached(const char *path, ObjData &data);
+
+extern bool objbinsave(const char *path, const ObjData &data, const ObjFileStamp &stamp = ObjFileStamp());
 
-extern bool objbinload(const char *path, ObjData &data);
+extern bool objbinload(const char *path, ObjData &data, ObjFileStamp *stamp = nullptr);
 
 extern bool objequal(const ObjData &data1, const ObjData &data2);
 
@@ -1027,6 +1027,9 @@ namespace DoExport {
 	    if (silent_time_estimator_enabled)
 	        print_statistics.estimated_silent_custom_gcode_print_times = silent_time_estimator.get_custom_gcode_times_dhm(true);
 	    print_statistics.total_toolchanges = std::max(0, wipe_tower_data.number_of_toolchanges);
+	    print_statistics.tool_ordering_time         = wipe_tower_data.tool_ordering_time;
+	    print_statistics.wipe_tower_planning_time   = wipe_tower_data.planning_time;
+	    print_statistics.wipe_tower_generation_time = wipe_tower_data.generation_time;
 	    if (! extruders.empty()) {
 	        std::pair<std::string, unsigned int> out_filament_used_mm ("; filament used [mm] = ", 0);
 	        std::pair<std::string, unsigned int> out_filament_used_cm3("; filament used [cm3] = ", 0);
@@ -1345,23 +1348,67 @@ void GCode::_do_export(Print& print, FILE* file, ThumbnailsGeneratorCallback thu
 
     // Do all objects for each layer.
     if (print.config().complete_objects.value) {
-        size_t finished_objects = 0;
-        const PrintObject *prev_object = (*print_object_instance_sequential_active)->print_object;
-        for (; print_object_instance_sequential_active != print_object_instances_ordering.end(); ++ print_object_instance_sequential_active) {
-            const PrintObject &object = *(*print_object_instance_sequential_active)->print_object;
-            if (&object != prev_object || tool_ordering.first_extruder() != final_extruder_id) {
-                tool_ordering = ToolOrdering(object, final_extruder_id);
-                unsigned int new_extruder_id = tool_ordering.first_extruder();
-                if (new_extruder_id == (unsigned int)-1)
-                    // Skip this object.
-                    continue;
-                initial_extruder_id = new_extruder_id;
-                final_extruder_id   = tool_ordering.last_extruder();
-                assert(final_extruder_id != (unsigned int)-1);
+        // Collect the object instances to be printed together with their tool ordering. The tool ordering of an object
+        // only depends on the last extruder of the object printed before, thus it is calculated upfront.
+        struct ObjectToPrint {
+            const PrintInstance        *instance;
+            ToolOrdering                tool_ordering;
+            unsigned int                initial_extruder_id;
+            unsigned int                final_extruder_id;
+            // Pair the object layers with the support layers by z.
+            std::vector<LayerToPrint>   layers;
+        };
+        std::vector<ObjectToPrint> objects_to_print;
+        {
+            const PrintObject *prev_object = (*print_object_instance_sequential_active)->print_object;
+            for (; print_object_instance_sequential_active != print_object_instances_ordering.end(); ++ print_object_instance_sequential_active) {
+                const PrintObject &object = *(*print_object_instance_sequential_active)->print_object;
+                if (&object != prev_object || tool_ordering.first_extruder() != final_extruder_id) {
+                    tool_ordering = ToolOrdering(object, final_extruder_id);
+                    unsigned int new_extruder_id = tool_ordering.first_extruder();
+                    if (new_extruder_id == (unsigned int)-1)
+                        // Skip this object.
+                        continue;
+                    initial_extruder_id = new_extruder_id;
+                    final_extruder_id   = tool_ordering.last_extruder();
+                    assert(final_extruder_id != (unsigned int)-1);
+                }
+                objects_to_print.push_back({ *print_object_instance_sequential_active, tool_ordering, initial_extruder_id, final_extruder_id, collect_layers_to_print(object) });
+                prev_object = &object;
             }
+        }
+        print.throw_if_canceled();
+
+        // The objects printed after the first one are exported on worker threads, each one by a copy of this G-code generator.
+        // As the state of the G-code generator at the start of an object depends on the end of the previous object, the workers
+        // start from an estimate of that state. The first layer of each object is then exported once more by this G-code generator.
+        // If its state after the first layer matches the state of the worker, the G-code of the other layers exported by the worker
+        // is used, otherwise the layers are exported again one after another. Either way the G-code is the same.
+        struct ObjectGCode {
+            std::unique_ptr<GCode>      gcodegen;
+            // Copy of gcodegen after the first layer of the object.
+            std::unique_ptr<GCode>      gcodegen_first_layer;
+            // G-code of the layers above the first layer.
+            std::string                 gcode;
+        };
+        std::vector<ObjectGCode> objects_gcode(objects_to_print.size());
+        // The spiral vase, the pressure equalizer and the motion planner of avoid crossing perimeters cannot be shared by the workers.
+        bool export_in_parallel = m_sequential_print_in_parallel && objects_to_print.size() > 1 && ! m_spiral_vase && ! print.config().avoid_crossing_perimeters.value;
+#ifdef HAS_PRESSURE_EQUALIZER
+        export_in_parallel &= ! m_pressure_equalizer;
+#endif /* HAS_PRESSURE_EQUALIZER */
+        m_num_objects_exported_in_parallel = 0;
+
+        for (size_t object_idx = 0; object_idx < objects_to_print.size(); ++ object_idx) {
+            const ObjectToPrint &object_to_print = objects_to_print[object_idx];
+            const PrintObject   &object          = *object_to_print.instance->print_object;
+            const size_t         instance_idx    = object_to_print.instance - object.instances().data();
+            auto                 export_layer    = [this, &print, &object_to_print, instance_idx](const LayerToPrint &layer_to_print) {
+                return this->process_layer(print, { layer_to_print }, object_to_print.tool_ordering.tools_for_layer(layer_to_print.print_z()), nullptr, instance_idx);
+            };
             print.throw_if_canceled();
-            this->set_origin(unscale((*print_object_instance_sequential_active)->shift));
-            if (finished_objects > 0) {
+            this->set_origin(unscale(object_to_print.instance->shift));
+            if (object_idx > 0) {
                 // Move to the origin position for the copy we're going to print.
                 // This happens before Z goes down to layer 0 again, so that no collision happens hopefully.
                 m_enable_cooling_markers = false; // we're not filtering these moves through CoolingBuffer
@@ -1374,34 +1421,97 @@ void GCode::_do_export(Print& print, FILE* file, ThumbnailsGeneratorCallback thu
                 // Ff we are printing the bottom layer of an object, and we have already finished
                 // another one, set first layer temperatures. This happens before the Z move
                 // is triggered, so machine has more time to reach such temperatures.
-                m_placeholder_parser.set("current_object_idx", int(finished_objects));
-                std::string between_objects_gcode = this->placeholder_parser_process("between_objects_gcode", print.config().between_objects_gcode.value, initial_extruder_id);
+                m_placeholder_parser.set("current_object_idx", int(object_idx));
+                std::string between_objects_gcode = this->placeholder_parser_process("between_objects_gcode", print.config().between_objects_gcode.value, object_to_print.initial_extruder_id);
                 // Set first layer bed and extruder temperatures, don't wait for it to reach the temperature.
-                this->_print_first_layer_bed_temperature(file, print, between_objects_gcode, initial_extruder_id, false);
-                this->_print_first_layer_extruder_temperatures(file, print, between_objects_gcode, initial_extruder_id, false);
+                this->_print_first_layer_bed_temperature(file, print, between_objects_gcode, object_to_print.initial_extruder_id, false);
+                this->_print_first_layer_extruder_temperatures(file, print, between_objects_gcode, object_to_print.initial_extruder_id, false);
                 _writeln(file, between_objects_gcode);
             }
             // Reset the cooling buffer internal state (the current position, feed rate, accelerations).
             m_cooling_buffer->reset();
-            m_cooling_buffer->set_current_extruder(initial_extruder_id);
-            // Pair the object layers with the support layers by z, extrude them.
-            std::vector<LayerToPrint> layers_to_print = collect_layers_to_print(object);
-            for (const LayerToPrint &ltp : layers_to_print) {
-                std::vector<LayerToPrint> lrs;
-                lrs.emplace_back(std::move(ltp));
-                this->process_layer(file, print, lrs, tool_ordering.tools_for_layer(ltp.print_z()), nullptr, *print_object_instance_sequential_active - object.instances().data());
+            m_cooling_buffer->set_current_extruder(object_to_print.initial_extruder_id);
+            size_t num_layers_exported = 0;
+            if (ObjectGCode &object_gcode = objects_gcode[object_idx]; object_gcode.gcodegen_first_layer) {
+                _write(file, export_layer(object_to_print.layers.front()));
+                num_layers_exported = 1;
+                if (this->sequential_print_state_equal(*object_gcode.gcodegen_first_layer)) {
+                    _write(file, object_gcode.gcode);
+                    this->take_over_sequential_print_state(*object_gcode.gcodegen, *object_gcode.gcodegen_first_layer);
+                    num_layers_exported = object_to_print.layers.size();
+                    ++ m_num_objects_exported_in_parallel;
+                }
+                object_gcode = ObjectGCode();
+            }
+            for (size_t layer_idx = num_layers_exported; layer_idx < object_to_print.layers.size(); ++ layer_idx) {
+                _write(file, export_layer(object_to_print.layers[layer_idx]));
                 print.throw_if_canceled();
             }
 #ifdef HAS_PRESSURE_EQUALIZER
             if (m_pressure_equalizer)
                 _write(file, m_pressure_equalizer->process("", true));
 #endif /* HAS_PRESSURE_EQUALIZER */
-            ++ finished_objects;
             // Flag indicating whether the nozzle temperature changes from 1st to 2nd layer were performed.
             // Reset it when starting another object from 1st layer.
             m_second_layer_things_done = false;
-            prev_object = &object;
+
+            if (object_idx == 0 && export_in_parallel) {
+                // Number of layers the progress indicator is incremented by when printing an object, see change_layer().
+                std::vector<int> object_layer_index_offsets(objects_to_print.size(), 0);
+                for (size_t i = 1; i + 1 < objects_to_print.size(); ++ i) {
+                    object_layer_index_offsets[i + 1] = object_layer_index_offsets[i];
+                    if (m_layer_count > 0)
+                        for (const LayerToPrint &layer_to_print : objects_to_print[i].layers)
+                            if (! objects_to_print[i].tool_ordering.tools_for_layer(layer_to_print.print_z()).extruders.empty())
+                                ++ object_layer_index_offsets[i + 1];
+                }
+                // Constructing a G-code generator is not thread safe, see PlaceholderParser::update_timestamp().
+                for (size_t i = 1; i < objects_to_print.size(); ++ i)
+                    if (objects_to_print[i].layers.size() > 1) {
+                        objects_gcode[i].gcodegen             = Slic3r::make_unique<GCode>();
+                        objects_gcode[i].gcodegen_first_layer = Slic3r::make_unique<GCode>();
+                    }
+                tbb::parallel_for(tbb::blocked_range<size_t>(1, objects_to_print.size(), 1),
+                    [this, &print, &objects_to_print, &objects_gcode, &object_layer_index_offsets](const tbb::blocked_range<size_t> &range) {
+                    for (size_t i = range.begin(); i < range.end(); ++ i) {
+                        ObjectGCode &object_gcode = objects_gcode[i];
+                        if (! object_gcode.gcodegen)
+                            continue;
+                        const ObjectToPrint &object_to_print = objects_to_print[i];
+                        const ObjectToPrint &prev_object     = objects_to_print[i - 1];
+                        const size_t         instance_idx    = object_to_print.instance - object_to_print.instance->print_object->instances().data();
+                        GCode               &gcodegen        = *object_gcode.gcodegen;
+                        auto                 export_layer    = [&gcodegen, &print, &object_to_print, instance_idx](const LayerToPrint &layer_to_print) {
+                            return gcodegen.process_layer(print, { layer_to_print }, object_to_print.tool_ordering.tools_for_layer(layer_to_print.print_z()), nullptr, instance_idx);
+                        };
+                        // Estimate the state at the end of the previous object, then travel to the origin of this object as above.
+                        this->copy_sequential_print_state(gcodegen);
+                        gcodegen.m_layer_index += object_layer_index_offsets[i];
+                        gcodegen.m_writer.set_extruder(prev_object.final_extruder_id);
+                        gcodegen.m_writer.travel_to_z(prev_object.layers.back().print_z() + m_config.z_offset.value);
+                        gcodegen.set_origin(unscale(object_to_print.instance->shift));
+                        gcodegen.retract();
+                        gcodegen.m_writer.travel_to_xy(gcodegen.point_to_gcode(Point(0, 0)));
+                        gcodegen.set_last_pos(Point(0, 0));
+                        gcodegen.m_avoid_crossing_perimeters.use_external_mp_once = false;
+                        gcodegen.m_avoid_crossing_perimeters.disable_once = true;
+                        gcodegen.m_placeholder_parser.set("current_object_idx", int(i));
+                        gcodegen.m_writer.set_bed_temperature(print.config().first_layer_bed_temperature.get_at(object_to_print.initial_extruder_id), false);
+                        gcodegen.m_cooling_buffer->reset();
+                        gcodegen.m_cooling_buffer->set_current_extruder(object_to_print.initial_extruder_id);
+                        // The G-code of the first layer is thrown away, it will be exported by the main G-code generator.
+                        export_layer(object_to_print.layers.front());
+                        gcodegen.copy_sequential_print_state(*object_gcode.gcodegen_first_layer);
+                        for (size_t layer_idx = 1; layer_idx < object_to_print.layers.size(); ++ layer_idx) {
+                            object_gcode.gcode += export_layer(object_to_print.layers[layer_idx]);
+                            print.throw_if_canceled();
+                        }
+                    }
+                });
+            }
         }
+        if (export_in_parallel)
+            BOOST_LOG_TRIVIAL(debug) << "Sequential print: " << m_num_objects_exported_in_parallel << " of " << objects_to_print.size() - 1 << " objects exported in parallel";
     } else {
         // Sort layers by Z.
         // All extrusion moves with the same top layer height are extruded uninterrupted.
@@ -1441,7 +1551,7 @@ void GCode::_do_export(Print& print, FILE* file, ThumbnailsGeneratorCallback thu
             const LayerTools &layer_tools = tool_ordering.tools_for_layer(layer.first);
             if (m_wipe_tower && layer_tools.has_wipe_tower)
                 m_wipe_tower->next_layer();
-            this->process_layer(file, print, layer.second, layer_tools, &print_object_instances_ordering, size_t(-1));
+            _write(file, this->process_layer(print, layer.second, layer_tools, &print_object_instances_ordering, size_t(-1)));
             print.throw_if_canceled();
         }
 #ifdef HAS_PRESSURE_EQUALIZER
@@ -1895,9 +2005,7 @@ namespace Skirt {
 // In non-sequential mode, process_layer is called per each print_z height with all object and support layers accumulated.
 // For multi-material prints, this routine minimizes extruder switches by gathering extruder specific extrusion paths
 // and performing the extruder specific extrusions together.
-void GCode::process_layer(
-    // Write into the output file.
-    FILE                            		*file,
+std::string GCode::process_layer(
     const Print                    			&print,
     // Set of object & print layers of the same PrintObject and with the same print_z.
     const std::vector<LayerToPrint> 		&layers,
@@ -1913,9 +2021,10 @@ void GCode::process_layer(
     // Either printing all copies of all objects, or just a single copy of a single object.
     assert(single_object_instance_idx == size_t(-1) || layers.size() == 1);
 
+    std::string gcode;
     if (layer_tools.extruders.empty())
         // Nothing to extrude.
-        return;
+        return gcode;
 
     // Extract 1st object_layer and support_layer of this set of layers with an equal print_z.
     const Layer         *object_layer  = nullptr;
@@ -1951,8 +2060,6 @@ void GCode::process_layer(
     }
     // If we're going to apply spiralvase to this layer, disable loop clipping
     m_enable_loop_clipping = ! m_spiral_vase || ! m_spiral_vase->enable;
-    
-    std::string gcode;
 
     // Set new layer - this will change Z and force a retraction if retract_layer_change is enabled.
     if (! print.config().before_layer_gcode.value.empty()) {
@@ -2285,13 +2392,112 @@ void GCode::process_layer(
     // printf("G-code after filter:\n%s\n", out.c_str());
 #endif /* HAS_PRESSURE_EQUALIZER */
     
-    _write(file, gcode);
     BOOST_LOG_TRIVIAL(trace) << "Exported layer " << layer.id() << " print_z " << print_z << 
         ", time estimator memory: " <<
             format_memsize_MB(m_normal_time_estimator.memory_used() + (m_silent_time_estimator_enabled ? m_silent_time_estimator.memory_used() : 0)) <<
         ", analyzer memory: " <<
             format_memsize_MB(m_analyzer.memory_used()) <<
         log_memory_info();
+    return gcode;
+}
+
+void GCode::copy_sequential_print_state(GCode &dst) const
+{
+    dst.m_origin                        = m_origin;
+    dst.m_config                        = m_config;
+    dst.m_writer                        = m_writer;
+    dst.m_placeholder_parser            = m_placeholder_parser;
+    dst.m_ooze_prevention               = m_ooze_prevention;
+    dst.m_wipe                          = m_wipe;
+    dst.m_avoid_crossing_perimeters.use_external_mp      = m_avoid_crossing_perimeters.use_external_mp;
+    dst.m_avoid_crossing_perimeters.use_external_mp_once = m_avoid_crossing_perimeters.use_external_mp_once;
+    dst.m_avoid_crossing_perimeters.disable_once         = m_avoid_crossing_perimeters.disable_once;
+    dst.m_enable_loop_clipping          = m_enable_loop_clipping;
+    dst.m_enable_cooling_markers        = m_enable_cooling_markers;
+    dst.m_enable_extrusion_role_markers = m_enable_extrusion_role_markers;
+    dst.m_enable_analyzer               = m_enable_analyzer;
+    dst.m_last_analyzer_extrusion_role  = m_last_analyzer_extrusion_role;
+    dst.m_layer_count                   = m_layer_count;
+    dst.m_layer_index                   = m_layer_index;
+    dst.m_layer                         = m_layer;
+    dst.m_seam_position                 = m_seam_position;
+    dst.m_volumetric_speed              = m_volumetric_speed;
+    dst.m_last_extrusion_role           = m_last_extrusion_role;
+    dst.m_last_mm3_per_mm               = m_last_mm3_per_mm;
+    dst.m_last_width                    = m_last_width;
+    dst.m_last_height                   = m_last_height;
+    dst.m_last_pos                      = m_last_pos;
+    dst.m_last_pos_defined              = m_last_pos_defined;
+    dst.m_cooling_buffer                = Slic3r::make_unique<CoolingBuffer>(dst, *m_cooling_buffer);
+    dst.m_skirt_done                    = m_skirt_done;
+    dst.m_brim_done                     = m_brim_done;
+    dst.m_second_layer_things_done      = m_second_layer_things_done;
+    dst.m_last_obj_copy                 = m_last_obj_copy;
+}
+
+bool GCode::sequential_print_state_equal(const GCode &rhs) const
+{
+    // Only the seam position of the object being printed is looked up.
+    auto seam_position = [](const GCode &gcodegen) {
+        auto it = (gcodegen.m_layer == nullptr) ? gcodegen.m_seam_position.end() : gcodegen.m_seam_position.find(gcodegen.m_layer->object());
+        return (it == gcodegen.m_seam_position.end()) ? std::make_pair(false, Point(0, 0)) : std::make_pair(true, it->second);
+    };
+    return m_origin                         == rhs.m_origin &&
+           m_layer                          == rhs.m_layer &&
+           m_layer_index                    == rhs.m_layer_index &&
+           m_writer.state_equal(rhs.m_writer) &&
+           m_cooling_buffer->state_equal(*rhs.m_cooling_buffer) &&
+           m_wipe.enable                    == rhs.m_wipe.enable &&
+           m_wipe.path.points               == rhs.m_wipe.path.points &&
+           m_avoid_crossing_perimeters.use_external_mp      == rhs.m_avoid_crossing_perimeters.use_external_mp &&
+           m_avoid_crossing_perimeters.use_external_mp_once == rhs.m_avoid_crossing_perimeters.use_external_mp_once &&
+           m_avoid_crossing_perimeters.disable_once         == rhs.m_avoid_crossing_perimeters.disable_once &&
+           m_enable_loop_clipping           == rhs.m_enable_loop_clipping &&
+           m_enable_cooling_markers         == rhs.m_enable_cooling_markers &&
+           m_last_analyzer_extrusion_role   == rhs.m_last_analyzer_extrusion_role &&
+           m_last_extrusion_role            == rhs.m_last_extrusion_role &&
+           m_last_mm3_per_mm                == rhs.m_last_mm3_per_mm &&
+           m_last_width                     == rhs.m_last_width &&
+           m_last_height                    == rhs.m_last_height &&
+           m_last_pos_defined               == rhs.m_last_pos_defined &&
+           m_last_pos                       == rhs.m_last_pos &&
+           m_skirt_done                     == rhs.m_skirt_done &&
+           m_brim_done                      == rhs.m_brim_done &&
+           m_second_layer_things_done       == rhs.m_second_layer_things_done &&
+           m_last_obj_copy                  == rhs.m_last_obj_copy &&
+           seam_position(*this)             == seam_position(rhs) &&
+           m_placeholder_parser.config()    == rhs.m_placeholder_parser.config() &&
+           m_config.equals(rhs.m_config);
+}
+
+void GCode::take_over_sequential_print_state(const GCode &worker, const GCode &worker_start)
+{
+    m_writer.take_over_state(worker.m_writer, worker_start.m_writer);
+    m_config                            = worker.m_config;
+    m_placeholder_parser                = worker.m_placeholder_parser;
+    m_placeholder_parser_failed_templates.insert(worker.m_placeholder_parser_failed_templates.begin(), worker.m_placeholder_parser_failed_templates.end());
+    m_wipe                              = worker.m_wipe;
+    m_avoid_crossing_perimeters.use_external_mp      = worker.m_avoid_crossing_perimeters.use_external_mp;
+    m_avoid_crossing_perimeters.use_external_mp_once = worker.m_avoid_crossing_perimeters.use_external_mp_once;
+    m_avoid_crossing_perimeters.disable_once         = worker.m_avoid_crossing_perimeters.disable_once;
+    m_enable_loop_clipping              = worker.m_enable_loop_clipping;
+    m_last_analyzer_extrusion_role      = worker.m_last_analyzer_extrusion_role;
+    m_layer_index                       = worker.m_layer_index;
+    m_layer                             = worker.m_layer;
+    if (m_layer != nullptr)
+        if (auto it = worker.m_seam_position.find(m_layer->object()); it != worker.m_seam_position.end())
+            m_seam_position[m_layer->object()] = it->second;
+    m_last_extrusion_role               = worker.m_last_extrusion_role;
+    m_last_mm3_per_mm                   = worker.m_last_mm3_per_mm;
+    m_last_width                        = worker.m_last_width;
+    m_last_height                       = worker.m_last_height;
+    m_last_pos                          = worker.m_last_pos;
+    m_last_pos_defined                  = worker.m_last_pos_defined;
+    m_cooling_buffer                    = Slic3r::make_unique<CoolingBuffer>(*this, *worker.m_cooling_buffer);
+    m_skirt_done                        = worker.m_skirt_done;
+    m_brim_done                         = worker.m_brim_done;
+    m_second_layer_things_done          = worker.m_second_layer_things_done;
+    m_last_obj_copy                     = worker.m_last_obj_copy;
 }
 
 void GCode::apply_print_config(const PrintConfig &print_config)
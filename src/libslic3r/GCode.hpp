@@ -186,6 +186,10 @@ public:
     // For Perl bindings, to be used exclusively by unit tests.
     unsigned int    layer_count() const { return m_layer_count; }
     void            set_layer_count(unsigned int value) { m_layer_count = value; }
+    // For unit tests: Export the objects of a sequential print on worker threads (default) or one after another.
+    void            set_sequential_print_in_parallel(bool value) { m_sequential_print_in_parallel = value; }
+    // For unit tests: Number of objects of the last sequential print exported on worker threads. The first object is always exported serially.
+    size_t          num_objects_exported_in_parallel() const { return m_num_objects_exported_in_parallel; }
     void            apply_print_config(const PrintConfig &print_config);
 
     // append full config to the given string
@@ -208,9 +212,8 @@ private:
 
     static std::vector<LayerToPrint>        		                   collect_layers_to_print(const PrintObject &object);
     static std::vector<std::pair<coordf_t, std::vector<LayerToPrint>>> collect_layers_to_print(const Print &print);
-    void            process_layer(
-        // Write into the output file.
-        FILE                            *file,
+    // Returns the G-code of the layer to be written into the output file.
+    std::string     process_layer(
         const Print                     &print,
         // Set of object & print layers of the same PrintObject and with the same print_z.
         const std::vector<LayerToPrint> &layers,
@@ -221,6 +224,14 @@ private:
         // Otherwise print a single copy of a single object.
         const size_t                     single_object_idx = size_t(-1));
 
+    // Sequential print: Copy the state of this G-code generator into a G-code generator exporting the layers of an object on a worker thread.
+    // The time estimators and the G-code analyzer are not copied.
+    void            copy_sequential_print_state(GCode &dst) const;
+    // Sequential print: Will this G-code generator export the same G-code as the worker generator rhs from now on?
+    bool            sequential_print_state_equal(const GCode &rhs) const;
+    // Sequential print: Continue from the state of a worker generator, which started at the state of worker_start.
+    void            take_over_sequential_print_state(const GCode &worker, const GCode &worker_start);
+
     void            set_last_pos(const Point &pos) { m_last_pos = pos; m_last_pos_defined = true; }
     bool            last_pos_defined() const { return m_last_pos_defined; }
     void            set_extruders(const std::vector<unsigned int> &extruder_ids);
@@ -364,6 +375,9 @@ private:
     bool                                m_second_layer_things_done;
     // Index of a last object copy extruded.
     std::pair<const PrintObject*, Point> m_last_obj_copy;
+    // Export the objects of a sequential print on worker threads.
+    bool                                m_sequential_print_in_parallel = true;
+    size_t                              m_num_objects_exported_in_parallel = 0;
 
     // Time estimators
     GCodeTimeEstimator m_normal_time_estimator;
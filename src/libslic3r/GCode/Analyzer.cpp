@@ -944,19 +944,17 @@ void GCodeAnalyzer::_calc_gcode_preview_extrusion_layers(GCodePreviewData& previ
             }
 
             // if layer not found, create and return it
-            layers.emplace_back(z, GCodePreviewData::Extrusion::Paths());
+            layers.emplace_back(z);
             return layers.back();
         }
 
-        static void store_polyline(const Polyline& polyline, const Metadata& data, float z, GCodePreviewData& preview_data)
+        static void store_polyline(Polyline& polyline, const Metadata& data, float z, GCodePreviewData& preview_data)
         {
             // if the polyline is valid, create the extrusion path from it and store it
             if (polyline.is_valid())
             {
-				auto& paths = get_layer_at_z(preview_data.extrusion.layers, z).paths;
-				paths.emplace_back(GCodePreviewData::Extrusion::Path());
-				GCodePreviewData::Extrusion::Path &path = paths.back();
-                path.polyline = polyline;
+				GCodePreviewData::Extrusion::Path path;
+                path.polyline = std::move(polyline);
 				path.extrusion_role = data.extrusion_role;
                 path.mm3_per_mm = data.mm3_per_mm;
                 path.width = data.width;
@@ -965,6 +963,7 @@ void GCodeAnalyzer::_calc_gcode_preview_extrusion_layers(GCodePreviewData& previ
                 path.extruder_id = data.extruder_id;
                 path.cp_color_id = data.cp_color_id;
                 path.fan_speed = data.fan_speed;
+                get_layer_at_z(preview_data.extrusion.layers, z).append(path);
             }
         }
     };
@@ -1040,6 +1039,8 @@ void GCodeAnalyzer::_calc_gcode_preview_extrusion_layers(GCodePreviewData& previ
 
     // we need to sort the layers by their z as they can be shuffled in case of sequential prints
     std::sort(preview_data.extrusion.layers.begin(), preview_data.extrusion.layers.end(), [](const GCodePreviewData::Extrusion::Layer& l1, const GCodePreviewData::Extrusion::Layer& l2)->bool { return l1.z < l2.z; });
+    for (GCodePreviewData::Extrusion::Layer &layer : preview_data.extrusion.layers)
+        layer.shrink_to_fit();
 }
 
 void GCodeAnalyzer::_calc_gcode_preview_travel(GCodePreviewData& preview_data, std::function<void()> cancel_callback)
@@ -1047,11 +1048,11 @@ void GCodeAnalyzer::_calc_gcode_preview_travel(GCodePreviewData& preview_data, s
     struct Helper
     {
         static void store_polyline(const Polyline3& polyline, GCodePreviewData::Travel::EType type, GCodePreviewData::Travel::Polyline::EDirection direction, 
-            float feedrate, unsigned int extruder_id, GCodePreviewData& preview_data)
+            float feedrate, unsigned int extruder_id, GCodePreviewData::Travel::PolylinesList& polylines)
         {
             // if the polyline is valid, store it
             if (polyline.is_valid())
-                preview_data.travel.polylines.emplace_back(type, direction, feedrate, extruder_id, polyline);
+                polylines.append(GCodePreviewData::Travel::Polyline(type, direction, feedrate, extruder_id, polyline));
         }
     };
 
@@ -1059,6 +1060,9 @@ void GCodeAnalyzer::_calc_gcode_preview_travel(GCodePreviewData& preview_data, s
     if (travel_moves == m_moves_map.end())
         return;
 
+    // the polylines are compressed into the preview data as they are completed
+    GCodePreviewData::Travel::PolylinesList& polylines = preview_data.travel.polylines;
+    size_t first_polyline_id = polylines.size();
     Polyline3 polyline;
     Vec3f position(FLT_MAX, FLT_MAX, FLT_MAX);
     GCodePreviewData::Travel::EType type = GCodePreviewData::Travel::Num_Types;
@@ -1088,7 +1092,7 @@ void GCodeAnalyzer::_calc_gcode_preview_travel(GCodePreviewData& preview_data, s
         {
             // store current polyline
             polyline.remove_duplicate_points();
-            Helper::store_polyline(polyline, type, direction, feedrate, extruder_id, preview_data);
+            Helper::store_polyline(polyline, type, direction, feedrate, extruder_id, polylines);
 
             // reset current polyline
             polyline = Polyline3();
@@ -1113,7 +1117,7 @@ void GCodeAnalyzer::_calc_gcode_preview_travel(GCodePreviewData& preview_data, s
 
     // store last polyline
     polyline.remove_duplicate_points();
-    Helper::store_polyline(polyline, type, direction, feedrate, extruder_id, preview_data);
+    Helper::store_polyline(polyline, type, direction, feedrate, extruder_id, polylines);
 
     // updates preview ranges data
     preview_data.ranges.height.update_from(height_range);
@@ -1121,9 +1125,8 @@ void GCodeAnalyzer::_calc_gcode_preview_travel(GCodePreviewData& preview_data, s
     preview_data.ranges.feedrate.update_from(feedrate_range);
 
     // we need to sort the polylines by their min z as they can be shuffled in case of sequential prints
-    std::sort(preview_data.travel.polylines.begin(), preview_data.travel.polylines.end(),
-        [](const GCodePreviewData::Travel::Polyline& p1, const GCodePreviewData::Travel::Polyline& p2)->bool
-    { return unscale<double>(p1.polyline.bounding_box().min(2)) < unscale<double>(p2.polyline.bounding_box().min(2)); });
+    polylines.sort_by_min_z(first_polyline_id);
+    preview_data.travel.polylines.shrink_to_fit();
 }
 
 void GCodeAnalyzer::_calc_gcode_preview_retractions(GCodePreviewData& preview_data, std::function<void()> cancel_callback)
@@ -21,6 +21,12 @@ CoolingBuffer::CoolingBuffer(GCode &gcodegen) : m_gcodegen(gcodegen), m_current_
     this->reset();
 }
 
+CoolingBuffer::CoolingBuffer(GCode &gcodegen, const CoolingBuffer &rhs) : 
+    m_gcodegen(gcodegen), m_axis(rhs.m_axis), m_current_pos(rhs.m_current_pos), m_current_extruder(rhs.m_current_extruder),
+    m_cooling_logic_proportional(rhs.m_cooling_logic_proportional)
+{
+}
+
 void CoolingBuffer::reset()
 {
     m_current_pos.assign(5, 0.f);
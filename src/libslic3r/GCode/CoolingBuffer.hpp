@@ -23,7 +23,10 @@ struct PerExtruderAdjustments;
 class CoolingBuffer {
 public:
     CoolingBuffer(GCode &gcodegen);
+    // Copy of the state of rhs for another G-code generator.
+    CoolingBuffer(GCode &gcodegen, const CoolingBuffer &rhs);
     void        reset();
+    bool        state_equal(const CoolingBuffer &rhs) const { return m_current_pos == rhs.m_current_pos && m_current_extruder == rhs.m_current_extruder; }
     void        set_current_extruder(unsigned int extruder_id) { m_current_extruder = extruder_id; }
     std::string process_layer(const std::string &gcode, size_t layer_id);
     GCode* 	    gcodegen() { return &m_gcodegen; }
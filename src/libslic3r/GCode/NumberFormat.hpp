@@ -0,0 +1,59 @@
+#ifndef slic3r_NumberFormat_hpp_
+#define slic3r_NumberFormat_hpp_
+
+#include <assert.h>
+#include <cmath>
+#include <cstdio>
+#include <string>
+
+namespace Slic3r {
+
+// Append a float formatted with a fixed number of decimal digits, producing the same output as sprintf("%.*f"),
+// but without parsing the format string. A float promoted to double and scaled by a power of ten up to 10^6 is exact,
+// therefore rounding the scaled value to an integer (ties to even, as printf does) yields the correctly rounded digits.
+inline void append_fixed(std::string &out, float value, int decimals)
+{
+    static const double pow10[] = { 1., 10., 100., 1000., 10000., 100000., 1000000. };
+    assert(decimals >= 0 && decimals <= 6);
+    double scaled = std::abs(double(value) * pow10[decimals]);
+    if (! std::isfinite(scaled) || scaled >= 1e15) {
+        char buf[64];
+        sprintf(buf, "%.*f", decimals, value);
+        out += buf;
+        return;
+    }
+    unsigned long long digits = (unsigned long long)std::nearbyint(scaled);
+    char  buf[32];
+    char *end = buf + sizeof(buf);
+    char *p   = end;
+    for (int i = 0; i < decimals; ++ i, digits /= 10)
+        *(-- p) = char('0' + digits % 10);
+    if (decimals > 0)
+        *(-- p) = '.';
+    do {
+        *(-- p) = char('0' + digits % 10);
+        digits /= 10;
+    } while (digits > 0);
+    if (std::signbit(value))
+        *(-- p) = '-';
+    out.append(p, end - p);
+}
+
+inline void append_int(std::string &out, int value)
+{
+    char  buf[16];
+    char *end = buf + sizeof(buf);
+    char *p   = end;
+    unsigned int digits = value < 0 ? 0u - unsigned(value) : unsigned(value);
+    do {
+        *(-- p) = char('0' + digits % 10);
+        digits /= 10;
+    } while (digits > 0);
+    if (value < 0)
+        *(-- p) = '-';
+    out.append(p, end - p);
+}
+
+} // namespace Slic3r
+
+#endif /* slic3r_NumberFormat_hpp_ */
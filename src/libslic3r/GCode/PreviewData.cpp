@@ -3,6 +3,9 @@
 #include <I18N.hpp>
 #include "Utils.hpp"
 
+#include <algorithm>
+#include <atomic>
+
 #include <boost/format.hpp>
 
 //! macro used to mark string used at localization, 
@@ -20,10 +23,172 @@ std::vector<unsigned char> Color::as_bytes() const
     return ret;
 }
 
-GCodePreviewData::Extrusion::Layer::Layer(float z, const Paths& paths)
-    : z(z)
-    , paths(paths)
+// The toolpaths are stored with the resolution of the G-code, one micrometer.
+static const constexpr coord_t SCALED_MICROMETER = coord_t(0.001 / SCALING_FACTOR + 0.5);
+
+static inline int32_t to_micrometers(coord_t v)
+{
+    return int32_t((v >= 0) ? (v + SCALED_MICROMETER / 2) / SCALED_MICROMETER : (v - SCALED_MICROMETER / 2) / SCALED_MICROMETER);
+}
+
+static inline coord_t from_micrometers(int32_t v)
+{
+    return coord_t(v) * SCALED_MICROMETER;
+}
+
+// Differences of the coordinates are stored zigzag encoded (sign in the lowest bit), 7 bits per byte.
+static inline void append_varint(std::vector<unsigned char> &out, int32_t value)
+{
+    uint32_t v = (uint32_t(value) << 1) ^ uint32_t(value >> 31);
+    for (; v >= 0x80; v >>= 7)
+        out.push_back((unsigned char)(v | 0x80));
+    out.push_back((unsigned char)v);
+}
+
+static inline int32_t read_varint(const unsigned char *&data)
+{
+    uint32_t v = 0;
+    for (int shift = 0;; shift += 7) {
+        unsigned char c = *data ++;
+        v |= uint32_t(c & 0x7f) << shift;
+        if ((c & 0x80) == 0)
+            break;
+    }
+    return int32_t(v >> 1) ^ - int32_t(v & 1);
+}
+
+// IEEE 754 half precision, rounded to nearest, out of range values are clamped to the largest finite half.
+static inline uint16_t float_to_half(float value)
+{
+    uint32_t f;
+    memcpy(&f, &value, sizeof(f));
+    uint32_t sign = (f >> 16) & 0x8000;
+    int32_t  exp  = int32_t((f >> 23) & 0xff) - 127 + 15;
+    uint32_t mant = f & 0x7fffff;
+    if (exp >= 31)
+        return uint16_t(sign | 0x7bff);
+    if (exp <= 0) {
+        // subnormal half
+        if (exp < -10)
+            return uint16_t(sign);
+        mant |= 0x800000;
+        uint32_t shift = uint32_t(14 - exp);
+        uint32_t half  = mant >> shift;
+        if ((mant >> (shift - 1)) & 1)
+            ++ half;
+        return uint16_t(sign | half);
+    }
+    uint32_t half = sign | (uint32_t(exp) << 10) | (mant >> 13);
+    if (mant & 0x1000)
+        // may carry into the exponent, which is still correct
+        ++ half;
+    if ((half & 0x7fff) >= 0x7c00)
+        half = sign | 0x7bff;
+    return uint16_t(half);
+}
+
+static inline float half_to_float(uint16_t half)
+{
+    uint32_t sign = uint32_t(half & 0x8000) << 16;
+    uint32_t exp  = (half >> 10) & 0x1f;
+    uint32_t mant = half & 0x3ff;
+    uint32_t f;
+    if (exp == 0) {
+        if (mant == 0)
+            f = sign;
+        else {
+            // subnormal half, normalize
+            exp = 127 - 15 + 1;
+            for (; (mant & 0x400) == 0; mant <<= 1)
+                -- exp;
+            f = sign | (exp << 23) | ((mant & 0x3ff) << 13);
+        }
+    } else if (exp == 31)
+        f = sign | 0x7f800000 | (mant << 13);
+    else
+        f = sign | ((exp + 127 - 15) << 23) | (mant << 13);
+    float out;
+    memcpy(&out, &f, sizeof(out));
+    return out;
+}
+
+void GCodePreviewData::Extrusion::Layer::append(const Path &path)
+{
+    PathData data;
+    data.num_points = 0;
+    size_t  points_begin = m_points.size();
+    int32_t last[2] = { 0, 0 };
+    for (const Point &pt : path.polyline.points) {
+        int32_t p[2] = { to_micrometers(pt.x()), to_micrometers(pt.y()) };
+        if (data.num_points == 0) {
+            data.first_point[0] = p[0];
+            data.first_point[1] = p[1];
+        } else if (p[0] == last[0] && p[1] == last[1])
+            continue;
+        else {
+            append_varint(m_points, p[0] - last[0]);
+            append_varint(m_points, p[1] - last[1]);
+        }
+        last[0] = p[0];
+        last[1] = p[1];
+        ++ data.num_points;
+    }
+    if (data.num_points < 2) {
+        m_points.resize(points_begin);
+        return;
+    }
+    data.points_end     = uint32_t(m_points.size());
+    data.mm3_per_mm     = float_to_half(path.mm3_per_mm);
+    data.width          = float_to_half(path.width);
+    data.height         = float_to_half(path.height);
+    data.feedrate       = float_to_half(path.feedrate);
+    data.fan_speed      = float_to_half(path.fan_speed);
+    data.extruder_id    = uint16_t(std::min<uint32_t>(path.extruder_id, 0xffff));
+    data.cp_color_id    = uint16_t(std::min<uint32_t>(path.cp_color_id, 0xffff));
+    data.extrusion_role = path.extrusion_role;
+    m_paths.emplace_back(data);
+}
+
+void GCodePreviewData::Extrusion::Layer::path_attributes(size_t path_id, Path &out) const
+{
+    const PathData &data = m_paths[path_id];
+    out.extrusion_role = data.extrusion_role;
+    out.mm3_per_mm     = half_to_float(data.mm3_per_mm);
+    out.width          = half_to_float(data.width);
+    out.height         = half_to_float(data.height);
+    out.feedrate       = half_to_float(data.feedrate);
+    out.extruder_id    = data.extruder_id;
+    out.cp_color_id    = data.cp_color_id;
+    out.fan_speed      = half_to_float(data.fan_speed);
+}
+
+void GCodePreviewData::Extrusion::Layer::path(size_t path_id, Path &out) const
+{
+    this->path_attributes(path_id, out);
+    const PathData      &data = m_paths[path_id];
+    const unsigned char *src  = m_points.data() + ((path_id == 0) ? 0 : m_paths[path_id - 1].points_end);
+    int32_t x = data.first_point[0];
+    int32_t y = data.first_point[1];
+    Points &points = out.polyline.points;
+    points.clear();
+    points.reserve(data.num_points);
+    points.emplace_back(from_micrometers(x), from_micrometers(y));
+    for (uint32_t i = 1; i < data.num_points; ++ i) {
+        x += read_varint(src);
+        y += read_varint(src);
+        points.emplace_back(from_micrometers(x), from_micrometers(y));
+    }
+}
+
+void GCodePreviewData::Extrusion::Layer::shrink_to_fit()
 {
+    m_paths.shrink_to_fit();
+    m_points.shrink_to_fit();
+}
+
+size_t GCodePreviewData::Extrusion::Layer::memory_used() const
+{
+    return SLIC3R_STDVEC_MEMSIZE(m_paths, PathData) + SLIC3R_STDVEC_MEMSIZE(m_points, unsigned char);
 }
 
 GCodePreviewData::Travel::Polyline::Polyline(EType type, EDirection direction, float feedrate, unsigned int extruder_id, const Polyline3& polyline)
@@ -157,11 +322,8 @@ size_t GCodePreviewData::Extrusion::memory_used() const
 {
     size_t out = sizeof(*this);
     out += SLIC3R_STDVEC_MEMSIZE(this->layers, Layer);
-    for (const Layer &layer : this->layers) {
-        out += SLIC3R_STDVEC_MEMSIZE(layer.paths, Path);
-        for (const Path &path : layer.paths)
-			out += SLIC3R_STDVEC_MEMSIZE(path.polyline.points, Point);
-    }
+    for (const Layer &layer : this->layers)
+        out += layer.memory_used();
 	return out;
 }
 
@@ -187,12 +349,117 @@ void GCodePreviewData::Travel::set_default()
 size_t GCodePreviewData::Travel::memory_used() const
 {
     size_t out = sizeof(*this);
-    out += SLIC3R_STDVEC_MEMSIZE(this->polylines, Polyline);
-	for (const Polyline &polyline : this->polylines)
-		out += SLIC3R_STDVEC_MEMSIZE(polyline.polyline.points, Vec3crd);
+    out += this->polylines.memory_used();
     return out;
 }
 
+void GCodePreviewData::Travel::PolylinesList::append(const Polyline &polyline)
+{
+    PolylineData data;
+    data.num_points = 0;
+    size_t  points_begin = m_points.size();
+    int32_t last[3] = { 0, 0, 0 };
+    for (const Vec3crd &pt : polyline.polyline.points) {
+        int32_t p[3] = { to_micrometers(pt.x()), to_micrometers(pt.y()), to_micrometers(pt.z()) };
+        if (data.num_points == 0) {
+            for (size_t i = 0; i < 3; ++ i)
+                data.first_point[i] = p[i];
+            data.min_z = p[2];
+        } else if (p[0] == last[0] && p[1] == last[1] && p[2] == last[2])
+            continue;
+        else {
+            for (size_t i = 0; i < 3; ++ i)
+                append_varint(m_points, p[i] - last[i]);
+            data.min_z = std::min(data.min_z, p[2]);
+        }
+        for (size_t i = 0; i < 3; ++ i)
+            last[i] = p[i];
+        ++ data.num_points;
+    }
+    if (data.num_points < 2) {
+        m_points.resize(points_begin);
+        return;
+    }
+    data.points_end  = uint32_t(m_points.size());
+    data.feedrate    = float_to_half(polyline.feedrate);
+    data.extruder_id = uint16_t(std::min<unsigned int>(polyline.extruder_id, 0xffff));
+    data.type        = polyline.type;
+    data.direction   = (unsigned char)polyline.direction;
+    m_polylines.emplace_back(data);
+}
+
+coord_t GCodePreviewData::Travel::PolylinesList::min_z(size_t polyline_id) const
+{
+    return from_micrometers(m_polylines[polyline_id].min_z);
+}
+
+void GCodePreviewData::Travel::PolylinesList::polyline_attributes(size_t polyline_id, Polyline &out) const
+{
+    const PolylineData &data = m_polylines[polyline_id];
+    out.type        = data.type;
+    out.direction   = Polyline::EDirection(data.direction);
+    out.feedrate    = half_to_float(data.feedrate);
+    out.extruder_id = data.extruder_id;
+}
+
+void GCodePreviewData::Travel::PolylinesList::polyline(size_t polyline_id, Polyline &out) const
+{
+    this->polyline_attributes(polyline_id, out);
+    const PolylineData  &data = m_polylines[polyline_id];
+    const unsigned char *src  = m_points.data() + ((polyline_id == 0) ? 0 : m_polylines[polyline_id - 1].points_end);
+    int32_t p[3] = { data.first_point[0], data.first_point[1], data.first_point[2] };
+    Points3 &points = out.polyline.points;
+    points.clear();
+    points.reserve(data.num_points);
+    points.emplace_back(from_micrometers(p[0]), from_micrometers(p[1]), from_micrometers(p[2]));
+    for (uint32_t i = 1; i < data.num_points; ++ i) {
+        for (size_t j = 0; j < 3; ++ j)
+            p[j] += read_varint(src);
+        points.emplace_back(from_micrometers(p[0]), from_micrometers(p[1]), from_micrometers(p[2]));
+    }
+}
+
+void GCodePreviewData::Travel::PolylinesList::sort_by_min_z(size_t first_polyline_id)
+{
+    if (first_polyline_id >= m_polylines.size())
+        return;
+    std::vector<uint32_t> order(m_polylines.size() - first_polyline_id);
+    for (size_t i = 0; i < order.size(); ++ i)
+        order[i] = uint32_t(first_polyline_id + i);
+    std::stable_sort(order.begin(), order.end(), [this](uint32_t i1, uint32_t i2) { return m_polylines[i1].min_z < m_polylines[i2].min_z; });
+    bool sorted = true;
+    for (size_t i = 0; i < order.size() && sorted; ++ i)
+        sorted = order[i] == first_polyline_id + i;
+    if (sorted)
+        return;
+    // Reorder the point differences together with the polylines, only the sorted range is copied.
+    size_t                      points_begin = (first_polyline_id == 0) ? 0 : m_polylines[first_polyline_id - 1].points_end;
+    std::vector<PolylineData>   polylines;
+    std::vector<unsigned char>  points;
+    polylines.reserve(order.size());
+    points.reserve(m_points.size() - points_begin);
+    for (uint32_t polyline_id : order) {
+        const PolylineData &data = m_polylines[polyline_id];
+        size_t src_begin = (polyline_id == 0) ? 0 : m_polylines[polyline_id - 1].points_end;
+        points.insert(points.end(), m_points.begin() + src_begin, m_points.begin() + data.points_end);
+        polylines.emplace_back(data);
+        polylines.back().points_end = uint32_t(points_begin + points.size());
+    }
+    std::copy(polylines.begin(), polylines.end(), m_polylines.begin() + first_polyline_id);
+    std::copy(points.begin(), points.end(), m_points.begin() + points_begin);
+}
+
+void GCodePreviewData::Travel::PolylinesList::shrink_to_fit()
+{
+    m_polylines.shrink_to_fit();
+    m_points.shrink_to_fit();
+}
+
+size_t GCodePreviewData::Travel::PolylinesList::memory_used() const
+{
+    return SLIC3R_STDVEC_MEMSIZE(m_polylines, PolylineData) + SLIC3R_STDVEC_MEMSIZE(m_points, unsigned char);
+}
+
 const Color GCodePreviewData::Retraction::Default_Color = Color(1.0f, 1.0f, 1.0f, 1.0f);
 
 GCodePreviewData::Retraction::Position::Position(const Vec3crd& position, float width, float height)
@@ -218,7 +485,9 @@ void GCodePreviewData::Shell::set_default()
     is_visible = false;
 }
 
-GCodePreviewData::GCodePreviewData()
+static std::atomic<size_t> s_last_preview_data_timestamp { 0 };
+
+GCodePreviewData::GCodePreviewData() : m_timestamp(++ s_last_preview_data_timestamp)
 {
     set_default();
 }
@@ -247,6 +516,7 @@ void GCodePreviewData::reset()
     travel.polylines.clear();
     retraction.positions.clear();
     unretraction.positions.clear();
+    m_timestamp = ++ s_last_preview_data_timestamp;
 }
 
 bool GCodePreviewData::empty() const
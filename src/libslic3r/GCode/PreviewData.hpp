@@ -234,6 +234,7 @@ public:
         static const std::string Default_Extrusion_Role_Names[erCount];
         static const EViewType Default_View_Type;
 
+		// Extrusion path as appended to and decoded from a Layer.
 		class Path
 		{
 		public:
@@ -256,12 +257,47 @@ public:
 		};
 		using Paths = std::vector<Path>;
 
-        struct Layer
+        // Extrusion paths of a single layer, stored column wise: The points of all the paths are stored in a single stream
+        // of differences to the preceding point, rounded to micrometers, the attributes are quantized to 16 bits.
+        // Several times smaller than a vector of Paths, the paths are decoded on demand.
+        class Layer
         {
+        public:
             float z;
-            Paths paths;
 
-            Layer(float z, const Paths& paths);
+            Layer(float z) : z(z) {}
+
+            // Quantize and append a path. Paths collapsing to a single point are dropped.
+            void   append(const Path &path);
+            size_t num_paths() const { return m_paths.size(); }
+            size_t num_points(size_t path_id) const { return m_paths[path_id].num_points; }
+            // Decode the attributes of a path, out.polyline is left untouched.
+            void   path_attributes(size_t path_id, Path &out) const;
+            // Decode a path, the memory of out.polyline is reused.
+            void   path(size_t path_id, Path &out) const;
+            void   shrink_to_fit();
+            size_t memory_used() const;
+
+        private:
+            struct PathData
+            {
+                // End of the points of this path in m_points.
+                uint32_t        points_end;
+                uint32_t        num_points;
+                // First point in micrometers, the following points are stored as differences.
+                int32_t         first_point[2];
+                uint16_t        mm3_per_mm;
+                uint16_t        width;
+                uint16_t        height;
+                uint16_t        feedrate;
+                uint16_t        fan_speed;
+                uint16_t        extruder_id;
+                uint16_t        cp_color_id;
+                ExtrusionRole   extrusion_role;
+            };
+
+            std::vector<PathData>       m_paths;
+            std::vector<unsigned char>  m_points;
         };
 
         typedef std::vector<Layer> LayersList;
@@ -310,10 +346,48 @@ public:
             unsigned int extruder_id;
             Polyline3 polyline;
 
+            Polyline() : type(Move), direction(Generic), feedrate(0.f), extruder_id(0) {}
             Polyline(EType type, EDirection direction, float feedrate, unsigned int extruder_id, const Polyline3& polyline);
         };
 
-        typedef std::vector<Polyline> PolylinesList;
+        // Travel polylines stored column wise, see Extrusion::Layer.
+        class PolylinesList
+        {
+        public:
+            // Quantize and append a polyline. Polylines collapsing to a single point are dropped.
+            void   append(const Polyline &polyline);
+            size_t size() const { return m_polylines.size(); }
+            bool   empty() const { return m_polylines.empty(); }
+            void   clear() { m_polylines.clear(); m_points.clear(); }
+            // Minimum scaled z of a polyline.
+            coord_t min_z(size_t polyline_id) const;
+            // Decode the attributes of a polyline, out.polyline is left untouched.
+            void   polyline_attributes(size_t polyline_id, Polyline &out) const;
+            // Decode a polyline, the memory of out.polyline is reused.
+            void   polyline(size_t polyline_id, Polyline &out) const;
+            // Stable sort of the polylines starting with first_polyline_id by their minimum z.
+            void   sort_by_min_z(size_t first_polyline_id = 0);
+            void   shrink_to_fit();
+            size_t memory_used() const;
+
+        private:
+            struct PolylineData
+            {
+                // End of the points of this polyline in m_points.
+                uint32_t        points_end;
+                uint32_t        num_points;
+                // First point in micrometers, the following points are stored as differences.
+                int32_t         first_point[3];
+                int32_t         min_z;
+                uint16_t        feedrate;
+                uint16_t        extruder_id;
+                EType           type;
+                unsigned char   direction;
+            };
+
+            std::vector<PolylineData>   m_polylines;
+            std::vector<unsigned char>  m_points;
+        };
 
         PolylinesList polylines;
         float width;
@@ -373,6 +447,10 @@ public:
     void reset();
     bool empty() const;
 
+    // Unique for the current content of the toolpaths, changed by reset().
+    // Allows the consumers to cache data derived from the toolpaths.
+    size_t timestamp() const { return m_timestamp; }
+
     Color get_extrusion_role_color(ExtrusionRole role) const;
     Color get_height_color(float height) const;
     Color get_width_color(float width) const;
@@ -390,6 +468,9 @@ public:
     size_t memory_used() const;
 
     static const std::vector<std::string>& ColorPrintColors();
+
+private:
+    size_t m_timestamp;
 };
 
 } // namespace Slic3r
@@ -13,6 +13,8 @@
 #include <cassert>
 #include <limits>
 
+#include <tbb/parallel_for.h>
+
 #include <libslic3r.h>
 
 #include "../GCodeWriter.hpp"
@@ -186,85 +188,102 @@ void ToolOrdering::collect_extruders(const PrintObject &object, const std::vecto
             layer_tools.has_support = true;
     }
 
-    // Extruder overrides are ordered by print_z.
-    std::vector<std::pair<double, unsigned int>>::const_iterator it_per_layer_extruder_override;
-	it_per_layer_extruder_override = per_layer_extruder_switches.begin();
-    unsigned int extruder_override = 0;
+    // Extruder overrides are ordered by print_z. Resolve the override active at each object layer first,
+    // so that the object layers could be processed in parallel.
+    std::vector<unsigned int> extruder_overrides(object.layers().size(), 0);
+    {
+        std::vector<std::pair<double, unsigned int>>::const_iterator it_per_layer_extruder_override = per_layer_extruder_switches.begin();
+        unsigned int extruder_override = 0;
+        for (size_t layer_idx = 0; layer_idx < object.layers().size(); ++ layer_idx) {
+            // Override extruder with the next 
+            for (; it_per_layer_extruder_override != per_layer_extruder_switches.end() && it_per_layer_extruder_override->first < object.layers()[layer_idx]->print_z + EPSILON; ++ it_per_layer_extruder_override)
+                extruder_override = (int)it_per_layer_extruder_override->second;
+            extruder_overrides[layer_idx] = extruder_override;
+        }
+    }
 
     // Collect the object extruders.
-    for (auto layer : object.layers()) {
-        LayerTools &layer_tools = this->tools_for_layer(layer->print_z);
-
-        // Override extruder with the next 
-    	for (; it_per_layer_extruder_override != per_layer_extruder_switches.end() && it_per_layer_extruder_override->first < layer->print_z + EPSILON; ++ it_per_layer_extruder_override)
-    		extruder_override = (int)it_per_layer_extruder_override->second;
-
-        // Store the current extruder override (set to zero if no overriden), so that layer_tools.wiping_extrusions().is_overridable_and_mark() will use it.
-        layer_tools.extruder_override = extruder_override;
-
-        // What extruders are required to print this object layer?
-        for (size_t region_id = 0; region_id < object.region_volumes.size(); ++ region_id) {
-            const LayerRegion *layerm = (region_id < layer->regions().size()) ? layer->regions()[region_id] : nullptr;
-            if (layerm == nullptr)
-                continue;
-            const PrintRegion &region = *object.print()->regions()[region_id];
-
-            if (! layerm->perimeters.entities.empty()) {
-                bool something_nonoverriddable = true;
-
-                if (m_print_config_ptr) { // in this case complete_objects is false (see ToolOrdering constructors)
-                    something_nonoverriddable = false;
-                    for (const auto& eec : layerm->perimeters.entities) // let's check if there are nonoverriddable entities
-                        if (!layer_tools.wiping_extrusions().is_overriddable_and_mark(dynamic_cast<const ExtrusionEntityCollection&>(*eec), *m_print_config_ptr, object, region))
-                            something_nonoverriddable = true;
-                }
+    // Each object layer maps to its own LayerTools, therefore the object layers are processed in parallel.
+    tbb::parallel_for(
+        tbb::blocked_range<size_t>(0, object.layers().size()),
+        [this, &object, &extruder_overrides](const tbb::blocked_range<size_t> &range) {
+        for (size_t layer_idx = range.begin(); layer_idx < range.end(); ++ layer_idx) {
+            const Layer  *layer             = object.layers()[layer_idx];
+            LayerTools   &layer_tools       = this->tools_for_layer(layer->print_z);
+            unsigned int  extruder_override = extruder_overrides[layer_idx];
+
+            // Store the current extruder override (set to zero if no overriden), so that layer_tools.wiping_extrusions().is_overridable_and_mark() will use it.
+            layer_tools.extruder_override = extruder_override;
+
+            // What extruders are required to print this object layer?
+            for (size_t region_id = 0; region_id < object.region_volumes.size(); ++ region_id) {
+                const LayerRegion *layerm = (region_id < layer->regions().size()) ? layer->regions()[region_id] : nullptr;
+                if (layerm == nullptr)
+                    continue;
+                const PrintRegion &region = *object.print()->regions()[region_id];
 
-                if (something_nonoverriddable)
-               		layer_tools.extruders.emplace_back((extruder_override == 0) ? region.config().perimeter_extruder.value : extruder_override);
+                if (! layerm->perimeters.entities.empty()) {
+                    bool something_nonoverriddable = true;
 
-                layer_tools.has_object = true;
-            }
+                    if (m_print_config_ptr) { // in this case complete_objects is false (see ToolOrdering constructors)
+                        something_nonoverriddable = false;
+                        for (const auto& eec : layerm->perimeters.entities) // let's check if there are nonoverriddable entities
+                            if (!layer_tools.wiping_extrusions().is_overriddable_and_mark(dynamic_cast<const ExtrusionEntityCollection&>(*eec), *m_print_config_ptr, object, region))
+                                something_nonoverriddable = true;
+                    }
+
+                    if (something_nonoverriddable)
+                        layer_tools.extruders.emplace_back((extruder_override == 0) ? region.config().perimeter_extruder.value : extruder_override);
 
-            bool has_infill       = false;
-            bool has_solid_infill = false;
-            bool something_nonoverriddable = false;
-            for (const ExtrusionEntity *ee : layerm->fills.entities) {
-                // fill represents infill extrusions of a single island.
-                const auto *fill = dynamic_cast<const ExtrusionEntityCollection*>(ee);
-                ExtrusionRole role = fill->entities.empty() ? erNone : fill->entities.front()->role();
-                if (is_solid_infill(role))
-                    has_solid_infill = true;
-                else if (role != erNone)
-                    has_infill = true;
-
-                if (m_print_config_ptr) {
-                    if (! layer_tools.wiping_extrusions().is_overriddable_and_mark(*fill, *m_print_config_ptr, object, region))
-                        something_nonoverriddable = true;
+                    layer_tools.has_object = true;
+                }
+
+                bool has_infill       = false;
+                bool has_solid_infill = false;
+                bool something_nonoverriddable = false;
+                for (const ExtrusionEntity *ee : layerm->fills.entities) {
+                    // fill represents infill extrusions of a single island.
+                    const auto *fill = dynamic_cast<const ExtrusionEntityCollection*>(ee);
+                    ExtrusionRole role = fill->entities.empty() ? erNone : fill->entities.front()->role();
+                    if (is_solid_infill(role))
+                        has_solid_infill = true;
+                    else if (role != erNone)
+                        has_infill = true;
+
+                    if (m_print_config_ptr) {
+                        if (! layer_tools.wiping_extrusions().is_overriddable_and_mark(*fill, *m_print_config_ptr, object, region))
+                            something_nonoverriddable = true;
+                    }
                 }
-            }
 
-            if (something_nonoverriddable || !m_print_config_ptr) {
-            	if (extruder_override == 0) {
-	                if (has_solid_infill)
-	                    layer_tools.extruders.emplace_back(region.config().solid_infill_extruder);
-	                if (has_infill)
-	                    layer_tools.extruders.emplace_back(region.config().infill_extruder);
-            	} else if (has_solid_infill || has_infill)
-            		layer_tools.extruders.emplace_back(extruder_override);
+                if (something_nonoverriddable || !m_print_config_ptr) {
+                    if (extruder_override == 0) {
+                        if (has_solid_infill)
+                            layer_tools.extruders.emplace_back(region.config().solid_infill_extruder);
+                        if (has_infill)
+                            layer_tools.extruders.emplace_back(region.config().infill_extruder);
+                    } else if (has_solid_infill || has_infill)
+                        layer_tools.extruders.emplace_back(extruder_override);
+                }
+                if (has_solid_infill || has_infill)
+                    layer_tools.has_object = true;
             }
-            if (has_solid_infill || has_infill)
-                layer_tools.has_object = true;
         }
-    }
-
-    for (auto& layer : m_layer_tools) {
-        // Sort and remove duplicates
-        sort_remove_duplicates(layer.extruders);
-
-        // make sure that there are some tools for each object layer (e.g. tall wiping object will result in empty extruders vector)
-        if (layer.extruders.empty() && layer.has_object)
-            layer.extruders.emplace_back(0); // 0="dontcare" extruder - it will be taken care of in reorder_extruders
-    }
+    });
+
+    tbb::parallel_for(
+        tbb::blocked_range<size_t>(0, m_layer_tools.size()),
+        [this](const tbb::blocked_range<size_t> &range) {
+        for (size_t i = range.begin(); i < range.end(); ++ i) {
+            LayerTools &layer = m_layer_tools[i];
+            // Sort and remove duplicates
+            sort_remove_duplicates(layer.extruders);
+
+            // make sure that there are some tools for each object layer (e.g. tall wiping object will result in empty extruders vector)
+            if (layer.extruders.empty() && layer.has_object)
+                layer.extruders.emplace_back(0); // 0="dontcare" extruder - it will be taken care of in reorder_extruders
+        }
+    });
 }
 
 // Reorder extruders to minimize layer changes.
@@ -311,14 +330,13 @@ void ToolOrdering::reorder_extruders(unsigned int last_extruder_id)
                 }
         }
         last_extruder_id = lt.extruders.back();
-    }
-
-    // Reindex the extruders, so they are zero based, not 1 based.
-    for (LayerTools &lt : m_layer_tools)
+        // Reindex the extruders, so they are zero based, not 1 based.
+        // Done in the same pass, as the ordering of a layer only depends on the layer below.
         for (unsigned int &extruder_id : lt.extruders) {
             assert(extruder_id > 0);
             -- extruder_id;
-        }    
+        }
+    }
 }
 
 void ToolOrdering::fill_wipe_tower_partitions(const PrintConfig &config, coordf_t object_bottom_z, coordf_t max_object_layer_height)
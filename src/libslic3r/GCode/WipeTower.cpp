@@ -17,11 +17,13 @@ TODO LIST
 
 #include <assert.h>
 #include <math.h>
+#include <cmath>
 #include <iostream>
 #include <vector>
 #include <numeric>
 
 #include "Analyzer.hpp"
+#include "NumberFormat.hpp"
 #include "BoundingBox.hpp"
 
 #if defined(__linux) || defined(__GNUC__ )
@@ -52,19 +54,17 @@ public:
         m_filpar(filament_parameters)
         {
             // adds tag for analyzer:
-            char buf[64];
-            sprintf(buf, ";%s%f\n", GCodeAnalyzer::Height_Tag.c_str(), m_layer_height); // don't rely on GCodeAnalyzer knowing the layer height - it knows nothing at priming
-            m_gcode += buf;
-            sprintf(buf, ";%s%d\n", GCodeAnalyzer::Extrusion_Role_Tag.c_str(), erWipeTower);
-            m_gcode += buf;
+            this->append_tag(GCodeAnalyzer::Height_Tag, m_layer_height); // don't rely on GCodeAnalyzer knowing the layer height - it knows nothing at priming
+            m_gcode += ';';
+            m_gcode += GCodeAnalyzer::Extrusion_Role_Tag;
+            append_int(m_gcode, erWipeTower);
+            m_gcode += '\n';
             change_analyzer_line_width(line_width);
         }
 
     WipeTowerWriter&              change_analyzer_line_width(float line_width) {
             // adds tag for analyzer:
-            char buf[64];
-            sprintf(buf, ";%s%f\n", GCodeAnalyzer::Width_Tag.c_str(), line_width);
-            m_gcode += buf;
+            this->append_tag(GCodeAnalyzer::Width_Tag, line_width);
             return *this;
     }
 
@@ -72,9 +72,7 @@ public:
             static const float area = float(M_PI) * 1.75f * 1.75f / 4.f;
             float mm3_per_mm = (len == 0.f ? 0.f : area * e / len);
             // adds tag for analyzer:
-            char buf[64];
-            sprintf(buf, ";%s%f\n", GCodeAnalyzer::Mm3_Per_Mm_Tag.c_str(), mm3_per_mm);
-            m_gcode += buf;
+            this->append_tag(GCodeAnalyzer::Mm3_Per_Mm_Tag, mm3_per_mm);
             return *this;
     }
 
@@ -114,8 +112,11 @@ public:
 
 	WipeTowerWriter& 			 feedrate(float f)
 	{
-		if (f != m_current_feedrate)
-			m_gcode += "G1" + set_format_F(f) + "\n";
+		if (f != m_current_feedrate) {
+			m_gcode += "G1";
+			set_format_F(f);
+			m_gcode += '\n';
+		}
 		return *this;
 	}
 
@@ -160,21 +161,21 @@ public:
 
 		m_gcode += "G1";
         if (std::abs(rot.x() - rotated_current_pos.x()) > (float)EPSILON)
-			m_gcode += set_format_X(rot.x());
+			set_format_X(rot.x());
 
         if (std::abs(rot.y() - rotated_current_pos.y()) > (float)EPSILON)
-			m_gcode += set_format_Y(rot.y());
+			set_format_Y(rot.y());
 
 
 		if (e != 0.f)
-			m_gcode += set_format_E(e);
+			set_format_E(e);
 
 		if (f != 0.f && f != m_current_feedrate) {
             if (limit_volumetric_flow) {
                 float e_speed = e / (((len == 0.f) ? std::abs(e) : len) / f * 60.f);
                 f /= std::max(1.f, e_speed / m_filpar[m_current_tool].max_e_speed);
             }
-			m_gcode += set_format_F(f);
+			set_format_F(f);
         }
 
         m_current_pos.x() = x;
@@ -238,9 +239,9 @@ public:
 			return *this;
 		m_gcode += "G1";
 		if (e != 0.f)
-			m_gcode += set_format_E(e);
+			set_format_E(e);
 		if (f != 0.f && f != m_current_feedrate)
-			m_gcode += set_format_F(f);
+			set_format_F(f);
 		m_gcode += "\n";
 		return *this;
 	}
@@ -268,9 +269,10 @@ public:
 	// Elevate the extruder head above the current print_z position.
 	WipeTowerWriter& z_hop(float hop, float f = 0.f)
 	{ 
-		m_gcode += std::string("G1") + set_format_Z(m_current_z + hop);
+		m_gcode += "G1";
+		set_format_Z(m_current_z + hop);
 		if (f != 0 && f != m_current_feedrate)
-			m_gcode += set_format_F(f);
+			set_format_F(f);
 		m_gcode += "\n";
 		return *this;
 	}
@@ -414,38 +416,42 @@ private:
     GCodeFlavor   m_gcode_flavor;
     const std::vector<WipeTower::FilamentParameters>& m_filpar;
 
-	std::string   set_format_X(float x)
+	// The following append the axis word to m_gcode, formatted as " X%.3f", " Y%.3f", " Z%.3f", " E%.4f" and " F%d".
+	void          set_format_X(float x)
 	{
-		char buf[64];
-		sprintf(buf, " X%.3f", x);
+		m_gcode += " X";
+		append_fixed(m_gcode, x, 3);
 		m_current_pos.x() = x;
-		return buf;
 	}
 
-	std::string   set_format_Y(float y) {
-		char buf[64];
-		sprintf(buf, " Y%.3f", y);
+	void          set_format_Y(float y) {
+		m_gcode += " Y";
+		append_fixed(m_gcode, y, 3);
 		m_current_pos.y() = y;
-		return buf;
 	}
 
-	std::string   set_format_Z(float z) {
-		char buf[64];
-		sprintf(buf, " Z%.3f", z);
-		return buf;
+	void          set_format_Z(float z) {
+		m_gcode += " Z";
+		append_fixed(m_gcode, z, 3);
 	}
 
-	std::string   set_format_E(float e) {
-		char buf[64];
-		sprintf(buf, " E%.4f", e);
-		return buf;
+	void          set_format_E(float e) {
+		m_gcode += " E";
+		append_fixed(m_gcode, e, 4);
 	}
 
-	std::string   set_format_F(float f) {
-		char buf[64];
-		sprintf(buf, " F%d", int(floor(f + 0.5f)));
+	void          set_format_F(float f) {
+		m_gcode += " F";
+		append_int(m_gcode, int(floor(f + 0.5f)));
 		m_current_feedrate = f;
-		return buf;
+	}
+
+	// Append ";<tag><value>\n", with the value formatted as "%f".
+	void          append_tag(const std::string &tag, float value) {
+		m_gcode += ';';
+		m_gcode += tag;
+		append_fixed(m_gcode, value, 6);
+		m_gcode += '\n';
 	}
 
 	WipeTowerWriter& operator=(const WipeTowerWriter &rhs);
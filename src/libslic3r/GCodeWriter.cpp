@@ -38,6 +38,58 @@ void GCodeWriter::set_extruders(std::vector<unsigned int> extruder_ids)
     this->multiple_extruders = (*std::max_element(extruder_ids.begin(), extruder_ids.end())) > 0;
 }
 
+GCodeWriter& GCodeWriter::operator=(const GCodeWriter &rhs)
+{
+    this->config                            = rhs.config;
+    this->multiple_extruders                = rhs.multiple_extruders;
+    m_extruders                             = rhs.m_extruders;
+    m_extrusion_axis                        = rhs.m_extrusion_axis;
+    m_single_extruder_multi_material        = rhs.m_single_extruder_multi_material;
+    m_last_acceleration                     = rhs.m_last_acceleration;
+    m_max_acceleration                      = rhs.m_max_acceleration;
+    m_last_fan_speed                        = rhs.m_last_fan_speed;
+    m_last_bed_temperature                  = rhs.m_last_bed_temperature;
+    m_last_bed_temperature_reached          = rhs.m_last_bed_temperature_reached;
+    m_lifted                                = rhs.m_lifted;
+    m_pos                                   = rhs.m_pos;
+    // The extruders refer to the config and the active extruder of the copy.
+    for (Extruder &extruder : m_extruders)
+        extruder.m_config = &this->config;
+    m_extruder = (rhs.m_extruder == nullptr) ? nullptr : &m_extruders[rhs.m_extruder - rhs.m_extruders.data()];
+    return *this;
+}
+
+bool GCodeWriter::state_equal(const GCodeWriter &rhs) const
+{
+    if (m_extruders.size() != rhs.m_extruders.size() ||
+        (m_extruder == nullptr ? -1 : int(m_extruder->id())) != (rhs.m_extruder == nullptr ? -1 : int(rhs.m_extruder->id())))
+        return false;
+    for (size_t i = 0; i < m_extruders.size(); ++ i) {
+        const Extruder &e1 = m_extruders[i];
+        const Extruder &e2 = rhs.m_extruders[i];
+        if (e1.id() != e2.id() || e1.m_E != e2.m_E || e1.m_retracted != e2.m_retracted || e1.m_restart_extra != e2.m_restart_extra)
+            return false;
+    }
+    return m_last_acceleration            == rhs.m_last_acceleration &&
+           m_last_fan_speed               == rhs.m_last_fan_speed &&
+           m_last_bed_temperature         == rhs.m_last_bed_temperature &&
+           m_last_bed_temperature_reached == rhs.m_last_bed_temperature_reached &&
+           m_lifted                       == rhs.m_lifted &&
+           m_pos                          == rhs.m_pos;
+}
+
+void GCodeWriter::take_over_state(const GCodeWriter &rhs, const GCodeWriter &rhs_start)
+{
+    assert(m_extruders.size() == rhs.m_extruders.size() && m_extruders.size() == rhs_start.m_extruders.size());
+    std::vector<double> absolute_E;
+    absolute_E.reserve(m_extruders.size());
+    for (size_t i = 0; i < m_extruders.size(); ++ i)
+        absolute_E.emplace_back(m_extruders[i].m_absolute_E + (rhs.m_extruders[i].m_absolute_E - rhs_start.m_extruders[i].m_absolute_E));
+    *this = rhs;
+    for (size_t i = 0; i < m_extruders.size(); ++ i)
+        m_extruders[i].m_absolute_E = absolute_E[i];
+}
+
 std::string GCodeWriter::preamble()
 {
     std::ostringstream gcode;
@@ -22,6 +22,8 @@ public:
         m_last_bed_temperature(0), m_last_bed_temperature_reached(true), 
         m_lifted(0)
         {}
+    GCodeWriter(const GCodeWriter &rhs) { *this = rhs; }
+    GCodeWriter& operator=(const GCodeWriter &rhs);
     Extruder*            extruder()             { return m_extruder; }
     const Extruder*      extruder()     const   { return m_extruder; }
 
@@ -68,6 +70,12 @@ public:
     std::string unlift();
     Vec3d       get_position() const { return m_pos; }
 
+    // Used to export the objects of a sequential print in parallel.
+    // Is the state of this writer equal to the state of rhs? The filament statistics are not compared.
+    bool        state_equal(const GCodeWriter &rhs) const;
+    // Take over the state of rhs, which started at the state of rhs_start. The filament statistics are accumulated.
+    void        take_over_state(const GCodeWriter &rhs, const GCodeWriter &rhs_start);
+
 private:
 	// Extruders are sorted by their ID, so that binary search is possible.
     std::vector<Extruder> m_extruders;
@@ -79,6 +79,7 @@ public:
 
 protected:
     friend class Layer;
+    friend class PrintObject;
 
     LayerRegion(Layer *layer, PrintRegion *region) : m_layer(layer), m_region(region) {}
     ~LayerRegion() {}
@@ -9,6 +9,8 @@
 #include "Format/3mf.hpp"
 
 #include <float.h>
+#include <mutex>
+#include <tbb/parallel_for.h>
 
 #include <boost/algorithm/string/predicate.hpp>
 #include <boost/algorithm/string/replace.hpp>
@@ -427,6 +429,49 @@ bool Model::arrange_objects(coordf_t dist, const BoundingBoxf* bb)
     return ret;
 }
 
+std::vector<Model> Model::split_to_beds(coordf_t dist, const BoundingBoxf &bb,
+                                        std::vector<const ModelInstance*> *unfittable) const
+{
+    arrangement::ArrangePolygons input;
+    std::vector<std::pair<const ModelObject*, const ModelInstance*>> instances;
+    for (const ModelObject *mo : objects)
+        for (const ModelInstance *minst : mo->instances) {
+            input.emplace_back(minst->get_arrange_polygon());
+            instances.emplace_back(mo, minst);
+        }
+    
+    arrangement::BedShapeHint bedhint(BoundingBox(scaled(bb.min), scaled(bb.max)));
+    arrangement::arrange_beds(input, scaled(dist), bedhint);
+    
+    int nbeds = 0;
+    for (size_t i = 0; i < input.size(); ++i) {
+        nbeds = std::max(nbeds, input[i].bed_idx + 1);
+        if (unfittable != nullptr && ! input[i].is_arranged())
+            unfittable->emplace_back(instances[i].second);
+    }
+    
+    std::vector<Model> out((size_t)nbeds);
+    for (int b = 0; b < nbeds; ++b) {
+        Model &model = out[size_t(b)];
+        // Objects are copied in their original order, only with the instances of this bed.
+        const ModelObject *last = nullptr;
+        ModelObject       *dst  = nullptr;
+        for (size_t i = 0; i < input.size(); ++i) {
+            if (input[i].bed_idx != b)
+                continue;
+            if (instances[i].first != last) {
+                last = instances[i].first;
+                dst  = model.add_object(*last);
+                dst->clear_instances();
+            }
+            ModelInstance *minst = dst->add_instance(*instances[i].second);
+            minst->apply_arrange_result(input[i].translation.cast<double>(), input[i].rotation);
+        }
+    }
+    
+    return out;
+}
+
 // Duplicate the entire model preserving instance relative positions.
 void Model::duplicate(size_t copies_num, coordf_t dist, const BoundingBoxf* bb)
 {
@@ -720,6 +765,15 @@ ModelVolume* ModelObject::add_volume(TriangleMesh &&mesh)
     return v;
 }
 
+ModelVolume* ModelObject::add_volume(TriangleMesh &&mesh, TriangleMesh &&convex_hull)
+{
+    ModelVolume* v = new ModelVolume(this, std::move(mesh), std::move(convex_hull));
+    this->volumes.push_back(v);
+    v->center_geometry_after_creation();
+    this->invalidate_bounding_box();
+    return v;
+}
+
 ModelVolume* ModelObject::add_volume(const ModelVolume &other)
 {
     ModelVolume* v = new ModelVolume(this, other);
@@ -739,6 +793,15 @@ ModelVolume* ModelObject::add_volume(const ModelVolume &other, TriangleMesh &&me
     return v;
 }
 
+ModelVolume* ModelObject::add_volume(const ModelVolume &other, TriangleMesh &&mesh, TriangleMesh &&convex_hull)
+{
+    ModelVolume* v = new ModelVolume(this, other, std::move(mesh), std::move(convex_hull));
+    this->volumes.push_back(v);
+    v->center_geometry_after_creation();
+    this->invalidate_bounding_box();
+    return v;
+}
+
 void ModelObject::delete_volume(size_t idx)
 {
     ModelVolumePtrs::iterator i = this->volumes.begin() + idx;
@@ -1261,6 +1324,17 @@ ModelObjectPtrs ModelObject::cut(size_t instance, coordf_t z, bool keep_upper, b
     return res;
 }
 
+// Convex hulls of the parts of a split mesh, calculated in parallel.
+static std::vector<TriangleMesh> split_convex_hulls(const TriangleMeshPtrs &meshes)
+{
+    std::vector<TriangleMesh> convex_hulls(meshes.size());
+    tbb::parallel_for(size_t(0), meshes.size(), [&meshes, &convex_hulls](size_t idx) {
+        if (meshes[idx]->stl.stats.number_of_facets > 1)
+            convex_hulls[idx] = meshes[idx]->convex_hull_3d();
+    });
+    return convex_hulls;
+}
+
 void ModelObject::split(ModelObjectPtrs* new_objects)
 {
     if (this->volumes.size() > 1) {
@@ -1271,10 +1345,11 @@ void ModelObject::split(ModelObjectPtrs* new_objects)
     }
     
     ModelVolume* volume = this->volumes.front();
+    // The split off parts are repaired already.
     TriangleMeshPtrs meshptrs = volume->mesh().split();
-    for (TriangleMesh *mesh : meshptrs) {
-        mesh->repair();
-        
+    std::vector<TriangleMesh> convex_hulls = split_convex_hulls(meshptrs);
+    for (size_t idx = 0; idx < meshptrs.size(); ++ idx) {
+        TriangleMesh *mesh = meshptrs[idx];
         // XXX: this seems to be the only real usage of m_model, maybe refactor this so that it's not needed?
         ModelObject* new_object = m_model->add_object();    
         new_object->name   = this->name;
@@ -1285,7 +1360,7 @@ void ModelObject::split(ModelObjectPtrs* new_objects)
         new_object->instances.reserve(this->instances.size());
         for (const ModelInstance *model_instance : this->instances)
             new_object->add_instance(*model_instance);
-        ModelVolume* new_vol = new_object->add_volume(*volume, std::move(*mesh));
+        ModelVolume* new_vol = new_object->add_volume(*volume, std::move(*mesh), std::move(convex_hulls[idx]));
 
         for (ModelInstance* model_instance : new_object->instances)
         {
@@ -1588,6 +1663,101 @@ void ModelVolume::center_geometry_after_creation(bool update_source_offset)
         source.mesh_offset = shift;
 }
 
+namespace {
+
+// Cache of the meshes transformed by ModelVolume::transformed_mesh_shared_ptr().
+// The transformed meshes are held until their source mesh is released by all its owners,
+// or until the cached meshes exceed a budget of facets, when the least recently used meshes are released.
+// The source meshes are never modified once shared, therefore a source mesh is identified by its shared pointer.
+class TransformedMeshCache
+{
+public:
+    std::shared_ptr<const TriangleMesh> get(const std::shared_ptr<const TriangleMesh> &src, const Transform3d &trafo)
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            this->release_expired();
+            for (Entry &entry : m_entries)
+                if (same_owner(entry.src, src) && entry.trafo.matrix() == trafo.matrix()) {
+                    entry.last_used = ++ m_timestamp;
+                    return entry.mesh;
+                }
+        }
+
+        // Transform the mesh outside of the lock, so that multiple meshes may be transformed in parallel.
+        auto mesh = std::make_shared<TriangleMesh>(*src);
+        mesh->transform(trafo, true);
+        if (mesh->repaired)
+            //FIXME The admesh repair function may break the face connectivity, rather refresh it here as the slicing code relies on it.
+            stl_check_facets_exact(&mesh->stl);
+        mesh->require_shared_vertices();
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (Entry &entry : m_entries)
+            if (same_owner(entry.src, src) && entry.trafo.matrix() == trafo.matrix())
+                // Another thread was faster.
+                return entry.mesh;
+        m_entries.push_back({ src, trafo, mesh, ++ m_timestamp });
+        m_facets += mesh->facets_count();
+        this->release_over_budget();
+        return mesh;
+    }
+
+private:
+    struct Entry {
+        std::weak_ptr<const TriangleMesh>   src;
+        Transform3d                         trafo;
+        std::shared_ptr<const TriangleMesh> mesh;
+        size_t                              last_used;
+    };
+
+    static bool same_owner(const std::weak_ptr<const TriangleMesh> &lhs, const std::shared_ptr<const TriangleMesh> &rhs)
+        { return ! lhs.owner_before(rhs) && ! rhs.owner_before(lhs); }
+
+    void release(size_t idx)
+    {
+        m_facets -= m_entries[idx].mesh->facets_count();
+        m_entries[idx] = std::move(m_entries.back());
+        m_entries.pop_back();
+    }
+
+    void release_expired()
+    {
+        for (size_t i = 0; i < m_entries.size();)
+            if (m_entries[i].src.expired())
+                this->release(i);
+            else
+                ++ i;
+    }
+
+    void release_over_budget()
+    {
+        while (m_facets > MAX_FACETS && m_entries.size() > 1) {
+            size_t idx_oldest = 0;
+            for (size_t i = 1; i < m_entries.size(); ++ i)
+                if (m_entries[i].last_used < m_entries[idx_oldest].last_used)
+                    idx_oldest = i;
+            this->release(idx_oldest);
+        }
+    }
+
+    static const size_t MAX_FACETS = 2000000;
+
+    std::mutex          m_mutex;
+    std::vector<Entry>  m_entries;
+    size_t              m_facets    = 0;
+    size_t              m_timestamp = 0;
+};
+
+TransformedMeshCache s_transformed_mesh_cache;
+
+} // namespace
+
+std::shared_ptr<const TriangleMesh> ModelVolume::transformed_mesh_shared_ptr(const Transform3d &trafo) const
+{
+    return s_transformed_mesh_cache.get(m_mesh, trafo);
+}
+
 void ModelVolume::calculate_convex_hull()
 {
     m_convex_hull = std::make_shared<TriangleMesh>(this->mesh().convex_hull_3d());
@@ -1656,19 +1826,19 @@ size_t ModelVolume::split(unsigned int max_extruders)
     unsigned int extruder_counter = 0;
     Vec3d offset = this->get_offset();
 
+    std::vector<TriangleMesh> convex_hulls = split_convex_hulls(meshptrs);
     for (TriangleMesh *mesh : meshptrs) {
-        mesh->repair();
         if (idx == 0)
         {
             this->set_mesh(std::move(*mesh));
-            this->calculate_convex_hull();
+            m_convex_hull = std::make_shared<TriangleMesh>(std::move(convex_hulls[idx]));
             // Assign a new unique ID, so that a new GLVolume will be generated.
             this->set_new_unique_id();
             // reset the source to disable reload from disk
             this->source = ModelVolume::Source();
         }
         else
-            this->object->volumes.insert(this->object->volumes.begin() + (++ivolume), new ModelVolume(object, *this, std::move(*mesh)));
+            this->object->volumes.insert(this->object->volumes.begin() + (++ivolume), new ModelVolume(object, *this, std::move(*mesh), std::move(convex_hulls[idx])));
 
         this->object->volumes[ivolume]->set_offset(Vec3d::Zero());
         this->object->volumes[ivolume]->center_geometry_after_creation();
@@ -219,8 +219,11 @@ public:
 
     ModelVolume*            add_volume(const TriangleMesh &mesh);
     ModelVolume*            add_volume(TriangleMesh &&mesh);
+    // The convex hull has to be calculated from the mesh passed in, it is centered together with the mesh.
+    ModelVolume*            add_volume(TriangleMesh &&mesh, TriangleMesh &&convex_hull);
     ModelVolume*            add_volume(const ModelVolume &volume);
     ModelVolume*            add_volume(const ModelVolume &volume, TriangleMesh &&mesh);
+    ModelVolume*            add_volume(const ModelVolume &volume, TriangleMesh &&mesh, TriangleMesh &&convex_hull);
     void                    delete_volume(size_t idx);
     void                    clear_volumes();
     bool                    is_multiparts() const { return volumes.size() > 1; }
@@ -463,6 +466,11 @@ public:
     void                calculate_convex_hull();
     const TriangleMesh& get_convex_hull() const;
     std::shared_ptr<const TriangleMesh> get_convex_hull_shared_ptr() const { return m_convex_hull; }
+    // Mesh of this volume transformed by trafo, with the shared vertices and the facet neighbors calculated, ready for slicing.
+    // The transformed meshes are cached and shared by all the callers transforming the same mesh by the same transformation,
+    // thus multiple regions or PrintObjects slicing the same volume transform its mesh just once.
+    // A cached mesh is released once its source mesh is released by all the ModelVolumes sharing it.
+    std::shared_ptr<const TriangleMesh> transformed_mesh_shared_ptr(const Transform3d &trafo) const;
     // Get count of errors in the mesh
     int                 get_mesh_errors_count() const;
 
@@ -566,6 +574,17 @@ private:
             calculate_convex_hull();
 		assert(this->config.id().valid()); assert(this->config.id() != other.config.id()); assert(this->id() != this->config.id());
     }
+    // Providing a new mesh with its convex hull calculated already, therefore this volume will get a new unique ID assigned.
+    ModelVolume(ModelObject *object, const ModelVolume &other, TriangleMesh &&mesh, TriangleMesh &&convex_hull) :
+        name(other.name), source(other.source), m_mesh(new TriangleMesh(std::move(mesh))), m_convex_hull(new TriangleMesh(std::move(convex_hull))),
+        config(other.config), m_type(other.m_type), object(object), m_transformation(other.m_transformation)
+    {
+		assert(this->id().valid()); assert(this->config.id().valid()); assert(this->id() != this->config.id());
+		assert(this->id() != other.id() && this->config.id() == other.config.id());
+        this->set_material_id(other.material_id());
+        this->config.set_new_unique_id();
+		assert(this->config.id().valid()); assert(this->config.id() != other.config.id()); assert(this->id() != this->config.id());
+    }
 
     ModelVolume& operator=(ModelVolume &rhs) = delete;
 
@@ -803,6 +822,10 @@ public:
     void 		  translate(coordf_t x, coordf_t y, coordf_t z) { for (ModelObject *o : this->objects) o->translate(x, y, z); }
     TriangleMesh  mesh() const;
     bool 		  arrange_objects(coordf_t dist, const BoundingBoxf* bb = NULL);
+    // Arrange the instances onto as many beds of the given size as needed, one Model per bed.
+    // Instances not fitting even onto an empty bed are left out and returned through unfittable.
+    std::vector<Model> split_to_beds(coordf_t dist, const BoundingBoxf &bb,
+                                     std::vector<const ModelInstance*> *unfittable = nullptr) const;
     // Croaks if the duplicated objects do not fit the print bed.
     void 		  duplicate(size_t copies_num, coordf_t dist, const BoundingBoxf* bb = NULL);
     void 	      duplicate_objects(size_t copies_num, coordf_t dist, const BoundingBoxf* bb = NULL);
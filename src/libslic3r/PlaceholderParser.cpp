@@ -5,6 +5,7 @@
 #include <iomanip>
 #include <sstream>
 #include <map>
+#include <mutex>
 #ifdef _MSC_VER
     #include <stdlib.h>  // provides **_environ
 #else
@@ -63,7 +64,32 @@
 
 namespace Slic3r {
 
-PlaceholderParser::PlaceholderParser(const DynamicConfig *external_config) : m_external_config(external_config)
+// Cache of the compiled templates, keyed by the template text.
+class PlaceholderParser::TemplateCache
+{
+public:
+    // Returns nullptr if the template could not be compiled and it has to be processed by the full macro parser.
+    std::shared_ptr<const CompiledTemplate> get(const std::string &templ)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_templates.find(templ);
+        if (it == m_templates.end()) {
+            // The templates are few (custom G-codes, output file name formats), just limit the cache to be on the safe side.
+            if (m_templates.size() >= 256)
+                m_templates.clear();
+            it = m_templates.emplace(templ, compile(templ)).first;
+        }
+        return it->second;
+    }
+
+private:
+    static std::shared_ptr<const CompiledTemplate> compile(const std::string &templ);
+
+    std::mutex                                                      m_mutex;
+    std::map<std::string, std::shared_ptr<const CompiledTemplate>>  m_templates;
+};
+
+PlaceholderParser::PlaceholderParser(const DynamicConfig *external_config) : m_external_config(external_config), m_template_cache(std::make_shared<TemplateCache>())
 {
     this->set("version", std::string(SLIC3R_VERSION));
     this->apply_env_variables();
@@ -1308,6 +1334,350 @@ static std::string process_macro(const std::string &templ, client::MyContext &co
     return output;
 }
 
+// A template split into segments of literal text, references of a single variable, conditional blocks and the other macros.
+// Only the other macros and the conditions not being a single boolean variable are parsed by the macro processor each time
+// the template is processed, the literal text is copied and the variables are just looked up.
+struct PlaceholderParser::CompiledTemplate
+{
+    enum SegmentType {
+        // Literal text.
+        TEXT,
+        // {variable}
+        VARIABLE,
+        // [variable]
+        LEGACY_VARIABLE,
+        // {if condition}...{elsif condition}...{else}...{endif}
+        CONDITIONAL,
+        // Any other {macro} or [legacy variable expansion].
+        MACRO,
+    };
+    struct Branch;
+    struct Segment {
+        SegmentType type;
+        // Literal text, variable name or the source of a macro.
+        std::string text;
+        // Branches of a CONDITIONAL segment, the {else} branch has an empty condition.
+        std::vector<Branch> branches;
+    };
+    struct Branch {
+        // Source of the condition.
+        std::string condition;
+        // Name of the variable if the condition is just a single variable.
+        std::string variable;
+        std::vector<Segment> body;
+    };
+    std::vector<Segment> segments;
+
+    std::string process(client::MyContext &context) const;
+
+    typedef std::string::const_iterator It;
+    static bool compile_block(It &it, It end, std::vector<Segment> &segments, std::string &keyword, std::string &condition);
+    static bool evaluate_condition(const Branch &branch, client::MyContext &context);
+    static void process_segments(const std::vector<Segment> &segments, client::MyContext &context, std::string &output);
+};
+
+namespace template_compiler {
+    typedef std::string::const_iterator It;
+
+    // White spaces skipped by the macro processor between the tokens.
+    static inline bool is_space(char c) { return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\v' || c == '\f'; }
+    static inline bool is_identifier_char(char c) { return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_'; }
+
+    static inline It skip_spaces(It it, It end)
+    {
+        while (it != end && is_space(*it))
+            ++ it;
+        return it;
+    }
+
+    // Keyword or identifier starting at it, empty if there is none.
+    static std::string identifier(It it, It end)
+    {
+        It begin = it;
+        if (it != end && (is_identifier_char(*it) && ! (*it >= '0' && *it <= '9')))
+            while (it != end && is_identifier_char(*it))
+                ++ it;
+        return std::string(begin, it);
+    }
+
+    static bool is_keyword(const std::string &id)
+    {
+        static const char *keywords[] = { "and", "if", "int", "else", "elsif", "endif", "false", "min", "max", "not", "or", "true" };
+        for (const char *keyword : keywords)
+            if (id == keyword)
+                return true;
+        return false;
+    }
+
+    // Name of a variable, if the source between begin and end is just a single variable name enclosed in white spaces.
+    static std::string single_variable(It begin, It end)
+    {
+        begin = skip_spaces(begin, end);
+        std::string id = identifier(begin, end);
+        if (id.empty() || is_keyword(id) || skip_spaces(begin + id.size(), end) != end)
+            return std::string();
+        return id;
+    }
+
+    // Skip a string or a regular expression enclosed in delimiters, it points to the opening delimiter.
+    // Returns end if not terminated.
+    static It skip_quoted(It it, It end)
+    {
+        char delimiter = *it ++;
+        for (; it != end; ++ it)
+            if (*it == '\\') {
+                if (++ it == end)
+                    return end;
+            } else if (*it == delimiter)
+                return ++ it;
+        return end;
+    }
+
+    // Find the closing brace of a macro, it points after the opening brace.
+    // Returns end if the macro is not terminated or if it contains an unexpected opening brace.
+    static It macro_end(It it, It end)
+    {
+        // Last two characters outside of the white spaces, to detect the regular expression operators =~ and !~.
+        char last = 0, last2 = 0;
+        while (it != end) {
+            char c = *it;
+            if (is_space(c)) {
+                ++ it;
+                continue;
+            }
+            if (c == '}')
+                return it;
+            if (c == '{')
+                return end;
+            if (c == '"' || (c == '/' && last == '~' && (last2 == '=' || last2 == '!'))) {
+                it = skip_quoted(it, end);
+                if (it == end)
+                    return end;
+                last = last2 = 0;
+                continue;
+            }
+            last2 = last;
+            last  = c;
+            ++ it;
+        }
+        return end;
+    }
+
+    // Find the closing bracket of a legacy variable expansion, it points after the opening bracket.
+    // Returns end if not a valid legacy variable expansion.
+    static It legacy_end(It it, It end)
+    {
+        for (int depth = 1; it != end; ++ it) {
+            char c = *it;
+            if (c == '[')
+                ++ depth;
+            else if (c == ']') {
+                if (-- depth == 0)
+                    return it;
+            } else if (! is_identifier_char(c) && ! is_space(c))
+                return end;
+        }
+        return end;
+    }
+}
+
+// Compile the template starting at it into segments, up to the end of the template or up to an {elsif}, {else} or {endif}
+// closing a block of a conditional. The keyword closing the block is returned through keyword together with the source
+// of its condition, it is left pointing after the closing macro.
+// Returns false if the template could not be compiled.
+bool PlaceholderParser::CompiledTemplate::compile_block(It &it, It end, std::vector<Segment> &segments, std::string &keyword, std::string &condition)
+{
+    using namespace template_compiler;
+
+    auto add_segment = [&segments](SegmentType type, It begin, It end) {
+        if (type == TEXT && ! segments.empty() && segments.back().type == TEXT)
+            segments.back().text.append(begin, end);
+        else
+            segments.push_back({ type, std::string(begin, end) });
+    };
+
+    keyword.clear();
+    while (it != end) {
+        if (*it != '{' && *it != '[') {
+            // Literal text up to the next macro.
+            It text_end = it;
+            while (text_end != end && *text_end != '{' && *text_end != '[')
+                ++ text_end;
+            add_segment(TEXT, it, text_end);
+            it = text_end;
+        } else if (*it == '[') {
+            It it_end = legacy_end(it + 1, end);
+            if (it_end == end)
+                return false;
+            std::string name = single_variable(it + 1, it_end);
+            if (name.empty())
+                add_segment(MACRO, it, it_end + 1);
+            else
+                segments.push_back({ LEGACY_VARIABLE, std::move(name) });
+            it = it_end + 1;
+        } else {
+            It it_end = macro_end(it + 1, end);
+            if (it_end == end)
+                return false;
+            It          keyword_begin = skip_spaces(it + 1, it_end);
+            std::string id            = identifier(keyword_begin, it_end);
+            It          keyword_end   = keyword_begin + id.size();
+            if (id == "elsif" || id == "else" || id == "endif") {
+                // Closing a block of a conditional, the caller checks whether it is expected.
+                keyword   = std::move(id);
+                condition = std::string(keyword_end, it_end);
+                it        = it_end + 1;
+                return true;
+            } else if (id == "if") {
+                Segment segment { CONDITIONAL };
+                std::string branch_keyword = "if";
+                std::string branch_condition(keyword_end, it_end);
+                it = it_end + 1;
+                while (branch_keyword != "endif") {
+                    Branch branch;
+                    if (branch_keyword == "else") {
+                        // {else} has no condition and it has to be the last branch.
+                        if (skip_spaces(branch_condition.begin(), branch_condition.end()) != branch_condition.end() ||
+                            (! segment.branches.empty() && segment.branches.back().condition.empty()))
+                            return false;
+                    } else {
+                        // {if} or {elsif} needs a condition and it can not follow the {else}.
+                        if (skip_spaces(branch_condition.begin(), branch_condition.end()) == branch_condition.end() ||
+                            (! segment.branches.empty() && segment.branches.back().condition.empty()))
+                            return false;
+                        branch.condition = std::move(branch_condition);
+                        branch.variable  = single_variable(branch.condition.begin(), branch.condition.end());
+                    }
+                    if (! compile_block(it, end, branch.body, branch_keyword, branch_condition) || branch_keyword.empty())
+                        // Not terminated by {endif}.
+                        return false;
+                    segment.branches.emplace_back(std::move(branch));
+                }
+                // {endif} has no condition.
+                if (skip_spaces(branch_condition.begin(), branch_condition.end()) != branch_condition.end())
+                    return false;
+                segments.emplace_back(std::move(segment));
+            } else {
+                std::string name = single_variable(it + 1, it_end);
+                if (name.empty())
+                    add_segment(MACRO, it, it_end + 1);
+                else
+                    segments.push_back({ VARIABLE, std::move(name) });
+                it = it_end + 1;
+            }
+        }
+    }
+    return true;
+}
+
+// Evaluate a condition of a branch the same way the macro processor does.
+bool PlaceholderParser::CompiledTemplate::evaluate_condition(const Branch &branch, client::MyContext &context)
+{
+    if (! branch.variable.empty()) {
+        const ConfigOption *opt = context.resolve_symbol(branch.variable);
+        if (opt != nullptr && opt->type() == coBool)
+            return opt->getBool();
+    }
+    // Let the macro processor parse just the boolean expression of the condition.
+    context.just_boolean_expression = true;
+    bool result = process_macro(branch.condition, context) == "true";
+    context.just_boolean_expression = false;
+    return result;
+}
+
+void PlaceholderParser::CompiledTemplate::process_segments(const std::vector<Segment> &segments, client::MyContext &context, std::string &output)
+{
+    typedef client::expr<std::string::const_iterator> Expr;
+
+    for (const Segment &segment : segments) {
+        switch (segment.type) {
+        case TEXT:
+            output += segment.text;
+            break;
+        case VARIABLE:
+        {
+            const ConfigOption *opt = context.resolve_symbol(segment.text);
+            if (opt == nullptr)
+                throw std::runtime_error("Not a variable name");
+            // Convert the value the same way the macro processor does, the other types are left to the macro processor.
+            Expr value;
+            switch (opt->type()) {
+            case coFloat:   value.set_d(opt->getFloat()); break;
+            case coInt:     value.set_i(opt->getInt()); break;
+            case coString:  value.set_s(static_cast<const ConfigOptionString*>(opt)->value); break;
+            case coPercent: value.set_d(opt->getFloat()); break;
+            case coBool:    value.set_b(opt->getBool()); break;
+            default:        output += process_macro("{" + segment.text + "}", context); continue;
+            }
+            output += value.to_string();
+            break;
+        }
+        case LEGACY_VARIABLE:
+        {
+            const ConfigOption *opt = context.resolve_symbol(segment.text);
+            if (opt == nullptr)
+                // Possibly a legacy vector indexing.
+                output += process_macro("[" + segment.text + "]", context);
+            else if (opt->is_scalar())
+                output += opt->serialize();
+            else {
+                const ConfigOptionVectorBase *vec = static_cast<const ConfigOptionVectorBase*>(opt);
+                if (vec->empty())
+                    throw std::runtime_error("Indexing an empty vector variable");
+                output += vec->vserialize()[(context.current_extruder_id >= vec->size()) ? 0 : context.current_extruder_id];
+            }
+            break;
+        }
+        case CONDITIONAL:
+        {
+            // The macro processor evaluates all the conditions and all the branches, reporting the errors of the branches
+            // not taken as well. Only the output of the first branch with a condition evaluating to true is kept.
+            bool        taken = false;
+            std::string skipped;
+            for (const Branch &branch : segment.branches) {
+                bool condition = branch.condition.empty() || evaluate_condition(branch, context);
+                if (condition && ! taken) {
+                    process_segments(branch.body, context, output);
+                    taken = true;
+                } else {
+                    skipped.clear();
+                    process_segments(branch.body, context, skipped);
+                }
+            }
+            break;
+        }
+        case MACRO:
+            output += process_macro(segment.text, context);
+            break;
+        }
+    }
+}
+
+std::shared_ptr<const PlaceholderParser::CompiledTemplate> PlaceholderParser::TemplateCache::compile(const std::string &templ)
+{
+    using namespace template_compiler;
+
+    // The macro processor validates UTF-8 sequences, leave the templates with non-ASCII characters to it.
+    for (char c : templ)
+        if (static_cast<unsigned char>(c) >= 0x80)
+            return nullptr;
+
+    auto        compiled = std::make_shared<CompiledTemplate>();
+    It          it       = templ.begin();
+    std::string keyword, condition;
+    if (! CompiledTemplate::compile_block(it, templ.end(), compiled->segments, keyword, condition) || ! keyword.empty())
+        // Failed or an {elsif}, {else} or {endif} not paired with an {if}, let the macro processor report the error.
+        return nullptr;
+    return compiled;
+}
+
+std::string PlaceholderParser::CompiledTemplate::process(client::MyContext &context) const
+{
+    std::string output;
+    process_segments(this->segments, context, output);
+    return output;
+}
+
 std::string PlaceholderParser::process(const std::string &templ, unsigned int current_extruder_id, const DynamicConfig *config_override) const
 {
     client::MyContext context;
@@ -1315,9 +1685,25 @@ std::string PlaceholderParser::process(const std::string &templ, unsigned int cu
     context.config              = &this->config();
     context.config_override     = config_override;
     context.current_extruder_id = current_extruder_id;
+
+    std::shared_ptr<const CompiledTemplate> compiled = m_template_cache->get(templ);
+    if (compiled) {
+        try {
+            return compiled->process(context);
+        } catch (std::exception &) {
+            // Process the whole template by the macro processor to report the error with the right line number and context.
+            context.error_message.clear();
+            context.just_boolean_expression = false;
+        }
+    }
     return process_macro(templ, context);
 }
 
+bool PlaceholderParser::is_template_compiled(const std::string &templ) const
+{
+    return m_template_cache->get(templ) != nullptr;
+}
+
 // Evaluate a boolean expression using the full expressive power of the PlaceholderParser boolean expression syntax.
 // Throws std::runtime_error on syntax or runtime error.
 bool PlaceholderParser::evaluate_boolean_expression(const std::string &templ, const DynamicConfig &config, const DynamicConfig *config_override)
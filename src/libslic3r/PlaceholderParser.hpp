@@ -3,6 +3,7 @@
 
 #include "libslic3r.h"
 #include <map>
+#include <memory>
 #include <string>
 #include <vector>
 #include "PrintConfig.hpp"
@@ -42,6 +43,9 @@ public:
     // Fill in the template using a macro processing language.
     // Throws std::runtime_error on syntax or runtime error.
     std::string process(const std::string &templ, unsigned int current_extruder_id = 0, const DynamicConfig *config_override = nullptr) const;
+    // Returns true if process() fills in the template from its compiled form, false if the template is parsed by the macro processor
+    // on each call, for example because it contains non-ASCII characters or it is not valid.
+    bool is_template_compiled(const std::string &templ) const;
     
     // Evaluate a boolean expression using the full expressive power of the PlaceholderParser boolean expression syntax.
     // Throws std::runtime_error on syntax or runtime error.
@@ -56,6 +60,12 @@ private:
 	// config has a higher priority than external_config when looking up a symbol.
     DynamicConfig 			 m_config;
     const DynamicConfig 	*m_external_config;
+
+    // Templates split into literal text, variable references and macros, cached by process().
+    // The compiled templates do not depend on the config, thus the cache is shared by the copies of this PlaceholderParser.
+    struct CompiledTemplate;
+    class  TemplateCache;
+    std::shared_ptr<TemplateCache> m_template_cache;
 };
 
 }
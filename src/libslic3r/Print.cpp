@@ -18,12 +18,15 @@
 #include <float.h>
 
 #include <algorithm>
+#include <chrono>
 #include <limits>
 #include <unordered_set>
 #include <boost/filesystem/path.hpp>
 #include <boost/format.hpp>
 #include <boost/log/trivial.hpp>
 
+#include <tbb/parallel_for.h>
+
 // Mark string for localization and translate.
 #define L(s) Slic3r::I18N::translate(s)
 
@@ -537,7 +540,7 @@ void Print::config_diffs(
     {
 	    const std::vector<std::string> &extruder_retract_keys = print_config_def.extruder_retract_keys();
 	    const std::string               filament_prefix       = "filament_";
-	    for (const t_config_option_key &opt_key : m_config.keys()) {
+	    for (const t_config_option_key &opt_key : m_config.keys_ref()) {
 	        const ConfigOption *opt_old = m_config.option(opt_key);
 	        assert(opt_old != nullptr);
 	        const ConfigOption *opt_new = new_full_config.option(opt_key);
@@ -566,11 +569,13 @@ void Print::config_diffs(
     object_diff = m_default_object_config.diff(new_full_config);
     region_diff = m_default_region_config.diff(new_full_config);
     // Prepare for storing of the full print config into new_full_config to be exported into the G-code and to be used by the PlaceholderParser.
-    for (const t_config_option_key &opt_key : new_full_config.keys()) {
-        const ConfigOption *opt_old = m_full_print_config.option(opt_key);
-        const ConfigOption *opt_new = new_full_config.option(opt_key);
-        if (opt_old == nullptr || *opt_new != *opt_old)
-            full_config_diff.emplace_back(opt_key);
+    // Both configs are sorted by the option keys, walk them in parallel.
+    auto it_old = m_full_print_config.cbegin();
+    for (auto it_new = new_full_config.cbegin(); it_new != new_full_config.cend(); ++ it_new) {
+        while (it_old != m_full_print_config.cend() && it_old->first < it_new->first)
+            ++ it_old;
+        if (it_old == m_full_print_config.cend() || it_old->first != it_new->first || *it_new->second != *it_old->second)
+            full_config_diff.emplace_back(it_new->first);
     }
 }
 
@@ -1097,13 +1102,14 @@ Print::ApplyStatus Print::apply(const Model &model, DynamicPrintConfig new_full_
                     if (&print_object == &print_object0) {
                         // Get the config applied to this volume.
                         PrintRegionConfig config = PrintObject::region_config_from_model_volume(m_default_region_config, it_range->second, *volume, num_extruders);
+                        size_t            config_hash = config.hash();
                         // Find an existing print region with the same config.
     					int idx_empty_slot = -1;
     					for (int i = 0; i < (int)m_regions.size(); ++ i) {
     						if (m_regions[i]->m_refcnt == 0) {
                                 if (idx_empty_slot == -1)
                                     idx_empty_slot = i;
-                            } else if (config.equals(m_regions[i]->config())) {
+                            } else if (m_regions[i]->config_hash() == config_hash && config.equals(m_regions[i]->config())) {
                                 region_id = i;
                                 break;
                             }
@@ -1146,6 +1152,59 @@ Print::ApplyStatus Print::apply(const Model &model, DynamicPrintConfig new_full_
 	return static_cast<ApplyStatus>(apply_status);
 }
 
+size_t Print::take_over_object_steps(Print &other)
+{
+    // The layers keep pointers to the regions, thus the regions of both Prints have to match by their indices.
+    if (m_full_print_config != other.m_full_print_config || m_regions.size() != other.m_regions.size())
+        return 0;
+    for (size_t region_id = 0; region_id < m_regions.size(); ++ region_id)
+        if (m_regions[region_id]->config_hash() != other.m_regions[region_id]->config_hash() ||
+            ! m_regions[region_id]->config().equals(other.m_regions[region_id]->config()))
+            return 0;
+
+    size_t num_taken_over = 0;
+    for (PrintObject *object : m_objects) {
+        if (object->is_step_done(posSlice))
+            continue;
+        const ModelObject &model_object = *object->model_object();
+        auto it_other = std::find_if(other.m_objects.begin(), other.m_objects.end(), [object, &model_object](const PrintObject *other_object) {
+            const ModelObject &other_model_object = *other_object->model_object();
+            // The same conditions, which invalidate the slicing step in Print::apply().
+            return other_model_object.id() == model_object.id() &&
+                transform3d_equal(other_object->trafo(), object->trafo()) &&
+                other_object->size() == object->size() && other_object->center_offset() == object->center_offset() &&
+                other_object->region_volumes == object->region_volumes &&
+                other_object->config().equals(object->config()) &&
+                ! model_volume_list_changed(other_model_object, model_object, ModelVolumeType::MODEL_PART) &&
+                ! model_volume_list_changed(other_model_object, model_object, ModelVolumeType::PARAMETER_MODIFIER) &&
+                other_model_object.origin_translation   == model_object.origin_translation &&
+                other_model_object.layer_height_profile == model_object.layer_height_profile &&
+                layer_height_ranges_equal(other_model_object.layer_config_ranges, model_object.layer_config_ranges, model_object.layer_height_profile.empty());
+        });
+        if (it_other == other.m_objects.end() || ! (*it_other)->is_step_done(posSlice))
+            continue;
+        PrintObject &other_object = **it_other;
+        // Steps done by the other PrintObject in a row. The support material is stored separately from the layers, it is not taken over.
+        std::vector<PrintObjectStep> steps;
+        for (PrintObjectStep step : { posSlice, posPerimeters, posPrepareInfill, posInfill })
+            if (other_object.is_step_done(step))
+                steps.emplace_back(step);
+            else
+                break;
+        object->take_over_layers(other_object);
+        for (PrintObjectStep step : steps) {
+            object->set_started(step);
+            object->set_done(step);
+        }
+        {
+            tbb::mutex::scoped_lock lock(other.state_mutex());
+            other_object.invalidate_step(posSlice);
+        }
+        ++ num_taken_over;
+    }
+    return num_taken_over;
+}
+
 bool Print::has_infinite_skirt() const
 {
     return (m_config.draft_shield && m_config.skirts > 0) || (m_config.ooze_prevention && this->extruders().size() > 1);
@@ -1579,13 +1638,26 @@ void Print::auto_assign_extruders(ModelObject* model_object) const
 void Print::process()
 {
     BOOST_LOG_TRIVIAL(info) << "Staring the slicing process." << log_memory_info();
+    // Is the processing limited by set_task() to stop before the object step?
+    auto task_stops_before = [this](PrintObjectStep step) { return m_task_to_object_step != -1 && m_task_to_object_step < int(step); };
     for (PrintObject *obj : m_objects)
-        obj->make_perimeters();
+        if (task_stops_before(posPerimeters))
+            obj->slice();
+        else
+            obj->make_perimeters();
+    if (task_stops_before(posPrepareInfill))
+        return;
     this->set_status(70, L("Infilling layers"));
     for (PrintObject *obj : m_objects)
-        obj->infill();
-    for (PrintObject *obj : m_objects)
-        obj->generate_support_material();
+        if (task_stops_before(posInfill))
+            obj->prepare_infill();
+        else
+            obj->infill();
+    if (! task_stops_before(posSupportMaterial))
+        for (PrintObject *obj : m_objects)
+            obj->generate_support_material();
+    if (m_task_to_object_step != -1)
+        return;
     if (this->set_started(psWipeTower)) {
         m_wipe_tower_data.clear();
         m_tool_ordering.clear();
@@ -1594,7 +1666,9 @@ void Print::process()
             this->_make_wipe_tower();
         } else if (! this->config().complete_objects.value) {
         	// Initialize the tool ordering, so it could be used by the G-code preview slider for planning tool changes and filament switches.
+            auto start_time = std::chrono::steady_clock::now();
         	m_tool_ordering = ToolOrdering(*this, -1, false);
+            m_wipe_tower_data.tool_ordering_time = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
             if (m_tool_ordering.empty() || m_tool_ordering.last_extruder() == unsigned(-1))
                 throw std::runtime_error("The print is empty. The model is not printable with current print settings.");
         }
@@ -2003,7 +2077,10 @@ void Print::_make_wipe_tower()
         wipe_volumes.push_back(std::vector<float>(wiping_matrix.begin()+i*number_of_extruders, wiping_matrix.begin()+(i+1)*number_of_extruders));
 
     // Let the ToolOrdering class know there will be initial priming extrusions at the start of the print.
+    auto start_time = std::chrono::steady_clock::now();
     m_wipe_tower_data.tool_ordering = ToolOrdering(*this, (unsigned int)-1, true);
+    m_wipe_tower_data.tool_ordering_time = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+    start_time = std::chrono::steady_clock::now();
 
     if (! m_wipe_tower_data.tool_ordering.has_wipe_tower())
         // Don't generate any wipe tower.
@@ -2064,38 +2141,77 @@ void Print::_make_wipe_tower()
     // Lets go through the wipe tower layers and determine pairs of extruder changes for each
     // to pass to wipe_tower (so that it can use it for planning the layout of the tower)
     {
-        unsigned int current_extruder_id = m_wipe_tower_data.tool_ordering.all_extruders().back();
-        for (auto &layer_tools : m_wipe_tower_data.tool_ordering.layer_tools()) { // for all layers
-            if (!layer_tools.has_wipe_tower) continue;
-            bool first_layer = &layer_tools == &m_wipe_tower_data.tool_ordering.front();
-            wipe_tower.plan_toolchange((float)layer_tools.print_z, (float)layer_tools.wipe_tower_layer_height, current_extruder_id, current_extruder_id, false);
-            for (const auto extruder_id : layer_tools.extruders) {
-                if ((first_layer && extruder_id == m_wipe_tower_data.tool_ordering.all_extruders().back()) || extruder_id != current_extruder_id) {
-                    float volume_to_wipe = wipe_volumes[current_extruder_id][extruder_id];             // total volume to wipe after this toolchange
-                    // Not all of that can be used for infill purging:
-                    volume_to_wipe -= (float)m_config.filament_minimal_purge_on_wipe_tower.get_at(extruder_id);
-
-                    // try to assign some infills/objects for the wiping:
-                    volume_to_wipe = layer_tools.wiping_extrusions().mark_wiping_extrusions(*this, current_extruder_id, extruder_id, volume_to_wipe);
-
-                    // add back the minimal amount toforce on the wipe tower:
-                    volume_to_wipe += (float)m_config.filament_minimal_purge_on_wipe_tower.get_at(extruder_id);
-
-                    // request a toolchange at the wipe tower with at least volume_to_wipe purging amount
-                    wipe_tower.plan_toolchange((float)layer_tools.print_z, (float)layer_tools.wipe_tower_layer_height, current_extruder_id, extruder_id,
-                                               first_layer && extruder_id == m_wipe_tower_data.tool_ordering.all_extruders().back(), volume_to_wipe);
-                    current_extruder_id = extruder_id;
+        std::vector<LayerTools> &layer_tools = m_wipe_tower_data.tool_ordering.layer_tools();
+        // The tool changes of a wipe tower layer only depend on the extruder printing at the start of that layer,
+        // which is the last extruder of the wipe tower layer below. Find the wipe tower layers and their starting extruders first,
+        // then mark the wiping extrusions of the layers in parallel, as each layer marks its own extrusions only.
+        std::vector<size_t>       wipe_tower_layers;
+        std::vector<unsigned int> start_extruders;
+        {
+            unsigned int current_extruder_id = m_wipe_tower_data.tool_ordering.all_extruders().back();
+            for (size_t i = 0; i < layer_tools.size(); ++ i) {
+                const LayerTools &lt = layer_tools[i];
+                if (! lt.has_wipe_tower) continue;
+                wipe_tower_layers.emplace_back(i);
+                start_extruders.emplace_back(current_extruder_id);
+                if (! lt.extruders.empty())
+                    current_extruder_id = lt.extruders.back();
+                if (i + 1 == layer_tools.size() || layer_tools[i + 1].wipe_tower_partitions == 0)
+                    break;
+            }
+        }
+
+        struct ToolChange {
+            unsigned int old_extruder_id;
+            unsigned int new_extruder_id;
+            bool         is_first_layer;
+            float        volume_to_wipe;
+        };
+        std::vector<std::vector<ToolChange>> tool_changes(wipe_tower_layers.size());
+        tbb::parallel_for(
+            tbb::blocked_range<size_t>(0, wipe_tower_layers.size()),
+            [this, &layer_tools, &wipe_tower_layers, &start_extruders, &tool_changes, &wipe_volumes](const tbb::blocked_range<size_t> &range) {
+            for (size_t idx = range.begin(); idx < range.end(); ++ idx) {
+                LayerTools   &lt                  = layer_tools[wipe_tower_layers[idx]];
+                bool          first_layer         = wipe_tower_layers[idx] == 0;
+                unsigned int  current_extruder_id = start_extruders[idx];
+                for (const auto extruder_id : lt.extruders) {
+                    if ((first_layer && extruder_id == m_wipe_tower_data.tool_ordering.all_extruders().back()) || extruder_id != current_extruder_id) {
+                        float volume_to_wipe = wipe_volumes[current_extruder_id][extruder_id];             // total volume to wipe after this toolchange
+                        // Not all of that can be used for infill purging:
+                        volume_to_wipe -= (float)m_config.filament_minimal_purge_on_wipe_tower.get_at(extruder_id);
+
+                        // try to assign some infills/objects for the wiping:
+                        volume_to_wipe = lt.wiping_extrusions().mark_wiping_extrusions(*this, current_extruder_id, extruder_id, volume_to_wipe);
+
+                        // add back the minimal amount toforce on the wipe tower:
+                        volume_to_wipe += (float)m_config.filament_minimal_purge_on_wipe_tower.get_at(extruder_id);
+
+                        tool_changes[idx].push_back({ current_extruder_id, extruder_id, first_layer && extruder_id == m_wipe_tower_data.tool_ordering.all_extruders().back(), volume_to_wipe });
+                        current_extruder_id = extruder_id;
+                    }
                 }
+                lt.wiping_extrusions().ensure_perimeters_infills_order(*this);
             }
-            layer_tools.wiping_extrusions().ensure_perimeters_infills_order(*this);
-            if (&layer_tools == &m_wipe_tower_data.tool_ordering.back() || (&layer_tools + 1)->wipe_tower_partitions == 0)
-                break;
+        });
+        this->throw_if_canceled();
+
+        // Request the toolchanges at the wipe tower with at least volume_to_wipe purging amount, layer by layer.
+        for (size_t idx = 0; idx < wipe_tower_layers.size(); ++ idx) {
+            const LayerTools &lt = layer_tools[wipe_tower_layers[idx]];
+            wipe_tower.plan_toolchange((float)lt.print_z, (float)lt.wipe_tower_layer_height, start_extruders[idx], start_extruders[idx], false);
+            for (const ToolChange &tool_change : tool_changes[idx])
+                wipe_tower.plan_toolchange((float)lt.print_z, (float)lt.wipe_tower_layer_height, tool_change.old_extruder_id, tool_change.new_extruder_id,
+                                           tool_change.is_first_layer, tool_change.volume_to_wipe);
         }
     }
+    m_wipe_tower_data.planning_time = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+    start_time = std::chrono::steady_clock::now();
 
     // Generate the wipe tower layers.
     m_wipe_tower_data.tool_changes.reserve(m_wipe_tower_data.tool_ordering.layer_tools().size());
     wipe_tower.generate(m_wipe_tower_data.tool_changes);
+    m_wipe_tower_data.generation_time = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
     m_wipe_tower_data.depth = wipe_tower.get_depth();
     m_wipe_tower_data.brim_width = wipe_tower.get_brim_width();
 
@@ -2120,6 +2236,9 @@ void Print::_make_wipe_tower()
 
     m_wipe_tower_data.used_filament = wipe_tower.get_used_filament();
     m_wipe_tower_data.number_of_toolchanges = wipe_tower.get_number_of_toolchanges();
+
+    BOOST_LOG_TRIVIAL(debug) << "Wipe tower: tool ordering " << m_wipe_tower_data.tool_ordering_time << " s, planning " << m_wipe_tower_data.planning_time <<
+        " s, generation " << m_wipe_tower_data.generation_time << " s, " << m_wipe_tower_data.number_of_toolchanges << " toolchanges";
 }
 
 // Generate a recommended G-code output file name based on the format template, default extension, and template parameters
@@ -2149,6 +2268,9 @@ DynamicConfig PrintStatistics::config() const
     config.set_key_value("total_weight",              new ConfigOptionFloat (this->total_weight));
     config.set_key_value("total_wipe_tower_cost",     new ConfigOptionFloat (this->total_wipe_tower_cost));
     config.set_key_value("total_wipe_tower_filament", new ConfigOptionFloat (this->total_wipe_tower_filament));
+    config.set_key_value("tool_ordering_time",        new ConfigOptionFloat (this->tool_ordering_time));
+    config.set_key_value("wipe_tower_planning_time",  new ConfigOptionFloat (this->wipe_tower_planning_time));
+    config.set_key_value("wipe_tower_generation_time", new ConfigOptionFloat (this->wipe_tower_generation_time));
     return config;
 }
 
@@ -2158,7 +2280,8 @@ DynamicConfig PrintStatistics::placeholders()
     for (const std::string &key : { 
         "print_time", "normal_print_time", "silent_print_time", 
         "used_filament", "extruded_volume", "total_cost", "total_weight", 
-        "total_toolchanges", "total_wipe_tower_cost", "total_wipe_tower_filament"})
+        "total_toolchanges", "total_wipe_tower_cost", "total_wipe_tower_filament",
+        "tool_ordering_time", "wipe_tower_planning_time", "wipe_tower_generation_time" })
         config.set_key_value(key, new ConfigOptionString(std::string("{") + key + "}"));
     return config;
 }
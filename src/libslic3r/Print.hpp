@@ -54,6 +54,8 @@ class PrintRegion
 public:
     const Print*                print() const { return m_print; }
     const PrintRegionConfig&    config() const { return m_config; }
+    // Hash of m_config, updated whenever m_config changes, to quickly find regions of the same config.
+    size_t                      config_hash() const { return m_config_hash; }
 	// 1-based extruder identifier for this region and role.
 	unsigned int 				extruder(FlowRole role) const;
     Flow                        flow(FlowRole role, double layer_height, bool bridge, bool first_layer, double width, const PrintObject &object) const;
@@ -69,10 +71,10 @@ public:
 // Methods modifying the PrintRegion's state:
 public:
     Print*                      print() { return m_print; }
-    void                        set_config(const PrintRegionConfig &config) { m_config = config; }
-    void                        set_config(PrintRegionConfig &&config) { m_config = std::move(config); }
+    void                        set_config(const PrintRegionConfig &config) { m_config = config; m_config_hash = m_config.hash(); }
+    void                        set_config(PrintRegionConfig &&config) { m_config = std::move(config); m_config_hash = m_config.hash(); }
     void                        config_apply_only(const ConfigBase &other, const t_config_option_keys &keys, bool ignore_nonexistent = false) 
-                                        { this->m_config.apply_only(other, keys, ignore_nonexistent); }
+                                        { this->m_config.apply_only(other, keys, ignore_nonexistent); m_config_hash = m_config.hash(); }
 
 protected:
     size_t             m_refcnt;
@@ -80,9 +82,10 @@ protected:
 private:
     Print             *m_print;
     PrintRegionConfig  m_config;
+    size_t             m_config_hash;
     
-    PrintRegion(Print* print) : m_refcnt(0), m_print(print) {}
-    PrintRegion(Print* print, const PrintRegionConfig &config) : m_refcnt(0), m_print(print), m_config(config) {}
+    PrintRegion(Print* print) : m_refcnt(0), m_print(print), m_config_hash(m_config.hash()) {}
+    PrintRegion(Print* print, const PrintRegionConfig &config) : m_refcnt(0), m_print(print), m_config(config), m_config_hash(m_config.hash()) {}
     ~PrintRegion() = default;
 };
 
@@ -210,6 +213,8 @@ private:
     bool                    invalidate_state_by_config_options(const std::vector<t_config_option_key> &opt_keys);
     // If ! m_slicing_params.valid, recalculate.
     void                    update_slicing_parameters();
+    // Move the layers sliced by a PrintObject of another Print with matching regions, see Print::take_over_object_steps().
+    void                    take_over_layers(PrintObject &other);
 
     static PrintObjectConfig object_config_from_model_object(const PrintObjectConfig &default_object_config, const ModelObject &object, size_t num_extruders);
     static PrintRegionConfig region_config_from_model_volume(const PrintRegionConfig &default_region_config, const DynamicPrintConfig *layer_range_config, const ModelVolume &volume, size_t num_extruders);
@@ -255,6 +260,7 @@ private:
     std::vector<ExPolygons> slice_region(size_t region_id, const std::vector<float> &z, SlicingMode mode) const;
     std::vector<ExPolygons> slice_modifiers(size_t region_id, const std::vector<float> &z) const;
     std::vector<ExPolygons> slice_volumes(const std::vector<float> &z, SlicingMode mode, const std::vector<const ModelVolume*> &volumes) const;
+    Transform3d             volume_trafo(const ModelVolume &volume) const;
     std::vector<ExPolygons> slice_volume(const std::vector<float> &z, SlicingMode mode, const ModelVolume &volume) const;
     std::vector<ExPolygons> slice_volume(const std::vector<float> &z, const std::vector<t_layer_height_range> &ranges, SlicingMode mode, const ModelVolume &volume) const;
 };
@@ -276,6 +282,11 @@ struct WipeTowerData
     float                                                 depth;
     float                                                 brim_width;
 
+    // Duration of the tool ordering, of the wipe tower planning and of the wipe tower G-code generation, in seconds.
+    double                                                tool_ordering_time;
+    double                                                planning_time;
+    double                                                generation_time;
+
     void clear() {
         priming.reset(nullptr);
         tool_changes.clear();
@@ -284,6 +295,9 @@ struct WipeTowerData
         number_of_toolchanges = -1;
         depth = 0.f;
         brim_width = 0.f;
+        tool_ordering_time = 0.;
+        planning_time = 0.;
+        generation_time = 0.;
     }
 
 private:
@@ -310,6 +324,10 @@ struct PrintStatistics
     double                          total_wipe_tower_cost;
     double                          total_wipe_tower_filament;
     std::map<size_t, float>         filament_stats;
+    // Duration of the slicing stages preceding the G-code export, in seconds.
+    double                          tool_ordering_time;
+    double                          wipe_tower_planning_time;
+    double                          wipe_tower_generation_time;
 
     // Config with the filled in print statistics.
     DynamicConfig           config() const;
@@ -331,6 +349,9 @@ struct PrintStatistics
         total_wipe_tower_cost  = 0.;
         total_wipe_tower_filament = 0.;
         filament_stats.clear();
+        tool_ordering_time         = 0.;
+        wipe_tower_planning_time   = 0.;
+        wipe_tower_generation_time = 0.;
     }
 };
 
@@ -358,8 +379,17 @@ public:
     bool                empty() const override { return m_objects.empty(); }
 
     ApplyStatus         apply(const Model &model, DynamicPrintConfig config) override;
-
+    // Take over the sliced layers of PrintObjects processed by another Print for the same ModelObjects and the same configuration,
+    // for example by the speculative slicing in the background. Only PrintObjects with posSlice not done are updated,
+    // the object steps taken over are marked as done. The steps of the other Print's PrintObjects taken over are invalidated.
+    // Returns the number of PrintObjects taken over. Neither Print shall be processed during this call.
+    size_t              take_over_object_steps(Print &other);
+
+    // Only params.to_object_step is supported: Stop processing after the object step, don't process the Print steps.
+    void                set_task(const TaskParams &params) override { m_task_to_object_step = params.to_object_step; }
     void                process() override;
+    // Revert the limit set by set_task().
+    void                finalize() override { m_task_to_object_step = -1; }
     // Exports G-code into a file name based on the path_template, returns the file path of the generated G-code file.
     // If preview_data is not null, the preview_data is filled in for the G-code visualization (not used by the command line Slic3r).
     std::string         export_gcode(const std::string& path_template, GCodePreviewData* preview_data, ThumbnailsGeneratorCallback thumbnail_cb = nullptr);
@@ -458,6 +488,9 @@ private:
     // Estimated print time, filament consumed.
     PrintStatistics                         m_print_statistics;
 
+    // Last object step to be processed by process(), set by set_task(). -1 if not limited.
+    int                                     m_task_to_object_step = -1;
+
     // To allow GCode to set the Print's GCodeExport step status.
     friend class GCode;
     // Allow PrintObject to access m_mutex and m_cancel_callback.
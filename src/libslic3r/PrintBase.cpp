@@ -12,7 +12,7 @@
 namespace Slic3r
 {
 
-size_t PrintStateBase::g_last_timestamp = 0;
+tbb::atomic<size_t> PrintStateBase::g_last_timestamp;
 
 // Update "scale", "input_filename", "input_filename_base" placeholders from the current m_objects.
 void PrintBase::update_object_placeholders(DynamicConfig &config, const std::string &default_ext) const
@@ -11,6 +11,7 @@
 #ifndef NOMINMAX
     #define NOMINMAX
 #endif
+#include "tbb/atomic.h"
 #include "tbb/mutex.h"
 
 #include "Model.hpp"
@@ -43,10 +44,9 @@ public:
     };
 
 protected:
-    //FIXME last timestamp is shared between Print & SLAPrint,
-    // and if multiple Print or SLAPrint instances are executed in parallel, modification of g_last_timestamp
-    // is not synchronized!
-    static size_t g_last_timestamp;
+    // Last timestamp is shared between Print & SLAPrint. It is atomic, as multiple Print instances may be processed in parallel,
+    // for example the speculative Print of the BackgroundSlicingProcess.
+    static tbb::atomic<size_t> g_last_timestamp;
 };
 
 // To be instantiated over PrintStep or PrintObjectStep enums.
@@ -3501,6 +3501,11 @@ CLITransformConfigDef::CLITransformConfigDef()
     def->label = L("Split");
     def->tooltip = L("Detect unconnected parts in the given model(s) and split them into separate objects.");
 
+    def = this->add("split_beds", coBool);
+    def->label = L("Split to beds");
+    def->tooltip = L("Arrange the objects of the given model(s) onto as many print beds as needed and export each bed separately, "
+                     "the output file names are suffixed with the bed number.");
+
     def = this->add("scale_to_fit", coPoint3);
     def->label = L("Scale to Fit");
     def->tooltip = L("Scale to fit the given volume.");
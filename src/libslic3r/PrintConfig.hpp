@@ -298,6 +298,41 @@ protected:
         const std::vector<std::string>& keys()      const { return m_keys; }
         const T&                        defaults()  const { return *m_defaults; }
 
+        // Compare two configs of the same type by walking the option offsets, without looking up the option keys.
+        t_config_option_keys diff(const T *lhs, const T *rhs) const
+        {
+            t_config_option_keys out;
+            for (size_t i = 0; i < m_offsets.size(); ++ i)
+                if (*option_at(lhs, i) != *option_at(rhs, i))
+                    out.emplace_back(m_keys[i]);
+            return out;
+        }
+        bool equals(const T *lhs, const T *rhs) const
+        {
+            for (size_t i = 0; i < m_offsets.size(); ++ i)
+                if (*option_at(lhs, i) != *option_at(rhs, i))
+                    return false;
+            return true;
+        }
+        // Compare with any other config, ignoring options not present in the other config.
+        t_config_option_keys diff(const T *lhs, const ConfigBase &rhs) const
+        {
+            t_config_option_keys out;
+            for (size_t i = 0; i < m_offsets.size(); ++ i) {
+                const ConfigOption *rhs_opt = rhs.option(m_keys[i]);
+                if (rhs_opt != nullptr && *option_at(lhs, i) != *rhs_opt)
+                    out.emplace_back(m_keys[i]);
+            }
+            return out;
+        }
+        size_t hash(const T *owner) const
+        {
+            size_t seed = 0;
+            for (size_t i = 0; i < m_offsets.size(); ++ i)
+                seed = ConfigHash::combine(seed, option_at(owner, i)->hash());
+            return seed;
+        }
+
         // To be called during the StaticCache setup.
         // Collect option keys from m_map_name_to_offset,
         // assign default values to m_defaults.
@@ -307,6 +342,8 @@ protected:
             m_defaults = defaults;
             m_keys.clear();
             m_keys.reserve(m_map_name_to_offset.size());
+            m_offsets.clear();
+            m_offsets.reserve(m_map_name_to_offset.size());
             for (const auto &kvp : defs->options) {
                 // Find the option given the option name kvp.first by an offset from (char*)m_defaults.
                 ConfigOption *opt = this->optptr(kvp.first, m_defaults);
@@ -314,6 +351,7 @@ protected:
                     // This option is not defined by the ConfigBase of type T.
                     continue;
                 m_keys.emplace_back(kvp.first);
+                m_offsets.emplace_back(m_map_name_to_offset.find(kvp.first)->second);
                 const ConfigOptionDef *def = defs->get(kvp.first);
                 assert(def != nullptr);
                 if (def->default_value)
@@ -322,8 +360,13 @@ protected:
         }
 
     private:
+        const ConfigOption* option_at(const T *owner, size_t idx) const
+            { return reinterpret_cast<const ConfigOption*>((const char*)owner + m_offsets[idx]); }
+
         T                                  *m_defaults;
         std::vector<std::string>            m_keys;
+        // Offsets of the options from the owner, in the order of m_keys.
+        std::vector<ptrdiff_t>              m_offsets;
     };
 };
 
@@ -338,6 +381,13 @@ public: \
     /* Overrides ConfigBase::keys(). Collect names of all configuration values maintained by this configuration store. */ \
     t_config_option_keys     keys() const override { return s_cache_##CLASS_NAME.keys(); } \
     const t_config_option_keys& keys_ref() const override { return s_cache_##CLASS_NAME.keys(); } \
+    /* Hides ConfigBase::diff() / equals() with faster variants using the cached option offsets. */ \
+    t_config_option_keys     diff(const CLASS_NAME &rhs) const { return s_cache_##CLASS_NAME.diff(this, &rhs); } \
+    t_config_option_keys     diff(const ConfigBase &rhs) const { return s_cache_##CLASS_NAME.diff(this, rhs); } \
+    bool                     equals(const CLASS_NAME &rhs) const { return s_cache_##CLASS_NAME.equals(this, &rhs); } \
+    bool                     equals(const ConfigBase &rhs) const { return this->diff(rhs).empty(); } \
+    /* Hash of all the option values. Configs comparing equal have equal hashes. */ \
+    size_t                   hash() const { return s_cache_##CLASS_NAME.hash(this); } \
     static const CLASS_NAME& defaults() { initialize_cache(); return s_cache_##CLASS_NAME.defaults(); } \
 private: \
     static void initialize_cache() \
@@ -415,6 +415,21 @@ void PrintObject::clear_layers()
     m_layers.clear();
 }
 
+// The regions of both Prints are expected to match by their indices, see Print::take_over_object_steps().
+void PrintObject::take_over_layers(PrintObject &other)
+{
+    this->clear_layers();
+    m_layers = std::move(other.m_layers);
+    other.m_layers.clear();
+    for (Layer *layer : m_layers) {
+        layer->m_object = this;
+        for (size_t region_id = 0; region_id < layer->m_regions.size(); ++ region_id)
+            layer->m_regions[region_id]->m_region = m_print->get_region(region_id);
+    }
+    m_slicing_params = other.m_slicing_params;
+    m_typed_slices   = other.m_typed_slices;
+}
+
 Layer* PrintObject::add_layer(int id, coordf_t height, coordf_t print_z, coordf_t slice_z)
 {
     m_layers.emplace_back(new Layer(id, this, height, print_z, slice_z));
@@ -2035,25 +2050,14 @@ std::vector<ExPolygons> PrintObject::slice_volumes(const std::vector<float> &z,
 {
     std::vector<ExPolygons> layers;
     if (! volumes.empty()) {
+        if (volumes.size() == 1)
+            return this->slice_volume(z, mode, *volumes.front());
         // Compose mesh.
         //FIXME better to perform slicing over each volume separately and then to use a Boolean operation to merge them.
-		TriangleMesh mesh(volumes.front()->mesh());
-        mesh.transform(volumes.front()->get_matrix(), true);
-		assert(mesh.repaired);
-		if (volumes.size() == 1 && mesh.repaired) {
-			//FIXME The admesh repair function may break the face connectivity, rather refresh it here as the slicing code relies on it.
-			stl_check_facets_exact(&mesh.stl);
-		}
-        for (size_t idx_volume = 1; idx_volume < volumes.size(); ++ idx_volume) {
-            const ModelVolume &model_volume = *volumes[idx_volume];
-            TriangleMesh vol_mesh(model_volume.mesh());
-            vol_mesh.transform(model_volume.get_matrix(), true);
-            mesh.merge(vol_mesh);
-        }
+        TriangleMesh mesh;
+        for (const ModelVolume *model_volume : volumes)
+            mesh.merge(*model_volume->transformed_mesh_shared_ptr(this->volume_trafo(*model_volume)));
         if (mesh.stl.stats.number_of_facets > 0) {
-            mesh.transform(m_trafo, true);
-            // apply XY shift
-            mesh.translate(- unscale<float>(m_center_offset.x()), - unscale<float>(m_center_offset.y()), 0);
             // perform actual slicing
             const Print *print = this->print();
             auto callback = TriangleMeshSlicer::throw_on_cancel_callback_type([print](){print->throw_if_canceled();});
@@ -2068,29 +2072,25 @@ std::vector<ExPolygons> PrintObject::slice_volumes(const std::vector<float> &z,
     return layers;
 }
 
+// Transformation of a volume into the coordinate system of this PrintObject, including the XY shift.
+Transform3d PrintObject::volume_trafo(const ModelVolume &volume) const
+{
+    return Geometry::assemble_transform(Vec3d(- unscale<double>(m_center_offset.x()), - unscale<double>(m_center_offset.y()), 0.)) * m_trafo * volume.get_matrix();
+}
+
 std::vector<ExPolygons> PrintObject::slice_volume(const std::vector<float> &z, SlicingMode mode, const ModelVolume &volume) const
 {
     std::vector<ExPolygons> layers;
     if (! z.empty()) {
-	    // Compose mesh.
+	    // The transformed mesh is shared with the other regions and PrintObjects slicing the same volume with the same transformation.
 	    //FIXME better to split the mesh into separate shells, perform slicing over each shell separately and then to use a Boolean operation to merge them.
-	    TriangleMesh mesh(volume.mesh());
-	    mesh.transform(volume.get_matrix(), true);
-		if (mesh.repaired) {
-			//FIXME The admesh repair function may break the face connectivity, rather refresh it here as the slicing code relies on it.
-			stl_check_facets_exact(&mesh.stl);
-		}
-	    if (mesh.stl.stats.number_of_facets > 0) {
-	        mesh.transform(m_trafo, true);
-	        // apply XY shift
-	        mesh.translate(- unscale<float>(m_center_offset.x()), - unscale<float>(m_center_offset.y()), 0);
+	    std::shared_ptr<const TriangleMesh> mesh = volume.transformed_mesh_shared_ptr(this->volume_trafo(volume));
+	    if (mesh->stl.stats.number_of_facets > 0) {
 	        // perform actual slicing
 	        TriangleMeshSlicer mslicer;
 	        const Print *print = this->print();
 	        auto callback = TriangleMeshSlicer::throw_on_cancel_callback_type([print](){print->throw_if_canceled();});
-	        // TriangleMeshSlicer needs the shared vertices.
-	        mesh.require_shared_vertices();
-	        mslicer.init(&mesh, callback);
+	        mslicer.init(mesh.get(), callback);
 	        mslicer.slice(z, mode, float(m_config.slice_closing_radius.value), &layers, callback);
 	        m_print->throw_if_canceled();
 	    }
@@ -157,7 +157,12 @@ ExPolygons ConcaveHull::to_expolygons() const
 
 ExPolygons offset_waffle_style_ex(const ConcaveHull &hull, coord_t delta)
 {
-    ClipperLib::Paths paths = Slic3rMultiPoints_to_ClipperPaths(hull.polygons());
+    return offset_waffle_style_ex(hull.polygons(), delta);
+}
+
+ExPolygons offset_waffle_style_ex(const Polygons &polys, coord_t delta)
+{
+    ClipperLib::Paths paths = Slic3rMultiPoints_to_ClipperPaths(polys);
     paths = fast_offset(paths, 2 * delta, ClipperLib::jtRound);
     paths = fast_offset(paths, -delta, ClipperLib::jtRound);
     ExPolygons ret = ClipperPaths_to_Slic3rExPolygons(paths);
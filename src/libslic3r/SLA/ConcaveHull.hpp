@@ -47,6 +47,7 @@ public:
 };
 
 ExPolygons offset_waffle_style_ex(const ConcaveHull &ccvhull, coord_t delta);
+ExPolygons offset_waffle_style_ex(const Polygons &polys, coord_t delta);
 Polygons   offset_waffle_style(const ConcaveHull &polys, coord_t delta);
 
 }}     // namespace Slic3r::sla
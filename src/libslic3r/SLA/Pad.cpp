@@ -3,6 +3,7 @@
 #include <libslic3r/SLA/SpatIndex.hpp>
 #include <libslic3r/SLA/BoostAdapter.hpp>
 #include <libslic3r/SLA/Contour3D.hpp>
+#include <libslic3r/SLA/Concurrency.hpp>
 
 #include "ConcaveHull.hpp"
 
@@ -295,6 +296,29 @@ ExPolygons breakstick_holes(const ExPolygons &input, Args...args)
     return ret;
 }
 
+// Calculate the concave hull of the input polygons, or take it from the cache
+// if it was calculated from the same input already.
+Polygons concave_hull(const Polygons &input,
+                      double          merge_dist,
+                      PadCache *      cache,
+                      ThrowOnCancel   thr)
+{
+    if (cache && cache->hull_valid && cache->hull_merge_dist == merge_dist &&
+        cache->hull_input == input)
+        return cache->hull;
+
+    ConcaveHull cchull{input, merge_dist, thr};
+
+    if (cache) {
+        cache->hull_input      = input;
+        cache->hull_merge_dist = merge_dist;
+        cache->hull            = cchull.polygons();
+        cache->hull_valid      = true;
+    }
+
+    return cchull.polygons();
+}
+
 static inline coord_t get_waffle_offset(const PadConfig &c)
 {
     return scaled(c.brim_size_mm + c.wing_distance());
@@ -402,7 +426,8 @@ public:
     _AroundPadSkeleton(const ExPolygons &support_blueprint,
                        const ExPolygons &model_blueprint,
                        const PadConfig & cfg,
-                       ThrowOnCancel     thr)
+                       ThrowOnCancel     thr,
+                       PadCache *        cache = nullptr)
     {
         // We need to merge the support and the model contours in a special
         // way in which the model contours have to be substracted from the
@@ -419,7 +444,8 @@ public:
                       ClipperLib::jtMiter, 1);
 
         ExPolygons fullcvh =
-            wafflized_concave_hull(support_blueprint, model_bp_offs, cfg, thr);
+            wafflized_concave_hull(support_blueprint, model_bp_offs, cfg, thr,
+                                   cache);
 
         auto model_bp_sticks =
             breakstick_holes(model_bp_offs, cfg.embed_object.object_gap_mm,
@@ -451,14 +477,15 @@ private:
     ExPolygons wafflized_concave_hull(const ExPolygons &supp_bp,
                                        const ExPolygons &model_bp,
                                        const PadConfig  &cfg,
-                                       ThrowOnCancel     thr)
+                                       ThrowOnCancel     thr,
+                                       PadCache *        cache)
     {
-        auto allin = reserve_vector<ExPolygon>(supp_bp.size() + model_bp.size());
+        auto allin = reserve_vector<Polygon>(supp_bp.size() + model_bp.size());
 
         for (auto &ep : supp_bp) allin.emplace_back(ep.contour);
         for (auto &ep : model_bp) allin.emplace_back(ep.contour);
 
-        ConcaveHull cchull{allin, get_merge_distance(cfg), thr};
+        Polygons cchull = concave_hull(allin, get_merge_distance(cfg), cache, thr);
         return offset_waffle_style_ex(cchull, get_waffle_offset(cfg));
     }
 
@@ -483,14 +510,16 @@ public:
     BelowPadSkeleton(const ExPolygons &support_blueprint,
                      const ExPolygons &model_blueprint,
                      const PadConfig & cfg,
-                     ThrowOnCancel     thr)
+                     ThrowOnCancel     thr,
+                     PadCache *        cache = nullptr)
     {
-        outer.reserve(support_blueprint.size() + model_blueprint.size());
+        auto allin = reserve_vector<Polygon>(support_blueprint.size() +
+                                             model_blueprint.size());
 
-        for (auto &ep : support_blueprint) outer.emplace_back(ep.contour);
-        for (auto &ep : model_blueprint) outer.emplace_back(ep.contour);
+        for (auto &ep : support_blueprint) allin.emplace_back(ep.contour);
+        for (auto &ep : model_blueprint) allin.emplace_back(ep.contour);
 
-        ConcaveHull ochull{outer, get_merge_distance(cfg), thr};
+        Polygons ochull = concave_hull(allin, get_merge_distance(cfg), cache, thr);
 
         outer = offset_waffle_style_ex(ochull, get_waffle_offset(cfg));
     }
@@ -543,44 +572,68 @@ bool add_cavity(Contour3D &pad, ExPolygon &top_poly, const PadConfig3D &cfg,
     return true;
 }
 
-Contour3D create_outer_pad_geometry(const ExPolygons & skeleton,
-                                    const PadConfig3D &cfg,
-                                    ThrowOnCancel      thr)
+// Merge the parts generated concurrently into one contour in the original
+// order, so that the output does not depend on the thread scheduling.
+Contour3D merge_parts(std::vector<Contour3D> &&parts)
 {
     Contour3D ret;
+    for (Contour3D &part : parts) ret.merge(part);
+    return ret;
+}
 
-    for (const ExPolygon &pad_part : skeleton) {
-        ExPolygon top_poly{pad_part};
-        ExPolygon bottom_poly =
-            offset_contour_only(pad_part, -scaled(cfg.bottom_offset()));
+Contour3D create_outer_pad_part(const ExPolygon &  pad_part,
+                                const PadConfig3D &cfg,
+                                ThrowOnCancel      thr)
+{
+    Contour3D ret;
 
-        if (bottom_poly.empty()) continue;
+    ExPolygon top_poly{pad_part};
+    ExPolygon bottom_poly =
+        offset_contour_only(pad_part, -scaled(cfg.bottom_offset()));
 
-        double z_min = -cfg.height, z_max = 0;
-        ret.merge(walls(top_poly.contour, bottom_poly.contour, z_max, z_min,
-                        cfg.bottom_offset(), thr));
+    if (bottom_poly.empty()) return ret;
 
-        if (cfg.wing_height > 0. && add_cavity(ret, top_poly, cfg, thr))
-            z_max = -cfg.wing_height;
+    double z_min = -cfg.height, z_max = 0;
+    ret.merge(walls(top_poly.contour, bottom_poly.contour, z_max, z_min,
+                    cfg.bottom_offset(), thr));
 
-        for (auto &h : bottom_poly.holes)
-            ret.merge(straight_walls(h, z_max, z_min, thr));
+    if (cfg.wing_height > 0. && add_cavity(ret, top_poly, cfg, thr))
+        z_max = -cfg.wing_height;
 
-        ret.merge(triangulate_expolygon_3d(bottom_poly, z_min, NORMALS_DOWN));
-        ret.merge(triangulate_expolygon_3d(top_poly, NORMALS_UP));
-    }
+    for (auto &h : bottom_poly.holes)
+        ret.merge(straight_walls(h, z_max, z_min, thr));
+
+    ret.merge(triangulate_expolygon_3d(bottom_poly, z_min, NORMALS_DOWN));
+    ret.merge(triangulate_expolygon_3d(top_poly, NORMALS_UP));
 
     return ret;
 }
 
+Contour3D create_outer_pad_geometry(const ExPolygons & skeleton,
+                                    const PadConfig3D &cfg,
+                                    ThrowOnCancel      thr)
+{
+    std::vector<Contour3D> parts(skeleton.size());
+
+    // The walls and the cavity of each pad part are triangulated concurrently
+    ccr::enumerate(skeleton.begin(), skeleton.end(),
+                   [&parts, &cfg, &thr](const ExPolygon &pad_part, size_t i) {
+                       parts[i] = create_outer_pad_part(pad_part, cfg, thr);
+                   });
+
+    return merge_parts(std::move(parts));
+}
+
 Contour3D create_inner_pad_geometry(const ExPolygons & skeleton,
                                     const PadConfig3D &cfg,
                                     ThrowOnCancel      thr)
 {
-    Contour3D ret;
+    std::vector<Contour3D> parts(skeleton.size());
 
     double z_max = 0., z_min = -cfg.height;
-    for (const ExPolygon &pad_part : skeleton) {
+    ccr::enumerate(skeleton.begin(), skeleton.end(),
+                   [&parts, z_max, z_min, &thr](const ExPolygon &pad_part, size_t i) {
+        Contour3D &ret = parts[i];
         ret.merge(straight_walls(pad_part.contour, z_max, z_min,thr));
 
         for (auto &h : pad_part.holes)
@@ -588,9 +641,9 @@ Contour3D create_inner_pad_geometry(const ExPolygons & skeleton,
 
         ret.merge(triangulate_expolygon_3d(pad_part, z_min, NORMALS_DOWN));
         ret.merge(triangulate_expolygon_3d(pad_part, z_max, NORMALS_UP));
-    }
+    });
 
-    return ret;
+    return merge_parts(std::move(parts));
 }
 
 Contour3D create_pad_geometry(const PadSkeleton &skelet,
@@ -612,17 +665,18 @@ Contour3D create_pad_geometry(const PadSkeleton &skelet,
 Contour3D create_pad_geometry(const ExPolygons &supp_bp,
                               const ExPolygons &model_bp,
                               const PadConfig & cfg,
-                              ThrowOnCancel thr)
+                              ThrowOnCancel thr,
+                              PadCache *cache)
 {
     PadSkeleton skelet;
 
     if (cfg.embed_object.enabled) {
         if (cfg.embed_object.everywhere)
-            skelet = BrimPadSkeleton(supp_bp, model_bp, cfg, thr);
+            skelet = BrimPadSkeleton(supp_bp, model_bp, cfg, thr, cache);
         else
-            skelet = AroundPadSkeleton(supp_bp, model_bp, cfg, thr);
+            skelet = AroundPadSkeleton(supp_bp, model_bp, cfg, thr, cache);
     } else
-        skelet = BelowPadSkeleton(supp_bp, model_bp, cfg, thr);
+        skelet = BelowPadSkeleton(supp_bp, model_bp, cfg, thr, cache);
 
     return create_pad_geometry(skelet, cfg, thr);
 }
@@ -671,13 +725,17 @@ void pad_blueprint(const TriangleMesh &mesh,
     pad_blueprint(mesh, output, slicegrid, thrfn);
 }
 
+void PadCache::clear() { *this = PadCache(); }
+
 void create_pad(const ExPolygons &sup_blueprint,
                 const ExPolygons &model_blueprint,
                 TriangleMesh &    out,
                 const PadConfig & cfg,
-                ThrowOnCancel thr)
+                ThrowOnCancel thr,
+                PadCache *cache)
 {
-    Contour3D t = create_pad_geometry(sup_blueprint, model_blueprint, cfg, thr);
+    Contour3D t = create_pad_geometry(sup_blueprint, model_blueprint, cfg, thr,
+                                      cache);
     out.merge(to_triangle_mesh(std::move(t)));
 }
 
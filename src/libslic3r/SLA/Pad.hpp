@@ -82,11 +82,31 @@ struct PadConfig {
     std::string validate() const;
 };
 
+/// Intermediate results of the pad generation which do not depend on most of
+/// the pad parameters. An instance is supposed to be kept along with the
+/// support mesh, so that changing e.g. the pad wall height or slope does not
+/// require to slice the supports and to calculate the concave hull again.
+struct PadCache {
+    // Silhouette of the support mesh sampled in the z range
+    ExPolygons support_contours;
+    float      support_zmin = 0.f, support_zmax = 0.f;
+    bool       support_contours_valid = false;
+
+    // Input of the concave hull, its merge distance and the resulting hull
+    Polygons hull_input;
+    double   hull_merge_dist = 0.;
+    Polygons hull;
+    bool     hull_valid = false;
+
+    void clear();
+};
+
 void create_pad(const ExPolygons &support_contours,
                 const ExPolygons &model_contours,
                 TriangleMesh &    output_mesh,
                 const PadConfig & = PadConfig(),
-                ThrowOnCancel throw_on_cancel = []{});
+                ThrowOnCancel throw_on_cancel = []{},
+                PadCache *        cache = nullptr);
 
 } // namespace sla
 } // namespace Slic3r
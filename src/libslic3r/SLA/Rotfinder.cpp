@@ -1,7 +1,13 @@
 #include <limits>
 #include <exception>
+#include <mutex>
+#include <random>
 
-#include <libnest2d/optimizers/nlopt/genetic.hpp>
+#include <tbb/parallel_for.h>
+#include <tbb/parallel_reduce.h>
+#include <tbb/blocked_range.h>
+
+#include <libnest2d/optimizers/nlopt/subplex.hpp>
 #include <libslic3r/SLA/Common.hpp>
 #include <libslic3r/SLA/Rotfinder.hpp>
 #include <libslic3r/SLA/SupportTree.hpp>
@@ -10,6 +16,76 @@
 namespace Slic3r {
 namespace sla {
 
+namespace {
+
+// Unit facet normals of a mesh stored as structure of arrays, so that the
+// score of a rotation can be evaluated with SIMD instructions without
+// transforming or copying the mesh itself.
+struct FacetNormals {
+    Eigen::ArrayXf nx, ny, nz;
+
+    explicit FacetNormals(const TriangleMesh &mesh)
+    {
+        const std::vector<stl_facet> &facets = mesh.stl.facet_start;
+        auto N = Eigen::Index(facets.size());
+        nx.resize(N); ny.resize(N); nz.resize(N);
+
+        tbb::parallel_for(tbb::blocked_range<Eigen::Index>(0, N, 4096),
+                          [this, &facets](const tbb::blocked_range<Eigen::Index> &r)
+        {
+            for (Eigen::Index i = r.begin(); i < r.end(); ++i) {
+                const stl_facet &f = facets[size_t(i)];
+                Vec3f U = f.vertex[1] - f.vertex[0];
+                Vec3f V = f.vertex[2] - f.vertex[0];
+
+                // So this is the normal. Degenerate facets yield a zero vector
+                // and do not contribute to the score.
+                Vec3f n = U.cross(V).normalized();
+                nx(i) = n.x(); ny(i) = n.y(); nz(i) = n.z();
+            }
+        });
+    }
+
+    Eigen::Index size() const { return nx.size(); }
+};
+
+// Block size of the parallel reduction over the facet normals.
+const constexpr Eigen::Index SCORE_BLOCK = 16384;
+
+// For all triangles we sum up the dot product of the rotated normal (a scalar
+// indicating how much are two vectors aligned) with each axis. This will
+// result in a value that is greater if a normal is aligned with all axes. If
+// the normal is aligned than the triangle itself is orthogonal to the axes and
+// that is good for print quality.
+//
+// The rotated normal is R * n, thus its dot product with the k-th axis is the
+// dot product of n with the k-th row of R.
+double rotation_score(const FacetNormals &normals, const Eigen::Matrix3d &R)
+{
+    Eigen::Matrix3f Rf = R.cast<float>();
+
+    // The deterministic reduction sums up the blocks in the same order in every
+    // call, thus the score of a rotation does not depend on the scheduling.
+    return tbb::parallel_deterministic_reduce(
+        tbb::blocked_range<Eigen::Index>(0, normals.size(), SCORE_BLOCK), 0.,
+        [&normals, &Rf](const tbb::blocked_range<Eigen::Index> &r, double sum)
+        {
+            auto len = r.end() - r.begin();
+            auto nx = normals.nx.segment(r.begin(), len);
+            auto ny = normals.ny.segment(r.begin(), len);
+            auto nz = normals.nz.segment(r.begin(), len);
+
+            for (int k = 0; k < 3; ++k)
+                sum += double((Rf(k, 0) * nx + Rf(k, 1) * ny + Rf(k, 2) * nz)
+                                  .abs().sum());
+
+            return sum;
+        },
+        std::plus<double>());
+}
+
+} // namespace
+
 std::array<double, 3> find_best_rotation(const ModelObject& modelobj,
                                          float accuracy,
                                          std::function<void(unsigned)> statuscb,
@@ -23,100 +99,114 @@ std::array<double, 3> find_best_rotation(const ModelObject& modelobj,
 
     static const unsigned MAX_TRIES = 100000;
 
+    // The search space of the x and y rotations is split into a grid of
+    // STARTS_PER_AXIS x STARTS_PER_AXIS cells and a local optimizer is started
+    // from a random point of each of them. The random points are drawn from
+    // a local generator with a fixed seed and the subplex optimizer itself is
+    // deterministic, it does not touch the global random generator of nlopt.
+    // Therefore the starts may run in parallel and the result is the same
+    // for the same input.
+    static const unsigned STARTS_PER_AXIS = 3;
+    static const unsigned STARTS = STARTS_PER_AXIS * STARTS_PER_AXIS;
+
     // return value
-    std::array<double, 3> rot;
+    std::array<double, 3> rot = {0., 0., 0.};
 
-    // We will use only one instance of this converted mesh to examine different
-    // rotations
-    EigenMesh3D emesh(modelobj.raw_mesh());
+    // The normals are calculated only once and shared by all the optimizers
+    // examining different rotations.
+    const FacetNormals normals(modelobj.raw_mesh());
 
-    // For current iteration number
+    // For current iteration number, shared by all the optimizers
     unsigned status = 0;
+    // The optimizers run in parallel, the status is updated and reported
+    // under a lock, one thread at a time.
+    std::mutex status_mutex;
 
-    // The maximum number of iterations
+    // The maximum number of iterations, split among the optimizer starts
     auto max_tries = unsigned(accuracy * MAX_TRIES);
 
     // call status callback with zero, because we are at the start
     statuscb(status);
 
-    // So this is the object function which is called by the solver many times
-    // It has to yield a single value representing the current score. We will
-    // call the status callback in each iteration but the actual value may be
-    // the same for subsequent iterations (status goes from 0 to 100 but
-    // iterations can be many more)
-    auto objfunc = [&emesh, &status, &statuscb, &stopcond, max_tries]
+    // So this is the object function which is called by the solvers many
+    // times. It has to yield a single value representing the current score.
+    // We will call the status callback in each iteration but the actual value
+    // may be the same for subsequent iterations (status goes from 0 to 100
+    // but iterations can be many more)
+    auto objfunc = [&normals, &status, &status_mutex, &statuscb, &stopcond, max_tries]
             (double rx, double ry, double rz)
     {
-        EigenMesh3D& m = emesh;
-
         // prepare the rotation transformation
-        Transform3d rt = Transform3d::Identity();
-
-        rt.rotate(Eigen::AngleAxisd(rz, Vec3d::UnitZ()));
-        rt.rotate(Eigen::AngleAxisd(ry, Vec3d::UnitY()));
-        rt.rotate(Eigen::AngleAxisd(rx, Vec3d::UnitX()));
-
-        double score = 0;
-
-        // For all triangles we calculate the normal and sum up the dot product
-        // (a scalar indicating how much are two vectors aligned) with each axis
-        // this will result in a value that is greater if a normal is aligned
-        // with all axes. If the normal is aligned than the triangle itself is
-        // orthogonal to the axes and that is good for print quality.
+        Eigen::Matrix3d R =
+            (Eigen::AngleAxisd(rz, Vec3d::UnitZ()) *
+             Eigen::AngleAxisd(ry, Vec3d::UnitY()) *
+             Eigen::AngleAxisd(rx, Vec3d::UnitX())).toRotationMatrix();
 
         // TODO: some applications optimize for minimum z-axis cross section
         // area. The current function is only an example of how to optimize.
 
         // Later we can add more criteria like the number of overhangs, etc...
-        for(int i = 0; i < m.F().rows(); i++) {
-            auto idx = m.F().row(i);
-
-            Vec3d p1 = m.V().row(idx(0));
-            Vec3d p2 = m.V().row(idx(1));
-            Vec3d p3 = m.V().row(idx(2));
-
-            Eigen::Vector3d U = p2 - p1;
-            Eigen::Vector3d V = p3 - p1;
-
-            // So this is the normal
-            auto n = U.cross(V).normalized();
-
-            // rotate the normal with the current rotation given by the solver
-            n = rt * n;
-
-            // We should score against the alignment with the reference planes
-            score += std::abs(n.dot(Vec3d::UnitX()));
-            score += std::abs(n.dot(Vec3d::UnitY()));
-            score += std::abs(n.dot(Vec3d::UnitZ()));
-        }
+        double score = rotation_score(normals, R);
 
         // report status
-        if(!stopcond()) statuscb( unsigned(++status * 100.0/max_tries) );
+        if(!stopcond()) {
+            std::lock_guard<std::mutex> lock(status_mutex);
+            statuscb( unsigned(++status * 100.0/max_tries) );
+        }
 
         return score;
     };
 
-    // Firing up the genetic optimizer. For now it uses the nlopt library.
-    StopCriteria stc;
-    stc.max_iterations = max_tries;
-    stc.relative_score_difference = 1e-3;
-    stc.stop_condition = stopcond;      // stop when stopcond returns true
-    TOptimizer<Method::G_GENETIC> solver(stc);
-
-    // We are searching rotations around the three axes x, y, z. Thus the
-    // problem becomes a 3 dimensional optimization task.
-    // We can specify the bounds for a dimension in the following way:
-    auto b = bound(-PI/2, PI/2);
-
-    // Now we start the optimization process with initial angles (0, 0, 0)
-    auto result = solver.optimize_max(objfunc,
-                                      libnest2d::opt::initvals(0.0, 0.0, 0.0),
-                                      b, b, b);
+    // The initial points of all the starts are drawn up front, so that they
+    // do not depend on the order in which the starts are executed.
+    const double span = PI / STARTS_PER_AXIS;
+    std::mt19937 rng(0);
+    std::uniform_real_distribution<double> cell_dist(0., span);
+    std::uniform_real_distribution<double> z_dist(-PI / 2, PI / 2);
+    std::array<std::array<double, 3>, STARTS> initvals;
+    for (unsigned n = 0; n < STARTS; ++n) {
+        initvals[n][0] = -PI / 2 + span * (n % STARTS_PER_AXIS) + cell_dist(rng);
+        initvals[n][1] = -PI / 2 + span * (n / STARTS_PER_AXIS) + cell_dist(rng);
+        initvals[n][2] = z_dist(rng);
+    }
+
+    using Result = libnest2d::opt::Result<double, double, double>;
+    std::vector<Result> results(STARTS);
+
+    tbb::parallel_for(0u, STARTS, [&](unsigned n) {
+        StopCriteria stc;
+        stc.max_iterations = std::max(1u, max_tries / STARTS);
+        stc.relative_score_difference = 1e-3;
+        stc.stop_condition = stopcond;      // stop when stopcond returns true
+        TOptimizer<Method::L_SUBPLEX> solver(stc);
+
+        // We are searching rotations around the three axes x, y, z. Thus the
+        // problem becomes a 3 dimensional optimization task. Each start
+        // searches its own cell of the x, y rotations.
+        double xmin = -PI / 2 + span * (n % STARTS_PER_AXIS);
+        double ymin = -PI / 2 + span * (n / STARTS_PER_AXIS);
+        auto bx = bound(xmin, xmin + span);
+        auto by = bound(ymin, ymin + span);
+        auto bz = bound(-PI/2, PI/2);
+
+        results[n] = solver.optimize_max(objfunc,
+                                         libnest2d::opt::initvals(initvals[n][0],
+                                                                  initvals[n][1],
+                                                                  initvals[n][2]),
+                                         bx, by, bz);
+    });
+
+    // The first of the equally good results wins, independently of the order
+    // in which the starts finished.
+    auto best = std::max_element(results.begin(), results.end(),
+                                 [](const Result &a, const Result &b) {
+                                     return a.score < b.score;
+                                 });
 
     // Save the result and fck off
-    rot[0] = std::get<0>(result.optimum);
-    rot[1] = std::get<1>(result.optimum);
-    rot[2] = std::get<2>(result.optimum);
+    rot[0] = std::get<0>(best->optimum);
+    rot[1] = std::get<1>(best->optimum);
+    rot[2] = std::get<2>(best->optimum);
 
     return rot;
 }
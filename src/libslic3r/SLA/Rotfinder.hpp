@@ -15,10 +15,13 @@ namespace sla {
   *
   * @param modelobj The model object representing the 3d mesh.
   * @param accuracy The optimization accuracy from 0.0f to 1.0f. Currently,
-  * the nlopt genetic optimizer is used and the number of iterations is
-  * accuracy * 100000. This can change in the future.
+  * the nlopt subplex optimizer is started in parallel from several seeded
+  * random points and the number of iterations is accuracy * 100000, split
+  * among the starts. The result is the same for the same input.
+  * This can change in the future.
   * @param statuscb A status indicator callback called with the unsigned
-  * argument spanning from 0 to 100. May not reach 100 if the optimization finds
+  * argument spanning from 0 to 100. It may be called from worker threads,
+  * but never concurrently. May not reach 100 if the optimization finds
   * an optimum before max iterations are reached.
   * @param stopcond A function that if returns true, the search process will be
   * terminated and the best solution found will be returned.
@@ -284,6 +284,12 @@ void SupportPointGenerator::process(const std::vector<ExPolygons>& slices, const
     }
 }
 
+// Number of random samples generated by a single task of the tiled sampler.
+// Each tile gets its own random generator seeded from the caller's generator,
+// so that the result is deterministic for a seeded generator irrespective of
+// the number of worker threads.
+static constexpr size_t SAMPLES_PER_TILE = 4096;
+
 std::vector<Vec2f> sample_expolygon(const ExPolygon &expoly, float samples_per_mm2, std::mt19937 &rng)
 {
     // Triangulate the polygon with holes into triplets of 3D points.
@@ -306,20 +312,31 @@ std::vector<Vec2f> sample_expolygon(const ExPolygon &expoly, float samples_per_m
         }
 
         size_t num_samples = size_t(ceil(areas.back() * samples_per_mm2));
-        std::uniform_real_distribution<> random_triangle(0., double(areas.back()));
-        std::uniform_real_distribution<> random_float(0., 1.);
-        for (size_t i = 0; i < num_samples; ++ i) {
-            double r = random_triangle(rng);
-            size_t idx_triangle = std::min<size_t>(std::upper_bound(areas.begin(), areas.end(), (float)r) - areas.begin(), areas.size() - 1) * 3;
-            // Select a random point on the triangle.
-            double u = float(sqrt(random_float(rng)));
-            double v = float(random_float(rng));
-            const Vec2f &a = triangles[idx_triangle ++];
-            const Vec2f &b = triangles[idx_triangle++];
-            const Vec2f &c = triangles[idx_triangle];
-            const Vec2f  x = a * (1.f - u) + b * (u * (1.f - v)) + c * (v * u);
-            out.emplace_back(x);
-        }
+        out.assign(num_samples, Vec2f::Zero());
+
+        // Seeds of the tiles are drawn sequentially to keep the sampling repeatable.
+        size_t num_tiles = (num_samples + SAMPLES_PER_TILE - 1) / SAMPLES_PER_TILE;
+        std::vector<std::mt19937::result_type> tile_seeds(num_tiles);
+        for (auto &seed : tile_seeds)
+            seed = rng();
+
+        tbb::parallel_for(size_t(0), num_tiles, [&out, &triangles, &areas, &tile_seeds, num_samples](size_t tile_id) {
+            std::mt19937 tile_rng(tile_seeds[tile_id]);
+            std::uniform_real_distribution<> random_triangle(0., double(areas.back()));
+            std::uniform_real_distribution<> random_float(0., 1.);
+            size_t i_end = std::min(num_samples, (tile_id + 1) * SAMPLES_PER_TILE);
+            for (size_t i = tile_id * SAMPLES_PER_TILE; i < i_end; ++ i) {
+                double r = random_triangle(tile_rng);
+                size_t idx_triangle = std::min<size_t>(std::upper_bound(areas.begin(), areas.end(), (float)r) - areas.begin(), areas.size() - 1) * 3;
+                // Select a random point on the triangle.
+                double u = float(sqrt(random_float(tile_rng)));
+                double v = float(random_float(tile_rng));
+                const Vec2f &a = triangles[idx_triangle ++];
+                const Vec2f &b = triangles[idx_triangle++];
+                const Vec2f &c = triangles[idx_triangle];
+                out[i] = a * (1.f - u) + b * (u * (1.f - v)) + c * (v * u);
+            }
+        });
     }
     return out;
 }
@@ -339,15 +356,38 @@ std::vector<Vec2f> sample_expolygon_with_boundary(const ExPolygon &expoly, float
 
 std::vector<Vec2f> sample_expolygon_with_boundary(const ExPolygons &expolys, float samples_per_mm2, float samples_per_mm_boundary, std::mt19937 &rng)
 {
+    // Sample the islands concurrently, each island with its own generator seeded from rng.
+    std::vector<std::mt19937::result_type> seeds(expolys.size());
+    for (auto &seed : seeds)
+        seed = rng();
+    std::vector<std::vector<Vec2f>> samples(expolys.size());
+    tbb::parallel_for(size_t(0), expolys.size(), [&expolys, &samples, &seeds, samples_per_mm2, samples_per_mm_boundary](size_t idx) {
+        std::mt19937 island_rng(seeds[idx]);
+        samples[idx] = sample_expolygon_with_boundary(expolys[idx], samples_per_mm2, samples_per_mm_boundary, island_rng);
+    });
+
+    size_t cnt = 0;
+    for (const std::vector<Vec2f> &s : samples)
+        cnt += s.size();
     std::vector<Vec2f> out;
-    for (const ExPolygon &expoly : expolys)
-        append(out, sample_expolygon_with_boundary(expoly, samples_per_mm2, samples_per_mm_boundary, rng));
+    out.reserve(cnt);
+    for (const std::vector<Vec2f> &s : samples)
+        append(out, s);
     return out;
 }
 
+// Parallel Poisson disk sampling from a set of raw samples after Li-Yi Wei, "Parallel Poisson disk sampling".
+// The raw samples are binned into a grid with the cell size equal to the Poisson radius. The cells are stored
+// in a flat vector ordered lexicographically and looked up through an open addressing hash table.
+// In each trial, a single candidate per cell is tested against the already accepted samples of the neighboring cells.
+// The cells are split into 3x3 phase groups: cells of the same phase do not share any neighbor,
+// therefore the cells of a single phase are processed concurrently without any locking.
 template<typename REFUSE_FUNCTION>
 static inline std::vector<Vec2f> poisson_disk_from_samples(const std::vector<Vec2f> &raw_samples, float radius, REFUSE_FUNCTION refuse_function)
 {
+    if (raw_samples.empty())
+        return {};
+
     Vec2f corner_min(std::numeric_limits<float>::max(), std::numeric_limits<float>::max());
     for (const Vec2f &pt : raw_samples) {
         corner_min.x() = std::min(corner_min.x(), pt.x());
@@ -359,14 +399,17 @@ static inline std::vector<Vec2f> poisson_disk_from_samples(const std::vector<Vec
         Vec2f coord;
         Vec2i cell_id;
     };
-    std::vector<RawSample> raw_samples_sorted;
-    RawSample sample;
-    for (const Vec2f &pt : raw_samples) {
-        sample.coord   = pt;
-        sample.cell_id = ((pt - corner_min) / radius).cast<int>();
-        raw_samples_sorted.emplace_back(sample);
-    }
-    std::sort(raw_samples_sorted.begin(), raw_samples_sorted.end(), [](const RawSample &lhs, const RawSample &rhs)
+    std::vector<RawSample> raw_samples_sorted(raw_samples.size());
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, raw_samples.size(), 4096),
+        [&raw_samples, &raw_samples_sorted, &corner_min, radius](const tbb::blocked_range<size_t> &range) {
+            for (size_t i = range.begin(); i < range.end(); ++ i) {
+                RawSample &sample = raw_samples_sorted[i];
+                sample.coord   = raw_samples[i];
+                sample.cell_id = ((raw_samples[i] - corner_min) / radius).cast<int>();
+            }
+        });
+    // Stable sort keeps the order of raw samples inside a cell, which is the order in which they are tried.
+    std::stable_sort(raw_samples_sorted.begin(), raw_samples_sorted.end(), [](const RawSample &lhs, const RawSample &rhs)
         { return lhs.cell_id.x() < rhs.cell_id.x() || (lhs.cell_id.x() == rhs.cell_id.x() && lhs.cell_id.y() < rhs.cell_id.y()); });
 
     struct PoissonDiskGridEntry {
@@ -377,86 +420,103 @@ static inline std::vector<Vec2f> poisson_disk_from_samples(const std::vector<Vec
         Vec2f   poisson_samples[max_positions];
         int     num_poisson_samples = 0;
 
+        Vec2i   cell_id;
         // Index into raw_samples:
         int     first_sample_idx;
         int     sample_cnt;
     };
 
-    struct CellIDHash {
-        std::size_t operator()(const Vec2i &cell_id) const {
-            return std::hash<int>()(cell_id.x()) ^ std::hash<int>()(cell_id.y() * 593);
+    // Flat vector of non-empty cells, each one pointing to its range in raw_samples_sorted.
+    std::vector<PoissonDiskGridEntry> cells;
+    for (size_t i = 0; i < raw_samples_sorted.size(); ++ i) {
+        const RawSample &sample = raw_samples_sorted[i];
+        if (! cells.empty() && sample.cell_id == cells.back().cell_id) {
+            // This sample is in the same cell as the previous, so just increase the count.  Cells are
+            // always contiguous, since we've sorted raw_samples_sorted by cell ID.
+            ++ cells.back().sample_cnt;
+        } else {
+            // This is a new cell.
+            PoissonDiskGridEntry data;
+            data.cell_id          = sample.cell_id;
+            data.first_sample_idx = int(i);
+            data.sample_cnt       = 1;
+            cells.emplace_back(data);
         }
-    };
+    }
 
-    // Map from cell IDs to hash_data.  Each hash_data points to the range in raw_samples corresponding to that cell.
-    // (We could just store the samples in hash_data.  This implementation is an artifact of the reference paper, which
-    // is optimizing for GPU acceleration that we haven't implemented currently.)
-    typedef std::unordered_map<Vec2i, PoissonDiskGridEntry, CellIDHash> Cells;
-    Cells cells;
-    {
-        typename Cells::iterator last_cell_id_it;
-        Vec2i           last_cell_id(-1, -1);
-        for (size_t i = 0; i < raw_samples_sorted.size(); ++ i) {
-            const RawSample &sample = raw_samples_sorted[i];
-            if (sample.cell_id == last_cell_id) {
-                // This sample is in the same cell as the previous, so just increase the count.  Cells are
-                // always contiguous, since we've sorted raw_samples_sorted by cell ID.
-                ++ last_cell_id_it->second.sample_cnt;
-            } else {
-                // This is a new cell.
-                PoissonDiskGridEntry data;
-                data.first_sample_idx = int(i);
-                data.sample_cnt       = 1;
-                auto result     = cells.insert({sample.cell_id, data});
-                last_cell_id    = sample.cell_id;
-                last_cell_id_it = result.first;
-            }
-        }
+    // Open addressing hash table mapping a cell ID to an index into cells. Load factor is kept below 0.5.
+    size_t table_size = 16;
+    while (table_size < 2 * cells.size())
+        table_size <<= 1;
+    const size_t table_mask = table_size - 1;
+    auto cell_hash = [table_mask](const Vec2i &cell_id) {
+        return (size_t(uint32_t(cell_id.x()) * 73856093u) ^ size_t(uint32_t(cell_id.y()) * 19349663u)) & table_mask;
+    };
+    std::vector<int> table(table_size, -1);
+    for (size_t i = 0; i < cells.size(); ++ i) {
+        size_t slot = cell_hash(cells[i].cell_id);
+        while (table[slot] != -1)
+            slot = (slot + 1) & table_mask;
+        table[slot] = int(i);
     }
+    auto find_cell = [&table, &cells, &cell_hash, table_mask](const Vec2i &cell_id) -> const PoissonDiskGridEntry* {
+        for (size_t slot = cell_hash(cell_id); table[slot] != -1; slot = (slot + 1) & table_mask)
+            if (cells[table[slot]].cell_id == cell_id)
+                return &cells[table[slot]];
+        return nullptr;
+    };
+
+    // Split the cells into 3x3 phase groups. Cell IDs are non-negative, as they are measured from corner_min.
+    std::vector<int> phases[9];
+    for (size_t i = 0; i < cells.size(); ++ i)
+        phases[(cells[i].cell_id.x() % 3) * 3 + cells[i].cell_id.y() % 3].emplace_back(int(i));
 
     const int   max_trials = 5;
     const float radius_squared = radius * radius;
     for (int trial = 0; trial < max_trials; ++ trial) {
-        // Create sample points for each entry in cells.
-        for (auto &it : cells) {
-            const Vec2i          &cell_id   = it.first;
-            PoissonDiskGridEntry &cell_data = it.second;
-            // This cell's raw sample points start at first_sample_idx.  On trial 0, try the first one. On trial 1, try first_sample_idx + 1.
-            int next_sample_idx = cell_data.first_sample_idx + trial;
-            if (trial >= cell_data.sample_cnt)
-                // There are no more points to try for this cell.
-                continue;
-            const RawSample &candidate = raw_samples_sorted[next_sample_idx];
-            // See if this point conflicts with any other points in this cell, or with any points in
-            // neighboring cells.  Note that it's possible to have more than one point in the same cell.
-            bool conflict = refuse_function(candidate.coord);
-            for (int i = -1; i < 2 && ! conflict; ++ i) {
-                for (int j = -1; j < 2; ++ j) {
-                    const auto &it_neighbor = cells.find(cell_id + Vec2i(i, j));
-                    if (it_neighbor != cells.end()) {
-                        const PoissonDiskGridEntry &neighbor = it_neighbor->second;
-                        for (int i_sample = 0; i_sample < neighbor.num_poisson_samples; ++ i_sample)
-                            if ((neighbor.poisson_samples[i_sample] - candidate.coord).squaredNorm() < radius_squared) {
-                                conflict = true;
-                                break;
+        for (const std::vector<int> &phase : phases) {
+            // Create sample points for each entry in cells of this phase.
+            tbb::parallel_for(tbb::blocked_range<size_t>(0, phase.size(), 64),
+                [&](const tbb::blocked_range<size_t> &range) {
+                for (size_t i_cell = range.begin(); i_cell < range.end(); ++ i_cell) {
+                    PoissonDiskGridEntry &cell_data = cells[phase[i_cell]];
+                    // This cell's raw sample points start at first_sample_idx.  On trial 0, try the first one. On trial 1, try first_sample_idx + 1.
+                    int next_sample_idx = cell_data.first_sample_idx + trial;
+                    if (trial >= cell_data.sample_cnt)
+                        // There are no more points to try for this cell.
+                        continue;
+                    const RawSample &candidate = raw_samples_sorted[next_sample_idx];
+                    // See if this point conflicts with any other points in this cell, or with any points in
+                    // neighboring cells.  Note that it's possible to have more than one point in the same cell.
+                    bool conflict = refuse_function(candidate.coord);
+                    for (int i = -1; i < 2 && ! conflict; ++ i) {
+                        for (int j = -1; j < 2 && ! conflict; ++ j) {
+                            const PoissonDiskGridEntry *neighbor = find_cell(cell_data.cell_id + Vec2i(i, j));
+                            if (neighbor != nullptr) {
+                                for (int i_sample = 0; i_sample < neighbor->num_poisson_samples; ++ i_sample)
+                                    if ((neighbor->poisson_samples[i_sample] - candidate.coord).squaredNorm() < radius_squared) {
+                                        conflict = true;
+                                        break;
+                                    }
                             }
+                        }
+                    }
+                    if (! conflict) {
+                        // Store the new sample.
+                        assert(cell_data.num_poisson_samples < cell_data.max_positions);
+                        if (cell_data.num_poisson_samples < cell_data.max_positions)
+                            cell_data.poisson_samples[cell_data.num_poisson_samples ++] = candidate.coord;
                     }
                 }
-            }
-            if (! conflict) {
-                // Store the new sample.
-                assert(cell_data.num_poisson_samples < cell_data.max_positions);
-                if (cell_data.num_poisson_samples < cell_data.max_positions)
-                    cell_data.poisson_samples[cell_data.num_poisson_samples ++] = candidate.coord;
-            }
+            });
         }
     }
 
     // Copy the results to the output.
     std::vector<Vec2f> out;
-    for (const auto& it : cells)
-        for (int i = 0; i < it.second.num_poisson_samples; ++ i)
-            out.emplace_back(it.second.poisson_samples[i]);
+    for (const PoissonDiskGridEntry &cell : cells)
+        for (int i = 0; i < cell.num_poisson_samples; ++ i)
+            out.emplace_back(cell.poisson_samples[i]);
     return out;
 }
 
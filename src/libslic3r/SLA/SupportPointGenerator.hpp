@@ -216,6 +216,13 @@ private:
 
 void remove_bottom_points(std::vector<SupportPoint> &pts, double gnd_lvl, double tolerance);
 
+// Random samples uniformly distributed over the area of the island. The samples are generated
+// concurrently in tiles, the result is deterministic for a given state of rng.
+std::vector<Vec2f> sample_expolygon(const ExPolygon &expoly, float samples_per_mm2, std::mt19937 &rng);
+// Random samples over the area of the islands plus equally spaced samples along their contours.
+std::vector<Vec2f> sample_expolygon_with_boundary(const ExPolygon &expoly, float samples_per_mm2, float samples_per_mm_boundary, std::mt19937 &rng);
+std::vector<Vec2f> sample_expolygon_with_boundary(const ExPolygons &expolys, float samples_per_mm2, float samples_per_mm_boundary, std::mt19937 &rng);
+
 }} // namespace Slic3r::sla
 
 #endif // SUPPORTPOINTGENERATOR_HPP
@@ -96,14 +96,59 @@ std::vector<ExPolygons> SupportTree::slice(
     return mrg;
 }
 
+void SupportTreeCache::validate(const EigenMesh3D &  emesh,
+                                const SupportConfig &cfg,
+                                double               ground_level)
+{
+    if (m_emesh != &emesh ||
+        m_head_front_radius_mm != cfg.head_front_radius_mm ||
+        m_head_back_radius_mm != cfg.head_back_radius_mm ||
+        m_head_width_mm != cfg.head_width_mm ||
+        m_head_penetration_mm != cfg.head_penetration_mm ||
+        m_ground_level != ground_level) {
+        m_records.clear();
+        m_emesh                = &emesh;
+        m_head_front_radius_mm = cfg.head_front_radius_mm;
+        m_head_back_radius_mm  = cfg.head_back_radius_mm;
+        m_head_width_mm        = cfg.head_width_mm;
+        m_head_penetration_mm  = cfg.head_penetration_mm;
+        m_ground_level         = ground_level;
+    }
+}
+
+SupportTreeCache::Record *SupportTreeCache::find(const SupportPoint &sp)
+{
+    auto it = m_records.find(Key(sp));
+    return it == m_records.end() ? nullptr : &it->second;
+}
+
+const SupportTreeCache::Record *SupportTreeCache::find(const SupportPoint &sp) const
+{
+    auto it = m_records.find(Key(sp));
+    return it == m_records.end() ? nullptr : &it->second;
+}
+
+void SupportTreeCache::assign(const SupportPoints &        pts,
+                              const std::vector<unsigned> &indices,
+                              const std::vector<Record> &  records)
+{
+    assert(indices.size() == records.size());
+
+    m_records.clear();
+    m_records.reserve(indices.size());
+    for (size_t i = 0; i < indices.size(); ++i)
+        m_records.emplace(Key(pts[indices[i]]), records[i]);
+}
+
 SupportTree::UPtr SupportTree::create(const SupportableMesh &sm,
-                                      const JobController &  ctl)
+                                      const JobController &  ctl,
+                                      SupportTreeCache *     cache)
 {
     auto builder = make_unique<SupportTreeBuilder>();
     builder->m_ctl = ctl;
     
     if (sm.cfg.enabled) {
-        builder->build(sm);
+        builder->build(sm, cache);
         builder->merge_and_cleanup();   // clean metadata, leave only the meshes.
     } else {
         builder->ground_level = sm.emesh.ground_level();
@@ -3,6 +3,7 @@
 
 #include <vector>
 #include <memory>
+#include <unordered_map>
 #include <Eigen/Geometry>
 
 #include <libslic3r/SLA/Common.hpp>
@@ -129,6 +130,80 @@ struct SupportableMesh
     {}
 };
 
+/// Results of the point-local stages of the support tree generation: the
+/// corrected orientation of the pinhead and the scan from the head towards the
+/// ground. These stages dominate the build time and do not depend on the
+/// other support points, so they are kept between subsequent builds over the
+/// same mesh. After editing a few support points, only the new points are
+/// optimized again, while the routing is rebuilt from the cached heads.
+class SupportTreeCache
+{
+public:
+    enum class Role {
+        Discarded,  // The tilt of the surface normal is not supportable
+        Unroutable, // Neither a pinhead nor a headless stick fits
+        Head,       // Full pinhead
+        Headless    // Headless stick
+    };
+
+    struct Record {
+        Vec3d normal = Vec3d::Zero(); // corrected direction of the head
+        Role  role   = Role::Discarded;
+
+        bool has_ground_scan = false;
+        EigenMesh3D::hit_result ground_scan;
+    };
+
+    /// Drop all the records if they were calculated with a different mesh,
+    /// head geometry or ground level.
+    void validate(const EigenMesh3D &emesh, const SupportConfig &cfg, double ground_level);
+
+    Record *find(const SupportPoint &sp);
+    const Record *find(const SupportPoint &sp) const;
+
+    /// Replace the content of the cache with the given records. Records of
+    /// the support points not present anymore are dropped this way.
+    void assign(const SupportPoints &pts,
+                const std::vector<unsigned> &indices,
+                const std::vector<Record> &records);
+
+    void clear() { m_records.clear(); }
+    size_t size() const { return m_records.size(); }
+
+private:
+    struct Key {
+        Vec3f pos;
+        float head_front_radius;
+
+        explicit Key(const SupportPoint &sp)
+            : pos(sp.pos), head_front_radius(sp.head_front_radius)
+        {}
+
+        bool operator==(const Key &k) const
+        {
+            return pos == k.pos && head_front_radius == k.head_front_radius;
+        }
+    };
+
+    struct KeyHash {
+        size_t operator()(const Key &k) const
+        {
+            std::hash<float> h;
+            size_t ret = h(k.head_front_radius);
+            for (int i = 0; i < 3; ++i)
+                ret ^= h(k.pos(i)) + 0x9e3779b9 + (ret << 6) + (ret >> 2);
+            return ret;
+        }
+    };
+
+    std::unordered_map<Key, Record, KeyHash> m_records;
+
+    const EigenMesh3D *m_emesh = nullptr;
+    double m_head_front_radius_mm = 0., m_head_back_radius_mm = 0.;
+    double m_head_width_mm = 0., m_head_penetration_mm = 0.;
+    double m_ground_level = 0.;
+};
+
 /// The class containing mesh data for the generated supports.
 class SupportTree
 {
@@ -136,8 +211,11 @@ class SupportTree
 public:
     using UPtr = std::unique_ptr<SupportTree>;
     
+    /// The optional cache is used to reuse the results of the previous
+    /// build with the same mesh and is updated with the new results.
     static UPtr create(const SupportableMesh &input,
-                       const JobController &ctl = {});
+                       const JobController &ctl = {},
+                       SupportTreeCache *cache = nullptr);
 
     virtual ~SupportTree() = default;
 
@@ -337,7 +337,8 @@ Pad::Pad(const TriangleMesh &support_mesh,
          const ExPolygons &  model_contours,
          double              ground_level,
          const PadConfig &   pcfg,
-         ThrowOnCancel       thr)
+         ThrowOnCancel       thr,
+         PadCache *          cache)
     : cfg(pcfg)
     , zlevel(ground_level + pcfg.full_height() - pcfg.required_elevation())
 {
@@ -348,8 +349,21 @@ Pad::Pad(const TriangleMesh &support_mesh,
     float zstart = float(zlevel);
     float zend   = zstart + float(pcfg.full_height() + EPSILON);
     
-    pad_blueprint(support_mesh, sup_contours, grid(zstart, zend, 0.1f), thr);
-    create_pad(sup_contours, model_contours, tmesh, pcfg);
+    if (cache && cache->support_contours_valid &&
+        cache->support_zmin == zstart && cache->support_zmax == zend) {
+        sup_contours = cache->support_contours;
+    } else {
+        pad_blueprint(support_mesh, sup_contours, grid(zstart, zend, 0.1f), thr);
+        
+        if (cache) {
+            cache->support_contours       = sup_contours;
+            cache->support_zmin           = zstart;
+            cache->support_zmax           = zend;
+            cache->support_contours_valid = true;
+        }
+    }
+    
+    create_pad(sup_contours, model_contours, tmesh, pcfg, thr, cache);
     
     tmesh.translate(0, 0, float(zlevel));
     if (!tmesh.empty()) tmesh.require_shared_vertices();
@@ -358,7 +372,11 @@ Pad::Pad(const TriangleMesh &support_mesh,
 const TriangleMesh &SupportTreeBuilder::add_pad(const ExPolygons &modelbase,
                                                 const PadConfig & cfg)
 {
-    m_pad = Pad{merged_mesh(), modelbase, ground_level, cfg, ctl().cancelfn};
+    // The cached support silhouette is stale if the support mesh changed
+    if (!m_meshcache_valid) m_pad_cache.clear();
+    
+    m_pad = Pad{merged_mesh(), modelbase, ground_level, cfg, ctl().cancelfn,
+                &m_pad_cache};
     return m_pad.tmesh;
 }
 
@@ -370,6 +388,7 @@ SupportTreeBuilder::SupportTreeBuilder(SupportTreeBuilder &&o)
     , m_crossbridges{std::move(o.m_crossbridges)}
     , m_compact_bridges{std::move(o.m_compact_bridges)}
     , m_pad{std::move(o.m_pad)}
+    , m_pad_cache{std::move(o.m_pad_cache)}
     , m_meshcache{std::move(o.m_meshcache)}
     , m_meshcache_valid{o.m_meshcache_valid}
     , m_model_height{o.m_model_height}
@@ -384,6 +403,7 @@ SupportTreeBuilder::SupportTreeBuilder(const SupportTreeBuilder &o)
     , m_crossbridges{o.m_crossbridges}
     , m_compact_bridges{o.m_compact_bridges}
     , m_pad{o.m_pad}
+    , m_pad_cache{o.m_pad_cache}
     , m_meshcache{o.m_meshcache}
     , m_meshcache_valid{o.m_meshcache_valid}
     , m_model_height{o.m_model_height}
@@ -399,6 +419,7 @@ SupportTreeBuilder &SupportTreeBuilder::operator=(SupportTreeBuilder &&o)
     m_crossbridges = std::move(o.m_crossbridges);
     m_compact_bridges = std::move(o.m_compact_bridges);
     m_pad = std::move(o.m_pad);
+    m_pad_cache = std::move(o.m_pad_cache);
     m_meshcache = std::move(o.m_meshcache);
     m_meshcache_valid = o.m_meshcache_valid;
     m_model_height = o.m_model_height;
@@ -415,6 +436,7 @@ SupportTreeBuilder &SupportTreeBuilder::operator=(const SupportTreeBuilder &o)
     m_crossbridges = o.m_crossbridges;
     m_compact_bridges = o.m_compact_bridges;
     m_pad = o.m_pad;
+    m_pad_cache = o.m_pad_cache;
     m_meshcache = o.m_meshcache;
     m_meshcache_valid = o.m_meshcache_valid;
     m_model_height = o.m_model_height;
@@ -514,10 +536,11 @@ const TriangleMesh &SupportTreeBuilder::retrieve_mesh(MeshType meshtype) const
     return m_meshcache;
 }
 
-bool SupportTreeBuilder::build(const SupportableMesh &sm)
+bool SupportTreeBuilder::build(const SupportableMesh &sm,
+                               SupportTreeCache *     cache)
 {
     ground_level = sm.emesh.ground_level() - sm.cfg.object_elevation_mm;
-    return SupportTreeBuildsteps::execute(*this, sm);
+    return SupportTreeBuildsteps::execute(*this, sm, cache);
 }
 
 }
@@ -237,7 +237,8 @@ struct Pad {
         const ExPolygons &  model_contours,
         double              ground_level,
         const PadConfig &   pcfg,
-        ThrowOnCancel       thr);
+        ThrowOnCancel       thr,
+        PadCache *          cache = nullptr);
     
     bool empty() const { return tmesh.facets_count() == 0; }
 };
@@ -267,6 +268,10 @@ class SupportTreeBuilder: public SupportTree {
     std::vector<CompactBridge> m_compact_bridges;    
     Pad m_pad;
     
+    // Support silhouette and concave hull of the last pad, reused when only
+    // the pad parameters change.
+    PadCache m_pad_cache;
+    
     using Mutex = ccr::SpinningMutex;
     
     mutable TriangleMesh m_meshcache;
@@ -489,7 +494,8 @@ public:
     virtual const TriangleMesh &retrieve_mesh(
         MeshType meshtype = MeshType::Support) const override;
 
-    bool build(const SupportableMesh &supportable_mesh);
+    bool build(const SupportableMesh &supportable_mesh,
+               SupportTreeCache *     cache = nullptr);
 };
 
 }} // namespace Slic3r::sla
@@ -16,7 +16,8 @@ using libnest2d::opt::GeneticOptimizer;
 using libnest2d::opt::SubplexOptimizer;
 
 SupportTreeBuildsteps::SupportTreeBuildsteps(SupportTreeBuilder &   builder,
-                                             const SupportableMesh &sm)
+                                             const SupportableMesh &sm,
+                                             SupportTreeCache *     cache)
     : m_cfg(sm.cfg)
     , m_mesh(sm.emesh)
     , m_support_pts(sm.pts)
@@ -24,7 +25,10 @@ SupportTreeBuildsteps::SupportTreeBuildsteps(SupportTreeBuilder &   builder,
     , m_builder(builder)
     , m_points(sm.pts.size(), 3)
     , m_thr(builder.ctl().cancelfn)
+    , m_cache(cache ? *cache : m_own_cache)
 {
+    m_cache.validate(m_mesh, m_cfg, m_builder.ground_level);
+
     // Prepare the support points in Eigen/IGL format as well, we will use
     // it mostly in this form.
     
@@ -38,11 +42,12 @@ SupportTreeBuildsteps::SupportTreeBuildsteps(SupportTreeBuilder &   builder,
 }
 
 bool SupportTreeBuildsteps::execute(SupportTreeBuilder &   builder,
-                                    const SupportableMesh &sm)
+                                    const SupportableMesh &sm,
+                                    SupportTreeCache *     cache)
 {
     if(sm.pts.empty()) return false;
     
-    SupportTreeBuildsteps alg(builder, sm);
+    SupportTreeBuildsteps alg(builder, sm, cache);
     
     // Let's define the individual steps of the processing. We can experiment
     // later with the ordering and the dependencies between them.
@@ -667,8 +672,108 @@ void SupportTreeBuildsteps::create_ground_pillar(const Vec3d &jp,
         m_pillar_index.guarded_insert(endp, unsigned(pillar_id));
 }
 
+SupportTreeCache::Record SupportTreeBuildsteps::filter_point(unsigned     fidx,
+                                                             const Vec3d &n)
+{
+    using Role = SupportTreeCache::Role;
+    SupportTreeCache::Record rec;
+
+    // for all normals we generate the spherical coordinates and
+    // saturate the polar angle to 45 degrees from the bottom then
+    // convert back to standard coordinates to get the new normal.
+    // Then we just create a quaternion from the two normals
+    // (Quaternion::FromTwoVectors) and apply the rotation to the
+    // arrow head.
+
+    auto [polar, azimuth] = dir_to_spheric(n);
+
+    // skip if the tilt is not sane
+    if(polar < PI - m_cfg.normal_cutoff_angle) return rec;
+
+    // We saturate the polar angle to 3pi/4
+    polar = std::max(polar, 3*PI / 4);
+
+    // save the head (pinpoint) position
+    Vec3d hp = m_points.row(fidx);
+
+    double w = m_cfg.head_width_mm +
+               m_cfg.head_back_radius_mm +
+               2*m_cfg.head_front_radius_mm;
+
+    double pin_r = double(m_support_pts[fidx].head_front_radius);
+
+    // Reassemble the now corrected normal
+    auto nn = spheric_to_dir(polar, azimuth).normalized();
+
+    // check available distance
+    EigenMesh3D::hit_result t
+        = pinhead_mesh_intersect(hp, // touching point
+                                 nn, // normal
+                                 pin_r,
+                                 m_cfg.head_back_radius_mm,
+                                 w);
+
+    if(t.distance() <= w) {
+
+        // Let's try to optimize this angle, there might be a
+        // viable normal that doesn't collide with the model
+        // geometry and its very close to the default.
+
+        StopCriteria stc;
+        stc.max_iterations = m_cfg.optimizer_max_iterations;
+        stc.relative_score_difference = m_cfg.optimizer_rel_score_diff;
+        stc.stop_score = w; // space greater than w is enough
+        GeneticOptimizer solver(stc);
+        solver.seed(0); // we want deterministic behavior
+
+        auto oresult = solver.optimize_max(
+            [this, pin_r, w, hp](double plr, double azm)
+            {
+                auto dir = spheric_to_dir(plr, azm).normalized();
+
+                double score = pinhead_mesh_distance(
+                    hp, dir, pin_r, m_cfg.head_back_radius_mm, w);
+
+                return score;
+            },
+            initvals(polar, azimuth), // start with what we have
+            bound(3 * PI / 4, PI),    // Must not exceed the tilt limit
+            bound(-PI, PI) // azimuth can be a full search
+            );
+
+        if(oresult.score > w) {
+            polar = std::get<0>(oresult.optimum);
+            azimuth = std::get<1>(oresult.optimum);
+            nn = spheric_to_dir(polar, azimuth).normalized();
+            t = EigenMesh3D::hit_result(oresult.score);
+        }
+    }
+
+    // save the verified and corrected normal
+    rec.normal = nn;
+    rec.role   = Role::Unroutable;
+
+    if (t.distance() > w) {
+        // Check distance from ground, we might have zero elevation.
+        if (hp(Z) + w * nn(Z) < m_builder.ground_level) {
+            rec.role = Role::Headless;
+        } else {
+            // mark the point for needing a head.
+            rec.role = Role::Head;
+        }
+    } else if (polar >= 3 * PI / 4) {
+        // Headless supports do not tilt like the headed ones
+        // so the normal should point almost to the ground.
+        rec.role = Role::Headless;
+    }
+
+    return rec;
+}
+
 void SupportTreeBuildsteps::filter()
 {
+    using Role = SupportTreeCache::Role;
+
     // Get the points that are too close to each other and keep only the
     // first one
     auto aliases = cluster(m_points, D_SP, 2);
@@ -681,120 +786,61 @@ void SupportTreeBuildsteps::filter()
         // Here we keep only the front point of the cluster.
         filtered_indices.emplace_back(a.front());
     }
+
+    // Take over the results of the points that were already processed in
+    // the previous run, the rest has to be calculated.
+    std::vector<SupportTreeCache::Record> records(filtered_indices.size());
+    PtIndices uncached_indices;  // indices into m_points
+    std::vector<size_t> uncached_pos; // positions in filtered_indices
+    for (size_t i = 0; i < filtered_indices.size(); ++i) {
+        const SupportTreeCache::Record *rec =
+            m_cache.find(m_support_pts[filtered_indices[i]]);
+
+        if (rec) records[i] = *rec;
+        else {
+            uncached_indices.emplace_back(filtered_indices[i]);
+            uncached_pos.emplace_back(i);
+        }
+    }
+
+    BOOST_LOG_TRIVIAL(debug) << "Support points reused from the previous run: "
+                             << filtered_indices.size() - uncached_indices.size()
+                             << " of " << filtered_indices.size();
     
     // calculate the normals to the triangles for filtered points
     auto nmls = sla::normals(m_points, m_mesh, m_cfg.head_front_radius_mm,
-                             m_thr, filtered_indices);
+                             m_thr, uncached_indices);
     
     // Not all of the support points have to be a valid position for
     // support creation. The angle may be inappropriate or there may
     // not be enough space for the pinhead. Filtering is applied for
     // these reasons.
-    
-    ccr::SpinningMutex mutex;
-    auto addfn = [&mutex](PtIndices &container, unsigned val) {
-        std::lock_guard<ccr::SpinningMutex> lk(mutex);
-        container.emplace_back(val);
-    };
-    
-    auto filterfn = [this, &nmls, addfn](unsigned fidx, size_t i) {
+    auto filterfn = [this, &nmls, &records, &uncached_pos](unsigned fidx, size_t i) {
         m_thr();
         
-        auto n = nmls.row(Eigen::Index(i));
-        
-        // for all normals we generate the spherical coordinates and
-        // saturate the polar angle to 45 degrees from the bottom then
-        // convert back to standard coordinates to get the new normal.
-        // Then we just create a quaternion from the two normals
-        // (Quaternion::FromTwoVectors) and apply the rotation to the
-        // arrow head.
-        
-        auto [polar, azimuth] = dir_to_spheric(n);
-        
-        // skip if the tilt is not sane
-        if(polar >= PI - m_cfg.normal_cutoff_angle) {
-            
-            // We saturate the polar angle to 3pi/4
-            polar = std::max(polar, 3*PI / 4);
-            
-            // save the head (pinpoint) position
-            Vec3d hp = m_points.row(fidx);
-            
-            double w = m_cfg.head_width_mm +
-                       m_cfg.head_back_radius_mm +
-                       2*m_cfg.head_front_radius_mm;
-            
-            double pin_r = double(m_support_pts[fidx].head_front_radius);
-            
-            // Reassemble the now corrected normal
-            auto nn = spheric_to_dir(polar, azimuth).normalized();
-            
-            // check available distance
-            EigenMesh3D::hit_result t
-                = pinhead_mesh_intersect(hp, // touching point
-                                         nn, // normal
-                                         pin_r,
-                                         m_cfg.head_back_radius_mm,
-                                         w);
-            
-            if(t.distance() <= w) {
-                
-                // Let's try to optimize this angle, there might be a
-                // viable normal that doesn't collide with the model
-                // geometry and its very close to the default.
-                
-                StopCriteria stc;
-                stc.max_iterations = m_cfg.optimizer_max_iterations;
-                stc.relative_score_difference = m_cfg.optimizer_rel_score_diff;
-                stc.stop_score = w; // space greater than w is enough
-                GeneticOptimizer solver(stc);
-                solver.seed(0); // we want deterministic behavior
-                
-                auto oresult = solver.optimize_max(
-                    [this, pin_r, w, hp](double plr, double azm)
-                    {
-                        auto dir = spheric_to_dir(plr, azm).normalized();
-                        
-                        double score = pinhead_mesh_distance(
-                            hp, dir, pin_r, m_cfg.head_back_radius_mm, w);
-                        
-                        return score;
-                    },
-                    initvals(polar, azimuth), // start with what we have
-                    bound(3 * PI / 4, PI),    // Must not exceed the tilt limit
-                    bound(-PI, PI) // azimuth can be a full search
-                    );
-                
-                if(oresult.score > w) {
-                    polar = std::get<0>(oresult.optimum);
-                    azimuth = std::get<1>(oresult.optimum);
-                    nn = spheric_to_dir(polar, azimuth).normalized();
-                    t = EigenMesh3D::hit_result(oresult.score);
-                }
-            }
-            
-            // save the verified and corrected normal
-            m_support_nmls.row(fidx) = nn;
-            
-            if (t.distance() > w) {
-                // Check distance from ground, we might have zero elevation.
-                if (hp(Z) + w * nn(Z) < m_builder.ground_level) {
-                    addfn(m_iheadless, fidx);
-                } else {
-                    // mark the point for needing a head.
-                    addfn(m_iheads, fidx);
-                }
-            } else if (polar >= 3 * PI / 4) {
-                // Headless supports do not tilt like the headed ones
-                // so the normal should point almost to the ground.
-                addfn(m_iheadless, fidx);
-            }
-        }
+        Vec3d n = nmls.row(Eigen::Index(i));
+        records[uncached_pos[i]] = filter_point(fidx, n);
     };
     
-    ccr::enumerate(filtered_indices.begin(), filtered_indices.end(), filterfn);
+    ccr::enumerate(uncached_indices.begin(), uncached_indices.end(), filterfn);
     
     m_thr();
+
+    for (size_t i = 0; i < filtered_indices.size(); ++i) {
+        unsigned fidx = filtered_indices[i];
+        const SupportTreeCache::Record &rec = records[i];
+
+        if (rec.role == Role::Discarded) continue;
+
+        m_support_nmls.row(fidx) = rec.normal;
+        switch (rec.role) {
+        case Role::Head:     m_iheads.emplace_back(fidx); break;
+        case Role::Headless: m_iheadless.emplace_back(fidx); break;
+        default: ;
+        }
+    }
+
+    m_cache.assign(m_support_pts, filtered_indices, records);
 }
 
 void SupportTreeBuildsteps::add_pinheads()
@@ -831,8 +877,14 @@ void SupportTreeBuildsteps::classify()
         double r = head.r_back_mm;
         Vec3d headjp = head.junction_point();
         
-        // collision check
-        auto hit = bridge_mesh_intersect(headjp, DOWN, r);
+        // collision check, the scan of an unchanged head is reused
+        SupportTreeCache::Record *rec = m_cache.find(m_support_pts[i]);
+        if (rec && !rec->has_ground_scan) {
+            rec->ground_scan = bridge_mesh_intersect(headjp, DOWN, r);
+            rec->has_ground_scan = true;
+        }
+        
+        auto hit = rec ? rec->ground_scan : bridge_mesh_intersect(headjp, DOWN, r);
         
         if(std::isinf(hit.distance())) ground_head_indices.emplace_back(i);
         else if(m_cfg.ground_facing_only)  head.invalidate();
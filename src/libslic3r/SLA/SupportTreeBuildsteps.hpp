@@ -206,6 +206,15 @@ class SupportTreeBuildsteps {
     // When bridging heads to pillars... TODO: find a cleaner solution
     ccr::BlockingMutex m_bridge_mutex;
 
+    // Results of the point-local steps kept from the previous run. If no
+    // external cache is provided, an empty one is used.
+    SupportTreeCache  m_own_cache;
+    SupportTreeCache &m_cache;
+
+    // Calculate the head orientation and role for one support point with
+    // the surface normal n.
+    SupportTreeCache::Record filter_point(unsigned fidx, const Vec3d &n);
+
     inline EigenMesh3D::hit_result ray_mesh_intersect(const Vec3d& s, 
                                                       const Vec3d& dir)
     {
@@ -283,7 +292,9 @@ class SupportTreeBuildsteps {
     
     
 public:
-    SupportTreeBuildsteps(SupportTreeBuilder & builder, const SupportableMesh &sm);
+    SupportTreeBuildsteps(SupportTreeBuilder &   builder,
+                          const SupportableMesh &sm,
+                          SupportTreeCache *     cache = nullptr);
 
     // Now let's define the individual steps of the support generation algorithm
 
@@ -291,7 +302,8 @@ public:
     // and decide the future of the appropriate ones. We will check if a
     // pinhead is applicable and adjust its angle at each support point. We
     // will also merge the support points that are just too close and can
-    // be considered as one.
+    // be considered as one. The results of the points present in the cache
+    // are reused.
     void filter();
 
     // Pinhead creation: based on the filtering results, the Head objects
@@ -331,7 +343,9 @@ public:
 
     inline void merge_result() { m_builder.merged_mesh(); }
 
-    static bool execute(SupportTreeBuilder & builder, const SupportableMesh &sm);
+    static bool execute(SupportTreeBuilder &   builder,
+                        const SupportableMesh &sm,
+                        SupportTreeCache *     cache = nullptr);
 };
 
 }
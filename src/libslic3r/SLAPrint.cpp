@@ -1214,6 +1214,7 @@ DynamicConfig SLAPrintStatistics::config() const
     config.set_key_value("support_used_material", new ConfigOptionFloat(this->support_used_material));
     config.set_key_value("total_cost", new ConfigOptionFloat(this->total_cost));
     config.set_key_value("total_weight", new ConfigOptionFloat(this->total_weight));
+    config.set_key_value("pad_generation_time", new ConfigOptionFloat(this->pad_generation_time));
     return config;
 }
 
@@ -1222,7 +1223,7 @@ DynamicConfig SLAPrintStatistics::placeholders()
     DynamicConfig config;
     for (const std::string &key : {
         "print_time", "total_cost", "total_weight",
-        "objects_used_material", "support_used_material" })
+        "objects_used_material", "support_used_material", "pad_generation_time" })
         config.set_key_value(key, new ConfigOptionString(std::string("{") + key + "}"));
 
     return config;
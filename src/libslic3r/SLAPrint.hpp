@@ -310,13 +310,26 @@ private:
         sla::SupportTree::UPtr  support_tree_ptr; // the supports
         std::vector<ExPolygons> support_slices;   // sliced supports
         
+        // Heads of the previous support tree build over the same mesh
+        sla::SupportTreeCache   support_tree_cache;
+        
+        // Silhouette of the model used for the pad in zero elevation mode,
+        // kept for pad parameter changes not affecting the sampled height.
+        ExPolygons              pad_model_blueprint;
+        float                   pad_blueprint_height = 0.f;
+        float                   pad_blueprint_layer_height = 0.f;
+        bool                    pad_blueprint_valid = false;
+        
+        // Duration of the last pad generation in seconds
+        double                  pad_generation_time = 0.;
+        
         inline SupportData(const TriangleMesh &t)
             : sla::SupportableMesh{t, {}, {}}
         {}
         
         sla::SupportTree::UPtr &create_support_tree(const sla::JobController &ctl)
         {
-            support_tree_ptr = sla::SupportTree::create(*this, ctl);
+            support_tree_ptr = sla::SupportTree::create(*this, ctl, &support_tree_cache);
             return support_tree_ptr;
         }
     };
@@ -350,6 +363,8 @@ struct SLAPrintStatistics
     size_t                          fast_layers_count;
     double                          total_cost;
     double                          total_weight;
+    // Time spent generating the pads of all objects in seconds
+    double                          pad_generation_time;
 
     // Config with the filled in print statistics.
     DynamicConfig           config() const;
@@ -366,6 +381,7 @@ struct SLAPrintStatistics
         fast_layers_count = 0;
         total_cost = 0.;
         total_weight = 0.;
+        pad_generation_time = 0.;
     }
 };
 
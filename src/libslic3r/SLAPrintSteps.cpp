@@ -1,4 +1,7 @@
 #include <libslic3r/SLAPrintSteps.hpp>
+
+#include <chrono>
+
 #include <libslic3r/MeshBoolean.hpp>
 
 // Need the cylinder method for the the drainholes in hollowing step
@@ -428,25 +431,44 @@ void SLAPrint::Steps::generate_pad(SLAPrintObject &po) {
     // repeated)
     
     if(po.m_config.pad_enable.getBool()) {
+        auto start_time = std::chrono::steady_clock::now();
+        SLAPrintObject::SupportData &sd = *po.m_supportdata;
+        
         // Get the distilled pad configuration from the config
         sla::PadConfig pcfg = make_pad_cfg(po.m_config);
         
         ExPolygons bp; // This will store the base plate of the pad.
-        double   pad_h             = pcfg.full_height();
-        const TriangleMesh &trmesh = po.transformed_mesh();
+        auto     pad_h             = float(pcfg.full_height());
+        auto     layer_h           = float(po.m_config.layer_height.getFloat());
         
         if (!po.m_config.supports_enable.getBool() || pcfg.embed_object) {
             // No support (thus no elevation) or zero elevation mode
             // we sometimes call it "builtin pad" is enabled so we will
             // get a sample from the bottom of the mesh and use it for pad
-            // creation.
-            sla::pad_blueprint(trmesh, bp, float(pad_h),
-                               float(po.m_config.layer_height.getFloat()),
-                               [this](){ throw_if_canceled(); });
+            // creation. The sample is reused if only the pad parameters
+            // not affecting the sampled height have changed.
+            if (!sd.pad_blueprint_valid || sd.pad_blueprint_height != pad_h ||
+                sd.pad_blueprint_layer_height != layer_h) {
+                sd.pad_model_blueprint.clear();
+                sla::pad_blueprint(po.transformed_mesh(), sd.pad_model_blueprint,
+                                   pad_h, layer_h,
+                                   [this](){ throw_if_canceled(); });
+                sd.pad_blueprint_height       = pad_h;
+                sd.pad_blueprint_layer_height = layer_h;
+                sd.pad_blueprint_valid        = true;
+            }
+            
+            bp = sd.pad_model_blueprint;
         }
         
-        po.m_supportdata->support_tree_ptr->add_pad(bp, pcfg);
-        auto &pad_mesh = po.m_supportdata->support_tree_ptr->retrieve_mesh(sla::MeshType::Pad);
+        sd.support_tree_ptr->add_pad(bp, pcfg);
+        auto &pad_mesh = sd.support_tree_ptr->retrieve_mesh(sla::MeshType::Pad);
+        
+        sd.pad_generation_time = std::chrono::duration<double>(
+            std::chrono::steady_clock::now() - start_time).count();
+        
+        BOOST_LOG_TRIVIAL(debug) << "Pad generated in "
+                                 << sd.pad_generation_time << " s";
         
         if (!validate_pad(pad_mesh, pcfg))
             throw std::runtime_error(
@@ -599,45 +621,75 @@ static ClipperPolygons get_all_polygons(const SliceRecord& record, SliceOrigin o
 void SLAPrint::Steps::initialize_printer_input()
 {
     auto &printer_input = m_print->m_printer_input;
+    const PrintObjects &objects = m_print->m_objects;
     
     // clear the rasterizer input
     printer_input.clear();
     
-    size_t mx = 0;
-    for(SLAPrintObject * o : m_print->m_objects) {
-        if(auto m = o->get_slice_index().size() > mx) mx = m;
-    }
-    
-    printer_input.reserve(mx);
-    
-    auto eps = coord_t(SCALED_EPSILON);
-    
-    for(SLAPrintObject * o : m_print->m_objects) {
-        coord_t gndlvl = o->get_slice_index().front().print_level() - ilhs;
-        
-        for(const SliceRecord& slicerecord : o->get_slice_index()) {
+    for(SLAPrintObject * o : objects)
+        for(const SliceRecord& slicerecord : o->get_slice_index())
             if (!slicerecord.is_valid())
                 throw std::runtime_error(
                     L("There are unprintable objects. Try to "
                       "adjust support settings to make the "
                       "objects printable."));
-
+    
+    auto eps = coord_t(SCALED_EPSILON);
+    
+    // The grid levels of the slice records of each object. The slice index of
+    // an object is sorted by the print level so these are sorted as well.
+    std::vector<std::vector<coord_t>> objlevels(objects.size());
+    
+    sla::ccr::enumerate(objects.begin(), objects.end(),
+                        [this, &objlevels, eps](const SLAPrintObject *o, size_t idx)
+    {
+        const std::vector<SliceRecord> &slice_index = o->get_slice_index();
+        if (slice_index.empty()) return;
+        
+        std::vector<coord_t> &lvls = objlevels[idx];
+        lvls.reserve(slice_index.size());
+        
+        coord_t gndlvl = slice_index.front().print_level() - ilhs;
+        for(const SliceRecord& slicerecord : slice_index) {
             coord_t lvlid = slicerecord.print_level() - gndlvl;
             
             // Neat trick to round the layer levels to the grid.
-            lvlid = eps * (lvlid / eps);
-
-            auto it = std::lower_bound(printer_input.begin(),
-                                       printer_input.end(),
-                                       PrintLayer(lvlid));
-
-            if(it == printer_input.end() || it->level() != lvlid)
-                it = printer_input.insert(it, PrintLayer(lvlid));
-            
+            lvls.emplace_back(eps * (lvlid / eps));
+        }
+    });
+    
+    // The union of all the levels, giving the index of each print layer.
+    std::vector<coord_t> levels;
+    levels.reserve(std::accumulate(objlevels.begin(), objlevels.end(), size_t(0),
+                                   [](size_t a, const std::vector<coord_t> &l) {
+        return a + l.size();
+    }));
+    
+    for (const std::vector<coord_t> &lvls : objlevels)
+        levels.insert(levels.end(), lvls.begin(), lvls.end());
+    
+    std::sort(levels.begin(), levels.end());
+    levels.erase(std::unique(levels.begin(), levels.end()), levels.end());
+    
+    printer_input.reserve(levels.size());
+    for (coord_t lvl : levels) printer_input.emplace_back(lvl);
+    
+    // Every layer collects its own slice records, looking them up in the
+    // sorted level lists of the objects. Layers are disjoint so no locking is
+    // needed and the records are added in the order of the objects, the same
+    // way as a sequential merge would do it.
+    sla::ccr::enumerate(printer_input.begin(), printer_input.end(),
+                        [&objects, &objlevels](PrintLayer &layer, size_t)
+    {
+        for (size_t o = 0; o < objects.size(); ++o) {
+            const std::vector<coord_t> &lvls = objlevels[o];
+            auto rng = std::equal_range(lvls.begin(), lvls.end(), layer.level());
             
-            it->add(slicerecord);
+            const std::vector<SliceRecord> &slice_index = objects[o]->get_slice_index();
+            for (auto it = rng.first; it != rng.second; ++it)
+                layer.add(slice_index[size_t(it - lvls.begin())]);
         }
-    }
+    });
 }
 
 // Merging the slices from all the print objects into one slice grid and
@@ -669,36 +721,26 @@ void SLAPrint::Steps::merge_slices_and_eval_stats() {
     const auto height         = scaled<double>(printer_config.display_height.getFloat());
     const double display_area = width*height;
     
-    double supports_volume(0.0);
-    double models_volume(0.0);
-    
-    double estim_time(0.0);
-    
-    size_t slow_layers = 0;
-    size_t fast_layers = 0;
-    
-    const double delta_fade_time = (init_exp_time - exp_time) / (fade_layers_cnt + 1);
-    double fade_layer_time = init_exp_time;
+    // Area statistics of each print layer, indexed the same way as the
+    // printer input. These are computed concurrently and reduced afterwards.
+    struct LayerStats {
+        double model_area = 0., support_area = 0., height = 0.;
+    };
     
-    sla::ccr::SpinningMutex mutex;
-    using Lock = std::lock_guard<sla::ccr::SpinningMutex>;
+    std::vector<LayerStats> layer_stats(printer_input.size());
     
     // Going to parallel:
-    auto printlayerfn = [
-            // functions and read only vars
-            areafn, area_fill, display_area, exp_time, init_exp_time, fast_tilt, slow_tilt, delta_fade_time,
-            
-            // write vars
-            &mutex, &models_volume, &supports_volume, &estim_time, &slow_layers,
-            &fast_layers, &fade_layer_time](PrintLayer& layer, size_t sliced_layer_cnt)
+    auto printlayerfn = [areafn, &layer_stats](PrintLayer& layer, size_t idx)
     {
         // vector of slice record references
         auto& slicerecord_references = layer.slices();
         
         if(slicerecord_references.empty()) return;
         
+        LayerStats &stats = layer_stats[idx];
+        
         // Layer height should match for all object slices for a given level.
-        const auto l_height = double(slicerecord_references.front().get().layer_height());
+        stats.height = double(slicerecord_references.front().get().layer_height());
         
         // Calculation of the consumed material
         
@@ -718,7 +760,7 @@ void SLAPrint::Steps::merge_slices_and_eval_stats() {
                             layer.slices().end(),
                             size_t(0),
                             [](size_t a, const SliceRecord &sr) {
-            return a + sr.get_slice(soModel).size();
+            return a + sr.get_slice(soSupport).size();
         });
         
         supports_polygons.reserve(c);
@@ -734,13 +776,8 @@ void SLAPrint::Steps::merge_slices_and_eval_stats() {
         }
         
         model_polygons = polyunion(model_polygons);
-        double layer_model_area = 0;
         for (const ClipperPolygon& polygon : model_polygons)
-            layer_model_area += areafn(polygon);
-        
-        if (layer_model_area < 0 || layer_model_area > 0) {
-            Lock lck(mutex); models_volume += layer_model_area * l_height;
-        }
+            stats.model_area += areafn(polygon);
         
         if(!supports_polygons.empty()) {
             if(model_polygons.empty()) supports_polygons = polyunion(supports_polygons);
@@ -748,13 +785,8 @@ void SLAPrint::Steps::merge_slices_and_eval_stats() {
             // allegedly, union of subject is done withing the diff according to the pftPositive polyFillType
         }
         
-        double layer_support_area = 0;
         for (const ClipperPolygon& polygon : supports_polygons)
-            layer_support_area += areafn(polygon);
-        
-        if (layer_support_area < 0 || layer_support_area > 0) {
-            Lock lck(mutex); supports_volume += layer_support_area * l_height;
-        }
+            stats.support_area += areafn(polygon);
         
         // Here we can save the expensively calculated polygons for printing
         ClipperPolygons trslices;
@@ -763,38 +795,58 @@ void SLAPrint::Steps::merge_slices_and_eval_stats() {
         for(ClipperPolygon& poly : supports_polygons) trslices.emplace_back(std::move(poly));
         
         layer.transformed_slices(polyunion(trslices));
+    };
+    
+    // sequential version for debugging:
+    // for(size_t i = 0; i < m_printer_input.size(); ++i) printlayerfn(i);
+    sla::ccr::enumerate(printer_input.begin(), printer_input.end(), printlayerfn);
+    
+    // Reduction of the layer statistics. This is cheap compared to the
+    // polygon operations above and doing it in layer order keeps the exposure
+    // fading and the summed volumes deterministic.
+    double supports_volume(0.0);
+    double models_volume(0.0);
+    
+    double estim_time(0.0);
+    
+    size_t slow_layers = 0;
+    size_t fast_layers = 0;
+    
+    const double delta_fade_time = (init_exp_time - exp_time) / (fade_layers_cnt + 1);
+    double fade_layer_time = init_exp_time;
+    
+    for (size_t sliced_layer_cnt = 0; sliced_layer_cnt < layer_stats.size(); ++sliced_layer_cnt) {
+        if (printer_input[sliced_layer_cnt].slices().empty()) continue;
+        
+        const LayerStats &stats = layer_stats[sliced_layer_cnt];
+        
+        models_volume   += stats.model_area * stats.height;
+        supports_volume += stats.support_area * stats.height;
         
         // Calculation of the slow and fast layers to the future controlling those values on FW
         
-        const bool is_fast_layer = (layer_model_area + layer_support_area) <= display_area*area_fill;
+        const bool is_fast_layer = (stats.model_area + stats.support_area) <= display_area*area_fill;
         const double tilt_time = is_fast_layer ? fast_tilt : slow_tilt;
         
-        { Lock lck(mutex);
-            if (is_fast_layer)
-                fast_layers++;
-            else
-                slow_layers++;
-            
-            
-            // Calculation of the printing time
-            
-            if (sliced_layer_cnt < 3)
-                estim_time += init_exp_time;
-            else if (fade_layer_time > exp_time)
-            {
-                fade_layer_time -= delta_fade_time;
-                estim_time += fade_layer_time;
-            }
-            else
-                estim_time += exp_time;
-            
-            estim_time += tilt_time;
+        if (is_fast_layer)
+            fast_layers++;
+        else
+            slow_layers++;
+        
+        // Calculation of the printing time
+        
+        if (sliced_layer_cnt < 3)
+            estim_time += init_exp_time;
+        else if (fade_layer_time > exp_time)
+        {
+            fade_layer_time -= delta_fade_time;
+            estim_time += fade_layer_time;
         }
-    };
-    
-    // sequential version for debugging:
-    // for(size_t i = 0; i < m_printer_input.size(); ++i) printlayerfn(i);
-    sla::ccr::enumerate(printer_input.begin(), printer_input.end(), printlayerfn);
+        else
+            estim_time += exp_time;
+        
+        estim_time += tilt_time;
+    }
     
     auto SCALING2 = SCALING_FACTOR * SCALING_FACTOR;
     print_statistics.support_used_material = supports_volume * SCALING2;
@@ -810,6 +862,10 @@ void SLAPrint::Steps::merge_slices_and_eval_stats() {
     print_statistics.fast_layers_count = fast_layers;
     print_statistics.slow_layers_count = slow_layers;
     
+    for (const SLAPrintObject *po : m_print->m_objects)
+        if (po->m_supportdata && po->m_config.pad_enable.getBool())
+            print_statistics.pad_generation_time += po->m_supportdata->pad_generation_time;
+    
     report_status(-2, "", SlicingStatus::RELOAD_SLA_PREVIEW);
 }
 
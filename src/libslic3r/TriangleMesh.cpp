@@ -4,8 +4,11 @@
 #include "Tesselate.hpp"
 #include <libqhullcpp/Qhull.h>
 #include <libqhullcpp/QhullFacetList.h>
+#include <libqhullcpp/QhullHyperplane.h>
 #include <libqhullcpp/QhullVertexSet.h>
+#include <atomic>
 #include <cmath>
+#include <limits>
 #include <deque>
 #include <queue>
 #include <set>
@@ -13,6 +16,7 @@
 #include <map>
 #include <utility>
 #include <algorithm>
+#include <array>
 #include <math.h>
 #include <type_traits>
 
@@ -452,37 +456,199 @@ std::deque<uint32_t> TriangleMesh::find_unvisited_neighbors(std::vector<unsigned
     return facets;
 }
 
+namespace {
+
+// Disjoint set of the facets connected over their edges, unified concurrently.
+// A root is always linked below a root with a lower index, therefore the root of a set is its lowest facet index
+// and the parts are ordered by their first facet, as the former flood fill ordered them.
+class FacetUnionFind
+{
+public:
+    explicit FacetUnionFind(size_t num_facets) : m_parent(num_facets)
+    {
+        tbb::parallel_for(tbb::blocked_range<size_t>(0, num_facets), [this](const tbb::blocked_range<size_t> &range) {
+            for (size_t i = range.begin(); i < range.end(); ++ i)
+                m_parent[i].store(uint32_t(i), std::memory_order_relaxed);
+        });
+    }
+
+    uint32_t find(uint32_t idx)
+    {
+        for (;;) {
+            uint32_t parent = m_parent[idx].load(std::memory_order_relaxed);
+            if (parent == idx)
+                return idx;
+            // Path halving. Failing the exchange only means another thread has shortened the path already.
+            uint32_t grandparent = m_parent[parent].load(std::memory_order_relaxed);
+            if (grandparent != parent)
+                m_parent[idx].compare_exchange_weak(parent, grandparent, std::memory_order_relaxed);
+            idx = grandparent;
+        }
+    }
+
+    void unite(uint32_t a, uint32_t b)
+    {
+        for (;;) {
+            a = this->find(a);
+            b = this->find(b);
+            if (a == b)
+                return;
+            if (a > b)
+                std::swap(a, b);
+            // Link the root b below a, unless b stopped being a root in the meantime.
+            uint32_t expected = b;
+            if (m_parent[b].compare_exchange_strong(expected, a, std::memory_order_relaxed))
+                return;
+        }
+    }
+
+private:
+    std::vector<std::atomic<uint32_t>> m_parent;
+};
+
+} // namespace
+
 /**
  * Splits a mesh into multiple meshes when possible.
  * 
+ * The facets are grouped by a concurrent union-find over the edge neighbors, and the parts are assembled in parallel
+ * together with their neighbors and shared vertices. The parts of a repaired mesh are repaired already,
+ * therefore they are returned with the repaired flag set and the repair statistics of a clean mesh.
+ * 
  * @return A TriangleMeshPtrs with the newly created meshes.
  */
 TriangleMeshPtrs TriangleMesh::split() const
 {
-    // Loop while we have remaining facets.
-    std::vector<unsigned char> facet_visited;
-    TriangleMeshPtrs meshes;
-    for (;;) {
-        std::deque<uint32_t> facets = find_unvisited_neighbors(facet_visited);
-        if (facets.empty())
-            break;
+    // Make sure we're not operating on a broken mesh.
+    if (! this->repaired)
+        throw std::runtime_error("split() requires repair()");
 
-        // Create a new mesh for the part that was just split off.
-        TriangleMesh* mesh = new TriangleMesh;
-        meshes.emplace_back(mesh);
-        mesh->stl.stats.type = inmemory;
-        mesh->stl.stats.number_of_facets = (uint32_t)facets.size();
-        mesh->stl.stats.original_num_facets = mesh->stl.stats.number_of_facets;
-        stl_allocate(&mesh->stl);
-
-        // Assign the facets to the new mesh.
-        bool first = true;
-        for (auto facet = facets.begin(); facet != facets.end(); ++ facet) {
-            mesh->stl.facet_start[facet - facets.begin()] = this->stl.facet_start[*facet];
-            stl_facet_stats(&mesh->stl, this->stl.facet_start[*facet], first);
+    const uint32_t num_facets = this->stl.stats.number_of_facets;
+    TriangleMeshPtrs meshes;
+    if (num_facets == 0)
+        return meshes;
+
+    FacetUnionFind sets(num_facets);
+    tbb::parallel_for(tbb::blocked_range<uint32_t>(0, num_facets), [this, &sets](const tbb::blocked_range<uint32_t> &range) {
+        for (uint32_t facet_idx = range.begin(); facet_idx < range.end(); ++ facet_idx)
+            for (int neighbor_idx : this->stl.neighbors_start[facet_idx].neighbor)
+                // Each edge is seen from both its facets, unite it once.
+                if (neighbor_idx > int(facet_idx))
+                    sets.unite(facet_idx, uint32_t(neighbor_idx));
+    });
+
+    // Number the parts in the order of their roots, collect the facets of each part in ascending order
+    // and the index of each facet inside its part.
+    std::vector<uint32_t> facet_part(num_facets);
+    tbb::parallel_for(tbb::blocked_range<uint32_t>(0, num_facets), [&sets, &facet_part](const tbb::blocked_range<uint32_t> &range) {
+        for (uint32_t facet_idx = range.begin(); facet_idx < range.end(); ++ facet_idx)
+            facet_part[facet_idx] = sets.find(facet_idx);
+    });
+    std::vector<uint32_t>              root_part(num_facets, uint32_t(-1));
+    std::vector<std::vector<uint32_t>> part_facets;
+    std::vector<int>                   facet_local(num_facets);
+    for (uint32_t facet_idx = 0; facet_idx < num_facets; ++ facet_idx) {
+        uint32_t &part_idx = root_part[facet_part[facet_idx]];
+        if (part_idx == uint32_t(-1)) {
+            part_idx = uint32_t(part_facets.size());
+            part_facets.emplace_back();
         }
+        facet_part[facet_idx]  = part_idx;
+        facet_local[facet_idx] = int(part_facets[part_idx].size());
+        part_facets[part_idx].emplace_back(facet_idx);
     }
 
+    // Part referencing each shared vertex and the index of the vertex inside its part.
+    // Multiple parts may touch at a single vertex, such a vertex is renumbered by each of the parts separately.
+    static constexpr int VERTEX_UNUSED = -1;
+    static constexpr int VERTEX_TOUCHING = -2;
+    std::vector<int> vertex_part;
+    std::vector<int> vertex_local;
+    if (this->has_shared_vertices()) {
+        vertex_part.assign(this->its.vertices.size(), VERTEX_UNUSED);
+        for (uint32_t facet_idx = 0; facet_idx < num_facets; ++ facet_idx)
+            for (int j = 0; j < 3; ++ j) {
+                int &part_idx = vertex_part[this->its.indices[facet_idx](j)];
+                if (part_idx == VERTEX_UNUSED)
+                    part_idx = int(facet_part[facet_idx]);
+                else if (part_idx != int(facet_part[facet_idx]))
+                    part_idx = VERTEX_TOUCHING;
+            }
+        vertex_local.assign(this->its.vertices.size(), -1);
+    }
+
+    meshes.assign(part_facets.size(), nullptr);
+    tbb::parallel_for(size_t(0), part_facets.size(), [this, &part_facets, &facet_local, &vertex_part, &vertex_local, &meshes](size_t part_idx) {
+        const std::vector<uint32_t> &facets = part_facets[part_idx];
+        TriangleMesh *mesh = new TriangleMesh;
+        meshes[part_idx] = mesh;
+        stl_file &stl = mesh->stl;
+        stl.stats.type = inmemory;
+        stl.stats.number_of_facets = uint32_t(facets.size());
+        stl.stats.original_num_facets = int(stl.stats.number_of_facets);
+        stl_allocate(&stl);
+
+        // Copy the facets with their neighbors renumbered, the opposite vertices are indexed locally to the facets.
+        // Bounding box, the shortest edge and the edge connectivity statistics of the part, as stl_check_facets_exact() would produce them.
+        stl_stats &stats = stl.stats;
+        stats.min = stats.max = this->stl.facet_start[facets.front()].vertex[0];
+        stats.shortest_edge = std::numeric_limits<float>::max();
+        for (size_t i = 0; i < facets.size(); ++ i) {
+            const stl_facet &facet = this->stl.facet_start[facets[i]];
+            stl.facet_start[i] = facet;
+            stl_neighbors &neighbors = stl.neighbors_start[i];
+            neighbors = this->stl.neighbors_start[facets[i]];
+            for (int &neighbor_idx : neighbors.neighbor)
+                if (neighbor_idx != -1)
+                    neighbor_idx = facet_local[neighbor_idx];
+            int num_neighbors = neighbors.num_neighbors();
+            stats.connected_edges += num_neighbors;
+            stats.connected_facets_1_edge += num_neighbors >= 1;
+            stats.connected_facets_2_edge += num_neighbors >= 2;
+            stats.connected_facets_3_edge += num_neighbors == 3;
+            for (int j = 0; j < 3; ++ j) {
+                stats.min = stats.min.cwiseMin(facet.vertex[j]);
+                stats.max = stats.max.cwiseMax(facet.vertex[j]);
+                stats.shortest_edge = std::min(stats.shortest_edge, (facet.vertex[(j + 1) % 3] - facet.vertex[j]).cwiseAbs().maxCoeff());
+            }
+        }
+        stats.size              = stats.max - stats.min;
+        stats.bounding_diameter = stats.size.norm();
+        stats.facets_w_1_bad_edge = stats.connected_facets_2_edge - stats.connected_facets_3_edge;
+        stats.facets_w_2_bad_edge = stats.connected_facets_1_edge - stats.connected_facets_2_edge;
+        stats.facets_w_3_bad_edge = int(stats.number_of_facets) - stats.connected_facets_1_edge;
+        stats.number_of_parts     = 1;
+
+        // A part of a repaired mesh has its normals oriented consistently already, but it may be turned inside out
+        // (a cavity split off its shell). Reverse it the same way repair() would.
+        stl_calculate_volume(&stl);
+        bool reversed = stats.facets_reversed > 0;
+
+        if (this->has_shared_vertices()) {
+            // Renumber the shared vertices referenced by this part.
+            std::map<int, int> vertices_touching;
+            mesh->its.indices.reserve(facets.size());
+            for (uint32_t facet_idx : facets) {
+                stl_triangle_vertex_indices indices;
+                for (int j = 0; j < 3; ++ j) {
+                    int  vertex_idx = this->its.indices[facet_idx](j);
+                    int &local_idx  = vertex_part[vertex_idx] == int(part_idx) ? vertex_local[vertex_idx] :
+                        vertices_touching.emplace(vertex_idx, -1).first->second;
+                    if (local_idx == -1) {
+                        local_idx = int(mesh->its.vertices.size());
+                        mesh->its.vertices.emplace_back(this->its.vertices[vertex_idx]);
+                    }
+                    indices(j) = local_idx;
+                }
+                if (reversed)
+                    // stl_reverse_all_facets() swaps the first two vertices of each facet.
+                    std::swap(indices(0), indices(1));
+                mesh->its.indices.emplace_back(indices);
+            }
+        }
+        mesh->repaired = true;
+    });
+
     return meshes;
 }
 
@@ -526,6 +692,52 @@ ExPolygons TriangleMesh::horizontal_projection() const
     return union_ex(offset(pp, scale_(0.01)), true);
 }
 
+// Akl-Toussaint heuristic: drop the points strictly inside the octagon spanned by the points extreme
+// in the axis and diagonal directions, they cannot be vertices of the convex hull.
+// Points closer than SCALED_EPSILON to the octagon boundary are kept.
+static Points convex_hull_2d_candidates(Points &&pts)
+{
+    if (pts.size() < 16)
+        return std::move(pts);
+
+    // Extremes in the counter-clockwise order: -x, -x-y, -y, x-y, x, x+y, y, -x+y
+    std::array<size_t, 8> extremes;
+    extremes.fill(0);
+    auto dot = [](const Point &pt, int dir) -> double {
+        static const double dirs[8][2] = { { -1, 0 }, { -1, -1 }, { 0, -1 }, { 1, -1 }, { 1, 0 }, { 1, 1 }, { 0, 1 }, { -1, 1 } };
+        return dirs[dir][0] * double(pt(0)) + dirs[dir][1] * double(pt(1));
+    };
+    for (size_t i = 1; i < pts.size(); ++ i)
+        for (int dir = 0; dir < 8; ++ dir)
+            if (dot(pts[i], dir) > dot(pts[extremes[dir]], dir))
+                extremes[dir] = i;
+
+    Points octagon;
+    for (size_t idx : extremes)
+        if (octagon.empty() || (pts[idx] != octagon.back() && pts[idx] != octagon.front()))
+            octagon.emplace_back(pts[idx]);
+    if (octagon.size() < 3)
+        return std::move(pts);
+
+    // Inward normals of the octagon edges with their offsets.
+    std::vector<std::pair<Vec2d, double>> edges;
+    edges.reserve(octagon.size());
+    for (size_t i = 0; i < octagon.size(); ++ i) {
+        Vec2d a = octagon[i].cast<double>();
+        Vec2d v = octagon[(i + 1) % octagon.size()].cast<double>() - a;
+        Vec2d n = Vec2d(- v(1), v(0)).normalized();
+        edges.emplace_back(n, n.dot(a) + SCALED_EPSILON);
+    }
+    pts.erase(std::remove_if(pts.begin(), pts.end(), [&edges](const Point &pt) {
+        Vec2d p = pt.cast<double>();
+        for (const std::pair<Vec2d, double> &edge : edges)
+            if (edge.first.dot(p) <= edge.second)
+                return false;
+        return true;
+    }), pts.end());
+    return std::move(pts);
+}
+
 // 2D convex hull of a 3D mesh projected into the Z=0 plane.
 Polygon TriangleMesh::convex_hull()
 {
@@ -535,7 +747,7 @@ Polygon TriangleMesh::convex_hull()
         const stl_vertex &v = this->its.vertices[i];
         pp.emplace_back(Point::new_scale(v(0), v(1)));
     }
-    return Slic3r::Geometry::convex_hull(pp);
+    return Slic3r::Geometry::convex_hull(convex_hull_2d_candidates(std::move(pp)));
 }
 
 BoundingBoxf3 TriangleMesh::bounding_box() const
@@ -563,6 +775,70 @@ BoundingBoxf3 TriangleMesh::transformed_bounding_box(const Transform3d &trafo) c
     return bbox;
 }
 
+// Akl-Toussaint heuristic in 3D: the points extreme in the 26 axis, face diagonal and body diagonal directions
+// span a polytope inside the convex hull. Points deeper inside it than EPSILON cannot be vertices of the convex hull.
+// Returns the candidate points as coordinate triplets, all the points if the polytope could not be constructed.
+static std::vector<realT> convex_hull_3d_candidates(std::vector<realT> &&pts)
+{
+    const size_t num_points = pts.size() / 3;
+    if (num_points < 64)
+        return std::move(pts);
+
+    std::vector<Vec3d> dirs;
+    for (int x = -1; x <= 1; ++ x)
+        for (int y = -1; y <= 1; ++ y)
+            for (int z = -1; z <= 1; ++ z)
+                if (x != 0 || y != 0 || z != 0)
+                    dirs.emplace_back(x, y, z);
+    auto point = [&pts](size_t idx) { return Vec3d(double(pts[idx * 3]), double(pts[idx * 3 + 1]), double(pts[idx * 3 + 2])); };
+    std::vector<size_t> extremes(dirs.size(), 0);
+    for (size_t i = 1; i < num_points; ++ i) {
+        Vec3d p = point(i);
+        for (size_t dir = 0; dir < dirs.size(); ++ dir)
+            if (dirs[dir].dot(p) > dirs[dir].dot(point(extremes[dir])))
+                extremes[dir] = i;
+    }
+    sort_remove_duplicates(extremes);
+    if (extremes.size() < 4)
+        return std::move(pts);
+
+    // Half spaces bounding the polytope of the extreme points: outer normal and offset.
+    std::vector<std::pair<Vec3d, double>> planes;
+    try {
+        std::vector<realT> extreme_points;
+        extreme_points.reserve(extremes.size() * 3);
+        for (size_t idx : extremes)
+            for (size_t i = 0; i < 3; ++ i)
+                extreme_points.emplace_back(pts[idx * 3 + i]);
+        orgQhull::Qhull qhull;
+        qhull.disableOutputStream();
+        qhull.runQhull("", 3, (int)extremes.size(), extreme_points.data(), "Qt");
+        for (const orgQhull::QhullFacet &facet : qhull.facetList().toStdVector()) {
+            orgQhull::QhullHyperplane plane = facet.hyperplane();
+            const realT *normal = plane.coordinates();
+            planes.emplace_back(Vec3d(double(normal[0]), double(normal[1]), double(normal[2])), double(plane.offset()));
+        }
+    } catch (...) {
+        // Flat set of extreme points.
+        return std::move(pts);
+    }
+
+    std::vector<unsigned char> inside(num_points, false);
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, num_points), [&planes, &inside, &point](const tbb::blocked_range<size_t> &range) {
+        for (size_t i = range.begin(); i < range.end(); ++ i) {
+            Vec3d p = point(i);
+            inside[i] = std::all_of(planes.begin(), planes.end(), [&p](const std::pair<Vec3d, double> &plane)
+                { return plane.first.dot(p) + plane.second < - EPSILON; });
+        }
+    });
+    std::vector<realT> out;
+    out.reserve(pts.size());
+    for (size_t i = 0; i < num_points; ++ i)
+        if (! inside[i])
+            out.insert(out.end(), pts.begin() + i * 3, pts.begin() + i * 3 + 3);
+    return out;
+}
+
 TriangleMesh TriangleMesh::convex_hull_3d() const
 {
     // The qhull call:
@@ -572,16 +848,11 @@ TriangleMesh TriangleMesh::convex_hull_3d() const
 	try
     {
     	if (this->has_shared_vertices()) {
-#if REALfloat
-	    	qhull.runQhull("", 3, (int)this->its.vertices.size(), (const realT*)(this->its.vertices.front().data()), "Qt");
-#else
 	    	src_vertices.reserve(this->its.vertices.size() * 3);
 	    	// We will now fill the vector with input points for computation:
 			for (const stl_vertex &v : this->its.vertices)
 				for (int i = 0; i < 3; ++ i)
 		        	src_vertices.emplace_back(v(i));
-	        qhull.runQhull("", 3, (int)src_vertices.size() / 3, src_vertices.data(), "Qt");
-#endif
 	    } else {
 	    	src_vertices.reserve(this->stl.facet_start.size() * 9);
 	    	// We will now fill the vector with input points for computation:
@@ -589,8 +860,10 @@ TriangleMesh TriangleMesh::convex_hull_3d() const
 				for (int i = 0; i < 3; ++ i)
 					for (int j = 0; j < 3; ++ j)
 		        		src_vertices.emplace_back(f.vertex[i](j));
-	        qhull.runQhull("", 3, (int)src_vertices.size() / 3, src_vertices.data(), "Qt");
 	    }
+	    // Only the points possibly on the hull are passed to qhull.
+	    src_vertices = convex_hull_3d_candidates(std::move(src_vertices));
+        qhull.runQhull("", 3, (int)src_vertices.size() / 3, src_vertices.data(), "Qt");
     }
     catch (...)
     {
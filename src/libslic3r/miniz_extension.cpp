@@ -1,5 +1,12 @@
 #include "miniz_extension.hpp"
 
+#include <algorithm>
+#include <atomic>
+#include <memory>
+
+#include <tbb/enumerable_thread_specific.h>
+#include <tbb/parallel_for.h>
+
 #if defined(_MSC_VER) || defined(__MINGW64__)
 #include "boost/nowide/cstdio.hpp"
 #endif
@@ -53,6 +60,16 @@ bool close_zip(mz_zip_archive *zip, bool isread)
     }
     return ret;
 }
+
+// Size of the blocks of a file deflated concurrently. Each block starts with an empty dictionary,
+// thus the blocks have to be large for the compression ratio not to suffer.
+const size_t DEFLATE_BLOCK_SIZE = 4 * 1024 * 1024;
+
+mz_bool append_to_string(const void *buf, int len, void *user)
+{
+    static_cast<std::string*>(user)->append(static_cast<const char*>(buf), size_t(len));
+    return MZ_TRUE;
+}
 }
 
 bool open_zip_reader(mz_zip_archive *zip, const std::string &fname)
@@ -68,4 +85,92 @@ bool open_zip_writer(mz_zip_archive *zip, const std::string &fname)
 bool close_zip_reader(mz_zip_archive *zip) { return close_zip(zip, true); }
 bool close_zip_writer(mz_zip_archive *zip) { return close_zip(zip, false); }
 
+bool add_file_to_zip_writer(mz_zip_archive *zip, const std::string &name, const std::vector<std::string> &parts, int level)
+{
+    if (level < 0)
+        level = MZ_DEFAULT_LEVEL;
+
+    size_t size = 0;
+    for (const std::string &part : parts)
+        size += part.size();
+
+    if (level == 0 || size <= DEFLATE_BLOCK_SIZE) {
+        // Not worth splitting, let miniz compress the file.
+        std::string data;
+        data.reserve(size);
+        for (const std::string &part : parts)
+            data += part;
+        return mz_zip_writer_add_mem(zip, name.c_str(), data.data(), data.size(), mz_uint(level));
+    }
+
+    // Split the concatenated parts into blocks of DEFLATE_BLOCK_SIZE, only the last block may be shorter.
+    // Consecutive small parts are merged into a single block, a large part is split into several blocks.
+    struct Span {
+        const char *data;
+        size_t      size;
+    };
+    struct Block {
+        std::vector<Span> spans;
+        std::string       deflated;
+    };
+    std::vector<Block> blocks(1);
+    size_t             block_size = 0;
+    mz_ulong           crc        = MZ_CRC32_INIT;
+    for (const std::string &part : parts) {
+        for (size_t offset = 0; offset < part.size();) {
+            if (block_size == DEFLATE_BLOCK_SIZE) {
+                blocks.emplace_back();
+                block_size = 0;
+            }
+            size_t span_size = std::min(DEFLATE_BLOCK_SIZE - block_size, part.size() - offset);
+            blocks.back().spans.push_back({ part.data() + offset, span_size });
+            block_size += span_size;
+            offset     += span_size;
+        }
+        crc = mz_crc32(crc, reinterpret_cast<const unsigned char*>(part.data()), part.size());
+    }
+
+    // Each block is deflated by a single compressor. All blocks but the last one end with a sync flush,
+    // which aligns them to a byte boundary, so that the deflated blocks may be simply concatenated.
+    // The compressors are large (some 300kB), one is allocated per worker thread and reused.
+    const mz_uint flags = tdefl_create_comp_flags_from_zip_params(level, -MZ_DEFAULT_WINDOW_BITS, MZ_DEFAULT_STRATEGY);
+    tbb::enumerable_thread_specific<std::unique_ptr<tdefl_compressor>> compressors;
+    std::atomic<bool> failed(false);
+    tbb::parallel_for(size_t(0), blocks.size(), [&blocks, &compressors, flags, &failed](size_t idx) {
+        Block &block = blocks[idx];
+        std::unique_ptr<tdefl_compressor> &compressor = compressors.local();
+        if (! compressor)
+            compressor.reset(new tdefl_compressor);
+        block.deflated.reserve(DEFLATE_BLOCK_SIZE / 4);
+        if (tdefl_init(compressor.get(), append_to_string, &block.deflated, int(flags)) != TDEFL_STATUS_OKAY) {
+            failed = true;
+            return;
+        }
+        for (size_t i = 0; i < block.spans.size(); ++ i) {
+            tdefl_flush flush = (i + 1 < block.spans.size()) ? TDEFL_NO_FLUSH : (idx + 1 == blocks.size()) ? TDEFL_FINISH : TDEFL_SYNC_FLUSH;
+            if (tdefl_compress_buffer(compressor.get(), block.spans[i].data, block.spans[i].size, flush) < TDEFL_STATUS_OKAY) {
+                failed = true;
+                return;
+            }
+        }
+    });
+    if (failed) {
+        zip->m_last_error = MZ_ZIP_COMPRESSION_FAILED;
+        return false;
+    }
+
+    std::string deflated;
+    size_t deflated_size = 0;
+    for (const Block &block : blocks)
+        deflated_size += block.deflated.size();
+    deflated.reserve(deflated_size);
+    for (Block &block : blocks) {
+        deflated += block.deflated;
+        block.deflated = std::string();
+    }
+
+    return mz_zip_writer_add_mem_ex_v2(zip, name.c_str(), deflated.data(), deflated.size(), nullptr, 0, mz_uint(level) | MZ_ZIP_FLAG_COMPRESSED_DATA,
+                                       size, mz_uint32(crc), nullptr, nullptr, 0, nullptr, 0);
+}
+
 }
@@ -2,6 +2,7 @@
 #define MINIZ_EXTENSION_HPP
 
 #include <string>
+#include <vector>
 #include <miniz.h>
 
 namespace Slic3r {
@@ -11,6 +12,10 @@ bool open_zip_writer(mz_zip_archive *zip, const std::string &fname_utf8);
 bool close_zip_reader(mz_zip_archive *zip);
 bool close_zip_writer(mz_zip_archive *zip);
 
+// Adds a file made of the concatenation of parts to the archive. Large files are split into
+// blocks deflated concurrently, the blocks are joined into a single deflate stream.
+bool add_file_to_zip_writer(mz_zip_archive *zip, const std::string &name, const std::vector<std::string> &parts, int level = MZ_DEFAULT_LEVEL);
+
 }
 
 #endif // MINIZ_EXTENSION_HPP
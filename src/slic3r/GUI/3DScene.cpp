@@ -19,7 +19,11 @@
 #include <string.h>
 #include <assert.h>
 
+#include <chrono>
+#include <numeric>
+
 #include <boost/log/trivial.hpp>
+#include <boost/format.hpp>
 
 #include <boost/filesystem/operations.hpp>
 #include <boost/algorithm/string/predicate.hpp>
@@ -28,6 +32,9 @@
 
 #include <Eigen/Dense>
 
+#include <tbb/parallel_for.h>
+#include <tbb/blocked_range.h>
+
 #ifdef HAS_GLSAFE
 void glAssertRecentCallImpl(const char *file_name, unsigned int line, const char *function_name)
 {
@@ -106,6 +113,40 @@ void GLIndexedVertexArray::finalize_geometry(bool opengl_initialized)
     }
 }
 
+void GLIndexedVertexArray::append(const GLIndexedVertexArray &src,
+    size_t vertices_begin, size_t vertices_end, size_t quads_begin, size_t quads_end, size_t triangles_begin, size_t triangles_end)
+{
+    assert(this->vertices_and_normals_interleaved_VBO_id == 0 && ! src.has_VBOs());
+    if (this->vertices_and_normals_interleaved_VBO_id != 0)
+        return;
+
+    // Shift of the indices from the vertices of src to the vertices of this.
+    const int shift = int(this->vertices_and_normals_interleaved.size() / 6) - int(vertices_begin / 6);
+
+    this->vertices_and_normals_interleaved.insert(this->vertices_and_normals_interleaved.end(),
+        src.vertices_and_normals_interleaved.begin() + vertices_begin, src.vertices_and_normals_interleaved.begin() + vertices_end);
+    if (vertices_begin < vertices_end) {
+        Vec3f min = Vec3f::Map(src.vertices_and_normals_interleaved.data() + vertices_begin + 3);
+        Vec3f max = min;
+        for (size_t i = vertices_begin + 6; i < vertices_end; i += 6) {
+            Vec3f p = Vec3f::Map(src.vertices_and_normals_interleaved.data() + i + 3);
+            min = min.cwiseMin(p);
+            max = max.cwiseMax(p);
+        }
+        m_bounding_box.merge(min.cast<double>());
+        m_bounding_box.merge(max.cast<double>());
+    }
+
+    for (size_t i = quads_begin; i < quads_end; ++ i)
+        this->quad_indices.emplace_back(src.quad_indices[i] + shift);
+    for (size_t i = triangles_begin; i < triangles_end; ++ i)
+        this->triangle_indices.emplace_back(src.triangle_indices[i] + shift);
+
+    this->vertices_and_normals_interleaved_size = this->vertices_and_normals_interleaved.size();
+    this->quad_indices_size                     = this->quad_indices.size();
+    this->triangle_indices_size                 = this->triangle_indices.size();
+}
+
 void GLIndexedVertexArray::release_geometry()
 {
     if (this->vertices_and_normals_interleaved_VBO_id) {
@@ -1854,6 +1895,245 @@ void _3DScene::point3_to_verts(const Vec3crd& point, double width, double height
     thick_point_to_verts(point, width, height, volume);
 }
 
+// Estimate of the memory of a triangulated extrusion path: the vertices and the indices of its segments,
+// and the caps at its ends.
+static const constexpr size_t BYTES_PER_TRIANGULATED_SEGMENT = 232;
+static const constexpr size_t BYTES_PER_TRIANGULATED_PATH    = 56;
+
+// Number of segments of the paths of a layer once simplified with the tolerance in mm.
+static size_t simplified_segments(const GCodePreviewData::Extrusion::Layer &layer, double tolerance)
+{
+    size_t out = 0;
+    GCodePreviewData::Extrusion::Path path;
+    for (size_t path_id = 0; path_id < layer.num_paths(); ++ path_id) {
+        size_t num_points = layer.num_points(path_id);
+        if (num_points == 2 || tolerance <= 0.)
+            out += num_points - 1;
+        else {
+            layer.path(path_id, path);
+            out += MultiPoint::_douglas_peucker(path.polyline.points, scale_(tolerance)).size() - 1;
+        }
+    }
+    return out;
+}
+
+void GCodePreviewToolpathsCache::update(const GCodePreviewData &preview_data)
+{
+    const GCodePreviewData::Extrusion::LayersList &layers = preview_data.extrusion.layers;
+
+    if (m_timestamp != preview_data.timestamp()) {
+        this->reset();
+        m_layers.assign(layers.size(), Layer());
+
+        size_t num_paths    = 0;
+        size_t num_segments = 0;
+        for (const GCodePreviewData::Extrusion::Layer &layer : layers) {
+            num_paths += layer.num_paths();
+            for (size_t path_id = 0; path_id < layer.num_paths(); ++ path_id)
+                num_segments += layer.num_points(path_id) - 1;
+        }
+
+        // Find the tolerance fitting the memory budget, estimated by simplifying a sample of the layers.
+        double tolerance = m_limits.min_tolerance;
+        if (m_limits.memory_budget > 0 && num_segments > 0) {
+            const size_t budget_segments = (m_limits.memory_budget > num_paths * BYTES_PER_TRIANGULATED_PATH) ?
+                (m_limits.memory_budget - num_paths * BYTES_PER_TRIANGULATED_PATH) / BYTES_PER_TRIANGULATED_SEGMENT : 0;
+            if (num_segments > budget_segments) {
+                static const constexpr size_t NUM_SAMPLES = 64;
+                const size_t step = std::max<size_t>(layers.size() / NUM_SAMPLES, 1);
+                size_t sampled_segments = 0;
+                for (size_t i = 0; i < layers.size(); i += step)
+                    sampled_segments += simplified_segments(layers[i], 0.);
+                for (; tolerance < m_limits.max_tolerance; tolerance = std::min(2. * tolerance, m_limits.max_tolerance)) {
+                    std::vector<size_t> simplified((layers.size() + step - 1) / step, 0);
+                    tbb::parallel_for(size_t(0), simplified.size(), [&layers, &simplified, step, tolerance](size_t i) {
+                        simplified[i] = simplified_segments(layers[i * step], tolerance);
+                    });
+                    size_t sampled_simplified = std::accumulate(simplified.begin(), simplified.end(), size_t(0));
+                    if (double(num_segments) * double(sampled_simplified) <= double(budget_segments) * double(sampled_segments))
+                        break;
+                }
+            }
+        }
+
+        m_timestamp      = preview_data.timestamp();
+        m_tolerance      = tolerance;
+        m_stats.segments = num_segments;
+    }
+
+    // Triangulate the layers not triangulated yet or released by trim().
+    ++ m_last_used;
+    std::vector<size_t> layer_ids;
+    for (size_t layer_id = 0; layer_id < m_layers.size(); ++ layer_id) {
+        Layer &layer = m_layers[layer_id];
+        if (layer.cached)
+            layer.last_used = m_last_used;
+        else
+            layer_ids.emplace_back(layer_id);
+    }
+    m_stats.hits   = m_layers.size() - layer_ids.size();
+    m_stats.misses = layer_ids.size();
+    if (layer_ids.empty())
+        return;
+
+    this->triangulate(preview_data, layer_ids, m_tolerance);
+    this->update_stats();
+    BOOST_LOG_TRIVIAL(debug) << "G-code preview toolpaths triangulated: " << m_stats.to_string();
+}
+
+bool GCodePreviewToolpathsCache::refine(const GCodePreviewData &preview_data, size_t layer_begin, size_t layer_end)
+{
+    if (m_timestamp != preview_data.timestamp())
+        return false;
+
+    // The layers being viewed are the most recently used ones.
+    ++ m_last_used;
+    layer_end = std::min(layer_end, m_layers.size());
+    size_t memory = this->memory_used();
+    std::vector<size_t> layer_ids;
+    for (size_t layer_id = layer_end; layer_id > layer_begin; -- layer_id) {
+        Layer &layer = m_layers[layer_id - 1];
+        if (! layer.cached)
+            continue;
+        layer.last_used = m_last_used;
+        if (layer.tolerance <= m_limits.min_tolerance)
+            continue;
+        const GCodePreviewData::Extrusion::Layer &src = preview_data.extrusion.layers[layer_id - 1];
+        size_t refined = src.num_paths() * BYTES_PER_TRIANGULATED_PATH;
+        for (size_t path_id = 0; path_id < src.num_paths(); ++ path_id)
+            refined += (src.num_points(path_id) - 1) * BYTES_PER_TRIANGULATED_SEGMENT;
+        if (m_limits.memory_budget > 0 && memory + refined > m_limits.memory_budget + layer.memory_used())
+            break;
+        memory = memory + refined - layer.memory_used();
+        layer_ids.emplace_back(layer_id - 1);
+    }
+
+    if (layer_ids.empty())
+        return false;
+
+    const double time = m_stats.time;
+    this->triangulate(preview_data, layer_ids, m_limits.min_tolerance);
+    this->update_stats();
+    m_stats.time += time;
+    BOOST_LOG_TRIVIAL(debug) << "G-code preview toolpaths refined " << layer_ids.size() << " layers: " << m_stats.to_string();
+    return true;
+}
+
+void GCodePreviewToolpathsCache::trim()
+{
+    size_t memory = this->memory_used();
+    if (m_limits.cache_budget == 0 || memory <= m_limits.cache_budget)
+        return;
+
+    std::vector<size_t> layer_ids;
+    for (size_t layer_id = 0; layer_id < m_layers.size(); ++ layer_id)
+        if (m_layers[layer_id].cached)
+            layer_ids.emplace_back(layer_id);
+    // The least recently used first. Of the layers used together, the bottom ones first, as the top layers are shown by default.
+    std::sort(layer_ids.begin(), layer_ids.end(), [this](size_t l1, size_t l2)
+        { return m_layers[l1].last_used < m_layers[l2].last_used || (m_layers[l1].last_used == m_layers[l2].last_used && l1 < l2); });
+
+    size_t released = 0;
+    for (size_t layer_id : layer_ids) {
+        if (memory <= m_limits.cache_budget)
+            break;
+        Layer &layer = m_layers[layer_id];
+        memory -= layer.memory_used();
+        layer = Layer();
+        ++ released;
+    }
+
+    this->update_stats();
+    BOOST_LOG_TRIVIAL(debug) << "G-code preview toolpaths released " << released << " layers: " << m_stats.to_string();
+}
+
+void GCodePreviewToolpathsCache::triangulate(const GCodePreviewData &preview_data, const std::vector<size_t> &layer_ids, double tolerance)
+{
+    auto time_start = std::chrono::steady_clock::now();
+    const GCodePreviewData::Extrusion::LayersList &layers = preview_data.extrusion.layers;
+    // Each layer is triangulated into its own vertex array, the threads do not share any data.
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, layer_ids.size()), [&layers, &layer_ids, tolerance, this](const tbb::blocked_range<size_t> &range) {
+        GCodePreviewData::Extrusion::Path path;
+        Polyline                          polyline;
+        for (size_t i = range.begin(); i < range.end(); ++ i) {
+            const GCodePreviewData::Extrusion::Layer &layer = layers[layer_ids[i]];
+            Layer                                    &dst   = m_layers[layer_ids[i]];
+            dst = Layer();
+            dst.tolerance = tolerance;
+            dst.last_used = m_last_used;
+            dst.cached    = true;
+            dst.path_ends.reserve(layer.num_paths());
+            for (size_t path_id = 0; path_id < layer.num_paths(); ++ path_id) {
+                // decodes the path into the memory of the previous one
+                layer.path(path_id, path);
+                if (path.polyline.size() >= 2) {
+                    const Polyline *pl = &path.polyline;
+                    if (path.polyline.size() > 2 && tolerance > 0.) {
+                        polyline.points = MultiPoint::_douglas_peucker(path.polyline.points, scale_(tolerance));
+                        pl = &polyline;
+                    }
+                    size_t num_segments = pl->size() - 1;
+                    thick_lines_to_indexed_vertex_array(pl->lines(), std::vector<double>(num_segments, path.width), std::vector<double>(num_segments, path.height),
+                        false, layer.z, dst.geometry);
+                    dst.segments += num_segments;
+                }
+                dst.path_ends.push_back({ dst.geometry.vertices_and_normals_interleaved.size(), dst.geometry.quad_indices.size(), dst.geometry.triangle_indices.size() });
+            }
+            dst.geometry.shrink_to_fit();
+        }
+    });
+    m_stats.time = std::chrono::duration<double>(std::chrono::steady_clock::now() - time_start).count();
+}
+
+void GCodePreviewToolpathsCache::update_stats()
+{
+    m_stats.layers                = m_layers.size();
+    m_stats.layers_cached         = 0;
+    m_stats.layers_simplified     = 0;
+    m_stats.segments_triangulated = 0;
+    m_stats.tolerance             = m_limits.min_tolerance;
+    for (const Layer &layer : m_layers) {
+        if (layer.cached)
+            ++ m_stats.layers_cached;
+        m_stats.segments_triangulated += layer.segments;
+        if (layer.tolerance > m_limits.min_tolerance) {
+            ++ m_stats.layers_simplified;
+            m_stats.tolerance = std::max(m_stats.tolerance, layer.tolerance);
+        }
+    }
+    m_stats.memory_used = this->memory_used();
+}
+
+std::string GCodePreviewToolpathsCache::Stats::to_string() const
+{
+    return (boost::format("%1% layers, %2% cached, %3% simplified with tolerance %4% mm, %5% of %6% segments triangulated, %7% in %8% s, %9% hits, %10% misses")
+        % layers % layers_cached % layers_simplified % tolerance % segments_triangulated % segments % Slic3r::format_memsize_MB(memory_used) % time
+        % hits % misses).str();
+}
+
+void GCodePreviewToolpathsCache::append_path(size_t layer_id, size_t path_id, GLIndexedVertexArray &dst) const
+{
+    const Layer                &layer = m_layers[layer_id];
+    assert(layer.cached);
+    const std::array<size_t, 3> begin = layer.path_begin(path_id);
+    const std::array<size_t, 3> &end  = layer.path_ends[path_id];
+    dst.append(layer.geometry, begin[0], end[0], begin[1], end[1], begin[2], end[2]);
+}
+
+size_t GCodePreviewToolpathsCache::path_vertices_size(size_t layer_id, size_t path_id) const
+{
+    const Layer &layer = m_layers[layer_id];
+    return layer.path_ends[path_id][0] - layer.path_begin(path_id)[0];
+}
+
+size_t GCodePreviewToolpathsCache::memory_used() const
+{
+    size_t out = sizeof(*this) + m_layers.capacity() * sizeof(Layer);
+    for (const Layer &layer : m_layers)
+        out += layer.memory_used();
+    return out;
+}
+
 #if !ENABLE_NON_STATIC_CANVAS_MANAGER
 GUI::GLCanvas3DManager _3DScene::s_canvas_mgr;
 #endif // !ENABLE_NON_STATIC_CANVAS_MANAGER
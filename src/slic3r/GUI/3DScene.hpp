@@ -11,6 +11,7 @@
 #include "slic3r/GUI/GLCanvas3DManager.hpp"
 #endif // !ENABLE_NON_STATIC_CANVAS_MANAGER
 
+#include <array>
 #include <functional>
 
 #ifndef NDEBUG
@@ -38,6 +39,7 @@ class GLToolbar;
 class SLAPrintObject;
 enum  SLAPrintObjectStep : unsigned int;
 class DynamicPrintConfig;
+class GCodePreviewData;
 class ExtrusionPath;
 class ExtrusionMultiPath;
 class ExtrusionLoop;
@@ -189,6 +191,13 @@ public:
         this->quad_indices_size = this->quad_indices.size();
     };
 
+    // Append a range of vertices of src together with the quads and triangles in the given ranges of its indices,
+    // which shall only reference the vertices of the range. The ranges are in the number of floats / indices.
+    void append(const GLIndexedVertexArray &src,
+                size_t vertices_begin, size_t vertices_end,
+                size_t quads_begin, size_t quads_end,
+                size_t triangles_begin, size_t triangles_end);
+
     // Finalize the initialization of the geometry & indices,
     // upload the geometry and indices to OpenGL VBO objects
     // and shrink the allocated data, possibly relasing it if it has been loaded into the VBOs.
@@ -608,6 +617,106 @@ private:
 
 GLVolumeWithIdAndZList volumes_to_render(const GLVolumePtrs& volumes, GLVolumeCollection::ERenderType type, const Transform3d& view_matrix, std::function<bool(const GLVolume&)> filter_func = nullptr);
 
+// Triangulated extrusion paths of the G-code preview.
+// The layers are triangulated in parallel, each into its own vertex array, therefore without any locking.
+// The triangulation is kept until the toolpaths of the GCodePreviewData change, thus the reloads of the preview
+// changing just the coloring of the paths (view type, color ranges, extruder filter) only copy the triangulated paths
+// into the GLVolumes of their colors.
+//
+// The paths are simplified before triangulation, which merges the collinear segments. If the triangulation would not fit
+// the memory budget, all the layers are simplified with a coarser tolerance first and the layers being viewed are refined later.
+//
+// Once the GLVolumes are sent to the GPU, trim() releases the least recently used layers exceeding the cache budget,
+// they are triangulated again by the next update().
+class GCodePreviewToolpathsCache
+{
+public:
+    struct Limits {
+        // Memory budget of the triangulated paths in bytes, zero for unlimited.
+        size_t memory_budget { 0 };
+        // Memory kept by trim() in bytes, zero for unlimited.
+        size_t cache_budget  { 0 };
+        // Tolerance of the simplification always applied, in mm. Well below the resolution of the screen at the usual zoom levels.
+        double min_tolerance { 0.005 };
+        // Maximum tolerance of the simplification, in mm. The memory budget is rather exceeded than simplifying the paths even more.
+        double max_tolerance { 0.5 };
+    };
+
+    struct Stats {
+        size_t layers                 { 0 };
+        // Number of layers triangulated, not released by trim().
+        size_t layers_cached          { 0 };
+        // Number of layers triangulated with a coarser tolerance than Limits::min_tolerance.
+        size_t layers_simplified      { 0 };
+        size_t segments               { 0 };
+        size_t segments_triangulated  { 0 };
+        // Tolerance of the simplified layers in mm.
+        double tolerance              { 0. };
+        size_t memory_used            { 0 };
+        // Number of layers taken from the cache and triangulated by the last update().
+        size_t hits                   { 0 };
+        size_t misses                 { 0 };
+        // Wall clock time spent by the triangulation in seconds.
+        double time                   { 0. };
+
+        std::string to_string() const;
+    };
+
+    void set_limits(const Limits &limits) { m_limits = limits; }
+    const Limits& limits() const { return m_limits; }
+    const Stats&  stats() const { return m_stats; }
+
+    // Triangulate the extrusion paths of preview_data, unless they are cached already.
+    void update(const GCodePreviewData &preview_data);
+    // Triangulate the simplified layers of the range <layer_begin, layer_end) with Limits::min_tolerance, the top layers first,
+    // as long as the memory budget allows. Returns true if any layer was refined, thus the GLVolumes shall be reloaded.
+    bool refine(const GCodePreviewData &preview_data, size_t layer_begin, size_t layer_end);
+    // Release the least recently used layers until the cache fits Limits::cache_budget.
+    void trim();
+    void reset() { m_timestamp = 0; m_tolerance = 0.; m_last_used = 0; m_layers.clear(); m_layers.shrink_to_fit(); m_stats = Stats(); }
+    bool empty() const { return m_layers.empty(); }
+    bool is_cached(size_t layer_id) const { return layer_id < m_layers.size() && m_layers[layer_id].cached; }
+
+    // Append the triangulated path of the layer to dst, the indices are shifted to the vertices of dst.
+    void append_path(size_t layer_id, size_t path_id, GLIndexedVertexArray &dst) const;
+    // Number of floats of the interleaved vertices and normals of the triangulated path.
+    size_t path_vertices_size(size_t layer_id, size_t path_id) const;
+
+    // Return an estimate of the memory consumed by the cache.
+    size_t memory_used() const;
+
+private:
+    struct Layer {
+        GLIndexedVertexArray  geometry;
+        // Ends of the vertices, the quad indices and the triangle indices of each path in geometry.
+        std::vector<std::array<size_t, 3>> path_ends;
+        // Tolerance of the simplification of the paths in mm.
+        double                tolerance { 0. };
+        size_t                segments  { 0 };
+        // Value of m_last_used when the layer was last updated or refined.
+        size_t                last_used { 0 };
+        // False if not triangulated yet or released by trim().
+        bool                  cached    { false };
+
+        std::array<size_t, 3> path_begin(size_t path_id) const { return (path_id == 0) ? std::array<size_t, 3>{ 0, 0, 0 } : path_ends[path_id - 1]; }
+        size_t                memory_used() const { return geometry.cpu_memory_used() - sizeof(geometry) + path_ends.capacity() * sizeof(path_ends.front()); }
+    };
+
+    // Triangulate the layers of the given indices, in parallel.
+    void triangulate(const GCodePreviewData &preview_data, const std::vector<size_t> &layer_ids, double tolerance);
+    void update_stats();
+
+    // GCodePreviewData::timestamp() of the cached toolpaths, zero if none.
+    size_t              m_timestamp { 0 };
+    // Tolerance fitting all the layers into the memory budget, used to triangulate the released layers again.
+    double              m_tolerance { 0. };
+    // Incremented by each update() and refine().
+    size_t              m_last_used { 0 };
+    std::vector<Layer>  m_layers;
+    Limits              m_limits;
+    Stats               m_stats;
+};
+
 class GLModel
 {
 protected:
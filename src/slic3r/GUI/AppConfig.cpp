@@ -42,6 +42,9 @@ void AppConfig::set_defaults()
     // Disable background processing by default as it is not stable.
     if (get("background_processing").empty())
         set("background_processing", "0");
+    // Speculative slicing of the values being edited doubles the memory consumed by the sliced objects, disable it by default.
+    if (get("background_speculative_slicing").empty())
+        set("background_speculative_slicing", "0");
     // If set, the "Controller" tab for the control of the printer over serial line and the serial port settings are hidden.
     // By default, Prusa has the controller hidden.
     if (get("no_controller").empty())
@@ -41,10 +41,12 @@ BackgroundSlicingProcess::BackgroundSlicingProcess()
     boost::filesystem::path temp_path(wxStandardPaths::Get().GetTempDir().utf8_str().data());
     temp_path /= (boost::format(".%1%.gcode") % get_current_pid()).str();
 	m_temp_output_path = temp_path.string();
+	m_speculative_print.set_status_silent();
 }
 
 BackgroundSlicingProcess::~BackgroundSlicingProcess() 
 { 
+	this->stop_speculation();
 	this->stop();
 	this->join_background_thread();
 	boost::nowide::remove(m_temp_output_path.c_str());
@@ -247,6 +249,18 @@ void BackgroundSlicingProcess::thread_proc_safe()
    	}
 }
 
+void BackgroundSlicingProcess::speculative_thread_proc()
+{
+	try {
+		m_speculative_print.process();
+	} catch (...) {
+		// Canceled, or the configuration is not valid. In the latter case the error will be reported
+		// by the regular background processing if this configuration is applied.
+	}
+	m_speculative_print.finalize();
+	m_speculation_running = false;
+}
+
 void BackgroundSlicingProcess::join_background_thread()
 {
 	std::unique_lock<std::mutex> lck(m_mutex);
@@ -285,6 +299,8 @@ bool BackgroundSlicingProcess::start()
 		return false;
 	if (! this->idle())
 		throw std::runtime_error("Cannot start a background task, the worker thread is not idle.");
+	// The regular background processing takes precedence over the speculative slicing.
+	this->stop_speculation();
 	m_state = STATE_STARTED;
 	m_print->set_cancel_callback([this](){ this->stop_internal(); });
 	lck.unlock();
@@ -320,6 +336,9 @@ bool BackgroundSlicingProcess::stop()
 bool BackgroundSlicingProcess::reset()
 {
 	bool stopped = this->stop();
+	this->stop_speculation();
+	m_speculative_print.clear();
+	m_speculation_pending = false;
 	this->reset_export();
 	m_print->clear();
 	this->invalidate_all_steps();
@@ -373,6 +392,20 @@ Print::ApplyStatus BackgroundSlicingProcess::apply(const Model &model, const Dyn
 	assert(m_print != nullptr);
 	assert(config.opt_enum<PrinterTechnology>("printer_technology") == m_print->technology());
 	Print::ApplyStatus invalidated = m_print->apply(model, config);
+	if (m_speculation_pending) {
+		// Take over the speculatively sliced objects, if they were sliced with the configuration just applied.
+		this->stop_speculation();
+		m_speculation_pending = false;
+		size_t num_taken_over = 0;
+		if (m_print == m_fff_print && m_state != STATE_STARTED && m_state != STATE_RUNNING)
+			num_taken_over = m_fff_print->take_over_object_steps(m_speculative_print);
+		if (num_taken_over > 0)
+			++ m_speculation_stats.hits;
+		else
+			++ m_speculation_stats.misses;
+		BOOST_LOG_TRIVIAL(info) << "Speculative slicing " << (num_taken_over > 0 ? "hit" : "miss") << ", " << num_taken_over << " objects taken over, hit rate " <<
+			int(100. * m_speculation_stats.hit_rate() + 0.5) << "% of " << m_speculation_stats.hits + m_speculation_stats.misses;
+	}
 	if ((invalidated & PrintBase::APPLY_STATUS_INVALIDATED) != 0 && m_print->technology() == ptFFF &&
 		m_gcode_preview_data != nullptr && ! this->m_fff_print->is_step_done(psGCodeExport)) {
 		// Some FFF status was invalidated, and the G-code was not exported yet.
@@ -383,6 +416,41 @@ Print::ApplyStatus BackgroundSlicingProcess::apply(const Model &model, const Dyn
 	return invalidated;
 }
 
+bool BackgroundSlicingProcess::speculate(const Model &model, const DynamicPrintConfig &config)
+{
+	if (m_print != m_fff_print || m_state == STATE_STARTED || m_state == STATE_RUNNING || this->is_export_scheduled() || this->is_upload_scheduled())
+		// Only speculate on idle cores.
+		return true;
+	if (m_speculation_running) {
+		// Don't block the UI thread waiting for the canceled speculation to finish.
+		m_speculative_print.cancel();
+		return false;
+	}
+	// The thread has finished already, joining it does not block.
+	this->stop_speculation();
+	// The steps of the speculative print not affected by the configuration change are kept.
+	m_speculative_print.apply(model, config);
+	if (m_speculative_print.empty())
+		return true;
+	PrintBase::TaskParams params;
+	params.to_object_step = posPerimeters;
+	m_speculative_print.set_task(params);
+	m_speculation_pending = true;
+	++ m_speculation_stats.started;
+	m_speculation_running = true;
+	m_speculative_thread = create_thread([this]{ this->speculative_thread_proc(); });
+	return true;
+}
+
+void BackgroundSlicingProcess::stop_speculation()
+{
+	if (m_speculative_thread.joinable()) {
+		m_speculative_print.cancel();
+		m_speculative_thread.join();
+		m_speculative_print.restart();
+	}
+}
+
 void BackgroundSlicingProcess::set_task(const PrintBase::TaskParams &params)
 {
 	assert(m_print != nullptr);
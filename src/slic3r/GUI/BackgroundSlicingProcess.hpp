@@ -2,6 +2,7 @@
 #define slic3r_GUI_BackgroundSlicingProcess_hpp_
 
 #include <string>
+#include <atomic>
 #include <condition_variable>
 #include <mutex>
 
@@ -88,6 +89,28 @@ public:
 	// After calling the apply() function, set_task() may be called to limit the task to be processed by process().
 	// This is useful for calculating SLA supports for a single object only.
 	void 		set_task(const PrintBase::TaskParams &params);
+	// Slice the objects and generate their perimeters with a configuration, which is likely to be applied next,
+	// for example with a value being edited at a settings page. The speculative slicing runs on its own thread
+	// and only if the background processing is not running. If the configuration passed to the next apply()
+	// matches, the speculatively sliced objects are taken over by the print.
+	// The caller shall not call it for each key stroke, but once the editing pauses.
+	// Does not block: If the previous speculation is still running, it is canceled and false is returned,
+	// then speculate() shall be called again later.
+	bool 		speculate(const Model &model, const DynamicPrintConfig &config);
+	// Cancel the speculative slicing and wait for its thread to finish.
+	void 		stop_speculation();
+
+	struct SpeculationStats {
+		// Number of the speculative slicing tasks started.
+		size_t 	started = 0;
+		// Number of the apply() calls following a speculation, which took over the speculatively sliced objects.
+		size_t 	hits 	= 0;
+		// Number of the apply() calls following a speculation, which did not take over anything.
+		size_t 	misses 	= 0;
+		double 	hit_rate() const { return (hits + misses == 0) ? 0. : double(hits) / double(hits + misses); }
+	};
+	const SpeculationStats& speculation_stats() const { return m_speculation_stats; }
+
 	// After calling apply, the empty() call will report whether there is anything to slice.
 	bool 		empty() const;
 	// Validate the print. Returns an empty string if valid, returns an error message if invalid.
@@ -134,6 +157,7 @@ public:
 private:
 	void 	thread_proc();
 	void 	thread_proc_safe();
+	void 	speculative_thread_proc();
 	void 	join_background_thread();
 	// To be called by Print::apply() through the Print::m_cancel_callback to stop the background
 	// processing before changing any data of running or finalized milestones.
@@ -172,6 +196,15 @@ private:
 	std::condition_variable		m_condition;
 	State 						m_state = STATE_INITIAL;
 
+	// Print sliced speculatively by m_speculative_thread, see speculate().
+	Print 						m_speculative_print;
+	boost::thread 				m_speculative_thread;
+	// Cleared by m_speculative_thread when finished, then it may be joined without blocking.
+	std::atomic<bool> 			m_speculation_running { false };
+	// Was a speculation started since the last apply()?
+	bool 						m_speculation_pending = false;
+	SpeculationStats 			m_speculation_stats;
+
     PrintState<BackgroundSlicingProcessStep, bspsCount>   	m_step_state;
     mutable tbb::mutex                      				m_step_state_mutex;
 	bool                set_step_started(BackgroundSlicingProcessStep step);
@@ -107,6 +107,12 @@ void Field::on_change_field()
         m_on_change(m_opt_id, get_value());
 }
 
+void Field::on_pending_change_field(const std::string &text)
+{
+    if (m_on_pending_change != nullptr && !m_disable_change_event)
+        m_on_pending_change(m_opt_id, text);
+}
+
 void Field::on_back_to_initial_value()
 {
 	if (m_back_to_initial_value != nullptr && m_is_modified_value)
@@ -357,6 +363,14 @@ void TextCtrl::BUILD() {
     }
 
     temp->Bind(wxEVT_SET_FOCUS, ([this](wxEvent& e) { on_set_focus(e); }), temp->GetId());
+
+    // The value being typed is only committed on kill focus or on enter, let the owner know about it in advance.
+    temp->Bind(wxEVT_TEXT, ([this, temp](wxCommandEvent& e)
+    {
+        e.Skip();
+        if (temp->HasFocus())
+            on_pending_change_field(into_u8(temp->GetValue()));
+    }), temp->GetId());
     
 	temp->Bind(wxEVT_LEFT_DOWN, ([temp](wxEvent& event)
 	{
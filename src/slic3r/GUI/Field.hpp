@@ -34,6 +34,7 @@ class Field;
 using t_field = std::unique_ptr<Field>;
 using t_kill_focus = std::function<void(const std::string&)>;
 using t_change = std::function<void(const t_config_option_key&, const boost::any&)>;
+using t_pending_change = std::function<void(const t_config_option_key&, const std::string&)>;
 using t_back_to_init = std::function<void(const std::string&)>;
 
 wxString double_to_string(double const value, const int max_precision = 4);
@@ -87,6 +88,8 @@ protected:
     void			on_set_focus(wxEvent& event);
     /// Call the attached on_change method. 
     void			on_change_field();
+    /// Call the attached m_on_pending_change method.
+    void			on_pending_change_field(const std::string &text);
     /// Call the attached m_back_to_initial_value method. 
 	void			on_back_to_initial_value();
     /// Call the attached m_back_to_sys_value method. 
@@ -105,6 +108,10 @@ public:
     /// Function object to store callback passed in from owning object.
 	t_change		m_on_change {nullptr};
 
+    /// Function object to store callback passed in from owning object.
+    /// Called with the text being edited, before the value is committed by on_change_field().
+	t_pending_change m_on_pending_change {nullptr};
+
 	/// Function object to store callback passed in from owning object.
 	t_back_to_init	m_back_to_initial_value{ nullptr };
 	t_back_to_init	m_back_to_sys_value{ nullptr };
@@ -54,6 +54,7 @@
 
 #include <tbb/parallel_for.h>
 #include <tbb/spin_mutex.h>
+#include <tbb/enumerable_thread_specific.h>
 
 #include <boost/log/trivial.hpp>
 #include <boost/algorithm/string/predicate.hpp>
@@ -85,6 +86,8 @@ static const size_t MAX_VERTEX_BUFFER_SIZE     = 131072 * 6; // 3.15MB
 static const size_t VERTEX_BUFFER_RESERVE_SIZE = 131072 * 2; // 1.05MB
 // Reserve size in number of floats, maximum sum of all preallocated buffers.
 static const size_t VERTEX_BUFFER_RESERVE_SIZE_SUM_MAX = 1024 * 1024 * 128 / 4; // 128MB
+// Memory kept by the cache of the triangulated G-code preview paths once the paths are sent to the GPU, in bytes.
+static const size_t GCODE_TOOLPATHS_CACHE_BUDGET = 1024 * 1024 * 256; // 256MB
 
 namespace Slic3r {
 namespace GUI {
@@ -2299,6 +2302,7 @@ std::vector<double> GLCanvas3D::get_current_print_zs(bool active_only) const
 
 void GLCanvas3D::set_toolpaths_range(double low, double high)
 {
+    m_toolpaths_range = std::make_pair(low, high);
     m_volumes.set_range(low, high);
 }
 
@@ -2864,6 +2868,8 @@ void GLCanvas3D::load_preview(const std::vector<std::string>& str_tool_colors, c
 
     // Release OpenGL data before generating new data.
     this->reset_volumes();
+    // The G-code preview is not valid, release its triangulated paths.
+    m_gcode_toolpaths_cache.reset();
 
     _load_print_toolpaths();
     _load_wipe_tower_toolpaths(str_tool_colors);
@@ -6192,17 +6198,14 @@ void GLCanvas3D::_load_print_object_toolpaths(const PrintObject& print_object, c
 
     //FIXME Improve the heuristics for a grain size.
     size_t          grain_size = std::max(ctxt.layers.size() / 16, size_t(1));
-    tbb::spin_mutex new_volume_mutex;
-    auto            new_volume = [this, &new_volume_mutex](const float *color) -> GLVolume* {
-    	// Allocate the volume before locking.
-		GLVolume *volume = new GLVolume(color);
-		volume->is_extrusion_path = true;
-    	tbb::spin_mutex::scoped_lock lock;
-    	// Lock by ROII, so if the emplace_back() fails, the lock will be released.
-        lock.acquire(new_volume_mutex);
-        m_volumes.volumes.emplace_back(volume);
-        lock.release();
-        return volume;
+    // The new volumes are collected per thread without locking and moved to m_volumes after the parallel loop.
+    // The volumes are owned by new_volumes_per_thread until moved to m_volumes, thus they are released if the loading throws.
+    tbb::enumerable_thread_specific<std::vector<std::unique_ptr<GLVolume>>> new_volumes_per_thread;
+    auto            new_volume = [&new_volumes_per_thread](const float *color) -> GLVolume* {
+        std::vector<std::unique_ptr<GLVolume>> &volumes = new_volumes_per_thread.local();
+        volumes.emplace_back(std::make_unique<GLVolume>(color));
+		volumes.back()->is_extrusion_path = true;
+        return volumes.back().get();
     };
     const size_t    volumes_cnt_initial = m_volumes.volumes.size();
     tbb::parallel_for(
@@ -6312,6 +6315,13 @@ void GLCanvas3D::_load_print_object_toolpaths(const PrintObject& print_object, c
     });
 
     BOOST_LOG_TRIVIAL(debug) << "Loading print object toolpaths in parallel - finalizing results" << m_volumes.log_memory_info() << log_memory_info();
+    size_t num_new_volumes = 0;
+    for (const std::vector<std::unique_ptr<GLVolume>> &volumes : new_volumes_per_thread)
+        num_new_volumes += volumes.size();
+    m_volumes.volumes.reserve(m_volumes.volumes.size() + num_new_volumes);
+    for (std::vector<std::unique_ptr<GLVolume>> &volumes : new_volumes_per_thread)
+        for (std::unique_ptr<GLVolume> &volume : volumes)
+            m_volumes.volumes.emplace_back(volume.release());
     // Remove empty volumes from the newly added volumes.
     m_volumes.volumes.erase(
         std::remove_if(m_volumes.volumes.begin() + volumes_cnt_initial, m_volumes.volumes.end(),
@@ -6378,18 +6388,15 @@ void GLCanvas3D::_load_wipe_tower_toolpaths(const std::vector<std::string>& str_
     //FIXME Improve the heuristics for a grain size.
     size_t          n_items = print->wipe_tower_data().tool_changes.size() + (ctxt.priming.empty() ? 0 : 1);
     size_t          grain_size = std::max(n_items / 128, size_t(1));
-    tbb::spin_mutex new_volume_mutex;
-    auto            new_volume = [this, &new_volume_mutex](const float *color) -> GLVolume* {
-        auto *volume = new GLVolume(color);
-		volume->is_extrusion_path = true;
-        tbb::spin_mutex::scoped_lock lock;
-        lock.acquire(new_volume_mutex);
-        m_volumes.volumes.emplace_back(volume);
-        lock.release();
-        return volume;
+    // The volumes are owned by new_volumes_per_thread until moved to m_volumes, thus they are released if the loading throws.
+    tbb::enumerable_thread_specific<std::vector<std::unique_ptr<GLVolume>>> new_volumes_per_thread;
+    auto            new_volume = [&new_volumes_per_thread](const float *color) -> GLVolume* {
+        std::vector<std::unique_ptr<GLVolume>> &volumes = new_volumes_per_thread.local();
+        volumes.emplace_back(std::make_unique<GLVolume>(color));
+		volumes.back()->is_extrusion_path = true;
+        return volumes.back().get();
     };
     const size_t   volumes_cnt_initial = m_volumes.volumes.size();
-    std::vector<GLVolumeCollection> volumes_per_thread(n_items);
     tbb::parallel_for(
         tbb::blocked_range<size_t>(0, n_items, grain_size),
         [&ctxt, &new_volume](const tbb::blocked_range<size_t>& range) {
@@ -6470,6 +6477,13 @@ void GLCanvas3D::_load_wipe_tower_toolpaths(const std::vector<std::string>& str_
     });
 
     BOOST_LOG_TRIVIAL(debug) << "Loading wipe tower toolpaths in parallel - finalizing results" << m_volumes.log_memory_info() << log_memory_info();
+    size_t num_new_volumes = 0;
+    for (const std::vector<std::unique_ptr<GLVolume>> &volumes : new_volumes_per_thread)
+        num_new_volumes += volumes.size();
+    m_volumes.volumes.reserve(m_volumes.volumes.size() + num_new_volumes);
+    for (std::vector<std::unique_ptr<GLVolume>> &volumes : new_volumes_per_thread)
+        for (std::unique_ptr<GLVolume> &volume : volumes)
+            m_volumes.volumes.emplace_back(volume.release());
     // Remove empty volumes from the newly added volumes.
     m_volumes.volumes.erase(
         std::remove_if(m_volumes.volumes.begin() + volumes_cnt_initial, m_volumes.volumes.end(),
@@ -6575,17 +6589,22 @@ void GLCanvas3D::_load_gcode_extrusion_paths(const GCodePreviewData& preview_dat
 	    size_t vertex_buffer_prealloc_size = 0;
 	    std::vector<std::vector<std::pair<float, GLVolume*>>> roles_filters;
 	    {
+		    GCodePreviewData::Extrusion::Path path;
 		    std::vector<size_t> num_paths_per_role(size_t(erCount), 0);
 		    for (const GCodePreviewData::Extrusion::Layer &layer : preview_data.extrusion.layers)
-		        for (const GCodePreviewData::Extrusion::Path &path : layer.paths)
+		        for (size_t path_id = 0; path_id < layer.num_paths(); ++ path_id) {
+		        	layer.path_attributes(path_id, path);
 		        	++ num_paths_per_role[size_t(path.extrusion_role)];
+		        }
             std::vector<std::vector<float>> roles_values;
 			roles_values.assign(size_t(erCount), std::vector<float>());
 		    for (size_t i = 0; i < roles_values.size(); ++ i)
 		    	roles_values[i].reserve(num_paths_per_role[i]);
             for (const GCodePreviewData::Extrusion::Layer& layer : preview_data.extrusion.layers)
-		        for (const GCodePreviewData::Extrusion::Path &path : layer.paths)
+		        for (size_t path_id = 0; path_id < layer.num_paths(); ++ path_id) {
+		        	layer.path_attributes(path_id, path);
 		        	roles_values[size_t(path.extrusion_role)].emplace_back(Helper::path_filter(preview_data.extrusion.view_type, path));
+		        }
             roles_filters.reserve(size_t(erCount));
 			size_t num_buffers = 0;
 		    for (std::vector<float> &values : roles_values) {
@@ -6608,14 +6627,38 @@ void GLCanvas3D::_load_gcode_extrusion_paths(const GCodePreviewData& preview_dat
 			}
 		}
 
+	    BOOST_LOG_TRIVIAL(debug) << "Loading G-code extrusion paths - triangulate paths" << m_volumes.log_memory_info() << log_memory_info();
+
+	    // triangulates the paths in parallel, unless they were triangulated already for a different coloring,
+	    // simplified to fit a quarter of the physical memory
+	    GCodePreviewToolpathsCache::Limits limits;
+	    limits.memory_budget = total_physical_memory() / 4;
+	    limits.cache_budget  = GCODE_TOOLPATHS_CACHE_BUDGET;
+	    m_gcode_toolpaths_cache.set_limits(limits);
+	    m_gcode_toolpaths_cache.update(preview_data);
+	    {
+	    	// refines the simplified layers shown by the layers slider
+	    	const GCodePreviewData::Extrusion::LayersList &layers = preview_data.extrusion.layers;
+	    	size_t layer_begin = 0;
+	    	while (layer_begin < layers.size() && layers[layer_begin].z < m_toolpaths_range.first)
+	    		++ layer_begin;
+	    	size_t layer_end = layer_begin;
+	    	while (layer_end < layers.size() && layers[layer_end].z <= m_toolpaths_range.second)
+	    		++ layer_end;
+	    	m_gcode_toolpaths_cache.refine(preview_data, layer_begin, layer_end);
+	    }
+
 	    BOOST_LOG_TRIVIAL(debug) << "Loading G-code extrusion paths - populate volumes" << m_volumes.log_memory_info() << log_memory_info();
 
-	    // populates volumes
+	    // populates volumes by copying the triangulated paths
         const bool is_selected_separate_extruder = m_selected_extruder > 0 && preview_data.extrusion.view_type == GCodePreviewData::Extrusion::ColorPrint;
-		for (const GCodePreviewData::Extrusion::Layer& layer : preview_data.extrusion.layers)
+        GCodePreviewData::Extrusion::Path path;
+		for (size_t layer_id = 0; layer_id < preview_data.extrusion.layers.size(); ++ layer_id)
 		{
-			for (const GCodePreviewData::Extrusion::Path& path : layer.paths)
+			const GCodePreviewData::Extrusion::Layer& layer = preview_data.extrusion.layers[layer_id];
+			for (size_t path_id = 0; path_id < layer.num_paths(); ++ path_id)
 			{
+				layer.path_attributes(path_id, path);
                 if (is_selected_separate_extruder && path.extruder_id != m_selected_extruder - 1)
                     continue;
 				std::vector<std::pair<float, GLVolume*>> &filters = roles_filters[size_t(path.extrusion_role)];
@@ -6628,7 +6671,7 @@ void GLCanvas3D::_load_gcode_extrusion_paths(const GCodePreviewData& preview_dat
 				vol.offsets.emplace_back(vol.indexed_vertex_array.quad_indices.size());
 				vol.offsets.emplace_back(vol.indexed_vertex_array.triangle_indices.size());
 
-				_3DScene::extrusionentity_to_verts(path.polyline, path.width, path.height, layer.z, vol);
+				m_gcode_toolpaths_cache.append_path(layer_id, path_id, vol.indexed_vertex_array);
 			}
 			// Ensure that no volume grows over the limits. If the volume is too large, allocate a new one.
 		    for (std::vector<std::pair<float, GLVolume*>> &filters : roles_filters) {
@@ -6648,6 +6691,8 @@ void GLCanvas3D::_load_gcode_extrusion_paths(const GCodePreviewData& preview_dat
 	    for (std::vector<std::pair<float, GLVolume*>> &filters : roles_filters)
 		    for (std::pair<float, GLVolume*> &filter : filters)
 	    		filter.second->indexed_vertex_array.finalize_geometry(m_initialized);
+	    // the volumes hold their own copy of the triangulated paths now, keep just the layers used recently
+	    m_gcode_toolpaths_cache.trim();
 
 	    BOOST_LOG_TRIVIAL(debug) << "Loading G-code extrusion paths - end" << m_volumes.log_memory_info() << log_memory_info();
 	} 
@@ -6660,6 +6705,7 @@ void GLCanvas3D::_load_gcode_extrusion_paths(const GCodePreviewData& preview_dat
             delete *it;
         m_volumes.volumes.erase(begin, end);
         m_gcode_preview_volume_index.first_volumes.erase(m_gcode_preview_volume_index.first_volumes.begin() + initial_volume_index_count, m_gcode_preview_volume_index.first_volumes.end());
+        m_gcode_toolpaths_cache.reset();
 	    BOOST_LOG_TRIVIAL(debug) << "Loading G-code extrusion paths - failed on low memory" << m_volumes.log_memory_info() << log_memory_info();
         //FIXME rethrow bad_alloc?
 	}
@@ -6676,12 +6722,16 @@ inline void travel_paths_internal(
 
 {
 	// colors travels by type
+	const GCodePreviewData::Travel::PolylinesList &polylines = preview_data.travel.polylines;
+	GCodePreviewData::Travel::Polyline polyline;
 	std::vector<std::pair<TYPE, GLVolume*>> by_type;
 	{
 		std::vector<TYPE> values;
-		values.reserve(preview_data.travel.polylines.size());
-		for (const GCodePreviewData::Travel::Polyline& polyline : preview_data.travel.polylines)
+		values.reserve(polylines.size());
+		for (size_t polyline_id = 0; polyline_id < polylines.size(); ++ polyline_id) {
+			polylines.polyline_attributes(polyline_id, polyline);
 			values.emplace_back(func_value(polyline));
+		}
 		sort_remove_duplicates(values);
 		by_type.reserve(values.size());
 		// creates a new volume for each feedrate
@@ -6691,14 +6741,16 @@ inline void travel_paths_internal(
 
 	// populates volumes
 	std::pair<TYPE, GLVolume*> key(0.f, nullptr);
-	for (const GCodePreviewData::Travel::Polyline& polyline : preview_data.travel.polylines)
+	for (size_t polyline_id = 0; polyline_id < polylines.size(); ++ polyline_id)
 	{
+		// decodes the polyline into the memory of the previous one
+		polylines.polyline(polyline_id, polyline);
 		key.first = func_value(polyline);
 		auto it = std::lower_bound(by_type.begin(), by_type.end(), key, [](const std::pair<TYPE, GLVolume*>& l, const std::pair<TYPE, GLVolume*>& r) { return l.first < r.first; });
 		assert(it != by_type.end() && it->first == func_value(polyline));
 
 		GLVolume& vol = *it->second;
-		vol.print_zs.emplace_back(unscale<double>(polyline.polyline.bounding_box().min(2)));
+		vol.print_zs.emplace_back(unscale<double>(polylines.min_z(polyline_id)));
 		vol.offsets.emplace_back(vol.indexed_vertex_array.quad_indices.size());
 		vol.offsets.emplace_back(vol.indexed_vertex_array.triangle_indices.size());
 
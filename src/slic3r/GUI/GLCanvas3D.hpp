@@ -494,6 +494,10 @@ private:
     bool m_reload_delayed;
 
     GCodePreviewVolumeIndex m_gcode_preview_volume_index;
+    // Triangulated extrusion paths of the last G-code preview, reused when only the coloring changes.
+    GCodePreviewToolpathsCache m_gcode_toolpaths_cache;
+    // Range of the print_z of the toolpaths shown, the simplified G-code preview layers of this range are refined on reload.
+    std::pair<double, double> m_toolpaths_range { 0., DBL_MAX };
 
 #if ENABLE_RENDER_PICKING_PASS
     bool m_show_picking_texture;
@@ -73,6 +73,11 @@ const t_field& OptionsGroup::build_field(const t_config_option_key& id, const Co
 			if (!m_disabled) 
 				this->on_change_OG(opt_id, value);
 	};
+    field->m_on_pending_change = [this](const std::string& opt_id, const std::string& text) {
+			//! This function will be called from Field.
+			if (!m_disabled)
+				this->on_pending_change(opt_id, text);
+	};
     field->m_on_kill_focus = [this](const std::string& opt_id) {
 			//! This function will be called from Field.					
 			if (!m_disabled) 
@@ -404,6 +409,35 @@ void ConfigOptionsGroup::on_change_OG(const t_config_option_key& opt_id, const b
 	OptionsGroup::on_change_OG(opt_id, value); 
 }
 
+void ConfigOptionsGroup::on_pending_change(const t_config_option_key& opt_id, const std::string& text)
+{
+	auto it = m_opt_map.find(opt_id);
+	if (m_on_pending_change == nullptr || m_config == nullptr || it == m_opt_map.end())
+		return;
+	const std::string &opt_key   = it->second.first;
+	int                opt_index = it->second.second;
+	const ConfigOption *opt      = m_config->option(opt_key);
+	if (opt == nullptr)
+		return;
+	// The text being edited may not be a valid value yet.
+	std::unique_ptr<ConfigOption> value(opt->clone());
+	try {
+		if (opt_index == -1 || ! opt->is_vector()) {
+			if (! value->deserialize(text))
+				return;
+		} else {
+			std::unique_ptr<ConfigOption> item(opt->clone());
+			if (! item->deserialize(text) || static_cast<const ConfigOptionVectorBase*>(item.get())->size() != 1)
+				return;
+			static_cast<ConfigOptionVectorBase*>(value.get())->set_at(item.get(), opt_index, 0);
+		}
+	} catch (const std::exception &) {
+		return;
+	}
+	if (! (*value == *opt))
+		m_on_pending_change(opt_key, *value);
+}
+
 void ConfigOptionsGroup::back_to_initial_value(const std::string& opt_key)
 {
 	if (m_get_initial_config == nullptr)
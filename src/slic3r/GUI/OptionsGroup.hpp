@@ -232,6 +232,7 @@ protected:
     virtual void		on_kill_focus(const std::string& opt_key) {};
 	virtual void		on_set_focus(const std::string& opt_key);
 	virtual void		on_change_OG(const t_config_option_key& opt_id, const boost::any& value);
+	virtual void		on_pending_change(const t_config_option_key& opt_id, const std::string& text) {}
 	virtual void		back_to_initial_value(const std::string& opt_key) {}
 	virtual void		back_to_sys_value(const std::string& opt_key) {}
 };
@@ -246,6 +247,8 @@ public:
     DynamicPrintConfig*		m_config {nullptr};
     bool					m_full_labels {0};
 	t_opt_map				m_opt_map;
+	// Called with the value being edited before it is committed, if the text being edited is a valid value.
+	std::function<void(const t_config_option_key& opt_key, const ConfigOption& value)> m_on_pending_change { nullptr };
 
     void        set_config(DynamicPrintConfig* config) { m_config = config; }
 	Option		get_option(const std::string& opt_key, int opt_index = -1);
@@ -266,6 +269,7 @@ public:
 	}
 
 	void		on_change_OG(const t_config_option_key& opt_id, const boost::any& value) override;
+	void		on_pending_change(const t_config_option_key& opt_id, const std::string& text) override;
 	void		back_to_initial_value(const std::string& opt_key) override;
 	void		back_to_sys_value(const std::string& opt_key) override;
 	void		back_to_config_value(const DynamicPrintConfig& config, const std::string& opt_key);
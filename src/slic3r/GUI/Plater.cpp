@@ -2841,28 +2841,37 @@ arrangement::BedShapeHint Plater::priv::get_bed_shape_hint() const {
 void Plater::priv::find_new_position(const ModelInstancePtrs &instances,
                                      coord_t min_d)
 {
-    arrangement::ArrangePolygons movable, fixed;
+    // The given instances are the new items to be arranged, everything else
+    // is considered already arranged on the physical bed and stays in place.
+    arrangement::ArrangePolygons arrpolys;
+    std::vector<size_t> newidx(instances.size());
 
     for (const ModelObject *mo : model.objects)
         for (const ModelInstance *inst : mo->instances) {
             auto it = std::find(instances.begin(), instances.end(), inst);
-            auto arrpoly = inst->get_arrange_polygon();
+            arrpolys.emplace_back(inst->get_arrange_polygon());
 
             if (it == instances.end())
-                fixed.emplace_back(std::move(arrpoly));
-            else
-                movable.emplace_back(std::move(arrpoly));
+                arrpolys.back().bed_idx = 0;
+            else {
+                arrpolys.back().bed_idx = arrangement::UNARRANGED;
+                newidx[size_t(it - instances.begin())] = arrpolys.size() - 1;
+            }
         }
 
-    if (updated_wipe_tower())
-        fixed.emplace_back(wipetower.get_arrange_polygon());
+    if (updated_wipe_tower()) {
+        arrpolys.emplace_back(wipetower.get_arrange_polygon());
+        arrpolys.back().bed_idx = 0;
+    }
 
-    arrangement::arrange(movable, fixed, min_d, get_bed_shape_hint());
+    arrangement::arrange_new_items(arrpolys, min_d, get_bed_shape_hint());
 
-    for (size_t i = 0; i < instances.size(); ++i)
-        if (movable[i].bed_idx == 0)
-            instances[i]->apply_arrange_result(movable[i].translation.cast<double>(),
-                                               movable[i].rotation);
+    for (size_t i = 0; i < instances.size(); ++i) {
+        const arrangement::ArrangePolygon &ap = arrpolys[newidx[i]];
+        if (ap.bed_idx == 0)
+            instances[i]->apply_arrange_result(ap.translation.cast<double>(),
+                                               ap.rotation);
+    }
 }
 
 void Plater::priv::ArrangeJob::process() {
@@ -5288,6 +5297,12 @@ void Plater::on_extruders_change(size_t num_extruders)
     sidebar().scrolled_panel()->Refresh();
 }
 
+bool Plater::speculate_config_change(const DynamicPrintConfig &config)
+{
+    return wxGetApp().app_config->get("background_speculative_slicing") != "1" || this->printer_technology() != ptFFF ||
+        p->background_process.speculate(this->model(), config);
+}
+
 void Plater::on_config_change(const DynamicPrintConfig &config)
 {
     bool update_scheduled = false;
@@ -238,6 +238,9 @@ public:
 
     void on_extruders_change(size_t extruders_count);
     void on_config_change(const DynamicPrintConfig &config);
+    // Slice speculatively with a configuration being edited, if enabled by the preferences.
+    // Returns false if the previous speculation is still being canceled, then it shall be called again later.
+    bool speculate_config_change(const DynamicPrintConfig &config);
     void force_filament_colors_update();
     void force_print_bed_update();
     // On activating the parent window.
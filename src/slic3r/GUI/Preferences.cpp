@@ -60,6 +60,16 @@ void PreferencesDialog::build()
 	option = Option (def,"background_processing");
 	m_optgroup_general->append_single_option_line(option);
 
+	def.label = L("Speculative slicing");
+	def.type = coBool;
+	def.tooltip = L("If this is enabled, Slic3r will slice the objects and generate their perimeters "
+					  "with a print or printer setting being edited before the value is confirmed. "
+					  "The results are used if the value is confirmed unchanged. This doubles the memory "
+					  "consumed by the sliced objects.");
+	def.set_default_value(new ConfigOptionBool{ app_config->get("background_speculative_slicing") == "1" });
+	option = Option (def,"background_speculative_slicing");
+	m_optgroup_general->append_single_option_line(option);
+
 	// Please keep in sync with ConfigWizard
 	def.label = L("Check for application updates");
 	def.type = coBool;
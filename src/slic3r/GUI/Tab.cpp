@@ -90,6 +90,9 @@ void Tab::create_preset_tab()
 
     m_preset_bundle = wxGetApp().preset_bundle;
 
+    m_speculation_timer.SetOwner(this);
+    this->Bind(wxEVT_TIMER, [this](wxTimerEvent &) { this->on_speculation_timer(); }, m_speculation_timer.GetId());
+
     // Vertical sizer to hold the choice menu and the rest of the page.
 #ifdef __WXOSX__
     auto  *main_sizer = new wxBoxSizer(wxVERTICAL);
@@ -876,6 +879,10 @@ static wxString pad_combo_value_for_config(const DynamicPrintConfig &config)
 
 void Tab::on_value_change(const std::string& opt_key, const boost::any& value)
 {
+    // The value being edited was committed, it will be sliced by the regular background processing.
+    m_speculation_timer.Stop();
+    m_speculation_value.reset();
+
     if (wxGetApp().plater() == nullptr) {
         return;
     }
@@ -918,6 +925,34 @@ void Tab::on_value_change(const std::string& opt_key, const boost::any& value)
     update();
 }
 
+// Called while a value is being edited, before it is committed by on_value_change().
+// Called for each key stroke, therefore the value is just stored and the speculative slicing is started
+// by the one shot m_speculation_timer once the typing pauses: A burst of edits starts a single speculation.
+void Tab::on_pending_value_change(const std::string& opt_key, const ConfigOption& value)
+{
+    // Only the print and printer presets are stored into the full config unmodified,
+    // the filament presets are merged over the extruders.
+    if (wxGetApp().plater() == nullptr || (m_type != Preset::TYPE_PRINT && m_type != Preset::TYPE_PRINTER))
+        return;
+    m_speculation_opt_key = opt_key;
+    m_speculation_value.reset(value.clone());
+    // Restarting the timer postpones the speculation.
+    m_speculation_timer.Start(300, wxTIMER_ONE_SHOT);
+}
+
+void Tab::on_speculation_timer()
+{
+    if (! m_speculation_value || wxGetApp().plater() == nullptr)
+        return;
+    DynamicPrintConfig config = m_preset_bundle->full_config();
+    config.set_key_value(m_speculation_opt_key, m_speculation_value->clone());
+    if (wxGetApp().plater()->speculate_config_change(config))
+        m_speculation_value.reset();
+    else
+        // The previous speculation is still being canceled, the UI thread does not wait for it. Try again later.
+        m_speculation_timer.Start(100, wxTIMER_ONE_SHOT);
+}
+
 // Show/hide the 'purging volumes' button
 void Tab::update_wiping_button_visibility() {
     if (m_preset_bundle->printers.get_selected_preset().printer_technology() == ptSLA)
@@ -3457,6 +3492,10 @@ ConfigOptionsGroupShp Page::new_optgroup(const wxString& title, int noncommon_la
 //!        });
     };
 
+    optgroup->m_on_pending_change = [tab](const t_config_option_key& opt_key, const ConfigOption& value) {
+        static_cast<Tab*>(tab)->on_pending_value_change(opt_key, value);
+    };
+
     optgroup->m_get_initial_config = [this, tab]() {
         DynamicPrintConfig config = static_cast<Tab*>(tab)->m_presets->get_selected_preset().config;
         return config;
@@ -23,6 +23,7 @@
 #include <wx/bmpbuttn.h>
 #include <wx/treectrl.h>
 #include <wx/imaglist.h>
+#include <wx/timer.h>
 
 #include <map>
 #include <vector>
@@ -221,6 +222,12 @@ protected:
     bool                m_completed { false };
     ConfigOptionMode    m_mode = comExpert; // to correct first Tab update_visibility() set mode to Expert
 
+    // The speculative slicing of a value being edited starts once the typing pauses, see on_pending_value_change().
+    wxTimer                         m_speculation_timer;
+    std::string                     m_speculation_opt_key;
+    std::unique_ptr<ConfigOption>   m_speculation_value;
+    void                on_speculation_timer();
+
 public:
 	PresetBundle*		m_preset_bundle;
 	bool				m_show_btn_incompatible_presets = false;
@@ -308,6 +315,7 @@ public:
 	size_t				get_selected_preset_item() { return m_selected_preset_item; }
 
 	void			on_value_change(const std::string& opt_key, const boost::any& value);
+	void			on_pending_value_change(const std::string& opt_key, const ConfigOption& value);
 
     void            update_wiping_button_visibility();
 
@@ -1,4 +1,5 @@
 #include "UndoRedo.hpp"
+#include "UndoRedoHistory.hpp"
 
 #include <algorithm>
 #include <iostream>
@@ -23,9 +24,6 @@
 
 #include <boost/foreach.hpp>
 
-#ifndef NDEBUG
-// #define SLIC3R_UNDOREDO_DEBUG
-#endif /* NDEBUG */
 #if 0
 	// Stop at a fraction of the normal Undo / Redo stack size.
 	#define UNDO_REDO_DEBUG_LOW_MEM_FACTOR 10000
@@ -47,138 +45,6 @@ bool Snapshot::is_topmost() const
 	return this->name == topmost_snapshot_name;
 }
 
-// Time interval, start is closed, end is open.
-struct Interval
-{
-public:
-	Interval(size_t begin, size_t end) : m_begin(begin), m_end(end) {}
-
-	size_t  begin() const { return m_begin; }
-	size_t  end()   const { return m_end; }
-
-	bool 	is_valid() const { return m_begin >= 0 && m_begin < m_end; }
-	// This interval comes strictly before the rhs interval.
-	bool 	strictly_before(const Interval &rhs) const { return this->is_valid() && rhs.is_valid() && m_end <= rhs.m_begin; }
-	// This interval comes strictly after the rhs interval.
-	bool 	strictly_after(const Interval &rhs) const { return this->is_valid() && rhs.is_valid() && rhs.m_end <= m_begin; }
-
-	bool    operator<(const Interval &rhs) const { return (m_begin < rhs.m_begin) || (m_begin == rhs.m_begin && m_end < rhs.m_end); }
-	bool 	operator==(const Interval &rhs) const { return m_begin == rhs.m_begin && m_end == rhs.m_end; }
-
-	void 	trim_begin(size_t new_begin)  { m_begin = std::max(m_begin, new_begin); }
-	void    trim_end(size_t new_end) { m_end = std::min(m_end, new_end); }
-	void 	extend_end(size_t new_end) { assert(new_end >= m_end); m_end = new_end; }
-
-	size_t 	memsize() const { return sizeof(this); }
-
-private:
-	size_t 	m_begin;
-	size_t 	m_end;
-};
-
-// History of a single object tracked by the Undo / Redo stack. The object may be mutable or immutable.
-class ObjectHistoryBase
-{
-public:
-	virtual ~ObjectHistoryBase() {}
-
-	// Is the object captured by this history mutable or immutable?
-	virtual bool is_mutable() const = 0;
-	virtual bool is_immutable() const = 0;
-	// The object is optional, it may be released if the Undo / Redo stack memory grows over the limits.
-	virtual bool is_optional() const { return false; }
-	// If it is an immutable object, return its pointer. There is a map assigning a temporary ObjectID to the immutable object pointer.
-	virtual const void* immutable_object_ptr() const { return nullptr; }
-
-	// If the history is empty, the ObjectHistory object could be released.
-	virtual bool empty() = 0;
-
-	// Release all data before the given timestamp. For the ImmutableObjectHistory, the shared pointer is NOT released.
-	// Return the amount of memory released.
-	virtual size_t release_before_timestamp(size_t timestamp) = 0;
-	// Release all data after the given timestamp. For the ImmutableObjectHistory, the shared pointer is NOT released.
-	// Return the amount of memory released.
-	virtual size_t release_after_timestamp(size_t timestamp) = 0;
-	// Release all optional data of this history.
-	virtual size_t release_optional() = 0;
-	// Restore optional data possibly released by release_optional.
-	virtual void   restore_optional() = 0;
-
-	// Estimated size in memory, to be used to drop least recently used snapshots.
-	virtual size_t memsize() const = 0;
-
-#ifdef SLIC3R_UNDOREDO_DEBUG
-	// Human readable debug information.
-	virtual std::string	format() = 0;
-#endif /* SLIC3R_UNDOREDO_DEBUG */
-
-#ifndef NDEBUG
-	virtual bool valid() = 0;
-#endif /* NDEBUG */
-};
-
-template<typename T> class ObjectHistory : public ObjectHistoryBase
-{
-public:
-	~ObjectHistory() override {}
-
-	// If the history is empty, the ObjectHistory object could be released.
-	bool empty() override { return m_history.empty(); }
-
-	// Release all data before the given timestamp. For the ImmutableObjectHistory, the shared pointer is NOT released.
-	size_t release_before_timestamp(size_t timestamp) override {
-		size_t mem_released = 0;
-		if (! m_history.empty()) {
-			assert(this->valid());
-			// it points to an interval which either starts with timestamp, or follows the timestamp.
-			auto it = std::lower_bound(m_history.begin(), m_history.end(), T(timestamp, timestamp));
-			// Find the first iterator with begin() < timestamp.
-			if (it == m_history.end())
-				-- it;
-			while (it != m_history.begin() && it->begin() >= timestamp)
-				-- it;
-			if (it->begin() < timestamp && it->end() > timestamp) {
-				it->trim_begin(timestamp);
-				if (it != m_history.begin())
-					-- it;
-			}
-			if (it->end() <= timestamp) {
-				auto it_end = ++ it;
-				for (it = m_history.begin(); it != it_end; ++ it)
-					mem_released += it->memsize();
-				m_history.erase(m_history.begin(), it_end);
-			}
-			assert(this->valid());
-		}
-		return mem_released;
-	}
-
-	// Release all data after the given timestamp. The shared pointer is NOT released.
-	size_t release_after_timestamp(size_t timestamp) override {
-		size_t mem_released = 0;
-		if (! m_history.empty()) {
-			assert(this->valid());
-			// it points to an interval which either starts with timestamp, or follows the timestamp.
-			auto it = std::lower_bound(m_history.begin(), m_history.end(), T(timestamp, timestamp));
-			if (it != m_history.begin()) {
-				auto it_prev = it;
-				-- it_prev;
-				assert(it_prev->begin() < timestamp);
-				// Trim the last interval with timestamp.
-				it_prev->trim_end(timestamp);
-			}
-			for (auto it2 = it; it2 != m_history.end(); ++ it2)
-				mem_released += it2->memsize();
-			m_history.erase(it, m_history.end());
-			assert(this->valid());
-		}
-		return mem_released;
-	}
-
-protected:
-	std::vector<T>	m_history;
-};
-
 // Big objects (mainly the triangle meshes) are tracked by Slicer using the shared pointers
 // and they are immutable.
 // The Undo / Redo stack therefore may keep a shared pointer to these immutable objects
@@ -296,159 +162,6 @@ private:
 	std::string 				m_serialized;
 };
 
-struct MutableHistoryInterval
-{
-private:
-	struct Data
-	{
-		// Reference counter of this data chunk. We may have used shared_ptr, but the shared_ptr is thread safe
-		// with the associated cost of CPU cache invalidation on refcount change.
-		size_t		refcnt;
-		size_t		size;
-		char 		data[1];
-
-		bool 		matches(const std::string& rhs) { return this->size == rhs.size() && memcmp(this->data, rhs.data(), this->size) == 0; }
-	};
-
-	Interval    m_interval;
-	Data	   *m_data;
-
-public:
-	MutableHistoryInterval(const Interval &interval, const std::string &input_data) : m_interval(interval), m_data(nullptr) {
-		m_data = (Data*)new char[offsetof(Data, data) + input_data.size()];
-		m_data->refcnt = 1;
-		m_data->size = input_data.size();
-		memcpy(m_data->data, input_data.data(), input_data.size());
-	}
-
-	MutableHistoryInterval(const Interval &interval, MutableHistoryInterval &other) : m_interval(interval), m_data(other.m_data) {
-		++ m_data->refcnt;
-	}
-
-	// as a key for std::lower_bound
-	MutableHistoryInterval(const size_t begin, const size_t end) : m_interval(begin, end), m_data(nullptr) {}
-
-	MutableHistoryInterval(MutableHistoryInterval&& rhs) : m_interval(rhs.m_interval), m_data(rhs.m_data) { rhs.m_data = nullptr; }
-	MutableHistoryInterval& operator=(MutableHistoryInterval&& rhs) { m_interval = rhs.m_interval; m_data = rhs.m_data; rhs.m_data = nullptr; return *this; }
-
-	~MutableHistoryInterval() {
-		if (m_data != nullptr && -- m_data->refcnt == 0)
-			delete[] (char*)m_data;
-	}
-
-	const Interval& interval() const { return m_interval; }
-	size_t		begin() const { return m_interval.begin(); }
-	size_t		end()   const { return m_interval.end(); }
-	void 		trim_begin(size_t timestamp) { m_interval.trim_begin(timestamp); }
-	void 		trim_end  (size_t timestamp) { m_interval.trim_end(timestamp); }
-	void 		extend_end(size_t timestamp) { m_interval.extend_end(timestamp); }
-
-	bool		operator<(const MutableHistoryInterval& rhs) const { return m_interval < rhs.m_interval; }
-	bool 		operator==(const MutableHistoryInterval& rhs) const { return m_interval == rhs.m_interval; }
-
-	const char* data() const { return m_data->data; }
-	size_t  	size() const { return m_data->size; }
-	size_t		refcnt() const { return m_data->refcnt; }
-	bool		matches(const std::string& data) { return m_data->matches(data); }
-	size_t 		memsize() const { 
-		return m_data->refcnt == 1 ?
-			// Count just the size of the snapshot data.
-			m_data->size :
-			// Count the size of the snapshot data divided by the number of references, rounded up.
-			(m_data->size + m_data->refcnt - 1) / m_data->refcnt;
-	}
-
-private:
-	MutableHistoryInterval(const MutableHistoryInterval &rhs);
-	MutableHistoryInterval& operator=(const MutableHistoryInterval &rhs);
-};
-
-#ifdef SLIC3R_UNDOREDO_DEBUG
-static inline std::string ptr_to_string(const void* ptr)
-{
-	char buf[64];
-	sprintf(buf, "%p", ptr);
-	return buf;
-}
-#endif
-
-// Smaller objects (Model, ModelObject, ModelInstance, ModelVolume, DynamicPrintConfig)
-// are mutable and there is not tracking of the changes, therefore a snapshot needs to be
-// taken every time and compared to the previous data at the Undo / Redo stack.
-// The serialized data is stored if it is different from the last value on the stack, otherwise
-// the serialized data is discarded.
-// The history of a single mutable object may not be continuous, as an mutable object may
-// be removed from the scene while being kept at the Copy / Paste stack, therefore an object snapshot
-// with the same serialized object data may be shared by multiple history intervals.
-template<typename T>
-class MutableObjectHistory : public ObjectHistory<MutableHistoryInterval>
-{
-public:
-	~MutableObjectHistory() override {}
-
-	bool is_mutable() const override { return true; }
-	bool is_immutable() const override { return false; }
-
-	// Estimated size in memory, to be used to drop least recently used snapshots.
-	size_t memsize() const override {
-		size_t memsize = sizeof(*this);
-		memsize += m_history.size() * sizeof(MutableHistoryInterval);
-		for (const MutableHistoryInterval &interval : m_history)
-			memsize += interval.memsize();
-		return memsize;
-	}
-
-	void save(size_t active_snapshot_time, size_t current_time, const std::string &data) {
-		assert(m_history.empty() || m_history.back().end() <= active_snapshot_time);
-		if (m_history.empty() || m_history.back().end() < active_snapshot_time) {
-			if (! m_history.empty() && m_history.back().matches(data))
-				// Share the previous data by reference counting.
-				m_history.emplace_back(Interval(current_time, current_time + 1), m_history.back());
-			else
-				// Allocate new data.
-				m_history.emplace_back(Interval(current_time, current_time + 1), data);
-		} else {
-			assert(! m_history.empty());
-			assert(m_history.back().end() == active_snapshot_time);
-			if (m_history.back().matches(data))
-				// Just extend the last interval using the old data.
-				m_history.back().extend_end(current_time + 1);
-			else
-				// Allocate new data time continuous with the previous data.
-				m_history.emplace_back(Interval(active_snapshot_time, current_time + 1), data);
-		}
-	}
-
-	std::string load(size_t timestamp) const {
-		assert(! m_history.empty());
-		auto it = std::lower_bound(m_history.begin(), m_history.end(), MutableHistoryInterval(timestamp, timestamp));
-		if (it == m_history.end() || it->begin() > timestamp) {
-			assert(it != m_history.begin());
-			-- it;
-		}
-		assert(timestamp >= it->begin() && timestamp < it->end());
-		return std::string(it->data(), it->data() + it->size());
-	}
-
-	// Currently all mutable snapshots are mandatory.
-	size_t release_optional() override { return 0; }
-	// Currently there is no way to release optional data from the mutable objects.
-	void   restore_optional() override {}
-
-#ifdef SLIC3R_UNDOREDO_DEBUG
-	std::string format() override {
-		std::string out = typeid(T).name();
-		for (const MutableHistoryInterval &interval : m_history)
-			out += std::string(", ptr:") + ptr_to_string(interval.data()) + " len:" + std::to_string(interval.size()) + " <" + std::to_string(interval.begin()) + "," + std::to_string(interval.end()) + ")";
-		return out;
-	}
-#endif /* SLIC3R_UNDOREDO_DEBUG */
-
-#ifndef NDEBUG
-	bool valid() override;
-#endif /* NDEBUG */
-};
-
 #ifndef NDEBUG
 template<typename T>
 bool ImmutableObjectHistory<T>::valid()
@@ -463,28 +176,6 @@ bool ImmutableObjectHistory<T>::valid()
 }
 #endif /* NDEBUG */
 
-#ifndef NDEBUG
-template<typename T>
-bool MutableObjectHistory<T>::valid()
-{
-	// Verify that the history intervals are sorted and do not overlap, and that the data reference counters are correct.
-	if (! m_history.empty()) {
-		std::map<const char*, size_t> refcntrs;
-		assert(m_history.front().data() != nullptr);
-		++ refcntrs[m_history.front().data()];
-		for (size_t i = 1; i < m_history.size(); ++ i) {
-			assert(m_history[i - 1].interval().strictly_before(m_history[i].interval()));
-			++ refcntrs[m_history[i].data()];
-		}
-		for (const auto &hi : m_history) {
-			assert(hi.data() != nullptr);
-			assert(refcntrs[hi.data()] == hi.refcnt());
-		}
-	}
-	return true;
-}
-#endif /* NDEBUG */
-
 class StackImpl
 {
 public:
@@ -493,6 +184,7 @@ public:
 	StackImpl() : m_memory_limit(std::min(Slic3r::total_physical_memory() / 10, size_t(1 * 16384 * 65536 / UNDO_REDO_DEBUG_LOW_MEM_FACTOR))), m_active_snapshot_time(0), m_current_time(0) {}
 
 	void clear() {
+		this->finish_encoding();
 		m_objects.clear();
 		m_shared_ptr_to_object_id.clear();
 		m_snapshots.clear();
@@ -594,6 +286,10 @@ private:
 		return it->second;
 	}
 	void 							collect_garbage();
+	// Encode the data of the mutable objects saved by the last snapshot on a worker thread.
+	void 							start_encoding();
+	// Wait for the worker thread and store the encoded data. To be called before the stored data is modified in place or loaded.
+	void 							finish_encoding();
 
 	// Maximum memory allowed to be occupied by the Undo / Redo stack. If the limit is exceeded,
 	// least recently used snapshots will be released.
@@ -611,6 +307,8 @@ private:
 	size_t 													m_current_time;
 	// Last selection serialized or deserialized.
 	Selection 												m_selection;
+	// Worker thread encoding the mutable objects of the last snapshot.
+	MutableHistoryEncoder 									m_encoder;
 };
 
 using InputArchive  = cereal::UserDataAdapter<StackImpl, cereal::BinaryInputArchive>;
@@ -755,7 +453,7 @@ template<typename T> ObjectID StackImpl::save_mutable_object(const T &object)
 		Slic3r::UndoRedo::OutputArchive archive(*this, oss);
 		archive(object);
 	}
-	object_history->save(m_active_snapshot_time, m_current_time, oss.str());
+	object_history->save(m_active_snapshot_time, m_current_time, oss.str(), m_encoder.jobs());
 	return object.id();
 }
 
@@ -810,6 +508,8 @@ template<typename T> void StackImpl::load_mutable_object(const Slic3r::ObjectID
 // Store the current application state onto the Undo / Redo stack, remove all snapshots after m_active_snapshot_time.
 void StackImpl::take_snapshot(const std::string& snapshot_name, const Slic3r::Model& model, const Slic3r::GUI::Selection& selection, const Slic3r::GUI::GLGizmosManager& gizmos, const SnapshotData &snapshot_data)
 {
+	// The encoding of the preceding snapshots is not waited for. The data being encoded is only read by the worker
+	// and it is kept alive by the encoder even if released from the history below.
 	// Release old snapshot data.
 	assert(m_active_snapshot_time <= m_current_time);
 	for (auto &kvp : m_objects)
@@ -835,6 +535,9 @@ void StackImpl::take_snapshot(const std::string& snapshot_name, const Slic3r::Mo
 	m_snapshots.emplace_back(topmost_snapshot_name, m_active_snapshot_time, 0, snapshot_data);
 	// Release empty objects from the history.
 	this->collect_garbage();
+	// Serialization of the objects had to be done on the UI thread, as the objects are being modified by the UI,
+	// but the serialized data may be encoded in the background.
+	this->start_encoding();
 	assert(this->valid());
 #ifdef SLIC3R_UNDOREDO_DEBUG
 	std::cout << "After snapshot" << std::endl;
@@ -849,6 +552,7 @@ void StackImpl::load_snapshot(size_t timestamp, Slic3r::Model& model, Slic3r::GU
 	if (it_snapshot == m_snapshots.end() || it_snapshot->timestamp != timestamp)
 		throw std::runtime_error((boost::format("Snapshot with timestamp %1% does not exist") % timestamp).str());
 
+	this->finish_encoding();
 	m_active_snapshot_time = timestamp;
 	model.clear_objects();
 	model.clear_materials();
@@ -951,10 +655,25 @@ void StackImpl::collect_garbage()
 	}
 }
 
+void StackImpl::start_encoding()
+{
+	m_encoder.start();
+}
+
+void StackImpl::finish_encoding()
+{
+	m_encoder.finish();
+}
+
 void StackImpl::release_least_recently_used()
 {
 	assert(this->valid());
 	size_t current_memsize = this->memsize();
+	if (current_memsize > m_memory_limit && ! m_encoder.empty()) {
+		// Only wait for the encoding of the last snapshot if the memory limit is exceeded by the raw data.
+		this->finish_encoding();
+		current_memsize = this->memsize();
+	}
 #ifdef SLIC3R_UNDOREDO_DEBUG
 	bool released = false;
 #endif
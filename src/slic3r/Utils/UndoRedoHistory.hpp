@@ -0,0 +1,575 @@
+#ifndef slic3r_Utils_UndoRedoHistory_hpp_
+#define slic3r_Utils_UndoRedoHistory_hpp_
+
+// Storage of the history of the objects captured by the Undo / Redo stack.
+// Internal to the Undo / Redo stack, exposed for the unit tests.
+
+#include <algorithm>
+#include <cassert>
+#include <cstdio>
+#include <map>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <typeinfo>
+#include <vector>
+
+#include <tbb/parallel_for.h>
+#include <tbb/task_group.h>
+
+#include <miniz.h>
+
+#ifndef NDEBUG
+// #define SLIC3R_UNDOREDO_DEBUG
+#endif /* NDEBUG */
+
+namespace Slic3r {
+namespace UndoRedo {
+
+// Time interval, start is closed, end is open.
+struct Interval
+{
+public:
+	Interval(size_t begin, size_t end) : m_begin(begin), m_end(end) {}
+
+	size_t  begin() const { return m_begin; }
+	size_t  end()   const { return m_end; }
+
+	bool 	is_valid() const { return m_begin >= 0 && m_begin < m_end; }
+	// This interval comes strictly before the rhs interval.
+	bool 	strictly_before(const Interval &rhs) const { return this->is_valid() && rhs.is_valid() && m_end <= rhs.m_begin; }
+	// This interval comes strictly after the rhs interval.
+	bool 	strictly_after(const Interval &rhs) const { return this->is_valid() && rhs.is_valid() && rhs.m_end <= m_begin; }
+
+	bool    operator<(const Interval &rhs) const { return (m_begin < rhs.m_begin) || (m_begin == rhs.m_begin && m_end < rhs.m_end); }
+	bool 	operator==(const Interval &rhs) const { return m_begin == rhs.m_begin && m_end == rhs.m_end; }
+
+	void 	trim_begin(size_t new_begin)  { m_begin = std::max(m_begin, new_begin); }
+	void    trim_end(size_t new_end) { m_end = std::min(m_end, new_end); }
+	void 	extend_end(size_t new_end) { assert(new_end >= m_end); m_end = new_end; }
+
+	size_t 	memsize() const { return sizeof(this); }
+
+private:
+	size_t 	m_begin;
+	size_t 	m_end;
+};
+
+// History of a single object tracked by the Undo / Redo stack. The object may be mutable or immutable.
+class ObjectHistoryBase
+{
+public:
+	virtual ~ObjectHistoryBase() {}
+
+	// Is the object captured by this history mutable or immutable?
+	virtual bool is_mutable() const = 0;
+	virtual bool is_immutable() const = 0;
+	// The object is optional, it may be released if the Undo / Redo stack memory grows over the limits.
+	virtual bool is_optional() const { return false; }
+	// If it is an immutable object, return its pointer. There is a map assigning a temporary ObjectID to the immutable object pointer.
+	virtual const void* immutable_object_ptr() const { return nullptr; }
+
+	// If the history is empty, the ObjectHistory object could be released.
+	virtual bool empty() = 0;
+
+	// Release all data before the given timestamp. For the ImmutableObjectHistory, the shared pointer is NOT released.
+	// Return the amount of memory released.
+	virtual size_t release_before_timestamp(size_t timestamp) = 0;
+	// Release all data after the given timestamp. For the ImmutableObjectHistory, the shared pointer is NOT released.
+	// Return the amount of memory released.
+	virtual size_t release_after_timestamp(size_t timestamp) = 0;
+	// Release all optional data of this history.
+	virtual size_t release_optional() = 0;
+	// Restore optional data possibly released by release_optional.
+	virtual void   restore_optional() = 0;
+
+	// Estimated size in memory, to be used to drop least recently used snapshots.
+	virtual size_t memsize() const = 0;
+
+#ifdef SLIC3R_UNDOREDO_DEBUG
+	// Human readable debug information.
+	virtual std::string	format() = 0;
+#endif /* SLIC3R_UNDOREDO_DEBUG */
+
+#ifndef NDEBUG
+	virtual bool valid() = 0;
+#endif /* NDEBUG */
+};
+
+template<typename T> class ObjectHistory : public ObjectHistoryBase
+{
+public:
+	~ObjectHistory() override {}
+
+	// If the history is empty, the ObjectHistory object could be released.
+	bool empty() override { return m_history.empty(); }
+
+	// Release all data before the given timestamp. For the ImmutableObjectHistory, the shared pointer is NOT released.
+	size_t release_before_timestamp(size_t timestamp) override {
+		size_t mem_released = 0;
+		if (! m_history.empty()) {
+			assert(this->valid());
+			// it points to an interval which either starts with timestamp, or follows the timestamp.
+			auto it = std::lower_bound(m_history.begin(), m_history.end(), T(timestamp, timestamp));
+			// Find the first iterator with begin() < timestamp.
+			if (it == m_history.end())
+				-- it;
+			while (it != m_history.begin() && it->begin() >= timestamp)
+				-- it;
+			if (it->begin() < timestamp && it->end() > timestamp) {
+				it->trim_begin(timestamp);
+				if (it != m_history.begin())
+					-- it;
+			}
+			if (it->end() <= timestamp) {
+				auto it_end = ++ it;
+				for (it = m_history.begin(); it != it_end; ++ it)
+					mem_released += it->memsize();
+				m_history.erase(m_history.begin(), it_end);
+			}
+			assert(this->valid());
+		}
+		return mem_released;
+	}
+
+	// Release all data after the given timestamp. The shared pointer is NOT released.
+	size_t release_after_timestamp(size_t timestamp) override {
+		size_t mem_released = 0;
+		if (! m_history.empty()) {
+			assert(this->valid());
+			// it points to an interval which either starts with timestamp, or follows the timestamp.
+			auto it = std::lower_bound(m_history.begin(), m_history.end(), T(timestamp, timestamp));
+			if (it != m_history.begin()) {
+				auto it_prev = it;
+				-- it_prev;
+				assert(it_prev->begin() < timestamp);
+				// Trim the last interval with timestamp.
+				it_prev->trim_end(timestamp);
+			}
+			for (auto it2 = it; it2 != m_history.end(); ++ it2)
+				mem_released += it2->memsize();
+			m_history.erase(it, m_history.end());
+			assert(this->valid());
+		}
+		return mem_released;
+	}
+
+protected:
+	std::vector<T>	m_history;
+};
+
+#ifdef SLIC3R_UNDOREDO_DEBUG
+inline std::string ptr_to_string(const void* ptr)
+{
+	char buf[64];
+	sprintf(buf, "%p", ptr);
+	return buf;
+}
+#endif
+
+// Serialized data of a mutable object, shared by the history intervals capturing the same data.
+// To save memory, the data is stored either deflate compressed, or as a difference to the data of the preceding
+// version of the same object (the base). The data is stored raw first and encoded by the worker thread of the stack.
+struct MutableHistoryData
+{
+	// Reference counter of this data chunk, counting both the history intervals and the data using this one as a base.
+	// We may have used shared_ptr, but the shared_ptr is thread safe with the associated cost of CPU cache invalidation on refcount change.
+	size_t 				refcnt		{ 1 };
+	// Number of history intervals referencing this data chunk.
+	size_t 				intervals	{ 0 };
+	// Size of the serialized data.
+	size_t 				size		{ 0 };
+	// Serialized data, its compressed form, or a delta to the base:
+	// The serialized data of the base with the range <prefix, base size - suffix) replaced by the payload.
+	std::string			payload;
+	MutableHistoryData *base		{ nullptr };
+	size_t 				prefix		{ 0 };
+	size_t 				suffix		{ 0 };
+	bool 				compressed	{ false };
+	// Length of the chain of the bases to decode this data.
+	unsigned int 		depth		{ 0 };
+
+	MutableHistoryData(const std::string &data) : size(data.size()), payload(data) {}
+
+	static MutableHistoryData* acquire(MutableHistoryData *data) { ++ data->refcnt; return data; }
+	static void release(MutableHistoryData *data) {
+		while (data != nullptr && -- data->refcnt == 0) {
+			MutableHistoryData *base = data->base;
+			delete data;
+			data = base;
+		}
+	}
+
+	bool 		is_raw() const { return this->base == nullptr && ! this->compressed; }
+	// Reconstruct the serialized data.
+	std::string decode() const;
+	// Store the serialized data as a key frame, releasing the base. The key frame is compressed, unless the compression
+	// does not save memory. To be called once the base is no longer referenced by the history, while no encoding is running.
+	void 		materialize() {
+		if (this->base != nullptr) {
+			std::string data = this->decode();
+			release(this->base);
+			this->base       = nullptr;
+			this->prefix     = 0;
+			this->suffix     = 0;
+			this->depth      = 0;
+			this->compressed = compress(data, this->payload);
+			if (! this->compressed)
+				this->payload = std::move(data);
+			this->payload.shrink_to_fit();
+		}
+	}
+	size_t 		memsize() const { return sizeof(*this) + this->payload.size(); }
+
+	// Deflate compress src into out. Returns false if the compression failed or if it does not save memory.
+	static bool compress(const std::string &src, std::string &out) {
+		mz_ulong len = mz_compressBound(mz_ulong(src.size()));
+		out.assign(len, '\0');
+		if (mz_compress2((unsigned char*)&out[0], &len, (const unsigned char*)src.data(), mz_ulong(src.size()), MZ_BEST_SPEED) == MZ_OK && len < src.size()) {
+			out.resize(len);
+			return true;
+		}
+		return false;
+	}
+};
+
+inline std::string MutableHistoryData::decode() const
+{
+	if (this->compressed) {
+		std::string out(this->size, '\0');
+		mz_ulong    len = mz_ulong(this->size);
+		if (mz_uncompress((unsigned char*)&out[0], &len, (const unsigned char*)this->payload.data(), mz_ulong(this->payload.size())) != MZ_OK || len != this->size)
+			throw std::runtime_error("Undo / Redo stack: Failed to decompress a snapshot");
+		return out;
+	}
+	if (this->base == nullptr)
+		return this->payload;
+	std::string base = this->base->decode();
+	assert(this->prefix + this->suffix <= base.size());
+	std::string out;
+	out.reserve(this->size);
+	out.append(base, 0, this->prefix).append(this->payload).append(base, base.size() - this->suffix, this->suffix);
+	assert(out.size() == this->size);
+	return out;
+}
+
+// Encoding of a single raw MutableHistoryData by the worker thread of the stack.
+// The worker only reads the raw data, the result is applied by the UI thread once the worker finished.
+// The job holds a reference to the data, thus the data being encoded survives its release from the history.
+struct MutableHistoryEncodeJob
+{
+	// Maximum length of a chain of deltas, a compressed key frame is stored after that.
+	static const constexpr unsigned int MAX_DEPTH = 16;
+
+	MutableHistoryEncodeJob(MutableHistoryData *data, MutableHistoryData *base, std::string &&base_data) :
+		data(MutableHistoryData::acquire(data)), base(base), base_data(std::move(base_data)) {}
+	MutableHistoryEncodeJob(MutableHistoryEncodeJob &&rhs) :
+		data(rhs.data), base(rhs.base), base_data(std::move(rhs.base_data)), payload(std::move(rhs.payload)), prefix(rhs.prefix), suffix(rhs.suffix), type(rhs.type) { rhs.data = nullptr; rhs.base = nullptr; }
+	~MutableHistoryEncodeJob() { MutableHistoryData::release(this->data); MutableHistoryData::release(this->base); }
+
+	// Called by the worker thread.
+	void encode() {
+		const std::string &src = data->payload;
+		if (this->base != nullptr) {
+			size_t len = std::min(src.size(), this->base_data.size());
+			for (this->prefix = 0; this->prefix < len && src[this->prefix] == this->base_data[this->prefix]; ++ this->prefix) ;
+			for (this->suffix = 0; this->prefix + this->suffix < len && src[src.size() - this->suffix - 1] == this->base_data[this->base_data.size() - this->suffix - 1]; ++ this->suffix) ;
+			// Only store a delta if it saves at least a half of the data, otherwise store a key frame.
+			if (2 * (src.size() - this->prefix - this->suffix) <= src.size()) {
+				this->payload.assign(src.begin() + this->prefix, src.end() - this->suffix);
+				this->type = Delta;
+				return;
+			}
+		}
+		this->type = MutableHistoryData::compress(src, this->payload) ? Compressed : Raw;
+	}
+
+	// Called by the UI thread after the worker thread finished.
+	void apply() {
+		switch (this->type) {
+		case Delta:
+			data->payload = std::move(this->payload);
+			data->payload.shrink_to_fit();
+			data->prefix  = this->prefix;
+			data->suffix  = this->suffix;
+			data->depth   = this->base->depth + 1;
+			data->base    = this->base;
+			this->base    = nullptr;
+			break;
+		case Compressed:
+			data->payload    = std::move(this->payload);
+			data->compressed = true;
+			data->depth      = 0;
+			break;
+		default:
+			data->depth      = 0;
+			break;
+		}
+	}
+
+	MutableHistoryData *data;
+	// Preceding version of the same object and its serialized data, null if data is to be stored as a key frame.
+	MutableHistoryData *base;
+	std::string 		base_data;
+
+	std::string 		payload;
+	size_t 				prefix { 0 };
+	size_t 				suffix { 0 };
+	enum Type {
+		Raw,
+		Delta,
+		Compressed,
+	} 					type { Raw };
+};
+
+// Encodes the data of the mutable objects saved by the snapshots on a worker thread.
+// The jobs of each snapshot are encoded as a separate batch, so that a snapshot may be taken
+// while the data of the preceding snapshots is still being encoded.
+class MutableHistoryEncoder
+{
+public:
+	~MutableHistoryEncoder() { m_worker.wait(); }
+
+	// Data saved since the last call to start(), to be encoded by start().
+	std::vector<MutableHistoryEncodeJob>& jobs() { return m_jobs; }
+	bool 	empty() const { return m_jobs.empty() && m_batches.empty(); }
+
+	// Encode the data of the jobs on a worker thread.
+	void 	start() {
+		if (! m_jobs.empty()) {
+			// The batch is allocated on the heap, the worker does not see the jobs added by the following snapshots.
+			m_batches.emplace_back(new std::vector<MutableHistoryEncodeJob>(std::move(m_jobs)));
+			m_jobs.clear();
+			std::vector<MutableHistoryEncodeJob> *batch = m_batches.back().get();
+			m_worker.run([batch]() {
+				tbb::parallel_for(size_t(0), batch->size(), [batch](size_t i) { (*batch)[i].encode(); });
+			});
+		}
+	}
+	// Wait for the worker thread and store the encoded data. To be called before the stored data is modified in place or loaded.
+	void 	finish() {
+		if (! m_batches.empty()) {
+			m_worker.wait();
+			// Apply in the order of the snapshots, the depth of a delta is derived from the depth of its base.
+			for (std::unique_ptr<std::vector<MutableHistoryEncodeJob>> &batch : m_batches)
+				for (MutableHistoryEncodeJob &job : *batch)
+					job.apply();
+			m_batches.clear();
+		}
+		// Jobs not started are dropped, their data is kept raw.
+		for (MutableHistoryEncodeJob &job : m_jobs)
+			job.apply();
+		m_jobs.clear();
+	}
+
+private:
+	tbb::task_group 													m_worker;
+	// Batches of jobs being encoded, one batch per snapshot.
+	std::vector<std::unique_ptr<std::vector<MutableHistoryEncodeJob>>> 	m_batches;
+	std::vector<MutableHistoryEncodeJob> 								m_jobs;
+};
+
+struct MutableHistoryInterval
+{
+private:
+	Interval    		m_interval;
+	MutableHistoryData *m_data;
+
+public:
+	MutableHistoryInterval(const Interval &interval, const std::string &input_data) : m_interval(interval), m_data(new MutableHistoryData(input_data)) {
+		m_data->intervals = 1;
+	}
+
+	MutableHistoryInterval(const Interval &interval, MutableHistoryInterval &other) : m_interval(interval), m_data(MutableHistoryData::acquire(other.m_data)) {
+		++ m_data->intervals;
+	}
+
+	// as a key for std::lower_bound
+	MutableHistoryInterval(const size_t begin, const size_t end) : m_interval(begin, end), m_data(nullptr) {}
+
+	MutableHistoryInterval(MutableHistoryInterval&& rhs) : m_interval(rhs.m_interval), m_data(rhs.m_data) { rhs.m_data = nullptr; }
+	MutableHistoryInterval& operator=(MutableHistoryInterval&& rhs) { m_interval = rhs.m_interval; std::swap(m_data, rhs.m_data); return *this; }
+
+	~MutableHistoryInterval() {
+		if (m_data != nullptr) {
+			-- m_data->intervals;
+			MutableHistoryData::release(m_data);
+		}
+	}
+
+	const Interval& interval() const { return m_interval; }
+	size_t		begin() const { return m_interval.begin(); }
+	size_t		end()   const { return m_interval.end(); }
+	void 		trim_begin(size_t timestamp) { m_interval.trim_begin(timestamp); }
+	void 		trim_end  (size_t timestamp) { m_interval.trim_end(timestamp); }
+	void 		extend_end(size_t timestamp) { m_interval.extend_end(timestamp); }
+
+	bool		operator<(const MutableHistoryInterval& rhs) const { return m_interval < rhs.m_interval; }
+	bool 		operator==(const MutableHistoryInterval& rhs) const { return m_interval == rhs.m_interval; }
+
+	MutableHistoryData* data() const { return m_data; }
+	size_t  	size() const { return m_data->size; }
+	size_t		intervals() const { return m_data->intervals; }
+	size_t 		memsize() const { 
+		return m_data->intervals == 1 ?
+			// Count just the size of the stored snapshot data.
+			m_data->memsize() :
+			// Count the size of the stored snapshot data divided by the number of references, rounded up.
+			(m_data->memsize() + m_data->intervals - 1) / m_data->intervals;
+	}
+
+private:
+	MutableHistoryInterval(const MutableHistoryInterval &rhs);
+	MutableHistoryInterval& operator=(const MutableHistoryInterval &rhs);
+};
+
+// Smaller objects (Model, ModelObject, ModelInstance, ModelVolume, DynamicPrintConfig)
+// are mutable and there is not tracking of the changes, therefore a snapshot needs to be
+// taken every time and compared to the previous data at the Undo / Redo stack.
+// The serialized data is stored if it is different from the last value on the stack, otherwise
+// the serialized data is discarded. The stored data is encoded as a delta to the previous value
+// or compressed asynchronously, see MutableHistoryData.
+// The history of a single mutable object may not be continuous, as an mutable object may
+// be removed from the scene while being kept at the Copy / Paste stack, therefore an object snapshot
+// with the same serialized object data may be shared by multiple history intervals.
+template<typename T>
+class MutableObjectHistory : public ObjectHistory<MutableHistoryInterval>
+{
+public:
+	~MutableObjectHistory() override {}
+
+	bool is_mutable() const override { return true; }
+	bool is_immutable() const override { return false; }
+
+	// Estimated size in memory, to be used to drop least recently used snapshots.
+	size_t memsize() const override {
+		size_t memsize = sizeof(*this);
+		memsize += m_history.size() * sizeof(MutableHistoryInterval);
+		for (const MutableHistoryInterval &interval : m_history)
+			memsize += interval.memsize();
+		memsize += m_last_data.size();
+		return memsize;
+	}
+
+	// Save the data, encoding of newly allocated data is appended to encode_jobs.
+	void save(size_t active_snapshot_time, size_t current_time, std::string &&data, std::vector<MutableHistoryEncodeJob> &encode_jobs) {
+		assert(m_history.empty() || m_history.back().end() <= active_snapshot_time);
+		assert(m_history.empty() || m_history.back().size() == m_last_data.size());
+		bool matches = ! m_history.empty() && m_last_data == data;
+		if (m_history.empty() || m_history.back().end() < active_snapshot_time) {
+			if (matches) {
+				// Share the previous data by reference counting.
+				m_history.emplace_back(Interval(current_time, current_time + 1), m_history.back());
+				return;
+			}
+			// Allocate new data.
+			m_history.emplace_back(Interval(current_time, current_time + 1), data);
+		} else {
+			assert(! m_history.empty());
+			assert(m_history.back().end() == active_snapshot_time);
+			if (matches) {
+				// Just extend the last interval using the old data.
+				m_history.back().extend_end(current_time + 1);
+				return;
+			}
+			// Allocate new data time continuous with the previous data.
+			m_history.emplace_back(Interval(active_snapshot_time, current_time + 1), data);
+		}
+		// Encode the new data as a delta to the previous data, or compress it as a key frame.
+		MutableHistoryData *base = (m_history.size() > 1 && m_history[m_history.size() - 2].data()->depth + 1 < MutableHistoryEncodeJob::MAX_DEPTH) ?
+			MutableHistoryData::acquire(m_history[m_history.size() - 2].data()) : nullptr;
+		// The depth is known before the data is encoded, thus the chain of deltas stays limited
+		// even if the following snapshots are taken while this data is being encoded.
+		if (base != nullptr)
+			m_history.back().data()->depth = base->depth + 1;
+		encode_jobs.emplace_back(m_history.back().data(), base, base ? std::move(m_last_data) : std::string());
+		m_last_data = std::move(data);
+	}
+
+	std::string load(size_t timestamp) const {
+		assert(! m_history.empty());
+		auto it = std::lower_bound(m_history.begin(), m_history.end(), MutableHistoryInterval(timestamp, timestamp));
+		if (it == m_history.end() || it->begin() > timestamp) {
+			assert(it != m_history.begin());
+			-- it;
+		}
+		assert(timestamp >= it->begin() && timestamp < it->end());
+		return (&*it == &m_history.back()) ? m_last_data : it->data()->decode();
+	}
+
+	size_t release_before_timestamp(size_t timestamp) override {
+		size_t memsize = this->memsize();
+		ObjectHistory<MutableHistoryInterval>::release_before_timestamp(timestamp);
+		if (! m_history.empty())
+			// The base of the first data was released from the history, store the first data as a compressed key frame.
+			m_history.front().data()->materialize();
+		else
+			m_last_data.clear();
+		size_t memsize_new = this->memsize();
+		return (memsize > memsize_new) ? memsize - memsize_new : 0;
+	}
+
+	size_t release_after_timestamp(size_t timestamp) override {
+		size_t memsize = this->memsize();
+		size_t history_size = m_history.size();
+		ObjectHistory<MutableHistoryInterval>::release_after_timestamp(timestamp);
+		if (m_history.empty())
+			m_last_data.clear();
+		else if (m_history.size() < history_size)
+			// The last data was released, cache the data of the new last interval.
+			m_last_data = m_history.back().data()->decode();
+		size_t memsize_new = this->memsize();
+		return (memsize > memsize_new) ? memsize - memsize_new : 0;
+	}
+
+	// Currently all mutable snapshots are mandatory.
+	size_t release_optional() override { return 0; }
+	// Currently there is no way to release optional data from the mutable objects.
+	void   restore_optional() override {}
+
+#ifdef SLIC3R_UNDOREDO_DEBUG
+	std::string format() override {
+		std::string out = typeid(T).name();
+		for (const MutableHistoryInterval &interval : m_history)
+			out += std::string(", ptr:") + ptr_to_string(interval.data()) + " len:" + std::to_string(interval.size()) + " stored:" + std::to_string(interval.data()->payload.size()) + 
+				" depth:" + std::to_string(interval.data()->depth) + " <" + std::to_string(interval.begin()) + "," + std::to_string(interval.end()) + ")";
+		return out;
+	}
+#endif /* SLIC3R_UNDOREDO_DEBUG */
+
+#ifndef NDEBUG
+	bool valid() override;
+#endif /* NDEBUG */
+
+private:
+	// Serialized data of the last interval, to be compared with the data being saved.
+	std::string 	m_last_data;
+};
+
+#ifndef NDEBUG
+template<typename T>
+bool MutableObjectHistory<T>::valid()
+{
+	// Verify that the history intervals are sorted and do not overlap, and that the data reference counters are correct.
+	if (! m_history.empty()) {
+		std::map<const MutableHistoryData*, size_t> refcntrs;
+		assert(m_history.front().data() != nullptr);
+		++ refcntrs[m_history.front().data()];
+		for (size_t i = 1; i < m_history.size(); ++ i) {
+			assert(m_history[i - 1].interval().strictly_before(m_history[i].interval()));
+			++ refcntrs[m_history[i].data()];
+		}
+		for (const auto &hi : m_history) {
+			assert(hi.data() != nullptr);
+			assert(refcntrs[hi.data()] == hi.intervals());
+		}
+		assert(m_history.back().size() == m_last_data.size());
+	}
+	return true;
+}
+#endif /* NDEBUG */
+
+} // namespace UndoRedo
+} // namespace Slic3r
+
+#endif /* slic3r_Utils_UndoRedoHistory_hpp_ */
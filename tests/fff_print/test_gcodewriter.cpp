@@ -1,8 +1,11 @@
 #include <catch2/catch.hpp>
 
+#include <limits>
 #include <memory>
+#include <random>
 
 #include "libslic3r/GCodeWriter.hpp"
+#include "libslic3r/GCode/NumberFormat.hpp"
 
 using namespace Slic3r;
 
@@ -94,3 +97,43 @@ SCENARIO("set_speed emits values with fixed-point output.", "[GCodeWriter]") {
         }
     }
 }
+
+TEST_CASE("append_fixed() and append_int() format as sprintf()", "[GCodeWriter]") {
+    auto check_fixed = [](float value, int decimals) {
+        char buf[64];
+        sprintf(buf, "%.*f", decimals, value);
+        std::string out;
+        append_fixed(out, value, decimals);
+        INFO("value " << buf << " decimals " << decimals);
+        REQUIRE(out == buf);
+    };
+    auto check_int = [](int value) {
+        std::string out;
+        append_int(out, value);
+        REQUIRE(out == std::to_string(value));
+    };
+
+    SECTION("edge cases") {
+        // Exact ties are rounded to even, the negative zero keeps its sign.
+        for (float value : { 0.f, -0.f, 0.5f, 1.5f, 2.5f, -2.5f, 0.125f, 0.375f, -0.0625f, 1.f / 1024.f, 0.0005f, -0.00049f,
+                             1e-7f, -1e-7f, 123456.789f, 1e8f, -1e9f, 1e15f, 3.4e38f, -3.4e38f,
+                             std::numeric_limits<float>::min(), std::numeric_limits<float>::denorm_min(), std::numeric_limits<float>::infinity(), std::numeric_limits<float>::quiet_NaN() })
+            for (int decimals = 0; decimals <= 6; ++ decimals)
+                check_fixed(value, decimals);
+        for (int value : { 0, 1, -1, 9, 10, -10, 1234567, std::numeric_limits<int>::max(), std::numeric_limits<int>::min() })
+            check_int(value);
+    }
+    SECTION("random values") {
+        std::mt19937 gen(0);
+        std::uniform_real_distribution<float> coordinate(-500.f, 500.f);
+        std::uniform_int_distribution<int>    halves(-200000, 200000);
+        std::uniform_int_distribution<int>    integer(std::numeric_limits<int>::min(), std::numeric_limits<int>::max());
+        for (size_t i = 0; i < 10000; ++ i) {
+            int decimals = int(i % 7);
+            check_fixed(coordinate(gen), decimals);
+            // Multiples of 1/2^k, many of them exact ties at the last printed digit.
+            check_fixed(float(halves(gen)) / float(1 << (i % 12)), decimals);
+            check_int(integer(gen));
+        }
+    }
+}
@@ -59,3 +59,42 @@ SCENARIO("Model construction", "[Model]") {
         }
     }
 }
+
+SCENARIO("Transformed volume meshes are shared", "[Model]") {
+    GIVEN("A model volume") {
+        std::weak_ptr<const TriangleMesh> weak_transformed;
+        {
+            Model        model;
+            ModelObject *model_object = model.add_object();
+            ModelVolume *volume       = model_object->add_volume(make_cube(20, 20, 20));
+            Transform3d  trafo        = Geometry::assemble_transform(Vec3d(10., 20., 30.), Vec3d(0., 0., 0.5 * PI));
+            std::shared_ptr<const TriangleMesh> transformed = volume->transformed_mesh_shared_ptr(trafo);
+            weak_transformed = transformed;
+            WHEN("The same transformation is requested again") {
+                THEN("The cached mesh is returned") {
+                    REQUIRE(volume->transformed_mesh_shared_ptr(trafo) == transformed);
+                }
+            }
+            WHEN("A different transformation is requested") {
+                THEN("A different mesh is returned") {
+                    REQUIRE(volume->transformed_mesh_shared_ptr(Transform3d::Identity()) != transformed);
+                }
+            }
+            THEN("The mesh is transformed and ready for slicing") {
+                REQUIRE(transformed->facets_count() == volume->mesh().facets_count());
+                REQUIRE(! transformed->its.vertices.empty());
+                REQUIRE(transformed->bounding_box().min.isApprox(volume->mesh().transformed_bounding_box(trafo).min));
+                REQUIRE(transformed->bounding_box().max.isApprox(volume->mesh().transformed_bounding_box(trafo).max));
+            }
+        }
+        WHEN("The source mesh is released") {
+            // Any further request releases the cached meshes of the released sources.
+            Model        model;
+            ModelObject *model_object = model.add_object();
+            model_object->add_volume(make_cube(10, 10, 10))->transformed_mesh_shared_ptr(Transform3d::Identity());
+            THEN("The transformed mesh is released as well") {
+                REQUIRE(weak_transformed.expired());
+            }
+        }
+    }
+}
@@ -125,3 +125,110 @@ SCENARIO("Print: Brim generation", "[Print]") {
         }
     }
 }
+
+SCENARIO("Print: Taking over the object steps of a speculative print", "[Print]") {
+    GIVEN("20mm cube sliced up to the perimeters by a speculative print") {
+        Slic3r::Print print;
+        Slic3r::Model model;
+        Slic3r::Test::init_print({TestMesh::cube_20x20x20}, print, model, { { "fill_density", 0 } });
+        Slic3r::Print speculative;
+        speculative.set_status_silent();
+        speculative.apply(model, print.full_print_config());
+        PrintBase::TaskParams task;
+        task.to_object_step = posPerimeters;
+        speculative.set_task(task);
+        speculative.process();
+        speculative.finalize();
+        THEN("the speculative print stops after the perimeters") {
+            REQUIRE(speculative.objects().front()->is_step_done(posPerimeters));
+            REQUIRE(! speculative.objects().front()->is_step_done(posInfill));
+            REQUIRE(! speculative.is_step_done(psSkirt));
+        }
+        WHEN("the print takes over the object steps") {
+            size_t num_taken_over = print.take_over_object_steps(speculative);
+            const PrintObject &object = *print.objects().front();
+            THEN("the sliced layers are moved to the print") {
+                REQUIRE(num_taken_over == 1);
+                REQUIRE(object.is_step_done(posPerimeters));
+                REQUIRE(object.layers().size() == 66);
+                for (const Layer *layer : object.layers()) {
+                    REQUIRE(layer->object() == &object);
+                    REQUIRE(layer->regions().front()->region() == print.regions().front());
+                    REQUIRE(layer->regions().front()->perimeters.items_count() == 3);
+                }
+                REQUIRE(! speculative.objects().front()->is_step_done(posSlice));
+                REQUIRE(speculative.objects().front()->layers().empty());
+            }
+            THEN("the G-code matches the G-code of a print processed from scratch") {
+                std::string gcode = Slic3r::Test::gcode(print);
+                std::string gcode_ref = Slic3r::Test::slice({TestMesh::cube_20x20x20}, { { "fill_density", 0 } });
+                // Skip the first line with the time stamp.
+                REQUIRE(gcode.substr(gcode.find('\n')) == gcode_ref.substr(gcode_ref.find('\n')));
+            }
+        }
+        WHEN("the print configuration differs from the speculative one") {
+            DynamicPrintConfig config = print.full_print_config();
+            config.set_deserialize({ { "perimeters", 4 } });
+            print.apply(model, config);
+            THEN("nothing is taken over") {
+                REQUIRE(print.take_over_object_steps(speculative) == 0);
+                REQUIRE(! print.objects().front()->is_step_done(posSlice));
+                REQUIRE(speculative.objects().front()->is_step_done(posPerimeters));
+            }
+        }
+    }
+}
+
+SCENARIO("Print: Tool ordering and wipe tower of a multi-material print", "[Print]") {
+    GIVEN("two 20mm cubes printed with four extruders and a wipe tower") {
+        Slic3r::Print print;
+        Slic3r::Test::init_and_process_print({TestMesh::cube_20x20x20, TestMesh::cube_20x20x20}, print, {
+            { "nozzle_diameter",        "0.4,0.4,0.4,0.4" },
+            { "wiping_volumes_matrix",  "0,140,140,140,140,0,140,140,140,140,0,140,140,140,140,0" },
+            { "wipe_tower",             true },
+            { "perimeter_extruder",     1 },
+            { "infill_extruder",        2 },
+            { "solid_infill_extruder",  3 },
+            { "wipe_into_infill",       true }
+        });
+        const ToolOrdering &tool_ordering = print.wipe_tower_data().tool_ordering;
+        THEN("every object layer is printed with the perimeter extruder, the infill may be used for wiping") {
+            size_t num_object_layers = 0;
+            for (const LayerTools &lt : tool_ordering) {
+                if (! lt.has_object)
+                    continue;
+                ++ num_object_layers;
+                REQUIRE(lt.has_extruder(0));
+                for (unsigned int extruder_id : lt.extruders)
+                    REQUIRE(extruder_id < 3);
+            }
+            REQUIRE(num_object_layers == print.objects().front()->layers().size());
+        }
+        THEN("a layer starts with the extruder the layer below ended with") {
+            unsigned int last_extruder = (unsigned int)-1;
+            for (const LayerTools &lt : tool_ordering) {
+                if (lt.extruders.empty())
+                    continue;
+                if (last_extruder != (unsigned int)-1 && lt.has_extruder(last_extruder))
+                    REQUIRE(lt.extruders.front() == last_extruder);
+                last_extruder = lt.extruders.back();
+            }
+        }
+        THEN("the wipe tower is generated and its stages are timed") {
+            REQUIRE(print.wipe_tower_data().number_of_toolchanges > 0);
+            REQUIRE(print.wipe_tower_data().tool_changes.size() > 0);
+            REQUIRE(print.wipe_tower_data().tool_ordering_time > 0.);
+            REQUIRE(print.wipe_tower_data().planning_time > 0.);
+            REQUIRE(print.wipe_tower_data().generation_time > 0.);
+            std::string gcode = Slic3r::Test::gcode(print);
+            REQUIRE(gcode.find("\nT2\n") != std::string::npos);
+            REQUIRE(print.print_statistics().total_toolchanges == print.wipe_tower_data().number_of_toolchanges);
+            REQUIRE(print.print_statistics().wipe_tower_generation_time == print.wipe_tower_data().generation_time);
+            DynamicConfig stats = print.print_statistics().config();
+            REQUIRE(stats.opt_float("tool_ordering_time") == print.wipe_tower_data().tool_ordering_time);
+            REQUIRE(stats.opt_float("wipe_tower_planning_time") == print.wipe_tower_data().planning_time);
+            REQUIRE(stats.opt_float("wipe_tower_generation_time") == print.wipe_tower_data().generation_time);
+            REQUIRE(PrintStatistics::placeholders().has("wipe_tower_generation_time"));
+        }
+    }
+}
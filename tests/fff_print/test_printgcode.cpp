@@ -1,11 +1,15 @@
 #include <catch2/catch.hpp>
 
 #include "libslic3r/libslic3r.h"
+#include "libslic3r/GCode.hpp"
 #include "libslic3r/GCodeReader.hpp"
 
 #include "test_data.hpp"
 
 #include <algorithm>
+#include <fstream>
+#include <boost/filesystem.hpp>
+#include <boost/nowide/cstdio.hpp>
 #include <boost/regex.hpp>
 
 using namespace Slic3r;
@@ -268,3 +272,48 @@ SCENARIO( "PrintGCode basic functionality", "[PrintGCode]") {
         }
     }
 }
+
+SCENARIO("PrintGCode exports the objects of a sequential print in parallel", "[PrintGCode]") {
+    GIVEN("several different objects printed one after another") {
+        auto export_gcode = [](bool in_parallel, size_t &num_objects_exported_in_parallel) {
+            Slic3r::Print print;
+            Slic3r::Model model;
+            Slic3r::Test::init_print({ TestMesh::cube_20x20x20, TestMesh::step, TestMesh::cube_20x20x20, TestMesh::slopy_cube }, print, model, {
+                { "complete_objects",               true },
+                { "gcode_comments",                 true },
+                { "layer_gcode",                    ";Layer:[layer_num] ([layer_z] mm)" },
+                { "between_objects_gcode",          "; between-object-gcode [current_object_idx]" }
+                });
+            print.set_status_silent();
+            print.process();
+            boost::filesystem::path temp = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path();
+            GCode gcodegen;
+            gcodegen.set_sequential_print_in_parallel(in_parallel);
+            gcodegen.do_export(&print, temp.string().c_str());
+            num_objects_exported_in_parallel = gcodegen.num_objects_exported_in_parallel();
+            std::ifstream t(temp.string());
+            std::string str((std::istreambuf_iterator<char>(t)), std::istreambuf_iterator<char>());
+            t.close();
+            boost::nowide::remove(temp.string().c_str());
+            // Skip the first line with the time stamp.
+            return str.substr(str.find('\n'));
+        };
+        WHEN("the G-code is exported in parallel and serially") {
+            size_t      num_parallel_objects_parallel = 0;
+            size_t      num_parallel_objects_serial   = 0;
+            std::string gcode_parallel = export_gcode(true,  num_parallel_objects_parallel);
+            std::string gcode_serial   = export_gcode(false, num_parallel_objects_serial);
+            THEN("the G-code is the same") {
+                REQUIRE(gcode_parallel.size() > 0);
+                REQUIRE(gcode_parallel == gcode_serial);
+            }
+            THEN("all the objects but the first one are exported on worker threads") {
+                REQUIRE(num_parallel_objects_parallel == 3);
+                REQUIRE(num_parallel_objects_serial == 0);
+            }
+            THEN("all the objects are printed") {
+                REQUIRE(gcode_parallel.find("; between-object-gcode 3") != std::string::npos);
+            }
+        }
+    }
+}
@@ -4,6 +4,7 @@
 #include "libslic3r/Point.hpp"
 #include "libslic3r/Config.hpp"
 #include "libslic3r/Model.hpp"
+#include "libslic3r/Geometry.hpp"
 #include "libslic3r/libslic3r.h"
 
 #include <algorithm>
@@ -325,6 +326,107 @@ SCENARIO( "TriangleMesh: split functionality.") {
             }
         }
     }
+    GIVEN( "Three cubes apart, the middle one turned inside out, merged into a single TriangleMesh") {
+        const std::vector<Vec3d> vertices { {20,20,0}, {20,0,0}, {0,0,0}, {0,20,0}, {20,20,20}, {0,20,20}, {0,0,20}, {20,0,20} };
+        const std::vector<Vec3i> facets { {0,1,2}, {0,2,3}, {4,5,6}, {4,6,7}, {0,4,7}, {0,7,1}, {1,7,6}, {1,6,2}, {2,6,5}, {2,5,3}, {4,0,3}, {4,3,5} };
+        std::vector<Vec3i> facets_reversed;
+        for (const Vec3i &facet : facets)
+            facets_reversed.emplace_back(facet(1), facet(0), facet(2));
+
+        TriangleMesh mesh(vertices, facets);
+        for (int i = 1; i < 3; ++ i) {
+            TriangleMesh cube(vertices, i == 1 ? facets_reversed : facets);
+            cube.translate(float(40 * i), 0.f, 0.f);
+            mesh.merge(cube);
+        }
+        mesh.repair();
+        WHEN( "The combined mesh is split") {
+            std::vector<TriangleMesh*> meshes = mesh.split();
+            THEN( "The parts are returned in the order of their facets, repaired") {
+                REQUIRE(meshes.size() == 3);
+                for (size_t i = 0; i < meshes.size(); ++ i) {
+                    const TriangleMesh &part = *meshes[i];
+                    REQUIRE(part.repaired);
+                    REQUIRE(part.facets_count() == 12);
+                    REQUIRE(part.its.vertices.size() == 8);
+                    REQUIRE(part.its.indices.size() == 12);
+                    REQUIRE(part.stl.stats.connected_facets_3_edge == 12);
+                    REQUIRE(part.stl.stats.volume == Approx(8000.));
+                    REQUIRE(part.bounding_box().min.isApprox(Vec3d(40. * i, 0., 0.)));
+                    REQUIRE(part.bounding_box().max.isApprox(Vec3d(40. * i + 20., 20., 20.)));
+                }
+            }
+            THEN( "The shared vertices and the neighbors match the facets of the parts") {
+                for (const TriangleMesh *part : meshes)
+                    for (size_t i = 0; i < part->facets_count(); ++ i) {
+                        const stl_facet &facet = part->stl.facet_start[i];
+                        for (int j = 0; j < 3; ++ j) {
+                            REQUIRE(part->its.vertices[part->its.indices[i](j)] == facet.vertex[j]);
+                            int neighbor = part->stl.neighbors_start[i].neighbor[j];
+                            REQUIRE(neighbor >= 0);
+                            REQUIRE(size_t(neighbor) < part->facets_count());
+                        }
+                    }
+            }
+            THEN( "Repairing the parts does not change them") {
+                for (const TriangleMesh *part : meshes) {
+                    TriangleMesh repaired = *part;
+                    repaired.repaired = false;
+                    repaired.repair();
+                    REQUIRE(repaired.stl.stats.volume == Approx(part->stl.stats.volume));
+                    REQUIRE(repaired.stl.stats.connected_edges == part->stl.stats.connected_edges);
+                    REQUIRE(repaired.stl.stats.shortest_edge == Approx(part->stl.stats.shortest_edge));
+                    for (size_t i = 0; i < part->facets_count(); ++ i)
+                        REQUIRE(repaired.stl.facet_start[i].normal.isApprox(part->stl.facet_start[i].normal));
+                }
+            }
+            for (TriangleMesh *part : meshes)
+                delete part;
+        }
+    }
+    GIVEN( "Two cubes touching at a single vertex, merged into a single TriangleMesh") {
+        TriangleMesh mesh = make_cube(20., 20., 20.);
+        TriangleMesh cube = make_cube(20., 20., 20.);
+        cube.translate(20.f, 20.f, 20.f);
+        mesh.merge(cube);
+        mesh.repair();
+        WHEN( "The combined mesh is split") {
+            std::vector<TriangleMesh*> meshes = mesh.split();
+            THEN( "Each part receives its own copy of the shared vertex") {
+                REQUIRE(meshes.size() == 2);
+                for (const TriangleMesh *part : meshes) {
+                    REQUIRE(part->its.vertices.size() == 8);
+                    REQUIRE(std::count(part->its.vertices.begin(), part->its.vertices.end(), stl_vertex(20.f, 20.f, 20.f)) == 1);
+                }
+            }
+            for (TriangleMesh *part : meshes)
+                delete part;
+        }
+    }
+}
+
+SCENARIO( "TriangleMesh: convex hulls.") {
+    GIVEN( "A sphere") {
+        TriangleMesh sphere = make_sphere(10., 2. * PI / 60.);
+        sphere.repair();
+        WHEN( "The 3D convex hull is calculated") {
+            TriangleMesh hull = sphere.convex_hull_3d();
+            THEN( "The hull encloses the sphere, which is convex") {
+                REQUIRE(hull.bounding_box().min.isApprox(sphere.bounding_box().min));
+                REQUIRE(hull.bounding_box().max.isApprox(sphere.bounding_box().max));
+                REQUIRE(hull.stl.stats.volume == Approx(sphere.stl.stats.volume));
+            }
+        }
+        WHEN( "The 2D convex hull is calculated") {
+            Polygon hull = sphere.convex_hull();
+            THEN( "The hull equals the hull of all the vertices") {
+                Points pts;
+                for (const stl_vertex &v : sphere.its.vertices)
+                    pts.emplace_back(Point::new_scale(v(0), v(1)));
+                REQUIRE(hull == Geometry::convex_hull(pts));
+            }
+        }
+    }
 }
 
 SCENARIO( "TriangleMesh: Mesh merge functions") {
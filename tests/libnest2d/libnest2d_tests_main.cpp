@@ -968,6 +968,61 @@ TEST_CASE("nfpConvexConvex", "[Geometry]") {
     testNfp<nfp::NfpLevel::CONVEX_ONLY, 1>(nfp_testdata);
 }
 
+TEST_CASE("NfpCacheReusesTranslatedNfps", "[Geometry]") {
+    using namespace libnest2d;
+    using Cache = placers::NfpCache<PolygonImpl>;
+
+    auto calcnfp = [](const Item& stationary, const Item& orbiter) {
+        auto nfp = nfp::noFitPolygon<nfp::NfpLevel::CONVEX_ONLY>(
+                    stationary.transformedShape(), orbiter.transformedShape());
+        placers::correctNfpPosition(nfp, stationary, orbiter);
+        return nfp.first;
+    };
+
+    auto equals = [](const PolygonImpl& p1, const PolygonImpl& p2) {
+        return shapelike::contourVertexCount(p1) ==
+                   shapelike::contourVertexCount(p2) &&
+               std::equal(shapelike::cbegin(p1), shapelike::cend(p1),
+                          shapelike::cbegin(p2));
+    };
+
+    Cache cache;
+
+    for(auto& td : nfp_testdata) {
+        Item stationary = td.stationary;
+        Item orbiter = td.orbiter;
+        orbiter.translate({210, 0});
+
+        size_t h = Cache::pairHash(Cache::shapeHash(stationary),
+                                   Cache::shapeHash(orbiter));
+
+        PolygonImpl nfp;
+        REQUIRE_FALSE(cache.get(h, stationary, orbiter, nfp));
+        cache.put(h, stationary, orbiter, calcnfp(stationary, orbiter));
+
+        // The same shapes elsewhere should get the same nfp moved along
+        Item stationary2 = stationary;
+        stationary2.translate({1000, -2000});
+        Item orbiter2 = orbiter;
+        orbiter2.translate({-300, 500});
+
+        REQUIRE(Cache::shapeHash(stationary2) == Cache::shapeHash(stationary));
+        REQUIRE(Cache::sameShape(stationary2, stationary));
+        REQUIRE(cache.get(h, stationary2, orbiter2, nfp));
+        REQUIRE(equals(nfp, calcnfp(stationary2, orbiter2)));
+
+        // A rotated item is a different shape
+        Item rotated = stationary;
+        rotated.rotation(Pi / 2);
+        REQUIRE_FALSE(Cache::sameShape(rotated, stationary));
+        REQUIRE_FALSE(cache.get(Cache::pairHash(Cache::shapeHash(rotated),
+                                                Cache::shapeHash(orbiter)),
+                                rotated, orbiter, nfp));
+    }
+
+    REQUIRE(cache.size() == nfp_testdata.size());
+}
+
 //TEST_CASE(GeometryAlgorithms, nfpConcaveConcave) {
 //    TEST_CASENfp<NfpLevel::BOTH_CONCAVE, 1000>(nfp_concave_TEST_CASEdata);
 //}
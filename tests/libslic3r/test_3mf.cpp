@@ -3,6 +3,7 @@
 #include "libslic3r/Model.hpp"
 #include "libslic3r/Format/3mf.hpp"
 #include "libslic3r/Format/STL.hpp"
+#include "libslic3r/miniz_extension.hpp"
 
 #include <boost/filesystem/operations.hpp>
 
@@ -85,3 +86,131 @@ SCENARIO("Export+Import geometry to/from 3mf file cycle", "[3mf]") {
         }
     }
 }
+
+SCENARIO("Export+Import of multiple objects to/from 3mf file cycle", "[3mf]") {
+    GIVEN("a model of several objects with multiple volumes") {
+        Model src_model;
+        for (int i = 0; i < 4; ++i) {
+            ModelObject* object = src_model.add_object();
+            object->name = "object " + std::to_string(i);
+            for (int j = 0; j <= i; ++j) {
+                TriangleMesh mesh = make_cube(10. + i, 20., 5. + j);
+                mesh.translate(float(30 * j), 0.f, 0.f);
+                ModelVolume* volume = object->add_volume(std::move(mesh));
+                volume->name = object->name + " volume " + std::to_string(j);
+            }
+        }
+        src_model.add_default_instances();
+
+        WHEN("model is saved+loaded to/from 3mf file") {
+            std::string test_file = std::string(TEST_DATA_DIR) + "/test_3mf/multiple_objects.3mf";
+            store_3mf(test_file.c_str(), &src_model, nullptr, false);
+
+            Model dst_model;
+            DynamicPrintConfig dst_config;
+            bool ret = load_3mf(test_file.c_str(), &dst_config, &dst_model, false);
+            boost::filesystem::remove(test_file);
+
+            THEN("objects and volumes are loaded in their original order") {
+                REQUIRE(ret);
+                REQUIRE(dst_model.objects.size() == src_model.objects.size());
+                for (size_t i = 0; i < src_model.objects.size(); ++i) {
+                    const ModelObject* src_object = src_model.objects[i];
+                    const ModelObject* dst_object = dst_model.objects[i];
+                    REQUIRE(dst_object->name == src_object->name);
+                    REQUIRE(dst_object->volumes.size() == src_object->volumes.size());
+                    for (size_t j = 0; j < src_object->volumes.size(); ++j) {
+                        REQUIRE(dst_object->volumes[j]->name == src_object->volumes[j]->name);
+                        const ModelVolume* dst_volume = dst_object->volumes[j];
+                        REQUIRE(dst_volume->mesh().facets_count() == src_object->volumes[j]->mesh().facets_count());
+                        // the convex hull of a cube is centered together with the mesh
+                        REQUIRE(dst_volume->get_convex_hull().bounding_box().min.isApprox(dst_volume->mesh().bounding_box().min));
+                        REQUIRE(dst_volume->get_convex_hull().bounding_box().max.isApprox(dst_volume->mesh().bounding_box().max));
+                    }
+                }
+            }
+        }
+    }
+}
+
+SCENARIO("Adding a large file to a zip archive", "[3mf]") {
+    GIVEN("a file made of several parts larger than a single deflate block") {
+        std::vector<std::string> parts;
+        for (size_t i = 0; i < 3; ++i) {
+            std::string part;
+            for (unsigned int j = 0; part.size() < (i + 1) * 3 * 1024 * 1024; ++j)
+                part += "     <vertex x=\"" + std::to_string(j * (i + 1)) + "\" y=\"" + std::to_string(j % 1000) + "\" />\n";
+            parts.emplace_back(std::move(part));
+        }
+        std::string data = parts[0] + parts[1] + parts[2];
+
+        WHEN("the parts are added to a zip archive and read back") {
+            std::string test_file = std::string(TEST_DATA_DIR) + "/test_3mf/large_file.zip";
+            mz_zip_archive archive;
+            mz_zip_zero_struct(&archive);
+            REQUIRE(open_zip_writer(&archive, test_file));
+            bool added = add_file_to_zip_writer(&archive, "large_file.txt", parts);
+            mz_zip_writer_finalize_archive(&archive);
+            close_zip_writer(&archive);
+
+            mz_zip_zero_struct(&archive);
+            REQUIRE(open_zip_reader(&archive, test_file));
+            size_t size = 0;
+            void *extracted = mz_zip_reader_extract_file_to_heap(&archive, "large_file.txt", &size, 0);
+            std::string read_back = extracted ? std::string((const char*)extracted, size) : std::string();
+            mz_free(extracted);
+            close_zip_reader(&archive);
+            boost::filesystem::remove(test_file);
+
+            THEN("the file content is preserved") {
+                REQUIRE(added);
+                REQUIRE(read_back == data);
+            }
+        }
+    }
+}
+
+SCENARIO("Adding a large file made of many small parts to a zip archive", "[3mf]") {
+    GIVEN("a file made of many parts much smaller than a deflate block") {
+        std::vector<std::string> parts;
+        std::string data;
+        for (unsigned int i = 0; data.size() < 10 * 1024 * 1024; ++i) {
+            std::string part;
+            for (unsigned int j = 0; j < 50; ++j)
+                part += "     <triangle v1=\"" + std::to_string(i * 50 + j) + "\" v2=\"" + std::to_string(i * 50 + j + 1) + "\" v3=\"" + std::to_string(j) + "\" />\n";
+            data += part;
+            parts.emplace_back(std::move(part));
+        }
+
+        WHEN("the parts are added to a zip archive and read back") {
+            std::string test_file = std::string(TEST_DATA_DIR) + "/test_3mf/small_parts.zip";
+            mz_zip_archive archive;
+            mz_zip_zero_struct(&archive);
+            REQUIRE(open_zip_writer(&archive, test_file));
+            bool added = add_file_to_zip_writer(&archive, "small_parts.txt", parts);
+            mz_zip_writer_add_mem(&archive, "single_stream.txt", data.data(), data.size(), MZ_DEFAULT_LEVEL);
+            mz_zip_writer_finalize_archive(&archive);
+            close_zip_writer(&archive);
+
+            mz_zip_zero_struct(&archive);
+            REQUIRE(open_zip_reader(&archive, test_file));
+            size_t size = 0;
+            void *extracted = mz_zip_reader_extract_file_to_heap(&archive, "small_parts.txt", &size, 0);
+            std::string read_back = extracted ? std::string((const char*)extracted, size) : std::string();
+            mz_free(extracted);
+            mz_zip_archive_file_stat stat_parts, stat_single;
+            bool stats = mz_zip_reader_file_stat(&archive, 0, &stat_parts) && mz_zip_reader_file_stat(&archive, 1, &stat_single);
+            close_zip_reader(&archive);
+            boost::filesystem::remove(test_file);
+
+            THEN("the file content is preserved") {
+                REQUIRE(added);
+                REQUIRE(read_back == data);
+            }
+            THEN("the parts are merged into large deflate blocks, the compression ratio is close to that of a single stream") {
+                REQUIRE(stats);
+                REQUIRE(double(stat_parts.m_comp_size) < 1.05 * double(stat_single.m_comp_size));
+            }
+        }
+    }
+}
@@ -0,0 +1,188 @@
+#include <catch2/catch.hpp>
+
+#include "libslic3r/Model.hpp"
+#include "libslic3r/Arrange.hpp"
+#include "libslic3r/MTUtils.hpp"
+
+using namespace Slic3r;
+
+SCENARIO("Splitting a model to beds", "[Arrange]") {
+    GIVEN("more cubes than fit onto a single bed") {
+        Model model;
+        for (int i = 0; i < 30; ++i) {
+            ModelObject *object = model.add_object();
+            object->name = "cube " + std::to_string(i);
+            object->add_volume(make_cube(50., 50., 10. + i % 3));
+        }
+        model.add_default_instances();
+
+        const BoundingBoxf bed(Vec2d(0., 0.), Vec2d(200., 200.));
+
+        WHEN("the model is split to beds") {
+            std::vector<Model> beds = model.split_to_beds(6., bed);
+
+            THEN("all the instances are placed onto the beds") {
+                REQUIRE(beds.size() > 1);
+                size_t count = 0;
+                for (const Model &m : beds)
+                    for (const ModelObject *o : m.objects)
+                        count += o->instances.size();
+                REQUIRE(count == 30);
+            }
+            THEN("the instances of each bed are inside the bed and do not overlap") {
+                for (const Model &m : beds) {
+                    std::vector<BoundingBoxf3> boxes;
+                    for (const ModelObject *o : m.objects)
+                        for (size_t i = 0; i < o->instances.size(); ++i)
+                            boxes.emplace_back(o->instance_bounding_box(i));
+
+                    for (size_t i = 0; i < boxes.size(); ++i) {
+                        REQUIRE(boxes[i].min.x() >= bed.min.x() - EPSILON);
+                        REQUIRE(boxes[i].min.y() >= bed.min.y() - EPSILON);
+                        REQUIRE(boxes[i].max.x() <= bed.max.x() + EPSILON);
+                        REQUIRE(boxes[i].max.y() <= bed.max.y() + EPSILON);
+                        for (size_t j = i + 1; j < boxes.size(); ++j) {
+                            bool separated = boxes[i].max.x() <= boxes[j].min.x() || boxes[j].max.x() <= boxes[i].min.x() ||
+                                             boxes[i].max.y() <= boxes[j].min.y() || boxes[j].max.y() <= boxes[i].min.y();
+                            REQUIRE(separated);
+                        }
+                    }
+                }
+            }
+            THEN("the objects keep their names") {
+                REQUIRE(beds.front().objects.front()->name == "cube 0");
+            }
+        }
+    }
+}
+
+SCENARIO("Splitting a model with an object larger than the bed", "[Arrange]") {
+    GIVEN("an oversized cube among cubes filling a few beds") {
+        Model model;
+        ModelObject *large = model.add_object();
+        large->name = "large cube";
+        large->add_volume(make_cube(250., 250., 10.));
+        for (int i = 0; i < 20; ++i) {
+            ModelObject *object = model.add_object();
+            object->name = "cube " + std::to_string(i);
+            object->add_volume(make_cube(60., 60., 10.));
+        }
+        model.add_default_instances();
+
+        const BoundingBoxf bed(Vec2d(0., 0.), Vec2d(200., 200.));
+
+        WHEN("the model is split to beds") {
+            std::vector<const ModelInstance*> unfittable;
+            std::vector<Model> beds = model.split_to_beds(6., bed, &unfittable);
+
+            THEN("the oversized instance is reported") {
+                REQUIRE(unfittable.size() == 1);
+                REQUIRE(unfittable.front() == large->instances.front());
+            }
+            THEN("the other instances are placed onto the beds") {
+                size_t count = 0;
+                for (const Model &m : beds)
+                    for (const ModelObject *o : m.objects) {
+                        REQUIRE(o->name != "large cube");
+                        count += o->instances.size();
+                    }
+                REQUIRE(count == 20);
+            }
+            THEN("no bed is empty") {
+                REQUIRE(beds.size() > 1);
+                for (const Model &m : beds)
+                    REQUIRE(! m.objects.empty());
+            }
+        }
+    }
+}
+
+SCENARIO("Arranging onto multiple beds", "[Arrange]") {
+    GIVEN("items of different sizes, some not fitting the bed") {
+        arrangement::BedShapeHint bedhint(BoundingBox(Point(0, 0), Point(scaled(200.), scaled(200.))));
+
+        arrangement::ArrangePolygons items;
+        for (int i = 0; i < 40; ++i) {
+            double size = (i % 5 == 0) ? 250. : 30. + 10. * (i % 4);
+            arrangement::ArrangePolygon ap;
+            ap.poly.contour = Polygon::new_scale({{0., 0.}, {size, 0.}, {size, size}, {0., size}});
+            items.emplace_back(ap);
+        }
+
+        WHEN("the items are arranged onto beds") {
+            arrangement::arrange_beds(items, scaled(6.), bedhint);
+
+            THEN("the oversized items are left unarranged") {
+                for (size_t i = 0; i < items.size(); ++i)
+                    REQUIRE(items[i].is_arranged() == (i % 5 != 0));
+            }
+            THEN("the beds are numbered contiguously") {
+                int nbeds = 0;
+                for (const arrangement::ArrangePolygon &ap : items)
+                    nbeds = std::max(nbeds, ap.bed_idx + 1);
+                REQUIRE(nbeds > 1);
+
+                std::vector<size_t> count(size_t(nbeds), 0);
+                for (const arrangement::ArrangePolygon &ap : items)
+                    if (ap.is_arranged()) ++count[size_t(ap.bed_idx)];
+                for (size_t c : count)
+                    REQUIRE(c > 0);
+            }
+        }
+    }
+}
+
+// The bounding box of an arrange polygon in its arranged position
+static BoundingBox arranged_bbox(const arrangement::ArrangePolygon &ap)
+{
+    Polygon p = ap.poly.contour;
+    p.rotate(ap.rotation);
+    p.translate(ap.translation.x(), ap.translation.y());
+    return p.bounding_box();
+}
+
+SCENARIO("Arranging only the new items", "[Arrange]") {
+    GIVEN("a bed with arranged items and a few new ones") {
+        const Polygon square = Polygon::new_scale({{0., 0.}, {40., 0.}, {40., 40.}, {0., 40.}});
+        arrangement::BedShapeHint bedhint(BoundingBox(Point(0, 0), Point(scaled(200.), scaled(200.))));
+
+        arrangement::ArrangePolygons items;
+        for (int i = 0; i < 3; ++i) {
+            arrangement::ArrangePolygon ap;
+            ap.poly.contour = square;
+            ap.translation  = Vec2crd(scaled(10. + 60. * i), scaled(80.));
+            ap.bed_idx      = 0;
+            items.emplace_back(ap);
+        }
+        for (int i = 0; i < 5; ++i) {
+            arrangement::ArrangePolygon ap;
+            ap.poly.contour = square;
+            items.emplace_back(ap);
+        }
+        const arrangement::ArrangePolygons input = items;
+
+        WHEN("the new items are arranged") {
+            arrangement::arrange_new_items(items, scaled(6.), bedhint);
+
+            THEN("the arranged items do not move") {
+                for (size_t i = 0; i < 3; ++i) {
+                    REQUIRE(items[i].translation == input[i].translation);
+                    REQUIRE(items[i].rotation == input[i].rotation);
+                    REQUIRE(items[i].bed_idx == 0);
+                }
+            }
+            THEN("the new items are placed around the arranged ones") {
+                for (size_t i = 3; i < items.size(); ++i) {
+                    REQUIRE(items[i].bed_idx == 0);
+                    BoundingBox bb = arranged_bbox(items[i]);
+                    for (size_t j = 0; j < i; ++j) {
+                        BoundingBox other = arranged_bbox(items[j]);
+                        bool separated = bb.max.x() <= other.min.x() || other.max.x() <= bb.min.x() ||
+                                         bb.max.y() <= other.min.y() || other.max.y() <= bb.min.y();
+                        REQUIRE(separated);
+                    }
+                }
+            }
+        }
+    }
+}
@@ -201,3 +201,56 @@ SCENARIO("Config ini load/save interface", "[Config]") {
         }
     }
 }
+
+SCENARIO("Config diff and hash", "[Config]") {
+    GIVEN("Two default static configs and a default dynamic config") {
+        PrintRegionConfig  config1;
+        PrintRegionConfig  config2;
+        DynamicPrintConfig full_config = DynamicPrintConfig::full_print_config();
+        THEN("The configs are equal and their hashes match.") {
+            REQUIRE(config1.diff(config2).empty());
+            REQUIRE(config1.equals(config2));
+            REQUIRE(config1.diff(full_config).empty());
+            REQUIRE(config1.hash() == config2.hash());
+        }
+        WHEN("Some options of one static config are modified") {
+            config2.perimeters.value = config1.perimeters.value + 1;
+            config2.fill_density.value = 11.;
+            config2.infill_extrusion_width = ConfigOptionFloatOrPercent(config1.infill_extrusion_width.value, ! config1.infill_extrusion_width.percent);
+            THEN("The diff lists the modified options in the order of the keys.") {
+                t_config_option_keys diff = config1.diff(config2);
+                REQUIRE(diff == static_cast<const ConfigBase&>(config1).diff(config2));
+                REQUIRE(diff.size() == 3);
+                REQUIRE(std::find(diff.begin(), diff.end(), "perimeters") != diff.end());
+                REQUIRE(std::find(diff.begin(), diff.end(), "fill_density") != diff.end());
+                REQUIRE(std::find(diff.begin(), diff.end(), "infill_extrusion_width") != diff.end());
+                REQUIRE(! config1.equals(config2));
+                REQUIRE(config1.hash() != config2.hash());
+            }
+            THEN("Applying the diff makes the configs equal.") {
+                config1.apply_only(config2, config1.diff(config2));
+                REQUIRE(config1.equals(config2));
+                REQUIRE(config1.hash() == config2.hash());
+            }
+        }
+        WHEN("A dynamic config is compared with a config containing a subset of its options") {
+            DynamicPrintConfig config;
+            config.set_key_value("perimeters", new ConfigOptionInt(full_config.opt_int("perimeters") + 1));
+            config.set_key_value("layer_height", new ConfigOptionFloat(full_config.opt_float("layer_height")));
+            config.set_key_value("custom_option", new ConfigOptionString("value"));
+            THEN("Only the modified options present in both configs are reported.") {
+                REQUIRE(full_config.diff(config) == t_config_option_keys{ "perimeters" });
+                REQUIRE(config.diff(full_config) == t_config_option_keys{ "perimeters" });
+                REQUIRE(full_config.diff(config) == static_cast<const ConfigBase&>(full_config).diff(config));
+            }
+        }
+    }
+    GIVEN("Nullable options") {
+        ConfigOptionFloatsNullable floats1({ 1., ConfigOptionFloatsNullable::nil_value(), 0. });
+        ConfigOptionFloatsNullable floats2({ 1., ConfigOptionFloatsNullable::nil_value(), -0. });
+        THEN("Equal options have equal hashes.") {
+            REQUIRE(floats1 == floats2);
+            REQUIRE(floats1.hash() == floats2.hash());
+        }
+    }
+}
@@ -0,0 +1,115 @@
+#include <catch2/catch.hpp>
+
+#include "libslic3r/GCode/PreviewData.hpp"
+
+using namespace Slic3r;
+
+SCENARIO("Compact storage of the G-code preview toolpaths", "[GCodePreviewData]") {
+    GIVEN("an extrusion path with points on a micrometer grid") {
+        GCodePreviewData::Extrusion::Path path;
+        path.polyline.points = { Point(scale_(10.), scale_(20.)), Point(scale_(10.001), scale_(20.)), Point(scale_(-150.5), scale_(210.25)), Point(scale_(-150.5), scale_(210.25)), Point(0, 0) };
+        path.extrusion_role = erExternalPerimeter;
+        path.mm3_per_mm     = 0.0625f;
+        path.width          = 0.5f;
+        path.height         = 0.25f;
+        path.feedrate       = 40.f;
+        path.extruder_id    = 3;
+        path.cp_color_id    = 2;
+        path.fan_speed      = 100.f;
+
+        WHEN("the path is appended to a layer and decoded") {
+            GCodePreviewData::Extrusion::Layer layer(0.25f);
+            layer.append(path);
+            GCodePreviewData::Extrusion::Path decoded;
+            layer.path(0, decoded);
+
+            THEN("the points are preserved, except for the duplicate ones") {
+                REQUIRE(layer.num_paths() == 1);
+                REQUIRE(layer.num_points(0) == 4);
+                REQUIRE(decoded.polyline.points == Points({ path.polyline.points[0], path.polyline.points[1], path.polyline.points[2], path.polyline.points[4] }));
+            }
+            THEN("the attributes are preserved") {
+                REQUIRE(decoded.extrusion_role == path.extrusion_role);
+                REQUIRE(decoded.mm3_per_mm == path.mm3_per_mm);
+                REQUIRE(decoded.width == path.width);
+                REQUIRE(decoded.height == path.height);
+                REQUIRE(decoded.feedrate == path.feedrate);
+                REQUIRE(decoded.extruder_id == path.extruder_id);
+                REQUIRE(decoded.cp_color_id == path.cp_color_id);
+                REQUIRE(decoded.fan_speed == path.fan_speed);
+            }
+        }
+        WHEN("widths are not representable exactly") {
+            GCodePreviewData::Extrusion::Layer layer(0.25f);
+            for (float width : { 0.45f, 0.6789f, 1.2345f }) {
+                path.width = width;
+                layer.append(path);
+            }
+            THEN("the decoded widths are close") {
+                GCodePreviewData::Extrusion::Path decoded;
+                for (size_t i = 0; i < layer.num_paths(); ++ i) {
+                    layer.path_attributes(i, decoded);
+                    REQUIRE(decoded.width == Approx(std::vector<float>{ 0.45f, 0.6789f, 1.2345f }[i]).epsilon(0.001));
+                }
+            }
+        }
+        WHEN("a path collapses to a single point") {
+            GCodePreviewData::Extrusion::Layer layer(0.25f);
+            path.polyline.points = { Point(0, 0), Point(100, 0) };
+            layer.append(path);
+            THEN("it is dropped") {
+                REQUIRE(layer.num_paths() == 0);
+            }
+        }
+    }
+    GIVEN("travel polylines") {
+        GCodePreviewData::Travel::PolylinesList polylines;
+        Polyline3 pl1;
+        pl1.points = { Vec3crd(coord_t(scale_(1.)), coord_t(scale_(2.)), coord_t(scale_(0.4))), Vec3crd(coord_t(scale_(1.)), coord_t(scale_(2.)), coord_t(scale_(0.6))) };
+        Polyline3 pl2;
+        pl2.points = { Vec3crd(coord_t(scale_(100.)), coord_t(scale_(0.)), coord_t(scale_(0.6))), Vec3crd(coord_t(scale_(50.)), coord_t(scale_(50.)), coord_t(scale_(0.6))), Vec3crd(coord_t(scale_(0.)), coord_t(scale_(0.)), coord_t(scale_(0.6))) };
+        polylines.append(GCodePreviewData::Travel::Polyline(GCodePreviewData::Travel::Retract, GCodePreviewData::Travel::Polyline::Vertical, 30.f, 1, pl1));
+        polylines.append(GCodePreviewData::Travel::Polyline(GCodePreviewData::Travel::Move, GCodePreviewData::Travel::Polyline::Generic, 150.f, 0, pl2));
+
+        WHEN("the polylines are decoded") {
+            GCodePreviewData::Travel::Polyline decoded;
+            THEN("the points and the attributes are preserved") {
+                REQUIRE(polylines.size() == 2);
+                polylines.polyline(0, decoded);
+                REQUIRE(decoded.polyline.points == pl1.points);
+                REQUIRE(decoded.type == GCodePreviewData::Travel::Retract);
+                REQUIRE(decoded.direction == GCodePreviewData::Travel::Polyline::Vertical);
+                REQUIRE(decoded.feedrate == 30.f);
+                REQUIRE(decoded.extruder_id == 1);
+                REQUIRE(polylines.min_z(0) == pl1.points.front().z());
+                polylines.polyline(1, decoded);
+                REQUIRE(decoded.polyline.points == pl2.points);
+                REQUIRE(decoded.type == GCodePreviewData::Travel::Move);
+                REQUIRE(decoded.feedrate == 150.f);
+            }
+        }
+        WHEN("a polyline with a lower z is appended and the polylines are sorted by their minimum z") {
+            Polyline3 pl3;
+            pl3.points = { Vec3crd(coord_t(scale_(5.)), coord_t(scale_(5.)), coord_t(scale_(0.2))), Vec3crd(coord_t(scale_(6.)), coord_t(scale_(5.)), coord_t(scale_(0.2))) };
+            polylines.append(GCodePreviewData::Travel::Polyline(GCodePreviewData::Travel::Extrude, GCodePreviewData::Travel::Polyline::Generic, 60.f, 2, pl3));
+            polylines.append(GCodePreviewData::Travel::Polyline(GCodePreviewData::Travel::Move, GCodePreviewData::Travel::Polyline::Vertical, 90.f, 0, pl1));
+            polylines.sort_by_min_z(1);
+            THEN("the polylines before the sorted range stay in place, the sort is stable") {
+                GCodePreviewData::Travel::Polyline decoded;
+                REQUIRE(polylines.size() == 4);
+                polylines.polyline(0, decoded);
+                REQUIRE(decoded.polyline.points == pl1.points);
+                REQUIRE(decoded.feedrate == 30.f);
+                polylines.polyline(1, decoded);
+                REQUIRE(decoded.polyline.points == pl3.points);
+                REQUIRE(decoded.extruder_id == 2);
+                polylines.polyline(2, decoded);
+                REQUIRE(decoded.polyline.points == pl1.points);
+                REQUIRE(decoded.feedrate == 90.f);
+                polylines.polyline(3, decoded);
+                REQUIRE(decoded.polyline.points == pl2.points);
+                REQUIRE(decoded.feedrate == 150.f);
+            }
+        }
+    }
+}
@@ -0,0 +1,67 @@
+#include <catch2/catch.hpp>
+
+#include "libslic3r/Format/objparser.hpp"
+
+#include <sstream>
+
+#include <boost/filesystem/operations.hpp>
+
+using namespace ObjParser;
+
+SCENARIO("Parsing OBJ files", "[obj]") {
+    GIVEN("faces referencing the vertices relatively and absolutely") {
+        // Long enough for the file to be split into multiple blocks parsed concurrently.
+        std::ostringstream obj;
+        obj << "o object\n";
+        const int num_triangles = 50000;
+        for (int i = 0; i < num_triangles; ++ i) {
+            obj << "v " << i << ".5 " << -i << " 1e-3\r\n";
+            obj << "v " << i << " 1 0\n";
+            obj << "v 0 " << i << ".25 2.\n";
+            if (i % 2 == 0)
+                obj << "f -3 -2 -1\n";
+            else
+                obj << "f " << 3 * i + 1 << " " << 3 * i + 2 << " " << 3 * i + 3 << "\n";
+        }
+        std::istringstream stream(obj.str());
+
+        WHEN("the file is parsed") {
+            ObjData data;
+            objparse(stream, data);
+            THEN("all the vertices and faces are read in order") {
+                REQUIRE(data.coordinates.size() == 4 * 3 * num_triangles);
+                REQUIRE(data.vertices.size() == 4 * num_triangles);
+                REQUIRE(data.objects.size() == 1);
+                bool indices_valid = true;
+                for (int i = 0; i < num_triangles; ++ i)
+                    for (int j = 0; j < 3; ++ j)
+                        indices_valid &= data.vertices[4 * i + j].coordIdx == 3 * i + j;
+                REQUIRE(indices_valid);
+                REQUIRE(data.coordinates[4 * 3 * (num_triangles - 1)] == Approx(num_triangles - 0.5f));
+                REQUIRE(data.coordinates[4 * 3 * (num_triangles - 1) + 2] == Approx(1e-3f));
+                REQUIRE(data.coordinates.back() == 1.f);
+            }
+        }
+    }
+
+    GIVEN("an OBJ file") {
+        std::string path = std::string(TEST_DATA_DIR) + "/frog_legs.obj";
+        ObjData data;
+        REQUIRE(objparse(path.c_str(), data));
+
+        WHEN("the file is parsed twice through the binary cache") {
+            ObjData data_parsed, data_cached;
+            bool parsed = objparse_cached(path.c_str(), data_parsed);
+            bool cache_exists = boost::filesystem::exists(path + ".bin");
+            bool cached = objparse_cached(path.c_str(), data_cached);
+            boost::filesystem::remove(path + ".bin");
+            THEN("the same data are loaded from the cache") {
+                REQUIRE(parsed);
+                REQUIRE(cache_exists);
+                REQUIRE(cached);
+                REQUIRE(objequal(data, data_parsed));
+                REQUIRE(objequal(data, data_cached));
+            }
+        }
+    }
+}
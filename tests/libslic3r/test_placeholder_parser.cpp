@@ -94,3 +94,84 @@ SCENARIO("Placeholder parser scripting", "[PlaceholderParser]") {
     SECTION("complex expression2") { REQUIRE(boolean_expression("printer_notes=~/.*PRINTER_VEwerfNDOR_PRUSA3D.*/ or printer_notes=~/.*PRINTertER_MODEL_MK2.*/ or (nozzle_diameter[0]==0.6 and num_extruders>1)")); }
     SECTION("complex expression3") { REQUIRE(! boolean_expression("printer_notes=~/.*PRINTER_VEwerfNDOR_PRUSA3D.*/ or printer_notes=~/.*PRINTertER_MODEL_MK2.*/ or (nozzle_diameter[0]==0.3 and num_extruders>1)")); }
 }
+
+SCENARIO("Placeholder parser processing of the cached templates", "[PlaceholderParser]") {
+	PlaceholderParser 	parser;
+	auto 				config = DynamicPrintConfig::full_print_config();
+	config.set_deserialize({ { "layer_height", "0.2" } });
+    parser.apply_config(config);
+	parser.set("temperature", new ConfigOptionInts({ 357, 359, 363, 378 }));
+	parser.set("foo", 0);
+	parser.set("bar", 2);
+	parser.set("name", std::string("part"));
+
+	const std::string templ =
+		"M104 S[temperature] ; {name}\n"
+		"{if bar > 1}G1 Z{layer_height + 0.1}{else}G1 Z0{endif}\n"
+		"; { foo } [ bar ] {\"}\"} [temperature_[bar]]\n";
+
+    SECTION("repeated processing yields the same result") {
+    	std::string first = parser.process(templ, 1);
+    	REQUIRE(first == "M104 S359 ; part\nG1 Z0.3\n; 0 2 } 363\n");
+    	REQUIRE(parser.process(templ, 1) == first);
+    	REQUIRE(PlaceholderParser(parser).process(templ, 1) == first);
+    }
+    SECTION("variables are resolved at each call") {
+    	REQUIRE(parser.process(templ, 0) == "M104 S357 ; part\nG1 Z0.3\n; 0 2 } 363\n");
+    	parser.set("bar", 0);
+    	parser.set("name", std::string("other"));
+    	REQUIRE(parser.process(templ, 5) == "M104 S357 ; other\nG1 Z0\n; 0 0 } 357\n");
+    }
+    SECTION("config override has precedence") {
+    	DynamicConfig config_override;
+    	config_override.set_key_value("name", new ConfigOptionString("override"));
+    	REQUIRE(parser.process("{name}", 0, &config_override) == "override");
+    	REQUIRE(parser.process("{name}") == "part");
+    }
+    SECTION("errors are reported by the cached templates") {
+    	REQUIRE_THROWS(parser.process("G1 {undefined_variable}"));
+    	REQUIRE_THROWS(parser.process("G1 {undefined_variable}"));
+    	REQUIRE_THROWS(parser.process("G1 [undefined_variable]"));
+    	REQUIRE_THROWS(parser.process("G1 {else} G2"));
+    	REQUIRE_THROWS(parser.process("G1 {if foo == 0} G2"));
+    	REQUIRE_THROWS(parser.process("G1 {if foo == 0} G2 {else} G3 {else} G4 {endif}"));
+    	REQUIRE_THROWS(parser.process("G1 {if foo} G2 {endif}"));
+    	// The branches not taken are evaluated as well.
+    	REQUIRE_THROWS(parser.process("G1 {if foo == 0} G2 {else} {undefined_variable} {endif}"));
+    	REQUIRE_THROWS(parser.process("G1 {if foo == 0} G2 {elsif undefined_variable} G3 {endif}"));
+    }
+    SECTION("conditional blocks are compiled") {
+    	const std::string start_gcode =
+    		"M104 S[first_layer_temperature] ; set extruder temp\n"
+    		"M140 S[first_layer_bed_temperature] ; set bed temp\n"
+    		"G28 W ; home all without mesh bed level\n"
+    		"{if bar > 1}G1 Z{layer_height} F720\n{if foo == 0}G92 E0\n{endif}{else}G1 Z0.2 F720\n{endif}"
+    		"{if nozzle_diameter[0] == 0.6}M221 S95\n{elsif nozzle_diameter[0] == 0.4}M221 S100\n{else}M221 S90\n{endif}"
+    		"{if use_relative_e_distances}M83{else}M82{endif} ; extruder mode\n";
+    	REQUIRE(parser.is_template_compiled(start_gcode));
+    	std::string expected =
+    		"M104 S200 ; set extruder temp\n"
+    		"M140 S0 ; set bed temp\n"
+    		"G28 W ; home all without mesh bed level\n"
+    		"G1 Z0.2 F720\nG92 E0\n"
+    		"M221 S95\n"
+    		"M82 ; extruder mode\n";
+    	parser.set("nozzle_diameter", new ConfigOptionFloats({ 0.6 }));
+    	parser.set("first_layer_temperature", new ConfigOptionInts({ 200 }));
+    	parser.set("first_layer_bed_temperature", new ConfigOptionInts({ 0 }));
+    	REQUIRE(parser.process(start_gcode) == expected);
+    	parser.set("bar", 0);
+    	parser.set("nozzle_diameter", new ConfigOptionFloats({ 0.4 }));
+    	parser.set("use_relative_e_distances", true);
+    	REQUIRE(parser.process(start_gcode) ==
+    		"M104 S200 ; set extruder temp\n"
+    		"M140 S0 ; set bed temp\n"
+    		"G28 W ; home all without mesh bed level\n"
+    		"G1 Z0.2 F720\n"
+    		"M221 S100\n"
+    		"M83 ; extruder mode\n");
+    	// Not compiled, processed by the macro processor.
+    	REQUIRE(! parser.is_template_compiled("{if bar > 1}G1{endif} ; \xc2\xb0C"));
+    	REQUIRE(! parser.is_template_compiled("G1 {else} G2"));
+    }
+}
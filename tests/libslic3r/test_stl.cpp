@@ -3,6 +3,14 @@
 #include "libslic3r/Model.hpp"
 #include "libslic3r/Format/STL.hpp"
 
+#include <admesh/stl.h>
+
+#include <boost/filesystem.hpp>
+#include <boost/nowide/cstdio.hpp>
+
+#include <cstring>
+#include <random>
+
 using namespace Slic3r;
 
 static inline std::string stl_path(const char* path)
@@ -55,3 +63,105 @@ SCENARIO("Reading an STL file", "[stl]") {
 		}
 	}
 }
+
+SCENARIO("Writing and reading back an ASCII STL file", "[stl]") {
+	GIVEN("a binary STL file with non round coordinates") {
+		stl_file stl;
+		REQUIRE(stl_open(&stl, stl_path("Geräte/20mmbox-čřšřěá.stl").c_str()));
+		REQUIRE(stl.stats.type == binary);
+		for (stl_facet &facet : stl.facet_start)
+			for (stl_vertex &v : facet.vertex)
+				v = v * 0.3173f - stl_vertex(1.f / 3.f, 1e-7f, -12345.678f);
+		WHEN("the file is written in ASCII format and read back") {
+			boost::filesystem::path temp = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path();
+			REQUIRE(stl_write_ascii(&stl, temp.string().c_str(), "test"));
+			stl_file loaded;
+			bool loaded_ok = stl_open(&loaded, temp.string().c_str());
+			boost::nowide::remove(temp.string().c_str());
+			THEN("the facets are loaded exactly") {
+				REQUIRE(loaded_ok);
+				REQUIRE(loaded.stats.type == ascii);
+				REQUIRE(loaded.stats.number_of_facets == stl.stats.number_of_facets);
+				for (size_t i = 0; i < stl.facet_start.size(); ++ i)
+					for (size_t j = 0; j < 3; ++ j)
+						REQUIRE(loaded.facet_start[i].vertex[j] == stl.facet_start[i].vertex[j]);
+			}
+		}
+	}
+}
+
+SCENARIO("Reading the coordinates of an ASCII STL file", "[stl]") {
+	GIVEN("an ASCII STL file with short decimal coordinates") {
+		// Short decimals are converted by the parser itself, the longer ones by strtof().
+		std::vector<std::string> values { "0", "-0", "0.0000", "-0.0000", "7", "+3.25", ".5", "-.5", "1.", "0.1", "-0.1", "0.3", "1.5E+02", "2.5e-3",
+			"-4.125E1", "1234567", "9999999", "0.0000001", "1e10", "1e-10", "3.4028235e38", "12345678", "0.123456789", "1e-45" };
+		std::mt19937 gen(0);
+		std::uniform_real_distribution<float> dist(-1000.f, 1000.f);
+		char buf[64];
+		for (size_t i = 0; i < 3000; ++ i) {
+			sprintf(buf, (i % 3 == 0) ? "%.4f" : (i % 3 == 1) ? "%.2f" : "%.3e", dist(gen));
+			values.emplace_back(buf);
+		}
+		while (values.size() % 9 != 0)
+			values.emplace_back("1.25");
+		boost::filesystem::path temp = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path();
+		FILE *fp = boost::nowide::fopen(temp.string().c_str(), "w");
+		REQUIRE(fp != nullptr);
+		fprintf(fp, "solid test\n");
+		for (size_t i = 0; i < values.size(); i += 9) {
+			fprintf(fp, "  facet normal 0 0 1\n    outer loop\n");
+			for (size_t j = 0; j < 9; j += 3)
+				fprintf(fp, "      vertex %s %s %s\n", values[i + j].c_str(), values[i + j + 1].c_str(), values[i + j + 2].c_str());
+			fprintf(fp, "    endloop\n  endfacet\n");
+		}
+		fprintf(fp, "endsolid test\n");
+		fclose(fp);
+		WHEN("the file is read") {
+			stl_file loaded;
+			bool loaded_ok = stl_open(&loaded, temp.string().c_str());
+			boost::nowide::remove(temp.string().c_str());
+			THEN("the coordinates match strtof() exactly") {
+				REQUIRE(loaded_ok);
+				REQUIRE(loaded.stats.type == ascii);
+				REQUIRE(loaded.facet_start.size() == values.size() / 9);
+				for (size_t i = 0; i < values.size(); ++ i) {
+					float expected = strtof(values[i].c_str(), nullptr);
+					float parsed   = loaded.facet_start[i / 9].vertex[(i % 9) / 3]((int)(i % 3));
+					INFO(values[i]);
+					// Compare the bits to tell the negative zero apart.
+					REQUIRE(memcmp(&parsed, &expected, sizeof(float)) == 0);
+				}
+			}
+		}
+	}
+}
+
+SCENARIO("Connecting facets of an STL", "[stl]") {
+	GIVEN("three facets sharing a single edge") {
+		stl_file stl;
+		stl.stats.type = inmemory;
+		stl.stats.number_of_facets = 3;
+		stl.stats.original_num_facets = 3;
+		stl_allocate(&stl);
+		const stl_vertex a(0.f, 0.f, 0.f), b(1.f, 0.f, 0.f);
+		const stl_vertex apex[3] = { stl_vertex(0.f, 1.f, 0.f), stl_vertex(0.f, -1.f, 0.f), stl_vertex(0.f, 0.f, 1.f) };
+		for (size_t i = 0; i < 3; ++ i) {
+			stl_facet &facet = stl.facet_start[i];
+			facet.normal = stl_normal::Zero();
+			facet.vertex[0] = (i == 1) ? b : a;
+			facet.vertex[1] = (i == 1) ? a : b;
+			facet.vertex[2] = apex[i];
+		}
+		WHEN("the facets are connected exactly") {
+			stl_check_facets_exact(&stl);
+			THEN("the first two facets are connected, the third one is not") {
+				REQUIRE(stl.stats.connected_edges == 2);
+				REQUIRE(stl.stats.connected_facets_1_edge == 2);
+				REQUIRE(stl.stats.connected_facets_2_edge == 0);
+				REQUIRE(stl.neighbors_start[0].neighbor[0] == 1);
+				REQUIRE(stl.neighbors_start[1].neighbor[0] == 0);
+				REQUIRE(stl.neighbors_start[2].num_neighbors() == 0);
+			}
+		}
+	}
+}
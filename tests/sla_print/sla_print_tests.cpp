@@ -4,6 +4,9 @@
 
 #include "sla_test_utils.hpp"
 
+#include "libslic3r/Model.hpp"
+#include "libslic3r/SLA/Rotfinder.hpp"
+
 namespace {
 
 const char *const BELOW_PAD_TEST_OBJECTS[] = {
@@ -82,6 +85,68 @@ TEST_CASE("Support point generator should be deterministic if seeded",
     }
 }
 
+TEST_CASE("Support tree rebuild should reuse the cached heads",
+          "[SLASupportGeneration]") {
+    TriangleMesh mesh = load_model("A_upsidedown.obj");
+    sla::EigenMesh3D emesh{mesh};
+
+    sla::SupportConfig supportcfg;
+    sla::SupportPointGenerator::Config autogencfg;
+    autogencfg.head_diameter = float(2 * supportcfg.head_front_radius_mm);
+    sla::SupportPointGenerator point_gen{emesh, autogencfg, [] {}, [](int) {}};
+
+    TriangleMeshSlicer slicer{&mesh};
+    auto bb   = mesh.bounding_box();
+    auto gnd  = float(bb.min.z() - supportcfg.object_elevation_mm);
+    auto slicegrid = grid(gnd, float(bb.max.z()), 0.05f);
+    std::vector<ExPolygons> slices;
+    slicer.slice(slicegrid, SlicingMode::Regular, CLOSING_RADIUS, &slices, []{});
+
+    point_gen.seed(0);
+    point_gen.execute(slices, slicegrid);
+    sla::SupportPoints pts = point_gen.output();
+    REQUIRE(pts.size() > 1);
+
+    // The cache is bound to the mesh instance, like in SLAPrintObject
+    sla::SupportableMesh sm{emesh, pts, supportcfg};
+    sla::SupportTreeCache cache;
+
+    sla::SupportTreeBuilder first;
+    first.build(sm, &cache);
+    size_t cached_cnt = cache.size();
+    REQUIRE(cached_cnt > 0);
+
+    // Simulate the removal of a single support point in the editor.
+    sm.pts.pop_back();
+
+    sla::SupportTreeBuilder uncached, cached;
+    uncached.build(sm);
+    cached.build(sm, &cache);
+
+    REQUIRE(cache.size() <= cached_cnt);
+    REQUIRE(cached.heads().size() == uncached.heads().size());
+    check_support_tree_integrity(cached, supportcfg);
+}
+
+TEST_CASE("Best rotation search should be deterministic", "[SLARotfinder]") {
+    Model model;
+    ModelObject *object = model.add_object();
+    object->add_volume(load_model("extruder_idler.obj"));
+    object->add_instance();
+
+    unsigned last_status = 0;
+    auto statuscb = [&last_status](unsigned st) { last_status = st; };
+
+    std::array<double, 3> rot1 = sla::find_best_rotation(*object, 0.02f, statuscb);
+    std::array<double, 3> rot2 = sla::find_best_rotation(*object, 0.02f);
+
+    REQUIRE(last_status > 0);
+    for (size_t i = 0; i < 3; ++i) {
+        REQUIRE(rot1[i] == rot2[i]);
+        REQUIRE(std::abs(rot1[i]) <= PI / 2 + EPSILON);
+    }
+}
+
 TEST_CASE("Flat pad geometry is valid", "[SLASupportGeneration]") {
     sla::PadConfig padcfg;
     
@@ -123,6 +188,31 @@ TEST_CASE("WingedPadAroundObjectIsValid", "[SLASupportGeneration]") {
     for (auto &fname : AROUND_PAD_TEST_OBJECTS) test_pad(fname, padcfg);
 }
 
+TEST_CASE("Pad with cached concave hull should match uncached pad",
+          "[SLASupportGeneration]") {
+    // Two separate support islands, merged by the concave hull
+    ExPolygon sup1 = square_with_hole(10.), sup2 = square_with_hole(10.);
+    sup2.translate(scaled(30.), 0);
+    ExPolygons supports = {sup1, sup2};
+
+    sla::PadConfig padcfg;
+    sla::PadCache  cache;
+
+    TriangleMesh first;
+    sla::create_pad(supports, {}, first, padcfg, []{}, &cache);
+    REQUIRE(cache.hull_valid);
+
+    // Parameter only change: the hull is taken from the cache
+    padcfg.wall_height_mm += 1.;
+
+    TriangleMesh cached, uncached;
+    sla::create_pad(supports, {}, cached, padcfg, []{}, &cache);
+    sla::create_pad(supports, {}, uncached, padcfg);
+
+    REQUIRE(cached.facets_count() == uncached.facets_count());
+    REQUIRE(cached.volume() == Approx(uncached.volume()));
+}
+
 TEST_CASE("ElevatedSupportGeometryIsValid", "[SLASupportGeneration]") {
     sla::SupportConfig supportcfg;
     supportcfg.object_elevation_mm = 5.;
@@ -226,3 +316,33 @@ TEST_CASE("Triangle mesh conversions should be correct", "[SLAConversions]")
         cntr.from_obj(infile);
     }
 }
+
+TEST_CASE("Island sampling should be uniform and deterministic if seeded", "[SLAPointGen]")
+{
+    // Large enough to be split into multiple sampling tiles.
+    ExPolygon island;
+    island.contour = Polygon{ {0, 0}, {scaled(100.), 0}, {scaled(100.), scaled(100.)}, {0, scaled(100.)} };
+    island.holes.emplace_back(Polygon{ {scaled(25.), scaled(25.)}, {scaled(25.), scaled(75.)}, {scaled(75.), scaled(75.)}, {scaled(75.), scaled(25.)} });
+
+    const float samples_per_mm2 = 10.f;
+    std::mt19937 rng(0);
+    std::vector<Vec2f> samples = sla::sample_expolygon(island, samples_per_mm2, rng);
+
+    REQUIRE(samples.size() == size_t(std::ceil(7500. * samples_per_mm2)));
+
+    BoundingBoxf bb(Vec2d(25., 25.), Vec2d(75., 75.));
+    size_t in_hole = 0;
+    for (const Vec2f &pt : samples) {
+        REQUIRE(pt.x() >= 0.f);
+        REQUIRE(pt.y() >= 0.f);
+        REQUIRE(pt.x() <= 100.f);
+        REQUIRE(pt.y() <= 100.f);
+        if (bb.contains(pt.cast<double>()))
+            ++ in_hole;
+    }
+    // Only the samples on the triangulation edges may touch the hole.
+    REQUIRE(in_hole < samples.size() / 1000);
+
+    std::mt19937 rng2(0);
+    REQUIRE(sla::sample_expolygon(island, samples_per_mm2, rng2) == samples);
+}
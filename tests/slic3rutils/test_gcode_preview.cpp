@@ -0,0 +1,98 @@
+#include <catch2/catch.hpp>
+
+#include "libslic3r/GCode/PreviewData.hpp"
+#include "slic3r/GUI/3DScene.hpp"
+
+using namespace Slic3r;
+
+// Zig-zag perimeters, the same number of segments in each layer.
+static void fill_preview_data(GCodePreviewData &preview_data, size_t num_layers)
+{
+    preview_data.reset();
+    for (size_t layer_id = 0; layer_id < num_layers; ++ layer_id) {
+        preview_data.extrusion.layers.emplace_back(0.2f * float(layer_id + 1));
+        GCodePreviewData::Extrusion::Layer &layer = preview_data.extrusion.layers.back();
+        for (size_t path_id = 0; path_id < 10; ++ path_id) {
+            GCodePreviewData::Extrusion::Path path;
+            path.extrusion_role = erPerimeter;
+            path.mm3_per_mm     = 0.05f;
+            path.width          = 0.45f;
+            path.height         = 0.2f;
+            path.feedrate       = 40.f;
+            path.extruder_id    = 0;
+            path.cp_color_id    = 0;
+            path.fan_speed      = 0.f;
+            for (size_t i = 0; i < 50; ++ i)
+                path.polyline.points.emplace_back(Point::new_scale(double(i), double(path_id + layer_id) + ((i & 1) ? 0.5 : 0.)));
+            layer.append(path);
+        }
+    }
+}
+
+// Vertices of the triangulated paths of a layer, as copied into a GLVolume.
+static std::vector<float> layer_vertices(const GCodePreviewToolpathsCache &cache, const GCodePreviewData &preview_data, size_t layer_id)
+{
+    GLIndexedVertexArray out;
+    for (size_t path_id = 0; path_id < preview_data.extrusion.layers[layer_id].num_paths(); ++ path_id)
+        cache.append_path(layer_id, path_id, out);
+    return out.vertices_and_normals_interleaved;
+}
+
+TEST_CASE("G-code preview toolpaths cache", "[GCodePreview]") {
+    GCodePreviewData           preview_data;
+    GCodePreviewToolpathsCache cache;
+    fill_preview_data(preview_data, 20);
+
+    cache.update(preview_data);
+    REQUIRE(cache.stats().layers_cached == 20);
+    REQUIRE(cache.stats().hits == 0);
+    REQUIRE(cache.stats().misses == 20);
+    const std::vector<float> bottom = layer_vertices(cache, preview_data, 0);
+    const std::vector<float> top    = layer_vertices(cache, preview_data, 19);
+    REQUIRE(! bottom.empty());
+    REQUIRE(! top.empty());
+
+    SECTION("reloading the same toolpaths hits the cache") {
+        cache.update(preview_data);
+        REQUIRE(cache.stats().hits == 20);
+        REQUIRE(cache.stats().misses == 0);
+        REQUIRE(layer_vertices(cache, preview_data, 19) == top);
+    }
+    SECTION("trim() releases the least recently used layers") {
+        // The layers shown by the layers slider are used more recently than the rest.
+        cache.refine(preview_data, 5, 10);
+        GCodePreviewToolpathsCache::Limits limits = cache.limits();
+        limits.cache_budget = cache.memory_used() / 2;
+        cache.set_limits(limits);
+        cache.trim();
+        REQUIRE(cache.memory_used() <= limits.cache_budget);
+        const size_t cached = cache.stats().layers_cached;
+        REQUIRE(cached < 20);
+        for (size_t layer_id = 5; layer_id < 10; ++ layer_id)
+            REQUIRE(cache.is_cached(layer_id));
+        REQUIRE(! cache.is_cached(0));
+        REQUIRE(cache.is_cached(19));
+
+        // The released layers are triangulated again.
+        cache.update(preview_data);
+        REQUIRE(cache.stats().hits == cached);
+        REQUIRE(cache.stats().misses == 20 - cached);
+        REQUIRE(cache.stats().layers_cached == 20);
+        REQUIRE(layer_vertices(cache, preview_data, 0) == bottom);
+        REQUIRE(layer_vertices(cache, preview_data, 19) == top);
+    }
+    SECTION("new toolpaths invalidate the cache") {
+        fill_preview_data(preview_data, 10);
+        cache.update(preview_data);
+        REQUIRE(cache.stats().layers == 10);
+        REQUIRE(cache.stats().hits == 0);
+        REQUIRE(cache.stats().misses == 10);
+    }
+    SECTION("reset() invalidates the cache") {
+        cache.reset();
+        REQUIRE(cache.empty());
+        cache.update(preview_data);
+        REQUIRE(cache.stats().hits == 0);
+        REQUIRE(cache.stats().misses == 20);
+    }
+}
@@ -0,0 +1,148 @@
+#include <catch2/catch.hpp>
+
+#include <random>
+
+#include "slic3r/Utils/UndoRedoHistory.hpp"
+
+using namespace Slic3r::UndoRedo;
+
+// Serialized data of a snapshot, repetitive enough to be compressible.
+static std::string snapshot_data(size_t size, size_t version)
+{
+    std::string out;
+    out.reserve(size);
+    for (size_t i = 0; out.size() < size; ++ i)
+        out += "volume " + std::to_string(i) + " offset " + std::to_string((i * 7) % 13) + ";";
+    out.resize(size);
+    // Modify a few bytes in the middle, as editing a single object does.
+    std::string edit = "version " + std::to_string(version);
+    out.replace(size / 2, edit.size(), edit);
+    return out;
+}
+
+static std::string random_data(size_t size)
+{
+    std::mt19937 gen(0);
+    std::uniform_int_distribution<int> dist(0, 255);
+    std::string out(size, '\0');
+    for (char &c : out)
+        c = char(dist(gen));
+    return out;
+}
+
+// Encode data the way the Undo / Redo stack does, with base as the preceding version.
+static void encode(MutableHistoryData *data, MutableHistoryData *base)
+{
+    MutableHistoryEncodeJob job(data, base ? MutableHistoryData::acquire(base) : nullptr, base ? base->decode() : std::string());
+    job.encode();
+    job.apply();
+}
+
+TEST_CASE("Undo / Redo mutable history data", "[UndoRedo]") {
+    const std::string v1 = snapshot_data(65536, 1);
+    const std::string v2 = snapshot_data(65536, 2);
+
+    SECTION("a small change is stored as a delta to the preceding version") {
+        auto *base = new MutableHistoryData(v1);
+        auto *data = new MutableHistoryData(v2);
+        encode(base, nullptr);
+        encode(data, base);
+        REQUIRE(data->base == base);
+        REQUIRE(data->depth == 1);
+        REQUIRE(data->prefix + data->suffix + data->payload.size() == v2.size());
+        REQUIRE(data->payload.size() < 16);
+        REQUIRE(v1.compare(0, data->prefix, v2, 0, data->prefix) == 0);
+        REQUIRE(data->decode() == v2);
+        MutableHistoryData::release(data);
+        MutableHistoryData::release(base);
+    }
+    SECTION("a key frame is compressed") {
+        auto *data = new MutableHistoryData(v1);
+        encode(data, nullptr);
+        REQUIRE(data->compressed);
+        REQUIRE(data->payload.size() < v1.size() / 4);
+        REQUIRE(data->decode() == v1);
+        MutableHistoryData::release(data);
+    }
+    SECTION("a large change is stored as a compressed key frame") {
+        auto *base = new MutableHistoryData(v1);
+        auto *data = new MutableHistoryData(std::string(v1.rbegin(), v1.rend()));
+        encode(data, base);
+        REQUIRE(data->base == nullptr);
+        REQUIRE(data->compressed);
+        REQUIRE(data->decode() == std::string(v1.rbegin(), v1.rend()));
+        MutableHistoryData::release(data);
+        MutableHistoryData::release(base);
+    }
+    SECTION("incompressible data is stored raw") {
+        const std::string random = random_data(4096);
+        auto *data = new MutableHistoryData(random);
+        encode(data, nullptr);
+        REQUIRE(data->is_raw());
+        REQUIRE(data->decode() == random);
+        MutableHistoryData::release(data);
+    }
+    SECTION("materialize() turns a delta into a compressed key frame") {
+        auto *base = new MutableHistoryData(v1);
+        auto *data = new MutableHistoryData(v2);
+        encode(base, nullptr);
+        encode(data, base);
+        REQUIRE(data->base == base);
+        // The history releases its reference to the base first.
+        MutableHistoryData::release(base);
+        data->materialize();
+        REQUIRE(data->base == nullptr);
+        REQUIRE(data->depth == 0);
+        REQUIRE(data->compressed);
+        REQUIRE(data->payload.size() < v2.size() / 4);
+        REQUIRE(data->decode() == v2);
+        MutableHistoryData::release(data);
+    }
+}
+
+TEST_CASE("Undo / Redo mutable object history", "[UndoRedo]") {
+    const size_t size = 65536;
+    const size_t num_snapshots = 100;
+
+    MutableObjectHistory<int> history;
+    MutableHistoryEncoder     encoder;
+    std::vector<std::string>  snapshots;
+
+    // Snapshot times of the data still stored by the history.
+    size_t first = 0;
+    for (size_t time = 0; time < num_snapshots; ++ time) {
+        // Take a snapshot: save the data and encode it in the background, while the preceding snapshots may still be encoded.
+        snapshots.emplace_back(snapshot_data(size, (time % 10 == 9) ? time - 1 : time));
+        history.save(time, time, std::string(snapshots.back()), encoder.jobs());
+        encoder.start();
+        // The memory of the stack is estimated while the data is being encoded.
+        REQUIRE(history.memsize() > 0);
+
+        if (time % 5 == 1) {
+            // Undo and take another snapshot: The data being encoded is released from the history and replaced.
+            history.release_after_timestamp(time);
+            snapshots.back() = snapshot_data(size, time + 1000);
+            history.save(time, time, std::string(snapshots.back()), encoder.jobs());
+            encoder.start();
+        }
+
+        if (time % 3 == 0) {
+            // Load a snapshot.
+            encoder.finish();
+            size_t t = first + (time * 7) % (time + 1 - first);
+            REQUIRE(history.load(t) == snapshots[t]);
+        }
+        if (time % 8 == 7) {
+            // Release the least recently used snapshots.
+            encoder.finish();
+            first += 3;
+            history.release_before_timestamp(first);
+            // The first data is stored compressed, not raw next to the raw copy of the last data.
+            REQUIRE(history.memsize() < 2 * size);
+        }
+    }
+    encoder.finish();
+
+    for (size_t t = first; t < num_snapshots; ++ t)
+        REQUIRE(history.load(t) == snapshots[t]);
+}